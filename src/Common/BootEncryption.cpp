@@ -1819,7 +1819,7 @@ namespace VeraCrypt
 			throw ParameterIncorrect (SRC_POS);
 
 		// we don't support Argon2 for system encryption for now
-		if (pkcs5_prf == ARGON2)
+		if (pkcs5_prf == ARGON2 || pkcs5_prf == ARGON2_P4)
 			throw ParameterIncorrect (SRC_POS);
 
 		int bootSectorId = 0;
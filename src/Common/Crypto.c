@@ -135,6 +135,7 @@ static Hash Hashes[] =
 	{ STREEBOG,		L"Streebog",	FALSE,	FALSE },
 #ifndef VC_DCS_DISABLE_ARGON2
 	{ ARGON2,		L"BLAKE2b-512",	FALSE,	FALSE },
+	{ ARGON2_P4,	L"BLAKE2b-512",	FALSE,	FALSE },
 #endif
     #endif
         { 0, 0, 0 }
@@ -746,6 +747,8 @@ int HashGetIdByName (wchar_t *name)
 #ifndef VC_DCS_DISABLE_ARGON2
 	if (_wcsicmp (name, L"Argon2") == 0 || _wcsicmp (name, L"Argon2id") == 0)
 		return ARGON2;
+	if (_wcsicmp (name, L"Argon2-P4") == 0)
+		return ARGON2_P4;
 #endif
 
 	for (i = 0; Hashes[i].Id != 0; i++)
@@ -48,6 +48,9 @@ extern "C" {
 // VeraCrypt Argon2id header key material size, in bytes, for the current volume format.
 // This is intentionally fixed for compatibility and must not depend on GetMaxPkcs5OutSize().
 #define ARGON2_HEADER_KEYDATA_SIZE	192
+
+// Number of lanes (parallelism) of the ARGON2_P4 KDF
+#define ARGON2_P4_LANES				4
 #endif
 
 // The first PRF to try when mounting
@@ -63,6 +66,7 @@ enum
 	STREEBOG,
 #ifndef VC_DCS_DISABLE_ARGON2
 	ARGON2,
+	ARGON2_P4,	// Argon2id with ARGON2_P4_LANES lanes
 #endif
 	HASH_ENUM_END_ID
 };
@@ -6655,6 +6655,11 @@ static BOOL PerformBenchmark(HWND hBenchDlg, HWND hwndDlg)
 
 			for (hid = FIRST_PRF_ID; hid <= LAST_PRF_ID; hid++) 
 			{
+#ifndef VC_DCS_DISABLE_ARGON2
+				// Same underlying hash as ARGON2
+				if (hid == ARGON2_P4)
+					continue;
+#endif
 				if (QueryPerformanceCounter (&performanceCountStart) == 0)
 					goto counter_error;
 
@@ -6773,6 +6778,12 @@ static BOOL PerformBenchmark(HWND hBenchDlg, HWND hwndDlg)
 					if (derive_key_argon2 ((const unsigned char*) "passphrase-1234567890", 21, (const unsigned char*)tmp_salt, 64, iterations, memoryCost, dk, ARGON2_HEADER_KEYDATA_SIZE, NULL) != 0)
 						goto key_derivation_error;
  					break;
+
+				case ARGON2_P4:
+					/* test with ARGON2_P4 used as the PRF */
+					if (derive_key_argon2_lanes ((const unsigned char*) "passphrase-1234567890", 21, (const unsigned char*)tmp_salt, 64, iterations, memoryCost, ARGON2_P4_LANES, dk, ARGON2_HEADER_KEYDATA_SIZE, NULL, NULL, NULL) != 0)
+						goto key_derivation_error;
+					break;
 				}
 	                   #endif	
                         }
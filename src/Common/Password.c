@@ -144,7 +144,7 @@ BOOL CheckPasswordLength (HWND hwndDlg, unsigned __int32 passwordLength, int pim
 	const char *pimLargeWarningMessage = "PIM_LARGE_WARNING";
 	const char *pimSmallWarningMessage = "PIM_SMALL_WARNING";
 #ifndef VC_DCS_DISABLE_ARGON2
-	argon2PimCondition = (bootPRF == ARGON2)? TRUE : FALSE;
+	argon2PimCondition = (bootPRF == ARGON2 || bootPRF == ARGON2_P4)? TRUE : FALSE;
 #endif
 	bootPimCondition = (!argon2PimCondition && bForBoot && (bootPRF != SHA512 && bootPRF != WHIRLPOOL))? TRUE : FALSE;
 	defaultPim = bootPimCondition? 98 : argon2PimCondition? 12 : 485;
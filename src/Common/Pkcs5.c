@@ -22,6 +22,7 @@
 #include "Whirlpool.h"
 #include "cpu.h"
 #include "misc.h"
+#include "hmac_mb.h"
 #else
 #pragma optimize ("t", on)
 #include <string.h>
@@ -36,6 +37,49 @@
 #include "Pkcs5.h"
 #include "Crypto.h"
 
+#ifdef HMAC_MB_AVAILABLE
+
+typedef void (*pbkdf2_mb_func) (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+
+/* Returns the multi-buffer core deriving the next group of the remaining blocks and sets *chains to the size of the
+   group, or returns NULL if the blocks are derived faster one by one. A core runs all its lanes whatever the number
+   of chains, so it is only used from a minimum number of chains which depends on the speed of the scalar code. */
+static pbkdf2_mb_func pbkdf2_mb_select (int blocks, int *chains, pbkdf2_mb_func avx2, int avx2_lanes, int avx2_min_chains, pbkdf2_mb_func avx512, int avx512_lanes, int avx512_min_chains)
+{
+#ifdef HMAC_MB_AVX512_AVAILABLE
+	if (HasSAVX512() && blocks >= avx512_min_chains)
+	{
+		*chains = blocks < avx512_lanes ? blocks : avx512_lanes;
+		return avx512;
+	}
+#endif
+	if (HasSAVX2() && blocks >= avx2_min_chains)
+	{
+		*chains = blocks < avx2_lanes ? blocks : avx2_lanes;
+		return avx2;
+	}
+
+	return NULL;
+}
+
+/* Runs iterations 2 to 'iterations' of the chains, which hold their first HMAC output in both u and x */
+static void pbkdf2_mb_iterate (pbkdf2_mb_func mb, const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations, long volatile *pAbortKeyDerivation)
+{
+	while (iterations > 1)
+	{
+		uint32 n = iterations - 1 < 1024 ? iterations - 1 : 1024;
+
+		// CANCELLATION CHECK: Check every 1024 iterations
+		if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
+			return; // Abort derivation
+
+		mb (pwd, pwd_len, u, x, chains, n);
+		iterations -= n;
+	}
+}
+
+#endif
+
 #if !defined(TC_WINDOWS_BOOT) || defined(TC_WINDOWS_BOOT_SHA2)
 
 typedef struct hmac_sha256_ctx_struct
@@ -204,17 +248,44 @@ static void derive_u_sha256 (const unsigned char *salt, int salt_len, uint32 ite
 	}
 }
 
+#ifdef HMAC_MB_AVAILABLE
+static pbkdf2_mb_func pbkdf2_mb_select_sha256 (int blocks, int *chains)
+{
+#ifdef HMAC_MB_AVX512_AVAILABLE
+	pbkdf2_mb_func avx512 = pbkdf2_sha256_mb_avx512;
+#else
+	pbkdf2_mb_func avx512 = NULL;
+#endif
+	/* with SHA-NI, a single chain is hashed about 5.5 times faster than 8 chains with AVX2
+	   and 4 times faster than 16 chains with AVX-512 */
+	if (HasSHA256())
+		return pbkdf2_mb_select (blocks, chains, pbkdf2_sha256_mb_avx2, 8, 7, avx512, 16, 5);
+
+	return pbkdf2_mb_select (blocks, chains, pbkdf2_sha256_mb_avx2, 8, 3, avx512, 16, 2);
+}
+#endif
+
 
-void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen
 #ifndef TC_WINDOWS_BOOT
-	, long volatile *pAbortKeyDerivation
+void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation)
+{
+	derive_key_sha256_part (pwd, pwd_len, salt, salt_len, iterations, 0, dk, dklen, pAbortKeyDerivation);
+}
+
+void derive_key_sha256_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation)
+#else
+void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen)
 #endif
-)
 {	
 	hmac_sha256_ctx hmac;
 	sha256_ctx* ctx;
 	unsigned char* buf = hmac.k;
 	int b, l, r;
+#ifdef HMAC_MB_AVAILABLE
+	unsigned char mb_u[HMAC_MB_MAX_CHAINS * SHA256_DIGESTSIZE], mb_x[HMAC_MB_MAX_CHAINS * SHA256_DIGESTSIZE];
+	pbkdf2_mb_func mb;
+	int chains, i;
+#endif
 #ifndef TC_WINDOWS_BOOT
 	unsigned char key[SHA256_DIGESTSIZE];
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
@@ -274,14 +345,43 @@ void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned ch
 
 	sha256_hash (buf, SHA256_BLOCKSIZE, ctx);
 
+	b = 1;
+
+#ifdef HMAC_MB_AVAILABLE
+	/* groups of blocks in the lanes of a multi-buffer core */
+	while ((mb = pbkdf2_mb_select_sha256 (l - b + 1, &chains)) != NULL)
+	{
+		for (i = 0; i < chains; i++)
+		{
+			derive_u_sha256 (salt, salt_len, 1, first_block + b + i, &hmac, pAbortKeyDerivation);
+			memcpy (&mb_u[i * SHA256_DIGESTSIZE], hmac.u, SHA256_DIGESTSIZE);
+		}
+
+		memcpy (mb_x, mb_u, chains * SHA256_DIGESTSIZE);
+		pbkdf2_mb_iterate (mb, pwd, pwd_len, mb_u, mb_x, chains, iterations, pAbortKeyDerivation);
+		// Check if the derivation was aborted
+		if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
+			goto done;
+
+		for (i = 0; i < chains; i++, b++)
+		{
+			memcpy (dk, &mb_x[i * SHA256_DIGESTSIZE], b < l ? SHA256_DIGESTSIZE : r);
+			dk += SHA256_DIGESTSIZE;
+		}
+	}
+
+	if (b > l)
+		goto done;
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 #ifndef TC_WINDOWS_BOOT
-		derive_u_sha256 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		derive_u_sha256 (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
 		if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
-			goto cancelled;
+			goto done;
 #else
 		derive_u_sha256 (salt, salt_len, iterations, b, &hmac);
 #endif
@@ -291,17 +391,17 @@ void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned ch
 
 	/* last block */
 #ifndef TC_WINDOWS_BOOT
-	derive_u_sha256 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+	derive_u_sha256 (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 	// Check if the derivation was aborted (in case of only one block)
 	if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
-		goto cancelled;
+		goto done;
 #else
 	derive_u_sha256 (salt, salt_len, iterations, b, &hmac);
 #endif
 	memcpy (dk, hmac.u, r);
 
 #ifndef TC_WINDOWS_BOOT
-cancelled:
+done:
 #endif
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	if (NT_SUCCESS (saveStatus))
@@ -309,6 +409,10 @@ void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned ch
 #endif
 	/* Prevent possible leaks. */
 	burn (&hmac, sizeof(hmac));
+#ifdef HMAC_MB_AVAILABLE
+	burn (mb_u, sizeof(mb_u));
+	burn (mb_x, sizeof(mb_x));
+#endif
 #ifndef TC_WINDOWS_BOOT
 	burn (key, sizeof(key));
 #endif
@@ -453,14 +557,36 @@ static void derive_u_sha512 (const unsigned char *salt, int salt_len, uint32 ite
 	}
 }
 
+#ifdef HMAC_MB_AVAILABLE
+static pbkdf2_mb_func pbkdf2_mb_select_sha512 (int blocks, int *chains)
+{
+#ifdef HMAC_MB_AVX512_AVAILABLE
+	pbkdf2_mb_func avx512 = pbkdf2_sha512_mb_avx512;
+#else
+	pbkdf2_mb_func avx512 = NULL;
+#endif
+	return pbkdf2_mb_select (blocks, chains, pbkdf2_sha512_mb_avx2, 4, 3, avx512, 8, 3);
+}
+#endif
+
 
 void derive_key_sha512 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation)
+{
+	derive_key_sha512_part (pwd, pwd_len, salt, salt_len, iterations, 0, dk, dklen, pAbortKeyDerivation);
+}
+
+void derive_key_sha512_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation)
 {
 	hmac_sha512_ctx hmac;
 	sha512_ctx* ctx;
 	unsigned char* buf = hmac.k;
 	int b, l, r;
 	unsigned char key[SHA512_DIGESTSIZE];
+#ifdef HMAC_MB_AVAILABLE
+	unsigned char mb_u[HMAC_MB_MAX_CHAINS / 2 * SHA512_DIGESTSIZE], mb_x[HMAC_MB_MAX_CHAINS / 2 * SHA512_DIGESTSIZE];
+	pbkdf2_mb_func mb;
+	int chains, i;
+#endif
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	NTSTATUS saveStatus = STATUS_INVALID_PARAMETER;
 	XSTATE_SAVE SaveState;
@@ -518,31 +644,64 @@ void derive_key_sha512 (const unsigned char *pwd, int pwd_len, const unsigned ch
 
 	sha512_hash (buf, SHA512_BLOCKSIZE, ctx);
 
+	b = 1;
+
+#ifdef HMAC_MB_AVAILABLE
+	/* groups of blocks in the lanes of a multi-buffer core */
+	while ((mb = pbkdf2_mb_select_sha512 (l - b + 1, &chains)) != NULL)
+	{
+		for (i = 0; i < chains; i++)
+		{
+			derive_u_sha512 (salt, salt_len, 1, first_block + b + i, &hmac, pAbortKeyDerivation);
+			memcpy (&mb_u[i * SHA512_DIGESTSIZE], hmac.u, SHA512_DIGESTSIZE);
+		}
+
+		memcpy (mb_x, mb_u, chains * SHA512_DIGESTSIZE);
+		pbkdf2_mb_iterate (mb, pwd, pwd_len, mb_u, mb_x, chains, iterations, pAbortKeyDerivation);
+		// Check if the derivation was aborted
+		if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
+			goto done;
+
+		for (i = 0; i < chains; i++, b++)
+		{
+			memcpy (dk, &mb_x[i * SHA512_DIGESTSIZE], b < l ? SHA512_DIGESTSIZE : r);
+			dk += SHA512_DIGESTSIZE;
+		}
+	}
+
+	if (b > l)
+		goto done;
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
-		derive_u_sha512 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		derive_u_sha512 (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
 		if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
-			goto cancelled;
+			goto done;
 		memcpy (dk, hmac.u, SHA512_DIGESTSIZE);
 		dk += SHA512_DIGESTSIZE;
 	}
 
 	/* last block */
-	derive_u_sha512 (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+	derive_u_sha512 (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 	// Check if the derivation was aborted (in case of only one block)
 	if (pAbortKeyDerivation && *pAbortKeyDerivation == 1)
-		goto cancelled;
+		goto done;
 	memcpy (dk, hmac.u, r);
 
-cancelled:
+done:
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
 	if (NT_SUCCESS (saveStatus))
 		KeRestoreExtendedProcessorState(&SaveState);
 #endif
 	/* Prevent possible leaks. */
 	burn (&hmac, sizeof(hmac));
+#ifdef HMAC_MB_AVAILABLE
+	burn (mb_u, sizeof(mb_u));
+	burn (mb_x, sizeof(mb_x));
+#endif
 	burn (key, sizeof(key));
 }
 
@@ -705,17 +864,39 @@ static void derive_u_blake2s (const unsigned char *salt, int salt_len, uint32 it
 	}
 }
 
+#ifdef HMAC_MB_AVAILABLE
+static pbkdf2_mb_func pbkdf2_mb_select_blake2s (int blocks, int *chains)
+{
+#ifdef HMAC_MB_AVX512_AVAILABLE
+	pbkdf2_mb_func avx512 = pbkdf2_blake2s_mb_avx512;
+#else
+	pbkdf2_mb_func avx512 = NULL;
+#endif
+	return pbkdf2_mb_select (blocks, chains, pbkdf2_blake2s_mb_avx2, 8, 2, avx512, 16, 2);
+}
+#endif
+
 
-void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen
 #ifndef TC_WINDOWS_BOOT
-	, volatile long *pAbortKeyDerivation
+void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
+{
+	derive_key_blake2s_part (pwd, pwd_len, salt, salt_len, iterations, 0, dk, dklen, pAbortKeyDerivation);
+}
+
+void derive_key_blake2s_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
+#else
+void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen)
 #endif
-)
 {	
 	hmac_blake2s_ctx hmac;
 	blake2s_state* ctx;
 	unsigned char* buf = hmac.k;
 	int b, l, r;
+#ifdef HMAC_MB_AVAILABLE
+	unsigned char mb_u[HMAC_MB_MAX_CHAINS * BLAKE2S_DIGESTSIZE], mb_x[HMAC_MB_MAX_CHAINS * BLAKE2S_DIGESTSIZE];
+	pbkdf2_mb_func mb;
+	int chains, i;
+#endif
 #ifndef TC_WINDOWS_BOOT
 	unsigned char key[BLAKE2S_DIGESTSIZE];
     /* If the password is longer than the hash algorithm block size,
@@ -769,14 +950,43 @@ void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned c
 
 	blake2s_update (ctx, buf, BLAKE2S_BLOCKSIZE);
 
+	b = 1;
+
+#ifdef HMAC_MB_AVAILABLE
+	/* groups of blocks in the lanes of a multi-buffer core */
+	while ((mb = pbkdf2_mb_select_blake2s (l - b + 1, &chains)) != NULL)
+	{
+		for (i = 0; i < chains; i++)
+		{
+			derive_u_blake2s (salt, salt_len, 1, first_block + b + i, &hmac, pAbortKeyDerivation);
+			memcpy (&mb_u[i * BLAKE2S_DIGESTSIZE], hmac.u, BLAKE2S_DIGESTSIZE);
+		}
+
+		memcpy (mb_x, mb_u, chains * BLAKE2S_DIGESTSIZE);
+		pbkdf2_mb_iterate (mb, pwd, pwd_len, mb_u, mb_x, chains, iterations, pAbortKeyDerivation);
+		// Check if the derivation was aborted
+		if (pAbortKeyDerivation && *pAbortKeyDerivation)
+			goto done;
+
+		for (i = 0; i < chains; i++, b++)
+		{
+			memcpy (dk, &mb_x[i * BLAKE2S_DIGESTSIZE], b < l ? BLAKE2S_DIGESTSIZE : r);
+			dk += BLAKE2S_DIGESTSIZE;
+		}
+	}
+
+	if (b > l)
+		goto done;
+#endif
+
 	/* first l - 1 blocks */
-	for (b = 1; b < l; b++)
+	for (; b < l; b++)
 	{
 #ifndef TC_WINDOWS_BOOT
-		derive_u_blake2s (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		derive_u_blake2s (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
 		if (pAbortKeyDerivation && *pAbortKeyDerivation)
-			goto cancelled;
+			goto done;
 #else
 		derive_u_blake2s (salt, salt_len, iterations, b, &hmac);
 #endif
@@ -786,20 +996,24 @@ void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned c
 
 	/* last block */
 #ifndef TC_WINDOWS_BOOT
-	derive_u_blake2s (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+	derive_u_blake2s (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 	// Check if the derivation was aborted (in case of only one block)
 	if (pAbortKeyDerivation && *pAbortKeyDerivation)
-		goto cancelled;
+		goto done;
 #else
 	derive_u_blake2s (salt, salt_len, iterations, b, &hmac);
 #endif
 	memcpy (dk, hmac.u, r);
 
 #ifndef TC_WINDOWS_BOOT
-cancelled:
+done:
 #endif
 	/* Prevent possible leaks. */
 	burn (&hmac, sizeof(hmac));
+#ifdef HMAC_MB_AVAILABLE
+	burn (mb_u, sizeof(mb_u));
+	burn (mb_x, sizeof(mb_x));
+#endif
 #ifndef TC_WINDOWS_BOOT
 	burn (key, sizeof(key));
 #endif
@@ -932,6 +1146,11 @@ static void derive_u_whirlpool (const unsigned char *salt, int salt_len, uint32
 }
 
 void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
+{
+	derive_key_whirlpool_part (pwd, pwd_len, salt, salt_len, iterations, 0, dk, dklen, pAbortKeyDerivation);
+}
+
+void derive_key_whirlpool_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
 {
 	hmac_whirlpool_ctx hmac;
 	WHIRLPOOL_CTX* ctx;
@@ -991,7 +1210,7 @@ void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned
 	/* first l - 1 blocks */
 	for (b = 1; b < l; b++)
 	{
-		derive_u_whirlpool (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		derive_u_whirlpool (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
 		if (pAbortKeyDerivation && *pAbortKeyDerivation)
 			goto cancelled;
@@ -1000,7 +1219,7 @@ void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned
 	}
 
 	/* last block */
-	derive_u_whirlpool (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+	derive_u_whirlpool (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 	// Check if the derivation was aborted (in case of only one block)
 	if (pAbortKeyDerivation && *pAbortKeyDerivation)
 		goto cancelled;
@@ -1135,6 +1354,11 @@ static void derive_u_streebog (const unsigned char *salt, int salt_len, uint32 i
 }
 
 void derive_key_streebog (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
+{
+	derive_key_streebog_part (pwd, pwd_len, salt, salt_len, iterations, 0, dk, dklen, pAbortKeyDerivation);
+}
+
+void derive_key_streebog_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
 {
 	hmac_streebog_ctx hmac;
 	STREEBOG_CTX* ctx;
@@ -1194,7 +1418,7 @@ void derive_key_streebog (const unsigned char *pwd, int pwd_len, const unsigned
 	/* first l - 1 blocks */
 	for (b = 1; b < l; b++)
 	{
-		derive_u_streebog (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+		derive_u_streebog (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 		// Check if the derivation was aborted
 		if (pAbortKeyDerivation && *pAbortKeyDerivation)
 			goto cancelled;
@@ -1203,7 +1427,7 @@ void derive_key_streebog (const unsigned char *pwd, int pwd_len, const unsigned
 	}
 
 	/* last block */
-	derive_u_streebog (salt, salt_len, iterations, b, &hmac, pAbortKeyDerivation);
+	derive_u_streebog (salt, salt_len, iterations, first_block + b, &hmac, pAbortKeyDerivation);
 	// Check if the derivation was aborted (in case of only one block)
 	if (pAbortKeyDerivation && *pAbortKeyDerivation)
 		goto cancelled;
@@ -1236,6 +1460,9 @@ wchar_t *get_kdf_name (int kdf_id)
 #ifndef VC_DCS_DISABLE_ARGON2
 	case ARGON2:
 		return L"Argon2";
+
+	case ARGON2_P4:
+		return L"Argon2-P4";
 #endif
 
 	default:		
@@ -1287,6 +1514,10 @@ int get_pkcs5_iteration_count(int pkcs5_prf_id, int pim, BOOL bBoot, int* pMemor
 		case ARGON2:
 			get_argon2_params (pim, &iteration_count, pMemoryCost);
 			break;
+
+		case ARGON2_P4:
+			get_argon2_p4_params (pim, &iteration_count, pMemoryCost);
+			break;
 #endif
 
 		default:
@@ -1308,7 +1539,7 @@ int is_pkcs5_prf_supported (int pkcs5_prf_id, PRF_BOOT_TYPE bootType)
       return 0;
 #ifndef VC_DCS_DISABLE_ARGON2
    // we don't support Argon2 in pre-boot authentication
-   if ((bootType == PRF_BOOT_MBR || bootType == PRF_BOOT_GPT) && pkcs5_prf_id == ARGON2)
+   if ((bootType == PRF_BOOT_MBR || bootType == PRF_BOOT_GPT) && (pkcs5_prf_id == ARGON2 || pkcs5_prf_id == ARGON2_P4))
       return 0;	
 #endif
    return 1;
@@ -1317,6 +1548,11 @@ int is_pkcs5_prf_supported (int pkcs5_prf_id, PRF_BOOT_TYPE bootType)
 
 #ifndef VC_DCS_DISABLE_ARGON2
 int derive_key_argon2(const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, uint32 memcost, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation)
+{
+	return derive_key_argon2_lanes (pwd, pwd_len, salt, salt_len, iterations, memcost, 1, dk, dklen, pAbortKeyDerivation, NULL, NULL);
+}
+
+int derive_key_argon2_lanes(const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, uint32 memcost, uint32 lanes, unsigned char *dk, int dklen, volatile long *pAbortKeyDerivation, run_lanes_fptr run_lanes, void *run_lanes_data)
 {
 	int result;
 #if defined (DEVICE_DRIVER) && !defined(_M_ARM64)
@@ -1325,14 +1561,15 @@ int derive_key_argon2(const unsigned char *pwd, int pwd_len, const unsigned char
 	if (HasSAVX2())
 		saveStatus = KeSaveExtendedProcessorState(XSTATE_MASK_GSSE, &SaveState);
 #endif
-	result = argon2id_hash_raw(
+	result = argon2id_hash_raw_lanes(
 		iterations, // number of iterations
 		memcost, // memory cost in KiB
-		1, // parallelism factor (number of threads)
+		lanes, // parallelism factor (number of lanes)
 		pwd, pwd_len, // password and its length
 		salt, salt_len, // salt and its length
 		dk, dklen,// derived key and its length
-		pAbortKeyDerivation 
+		pAbortKeyDerivation,
+		run_lanes, run_lanes_data // executor filling the lanes of each slice
 	);
 	if (0 != result)
 	{
@@ -1427,6 +1664,23 @@ void get_argon2_params(int pim, int* pIterations, int* pMemcost)
         *pIterations = 13 + (pim - 31);
     }
 }
+
+/**
+ * get_argon2_p4_params
+ *
+ * Memory cost and time cost of the ARGON2_P4 KDF (Argon2id with ARGON2_P4_LANES lanes) for a given PIM.
+ *
+ * The memory cost and the time cost are the ones of Argon2 (see get_argon2_params), so the derivation takes
+ * about as long as Argon2 when the lanes are filled one after another (e.g. on Windows) and the lanes filled
+ * concurrently only shorten it.
+ *
+ * Example:
+ *   - For PIM = 12 (default): 416 MiB and 6 iterations
+ */
+void get_argon2_p4_params(int pim, int* pIterations, int* pMemcost)
+{
+	get_argon2_params (pim, pIterations, pMemcost);
+}
 #endif
 
 #endif //!TC_WINDOWS_BOOT
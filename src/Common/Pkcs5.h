@@ -15,6 +15,9 @@
 #define TC_HEADER_PKCS5
 
 #include "Tcdefs.h"
+#if !defined(TC_WINDOWS_BOOT) && !defined(VC_DCS_DISABLE_ARGON2)
+#include "argon2.h"
+#endif
 
 #if defined(__cplusplus)
 extern "C"
@@ -22,24 +25,32 @@ extern "C"
 #endif
 
 #ifndef TC_WINDOWS_BOOT
+/* derive_key_*_part functions write dklen bytes of the derived key starting at output block first_block
+   (zero-based), so that independent parts of a key can be derived concurrently */
+
 /* output written to input_digest which must be at lease 32 bytes long */
 void hmac_blake2s (unsigned char *key, int keylen, unsigned char *input_digest, int len);
 void derive_key_blake2s (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+void derive_key_blake2s_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 /* output written to d which must be at lease 32 bytes long */
 void hmac_sha256 (unsigned char *k, int lk, unsigned char *d, int ld);
 void derive_key_sha256 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+void derive_key_sha256_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 /* output written to d which must be at lease 64 bytes long */
 void hmac_sha512 (unsigned char *k, int lk, unsigned char *d, int ld);
 void derive_key_sha512 (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+void derive_key_sha512_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 /* output written to d which must be at lease 64 bytes long */
 void hmac_whirlpool (unsigned char *k, int lk, unsigned char *d, int ld);
 void derive_key_whirlpool (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+void derive_key_whirlpool_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 void hmac_streebog (unsigned char *k, int lk, unsigned char *d, int ld);
 void derive_key_streebog (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
+void derive_key_streebog_part (const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, int first_block, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 
 int get_pkcs5_iteration_count (int pkcs5_prf_id, int pim, BOOL bBoot, int* pMemoryCost);
 wchar_t *get_kdf_name (int kdf_id);
@@ -47,6 +58,10 @@ wchar_t *get_kdf_name (int kdf_id);
 #ifndef VC_DCS_DISABLE_ARGON2
 int derive_key_argon2(const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, uint32 memcost, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation);
 void get_argon2_params(int pim, int* pIterations, int* pMemcost);
+/* Argon2id with several lanes; the lanes of each slice are filled by run_lanes (e.g. on worker threads)
+   or one after another if run_lanes is NULL, which yields the same key */
+int derive_key_argon2_lanes(const unsigned char *pwd, int pwd_len, const unsigned char *salt, int salt_len, uint32 iterations, uint32 memcost, uint32 lanes, unsigned char *dk, int dklen, long volatile *pAbortKeyDerivation, run_lanes_fptr run_lanes, void *run_lanes_data);
+void get_argon2_p4_params(int pim, int* pIterations, int* pMemcost);
 #endif
 
 /* check if given PRF supported.*/
@@ -283,6 +283,7 @@ BOOL Randmix ()
 				break;
 
 			case ARGON2:
+			case ARGON2_P4:
 				digestSize = BLAKE2B_DIGESTSIZE;
 				break;
 	
@@ -338,6 +339,7 @@ BOOL Randmix ()
 				break;
 
 			case ARGON2:
+			case ARGON2_P4:
 				// For Argon2, we use the underlying Blake2b hash function
 				blake2b_init(&b2ctx, BLAKE2B_OUTBYTES);
 				blake2b_update(&b2ctx, pRandPool, RNG_POOL_SIZE);
@@ -374,6 +376,7 @@ BOOL Randmix ()
 				break;
 
 			case ARGON2:
+			case ARGON2_P4:
 				burn (&b2ctx, sizeof(b2ctx));
 				break;
 
@@ -339,7 +339,7 @@ int ReadVolumeHeaderWithAbort (BOOL bBoot, unsigned char *encryptedHeader, Passw
 
 #ifndef VC_DCS_DISABLE_ARGON2
 		// we don't support Argon2 in pre-boot authentication
-		if (bBoot && (enqPkcs5Prf == ARGON2))
+		if (bBoot && (enqPkcs5Prf == ARGON2 || enqPkcs5Prf == ARGON2_P4))
 			continue;
 #endif
 
@@ -393,7 +393,7 @@ int ReadVolumeHeaderWithAbort (BOOL bBoot, unsigned char *encryptedHeader, Passw
 						if (derivationResult != 0)
 						{
 #ifndef VC_DCS_DISABLE_ARGON2
-							if (item->Pkcs5Prf == ARGON2)
+							if (item->Pkcs5Prf == ARGON2 || item->Pkcs5Prf == ARGON2_P4)
 								lastArgon2DerivationResult = (int) derivationResult;
 #endif
 							item->Free = TRUE;
@@ -475,6 +475,24 @@ KeyReady:	;
 					}
 				}
 				break;
+
+			case ARGON2_P4:
+				{
+					int derivationResult = derive_key_argon2_lanes(keyInfo->userKey, keyInfo->keyLength, keyInfo->salt,
+						PKCS5_SALT_SIZE, keyInfo->noIterations, keyInfo->memoryCost, ARGON2_P4_LANES, dk, ARGON2_HEADER_KEYDATA_SIZE, effectiveAbortKeyDerivation, NULL, NULL);
+					if (derivationResult != 0)
+					{
+						if (selected_pkcs5_prf == 0)
+						{
+							lastArgon2DerivationResult = derivationResult;
+							continue;
+						}
+
+						status = MapArgon2ResultToVcError (derivationResult);
+						goto err;
+					}
+				}
+				break;
 #endif
 #endif	
                         default:
@@ -513,7 +531,7 @@ KeyReady:	;
 
 #ifndef VC_DCS_DISABLE_ARGON2
 				/* Only XTS mode reaches this point; both XTS keys must fit in the fixed Argon2id output. */
-				if (pkcs5_prf == ARGON2 && EAGetKeySize (cryptoInfo->ea) * 2 > ARGON2_HEADER_KEYDATA_SIZE)
+				if ((pkcs5_prf == ARGON2 || pkcs5_prf == ARGON2_P4) && EAGetKeySize (cryptoInfo->ea) * 2 > ARGON2_HEADER_KEYDATA_SIZE)
 					continue;
 #endif
 
@@ -1036,7 +1054,7 @@ int CreateVolumeHeaderInMemory (HWND hwndDlg, BOOL bBoot, unsigned char *header,
 
 #ifndef VC_DCS_DISABLE_ARGON2
 	// we don't support Argon2 in pre-boot authentication
-	if (bBoot && (pkcs5_prf == ARGON2))
+	if (bBoot && (pkcs5_prf == ARGON2 || pkcs5_prf == ARGON2_P4))
 	{
 		crypto_close (cryptoInfo);
 		return ERR_PARAMETER_INCORRECT;
@@ -1108,7 +1126,7 @@ int CreateVolumeHeaderInMemory (HWND hwndDlg, BOOL bBoot, unsigned char *header,
 	cryptoInfo->ea = ea;
 
 #ifndef VC_DCS_DISABLE_ARGON2
-	if (pkcs5_prf == ARGON2 && EAGetKeySize (ea) * 2 > ARGON2_HEADER_KEYDATA_SIZE)
+	if ((pkcs5_prf == ARGON2 || pkcs5_prf == ARGON2_P4) && EAGetKeySize (ea) * 2 > ARGON2_HEADER_KEYDATA_SIZE)
 	{
 		crypto_close (cryptoInfo);
 		retVal = ERR_PARAMETER_INCORRECT;
@@ -1181,6 +1199,19 @@ int CreateVolumeHeaderInMemory (HWND hwndDlg, BOOL bBoot, unsigned char *header,
 				}
 			}
 			break;
+
+		case ARGON2_P4:
+			{
+				int derivationResult = derive_key_argon2_lanes(keyInfo.userKey, keyInfo.keyLength, keyInfo.salt,
+					PKCS5_SALT_SIZE, keyInfo.noIterations, keyInfo.memoryCost, ARGON2_P4_LANES, dk, ARGON2_HEADER_KEYDATA_SIZE, NULL, NULL, NULL);
+				if (derivationResult != 0)
+				{
+					crypto_close (cryptoInfo);
+					retVal = MapArgon2ResultToVcError (derivationResult);
+					goto err;
+				}
+			}
+			break;
 #endif
         #endif
 		default:
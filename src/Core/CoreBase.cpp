@@ -14,6 +14,7 @@
 
 #include "CoreBase.h"
 #include "RandomNumberGenerator.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/Volume.h"
 
 namespace VeraCrypt
@@ -33,58 +34,143 @@ namespace VeraCrypt
 
 	void CoreBase::ChangePassword (shared_ptr <Volume> openVolume, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, bool emvSupportEnabled, shared_ptr <Pkcs5Kdf> newPkcs5Kdf, int wipeCount) const
 	{
+		VolumeList openVolumes;
+		openVolumes.push_back (openVolume);
+
+		ChangePasswords (openVolumes, newPassword, newPim, newKeyfiles, emvSupportEnabled, newPkcs5Kdf, wipeCount);
+	}
+
+	shared_ptr <Volume> CoreBase::ChangePassword (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, bool emvSupportEnabled, shared_ptr <Pkcs5Kdf> newPkcs5Kdf, int wipeCount) const
+	{
+		shared_ptr <Volume> volume = OpenVolume (volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled);
+		ChangePassword (volume, newPassword, newPim, newKeyfiles, emvSupportEnabled, newPkcs5Kdf, wipeCount);
+		return volume;
+	}
+
+	void CoreBase::ChangePasswords (const VolumeList &openVolumes, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, bool emvSupportEnabled, shared_ptr <Pkcs5Kdf> newPkcs5Kdf, int wipeCount) const
+	{
+		typedef EncryptionThreadPool::KeyDerivationWorkItem KeyDerivationWorkItem;
+
+		// One re-encryption of a header; the passes are written in list order
+		struct HeaderPass
+		{
+			HeaderPass (shared_ptr <Volume> volume, bool backupHeader, shared_ptr <Pkcs5Kdf> kdf)
+				: BackupHeader (backupHeader), Kdf (kdf), OpenVolume (volume), Salt (volume->GetSaltSize()) { }
+
+			bool BackupHeader;
+			shared_ptr <Pkcs5Kdf> Kdf;
+			shared_ptr <Volume> OpenVolume;
+			SecureBuffer Salt;
+			shared_ptr <KeyDerivationWorkItem> WorkItem;
+		};
+
 		if ((!newPassword || newPassword->Size() < 1) && (!newKeyfiles || newKeyfiles->empty()))
 			throw PasswordEmpty (SRC_POS);
 
-		if (!newPkcs5Kdf)
-		{
-			newPkcs5Kdf = openVolume->GetPkcs5Kdf();
-		}
+		// All volumes are checked and all salts are generated before any header is written
+		vector < shared_ptr <HeaderPass> > passes;
+		uint64 memoryCost = 0;
 
-		if ((openVolume->GetHeader()->GetFlags() & TC_HEADER_FLAG_ENCRYPTED_SYSTEM) != 0
-			&& openVolume->GetType() == VolumeType::Hidden
-			&& openVolume->GetPath().IsDevice())
+		foreach (shared_ptr <Volume> openVolume, openVolumes)
 		{
-			throw EncryptedSystemRequired (SRC_POS);
-		}
+			shared_ptr <Pkcs5Kdf> kdf = newPkcs5Kdf ? newPkcs5Kdf : openVolume->GetPkcs5Kdf();
 
-		RandomNumberGenerator::SetHash (newPkcs5Kdf->GetHash());
+			if ((openVolume->GetHeader()->GetFlags() & TC_HEADER_FLAG_ENCRYPTED_SYSTEM) != 0
+				&& openVolume->GetType() == VolumeType::Hidden
+				&& openVolume->GetPath().IsDevice())
+			{
+				throw EncryptedSystemRequired (SRC_POS);
+			}
+
+			RandomNumberGenerator::SetHash (kdf->GetHash());
+			memoryCost = max (memoryCost, kdf->GetMemoryCost (newPim));
 
-		SecureBuffer newSalt (openVolume->GetSaltSize());
-		SecureBuffer newHeaderKey (VolumeHeader::GetHeaderKeyDerivationSize (newPkcs5Kdf));
+			for (int header = 0; header < (openVolume->GetLayout()->HasBackupHeader() ? 2 : 1); header++)
+			{
+				for (int i = 1; i <= wipeCount; i++)
+				{
+					shared_ptr <HeaderPass> pass (new HeaderPass (openVolume, header != 0, kdf));
+
+					if (i == wipeCount)
+						RandomNumberGenerator::GetData (pass->Salt);
+					else
+						RandomNumberGenerator::GetDataFast (pass->Salt);
+
+					passes.push_back (pass);
+				}
+			}
+		}
 
 		shared_ptr <VolumePassword> password (Keyfile::ApplyListToPassword (newKeyfiles, newPassword, emvSupportEnabled));
 
-		bool backupHeader = false;
-		while (true)
+		if (!EncryptionThreadPool::IsRunning() || passes.size() < 2)
 		{
-			for (int i = 1; i <= wipeCount; i++)
+			SecureBuffer newHeaderKey;
+
+			foreach (shared_ptr <HeaderPass> pass, passes)
 			{
-				if (i == wipeCount)
-					RandomNumberGenerator::GetData (newSalt);
-				else
-					RandomNumberGenerator::GetDataFast (newSalt);
+				newHeaderKey.Allocate (VolumeHeader::GetHeaderKeyDerivationSize (pass->Kdf));
 
-				int derivationResult = newPkcs5Kdf->DeriveKey (newHeaderKey, *password, newPim, newSalt);
+				int derivationResult = pass->Kdf->DeriveKey (newHeaderKey, *password, newPim, pass->Salt);
 				if (derivationResult != 0)
-					throw ExternalException (SRC_POS, newPkcs5Kdf->GetDerivationFailureMessage (derivationResult));
+					throw ExternalException (SRC_POS, pass->Kdf->GetDerivationFailureMessage (derivationResult));
 
-				openVolume->ReEncryptHeader (backupHeader, newSalt, newHeaderKey, newPkcs5Kdf);
-				openVolume->GetFile()->Flush();
+				pass->OpenVolume->ReEncryptHeader (pass->BackupHeader, pass->Salt, newHeaderKey, pass->Kdf);
+				pass->OpenVolume->GetFile()->Flush();
 			}
 
-			if (!openVolume->GetLayout()->HasBackupHeader() || backupHeader)
-				break;
+			return;
+		}
+
+		// Header keys of the following passes are derived on the thread pool while a pass is being written.
+		// Memory-hard derivations are limited so that the passes in flight fit in the memory budget.
+		size_t maxPendingPassCount = max ((size_t) 1, EncryptionThreadPool::GetThreadCount());
+		if (memoryCost > 0)
+			maxPendingPassCount = (size_t) max ((uint64) 1, min ((uint64) maxPendingPassCount, GetKeyDerivationMemoryBudget() / memoryCost));
+
+		SharedVal <size_t> outstandingWorkItemCount (0);
+		SyncEvent keyDerivationCompletedEvent;
+		SyncEvent noOutstandingWorkItemEvent;
+		long volatile abortKeyDerivation = 0;
+		size_t enqueuedWorkItemCount = 0;
+
+		try
+		{
+			for (size_t i = 0; i < passes.size(); ++i)
+			{
+				for (; enqueuedWorkItemCount < passes.size() && enqueuedWorkItemCount < i + maxPendingPassCount; ++enqueuedWorkItemCount)
+				{
+					HeaderPass &queuedPass = *passes[enqueuedWorkItemCount];
+
+					queuedPass.WorkItem.reset (new KeyDerivationWorkItem (queuedPass.Kdf, VolumeHeader::GetHeaderKeyDerivationSize (queuedPass.Kdf)));
+					EncryptionThreadPool::BeginKeyDerivation (*queuedPass.WorkItem, *password, newPim, queuedPass.Salt, keyDerivationCompletedEvent, noOutstandingWorkItemEvent, outstandingWorkItemCount, &abortKeyDerivation);
+				}
+
+				HeaderPass &pass = *passes[i];
+
+				while (!pass.WorkItem->Completed.Get())
+					keyDerivationCompletedEvent.Wait();
 
-			backupHeader = true;
+				if (pass.WorkItem->ItemException.get())
+					pass.WorkItem->ItemException->Throw();
+
+				if (pass.WorkItem->Result != 0)
+					throw ExternalException (SRC_POS, pass.Kdf->GetDerivationFailureMessage (pass.WorkItem->Result));
+
+				pass.OpenVolume->ReEncryptHeader (pass.BackupHeader, pass.Salt, pass.WorkItem->DerivedKey, pass.Kdf);
+				pass.OpenVolume->GetFile()->Flush();
+			}
+		}
+		catch (...)
+		{
+			abortKeyDerivation = 1;
+			if (enqueuedWorkItemCount > 0)
+				noOutstandingWorkItemEvent.Wait();
+			throw;
 		}
-	}
 
-	shared_ptr <Volume> CoreBase::ChangePassword (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, bool emvSupportEnabled, shared_ptr <Pkcs5Kdf> newPkcs5Kdf, int wipeCount) const
-	{
-		shared_ptr <Volume> volume = OpenVolume (volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled);
-		ChangePassword (volume, newPassword, newPim, newKeyfiles, emvSupportEnabled, newPkcs5Kdf, wipeCount);
-		return volume;
+		// Work items are referenced by the pool until the last one is released
+		noOutstandingWorkItemEvent.Wait();
 	}
 
 	void CoreBase::CoalesceSlotNumberAndMountPoint (MountOptions &options) const
@@ -140,6 +226,11 @@ namespace VeraCrypt
 #endif
 	}
 
+	uint64 CoreBase::GetKeyDerivationMemoryBudget () const
+	{
+		return 1024ULL * 1024 * 1024;
+	}
+
 	uint64 CoreBase::GetMaxHiddenVolumeSize (shared_ptr <Volume> outerVolume) const
 	{
 		uint32 sectorSize = outerVolume->GetSectorSize();
@@ -259,10 +350,42 @@ namespace VeraCrypt
 			return false;
 	}
 
-	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope) const
+	MountResultList CoreBase::MountVolumes (MountOptionsList &optionsList)
+	{
+		// Volumes are mounted in list order. A volume without a mount point gets the first free slot
+		// not lower than its slot number, so that the slots do not depend on which volumes fail to mount.
+		MountResultList results;
+
+		foreach (shared_ptr <MountOptions> options, optionsList)
+		{
+			shared_ptr <MountResult> result (new MountResult);
+
+			try
+			{
+				if (!options->MountPoint || options->MountPoint->IsEmpty())
+					options->SlotNumber = GetFirstFreeSlotNumber (options->SlotNumber);
+
+				result->MountedVolume = MountVolume (*options);
+			}
+			catch (Exception &e)
+			{
+				result->Error.reset (e.CloneNew());
+			}
+			catch (exception &e)
+			{
+				result->Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			}
+
+			results.push_back (result);
+		}
+
+		return results;
+	}
+
+	shared_ptr <Volume> CoreBase::OpenVolume (shared_ptr <VolumePath> volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr<Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr<Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeHeaderHint &headerHint) const
 	{
 		make_shared_auto (Volume, volume);
-		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope);
+		volume->Open (*volumePath, preserveTimestamps, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf, protectionKeyfiles, sharedAccessAllowed, volumeType, useBackupHeaders, partitionInSystemEncryptionScope, headerHint);
 		return volume;
 	}
 
@@ -51,10 +51,22 @@ namespace VeraCrypt
 		else
 			ProtectionKdf.reset();
 		TC_CLONE_SHARED (KeyfileList, ProtectionKeyfiles);
+		TC_CLONE (ReadChunkSize);
+		TC_CLONE (FuseMaxThreads);
+		TC_CLONE (FuseMaxRequestSize);
+		TC_CLONE (FuseSplice);
+		TC_CLONE (FuseWritebackCache);
+		TC_CLONE (HeaderHint);
+		TC_CLONE (IoEngine);
+		TC_CLONE (MountJobs);
 		TC_CLONE (Removable);
 		TC_CLONE (SharedAccessAllowed);
 		TC_CLONE (SlotNumber);
 		TC_CLONE (UseBackupHeaders);
+#ifdef TC_LINUX
+		TC_CLONE (UseUblk);
+#endif
+		TC_CLONE (WorkerPlacement);
 	}
 
 	void MountOptions::Deserialize (shared_ptr <Stream> stream)
@@ -128,6 +140,19 @@ namespace VeraCrypt
 
 		sr.Deserialize ("Pim", Pim);
 		sr.Deserialize ("ProtectionPim", ProtectionPim);
+		WorkerPlacement = static_cast <EncryptionThreadPool::PlacementPolicy::Enum> (sr.DeserializeInt32 ("WorkerPlacement"));
+		sr.Deserialize ("ReadChunkSize", ReadChunkSize);
+		sr.Deserialize ("FuseMaxThreads", FuseMaxThreads);
+		sr.Deserialize ("FuseMaxRequestSize", FuseMaxRequestSize);
+		sr.Deserialize ("FuseSplice", FuseSplice);
+		sr.Deserialize ("FuseWritebackCache", FuseWritebackCache);
+#ifdef TC_LINUX
+		sr.Deserialize ("UseUblk", UseUblk);
+#endif
+		IoEngine = static_cast <FileIoEngine::Enum> (sr.DeserializeInt32 ("IoEngine"));
+		HeaderHint.Pkcs5PrfName = sr.DeserializeWString ("HeaderHintPkcs5PrfName");
+		HeaderHint.EncryptionAlgorithmName = sr.DeserializeWString ("HeaderHintEncryptionAlgorithmName");
+		sr.Deserialize ("MountJobs", MountJobs);
 	}
 
 	void MountOptions::Serialize (shared_ptr <Stream> stream) const
@@ -183,6 +208,19 @@ namespace VeraCrypt
 
 		sr.Serialize ("Pim", Pim);
 		sr.Serialize ("ProtectionPim", ProtectionPim);
+		sr.Serialize ("WorkerPlacement", static_cast <uint32> (WorkerPlacement));
+		sr.Serialize ("ReadChunkSize", ReadChunkSize);
+		sr.Serialize ("FuseMaxThreads", FuseMaxThreads);
+		sr.Serialize ("FuseMaxRequestSize", FuseMaxRequestSize);
+		sr.Serialize ("FuseSplice", FuseSplice);
+		sr.Serialize ("FuseWritebackCache", FuseWritebackCache);
+#ifdef TC_LINUX
+		sr.Serialize ("UseUblk", UseUblk);
+#endif
+		sr.Serialize ("IoEngine", static_cast <uint32> (IoEngine));
+		sr.Serialize ("HeaderHintPkcs5PrfName", HeaderHint.Pkcs5PrfName);
+		sr.Serialize ("HeaderHintEncryptionAlgorithmName", HeaderHint.EncryptionAlgorithmName);
+		sr.Serialize ("MountJobs", MountJobs);
 	}
 
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountOptions);
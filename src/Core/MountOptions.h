@@ -13,7 +13,9 @@
 #ifndef TC_HEADER_Core_MountOptions
 #define TC_HEADER_Core_MountOptions
 
+#include "Platform/FileIoBatch.h"
 #include "Platform/Serializable.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/Keyfile.h"
 #include "Volume/Volume.h"
 #include "Volume/VolumeSlot.h"
@@ -23,9 +25,17 @@ namespace VeraCrypt
 {
 	struct MountOptions : public Serializable
 	{
+		static const uint32 MaxFuseRequestSize = 1024 * 1024;
+
 		MountOptions ()
 			:
 			CachePassword (false),
+			FuseMaxRequestSize (0),
+			FuseMaxThreads (0),
+			FuseSplice (false),
+			FuseWritebackCache (false),
+			IoEngine (FileIoEngine::Blocking),
+			MountJobs (0),
 #ifdef TC_LINUX
 			MountNtfsWithKernelDriver (false),
 #endif
@@ -37,10 +47,15 @@ namespace VeraCrypt
 			PreserveTimestamps (true),
 			Protection (VolumeProtection::None),
 			ProtectionPim (-1),
+			ReadChunkSize (Volume::DefaultReadChunkSize),
 			Removable (false),
 			SharedAccessAllowed (false),
 			SlotNumber (0),
-			UseBackupHeaders (false)
+			UseBackupHeaders (false),
+#ifdef TC_LINUX
+			UseUblk (false),
+#endif
+			WorkerPlacement (EncryptionThreadPool::PlacementPolicy::Default)
 		{
 		}
 
@@ -54,6 +69,13 @@ namespace VeraCrypt
 		bool CachePassword;
 		wstring FilesystemOptions;
 		wstring FilesystemType;
+		uint32 FuseMaxRequestSize;	// Zero selects the default of the FUSE library
+		int FuseMaxThreads;	// Zero selects the default of the FUSE library
+		bool FuseSplice;
+		bool FuseWritebackCache;
+		VolumeHeaderHint HeaderHint;	// Set from VolumeHeaderHintStore when mounting
+		FileIoEngine::Enum IoEngine;
+		int MountJobs;	// Volumes opened at the same time by CoreBase::MountVolumes(); zero selects the number of CPUs
 #ifdef TC_LINUX
 		bool MountNtfsWithKernelDriver;
 #endif
@@ -73,15 +95,22 @@ namespace VeraCrypt
 		int ProtectionPim;
 		shared_ptr <Pkcs5Kdf> ProtectionKdf;
 		shared_ptr <KeyfileList> ProtectionKeyfiles;
+		uint64 ReadChunkSize;
 		bool Removable;
 		bool SharedAccessAllowed;
 		VolumeSlotNumber SlotNumber;
 		bool UseBackupHeaders;
+#ifdef TC_LINUX
+		bool UseUblk;
+#endif
 		bool EMVSupportEnabled;
+		EncryptionThreadPool::PlacementPolicy::Enum WorkerPlacement;
 
 	protected:
 		void CopyFrom (const MountOptions &other);
 	};
+
+	typedef list < shared_ptr <MountOptions> > MountOptionsList;
 }
 
 #endif // TC_HEADER_Core_MountOptions
@@ -0,0 +1,45 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include "MountResult.h"
+#include "Platform/SerializerFactory.h"
+
+namespace VeraCrypt
+{
+	void MountResult::Deserialize (shared_ptr <Stream> stream)
+	{
+		Serializer sr (stream);
+
+		bool mounted;
+		sr.Deserialize ("Mounted", mounted);
+
+		if (mounted)
+			MountedVolume = Serializable::DeserializeNew <VolumeInfo> (stream);
+		else
+			Error = Serializable::DeserializeNew <Exception> (stream);
+	}
+
+	void MountResult::Serialize (shared_ptr <Stream> stream) const
+	{
+		if (!MountedVolume && !Error)
+			throw ParameterIncorrect (SRC_POS);
+
+		Serializable::Serialize (stream);
+		Serializer sr (stream);
+
+		sr.Serialize ("Mounted", MountedVolume ? true : false);
+
+		if (MountedVolume)
+			MountedVolume->Serialize (stream);
+		else
+			Error->Serialize (stream);
+	}
+
+	TC_SERIALIZER_FACTORY_ADD_CLASS (MountResult);
+}
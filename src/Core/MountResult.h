@@ -0,0 +1,39 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Core_MountResult
+#define TC_HEADER_Core_MountResult
+
+#include "Platform/Platform.h"
+#include "Platform/Serializable.h"
+#include "Volume/VolumeInfo.h"
+
+namespace VeraCrypt
+{
+	struct MountResult;
+	typedef list < shared_ptr <MountResult> > MountResultList;
+
+	// Outcome of mounting one volume of the list passed to CoreBase::MountVolumes()
+	struct MountResult : public Serializable
+	{
+		MountResult () { }
+		virtual ~MountResult () { }
+
+		TC_SERIALIZABLE (MountResult);
+
+		shared_ptr <Exception> Error;		// Set if the volume has not been mounted
+		shared_ptr <VolumeInfo> MountedVolume;
+
+	private:
+		MountResult (const MountResult &);
+		MountResult &operator= (const MountResult &);
+	};
+}
+
+#endif // TC_HEADER_Core_MountResult
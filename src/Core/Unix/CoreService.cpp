@@ -1094,6 +1094,17 @@ namespace VeraCrypt
 						continue;
 					}
 
+					// MountVolumesRequest
+					MountVolumesRequest *mountVolumesRequest = dynamic_cast <MountVolumesRequest*> (request.get());
+					if (mountVolumesRequest)
+					{
+						MountVolumesResponse (
+							Core->MountVolumes (*mountVolumesRequest->OptionsList)
+						).Serialize (outputStream);
+
+						continue;
+					}
+
 					// SetFileOwnerRequest
 					SetFileOwnerRequest *setFileOwnerRequest = dynamic_cast <SetFileOwnerRequest*> (request.get());
 					if (setFileOwnerRequest)
@@ -1195,6 +1206,12 @@ namespace VeraCrypt
 		return SendRequest <MountVolumeResponse> (request)->MountedVolumeInfo;
 	}
 
+	MountResultList CoreService::RequestMountVolumes (MountOptionsList &optionsList)
+	{
+		MountVolumesRequest request (&optionsList);
+		return SendRequest <MountVolumesResponse> (request)->Results;
+	}
+
 	void CoreService::RequestSetFileOwner (const FilesystemPath &path, const UserId &owner)
 	{
 		SetFileOwnerRequest request (path, owner);
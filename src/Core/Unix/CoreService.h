@@ -40,6 +40,7 @@ namespace VeraCrypt
 		static void RequestExecuteMacOSXAPFSFormatter (const DevicePath &devicePath, uint64 userId, uint64 groupId);
 #endif
 		static shared_ptr <VolumeInfo> RequestMountVolume (MountOptions &options);
+		static MountResultList RequestMountVolumes (MountOptionsList &optionsList);
 		static void RequestSetFileOwner (const FilesystemPath &path, const UserId &owner);
 		static void SetAdminPasswordCallback (shared_ptr <GetStringFunctor> functor) { AdminPasswordCallback = functor; }
 		static void Start ();
@@ -14,6 +14,8 @@
 #define TC_HEADER_Core_Windows_CoreServiceProxy
 
 #include "CoreService.h"
+#include "Platform/Time.h"
+#include "Volume/VolumeHeaderHintStore.h"
 #include "Volume/VolumePasswordCache.h"
 
 namespace VeraCrypt
@@ -91,6 +93,11 @@ namespace VeraCrypt
 		virtual shared_ptr <VolumeInfo> MountVolume (MountOptions &options)
 		{
 			shared_ptr <VolumeInfo> mountedVolume;
+			uint64 startTime = Time::GetCurrent();
+
+			options.HeaderHint = VolumeHeaderHint();
+			if (UsesHeaderHint (options))
+				options.HeaderHint = VolumeHeaderHintStore::Find (*options.Path);
 
 			if (!VolumePasswordCache::IsEmpty()
 				&& (!options.Password || options.Password->IsEmpty())
@@ -152,12 +159,157 @@ namespace VeraCrypt
 				}
 			}
 
+			if (UsesHeaderHint (options))
+				VolumeHeaderHintStore::RecordMount (options.HeaderHint, *mountedVolume, (Time::GetCurrent() - startTime) / 10000);
+
 			VolumeEventArgs eventArgs (mountedVolume);
 			T::VolumeMountedEvent.Raise (eventArgs);
 
 			return mountedVolume;
 		}
 
+		virtual MountResultList MountVolumes (MountOptionsList &optionsList)
+		{
+			uint64 startTime = Time::GetCurrent();
+
+			CachedPasswordList cachedPasswords;
+			if (!VolumePasswordCache::IsEmpty())
+				cachedPasswords = VolumePasswordCache::GetPasswords();
+
+			vector < shared_ptr <MountOptions> > volumeOptions;
+			vector < shared_ptr <MountResult> > volumeResults;
+			vector <bool> cachedPasswordUsed;
+
+			MountOptionsList requestList;
+			vector <size_t> requestVolumes;
+
+			// Passwords and keyfiles are prepared as in MountVolume()
+			foreach (shared_ptr <MountOptions> options, optionsList)
+			{
+				options->HeaderHint = VolumeHeaderHint();
+				if (UsesHeaderHint (*options))
+					options->HeaderHint = VolumeHeaderHintStore::Find (*options->Path);
+
+				shared_ptr <MountOptions> newOptions (new MountOptions (*options));
+
+				bool useCachedPassword = !cachedPasswords.empty()
+					&& (!options->Password || options->Password->IsEmpty())
+					&& (!options->Keyfiles || options->Keyfiles->empty());
+
+				if (useCachedPassword)
+				{
+					newOptions->Password = cachedPasswords.front();
+				}
+				else
+				{
+					newOptions->Password = Keyfile::ApplyListToPassword (options->Keyfiles, options->Password, options->EMVSupportEnabled);
+					if (newOptions->Keyfiles)
+						newOptions->Keyfiles->clear();
+
+					newOptions->ProtectionPassword = Keyfile::ApplyListToPassword (options->ProtectionKeyfiles, options->ProtectionPassword, options->EMVSupportEnabled);
+					if (newOptions->ProtectionKeyfiles)
+						newOptions->ProtectionKeyfiles->clear();
+				}
+
+				volumeOptions.push_back (options);
+				volumeResults.push_back (shared_ptr <MountResult> ());
+				cachedPasswordUsed.push_back (useCachedPassword);
+
+				requestList.push_back (newOptions);
+				requestVolumes.push_back (volumeOptions.size() - 1);
+			}
+
+			// Volumes not mounted with a cached password are retried with the next one
+			CachedPasswordList::const_iterator cachedPassword = cachedPasswords.begin();
+
+			while (!requestList.empty())
+			{
+				MountResultList requestResults = CoreService::RequestMountVolumes (requestList);
+				if (requestResults.size() != requestList.size())
+					throw ParameterIncorrect (SRC_POS);
+
+				if (cachedPassword != cachedPasswords.end())
+					++cachedPassword;
+
+				MountOptionsList retryList;
+				vector <size_t> retryVolumes;
+
+				MountResultList::const_iterator result = requestResults.begin();
+				MountOptionsList::const_iterator requestOptions = requestList.begin();
+
+				for (size_t i = 0; i < requestVolumes.size(); ++i, ++result, ++requestOptions)
+				{
+					size_t volume = requestVolumes[i];
+
+					if (cachedPasswordUsed[volume] && cachedPassword != cachedPasswords.end()
+						&& dynamic_cast <PasswordIncorrect *> ((*result)->Error.get()))
+					{
+						(*requestOptions)->Password = *cachedPassword;
+						retryList.push_back (*requestOptions);
+						retryVolumes.push_back (volume);
+					}
+					else
+					{
+						volumeResults[volume] = *result;
+					}
+				}
+
+				requestList = retryList;
+				requestVolumes = retryVolumes;
+			}
+
+			// Volumes of a batch are opened concurrently, so only the mount time of a single volume is a valid statistic
+			uint64 mountTime = (Time::GetCurrent() - startTime) / 10000;
+			MountResultList results;
+
+			for (size_t i = 0; i < volumeOptions.size(); ++i)
+			{
+				const MountOptions &options = *volumeOptions[i];
+				shared_ptr <MountResult> result = volumeResults[i];
+
+				if (result->Error)
+				{
+					if (!cachedPasswordUsed[i])
+					{
+						if (dynamic_cast <ProtectionPasswordIncorrect *> (result->Error.get()))
+						{
+							if (options.ProtectionKeyfiles && !options.ProtectionKeyfiles->empty())
+								result->Error.reset (new ProtectionPasswordKeyfilesIncorrect (result->Error->what()));
+						}
+						else if (dynamic_cast <PasswordIncorrect *> (result->Error.get()))
+						{
+							if (options.Keyfiles && !options.Keyfiles->empty())
+								result->Error.reset (new PasswordKeyfilesIncorrect (result->Error->what()));
+						}
+					}
+
+					results.push_back (result);
+					continue;
+				}
+
+				if (!cachedPasswordUsed[i] && options.CachePassword
+					&& ((options.Password && !options.Password->IsEmpty()) || (options.Keyfiles && !options.Keyfiles->empty())))
+				{
+					VolumePasswordCache::Store (*Keyfile::ApplyListToPassword (options.Keyfiles, options.Password, options.EMVSupportEnabled));
+				}
+
+				if (UsesHeaderHint (options))
+				{
+					if (volumeOptions.size() == 1)
+						VolumeHeaderHintStore::RecordMount (options.HeaderHint, *result->MountedVolume, mountTime);
+					else
+						VolumeHeaderHintStore::UpdateHint (*result->MountedVolume);
+				}
+
+				VolumeEventArgs eventArgs (result->MountedVolume);
+				T::VolumeMountedEvent.Raise (eventArgs);
+
+				results.push_back (result);
+			}
+
+			return results;
+		}
+
 		virtual void SetAdminPasswordCallback (shared_ptr <GetStringFunctor> functor)
 		{
 			CoreService::SetAdminPasswordCallback (functor);
@@ -172,6 +324,16 @@ namespace VeraCrypt
 		{
 			VolumePasswordCache::Clear();
 		}
+
+	protected:
+		// Hints refer only to primary headers of normal volumes (see VolumeHeaderHintStore)
+		static bool UsesHeaderHint (const MountOptions &options)
+		{
+			return VolumeHeaderHintStore::IsEnabled() && options.Path
+				&& !options.UseBackupHeaders
+				&& !options.PartitionInSystemEncryptionScope
+				&& options.Protection != VolumeProtection::HiddenVolumeReadOnly;
+		}
 	};
 }
 
@@ -282,6 +282,31 @@ namespace VeraCrypt
 		Options->Serialize (stream);
 	}
 
+	// MountVolumesRequest
+	void MountVolumesRequest::Deserialize (shared_ptr <Stream> stream)
+	{
+		CoreServiceRequest::Deserialize (stream);
+		Serializable::DeserializeList (stream, DeserializedOptionsList);
+		OptionsList = &DeserializedOptionsList;
+	}
+
+	bool MountVolumesRequest::RequiresElevation () const
+	{
+		foreach (shared_ptr <MountOptions> options, *OptionsList)
+		{
+			if (MountVolumeRequest (options.get()).RequiresElevation())
+				return true;
+		}
+
+		return false;
+	}
+
+	void MountVolumesRequest::Serialize (shared_ptr <Stream> stream) const
+	{
+		CoreServiceRequest::Serialize (stream);
+		Serializable::SerializeList (stream, *OptionsList);
+	}
+
 	// SetFileOwnerRequest
 	void SetFileOwnerRequest::Deserialize (shared_ptr <Stream> stream)
 	{
@@ -327,5 +352,6 @@ namespace VeraCrypt
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetDeviceSizeRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (GetHostDevicesRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumeRequest);
+	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumesRequest);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (SetFileOwnerRequest);
 }
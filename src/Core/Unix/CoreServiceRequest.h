@@ -156,6 +156,20 @@ namespace VeraCrypt
 		shared_ptr <MountOptions> DeserializedOptions;
 	};
 
+	struct MountVolumesRequest : CoreServiceRequest
+	{
+		MountVolumesRequest () { }
+		MountVolumesRequest (MountOptionsList *optionsList) : OptionsList (optionsList) { }
+		TC_SERIALIZABLE (MountVolumesRequest);
+
+		virtual bool RequiresElevation () const;
+
+		MountOptionsList *OptionsList;
+
+	protected:
+		MountOptionsList DeserializedOptionsList;
+	};
+
 
 	struct SetFileOwnerRequest : CoreServiceRequest
 	{
@@ -124,6 +124,18 @@ namespace VeraCrypt
 		MountedVolumeInfo->Serialize (stream);
 	}
 
+	// MountVolumesResponse
+	void MountVolumesResponse::Deserialize (shared_ptr <Stream> stream)
+	{
+		Serializable::DeserializeList (stream, Results);
+	}
+
+	void MountVolumesResponse::Serialize (shared_ptr <Stream> stream) const
+	{
+		Serializable::Serialize (stream);
+		Serializable::SerializeList (stream, Results);
+	}
+
 	// SetFileOwnerResponse
 	void SetFileOwnerResponse::Deserialize (shared_ptr <Stream> stream)
 	{
@@ -145,5 +157,6 @@ namespace VeraCrypt
 	TC_SERIALIZER_FACTORY_ADD_CLASS (ExecuteMacOSXAPFSFormatterResponse);
 #endif
 	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumeResponse);
+	TC_SERIALIZER_FACTORY_ADD_CLASS (MountVolumesResponse);
 	TC_SERIALIZER_FACTORY_ADD_CLASS (SetFileOwnerResponse);
 }
@@ -92,6 +92,15 @@ namespace VeraCrypt
 		shared_ptr <VolumeInfo> MountedVolumeInfo;
 	};
 
+	struct MountVolumesResponse : CoreServiceResponse
+	{
+		MountVolumesResponse () { }
+		MountVolumesResponse (const MountResultList &results) : Results (results) { }
+		TC_SERIALIZABLE (MountVolumesResponse);
+
+		MountResultList Results;
+	};
+
 	struct SetFileOwnerResponse : CoreServiceResponse
 	{
 		SetFileOwnerResponse () { }
@@ -28,6 +28,7 @@
 #include "Platform/SystemLog.h"
 #include "Core/Unix/UnixUser.h"
 #include "Driver/Fuse/FuseService.h"
+#include "Volume/EncryptionThreadPool.h"
 #include "Volume/VolumePasswordCache.h"
 
 namespace VeraCrypt
@@ -1064,19 +1065,262 @@ namespace VeraCrypt
 		if (IsVolumeMounted (*options.Path))
 			throw VolumeAlreadyMounted (SRC_POS);
 
-		if (options.MountPoint && !options.MountPoint->IsEmpty())
+		ValidateMountPoint (options);
+
+		Cipher::EnableHwSupport (!options.NoHardwareCrypto);
+		EncryptionThreadPool::SetPlacementPolicy (options.WorkerPlacement);
+		FileIoBatch::SetDefaultEngine (options.IoEngine);
+
+		return MountOpenedVolume (OpenVolumeForMount (options), options);
+	}
+
+	MountResultList CoreUnix::MountVolumes (MountOptionsList &optionsList)
+	{
+		MountResultList results;
+		if (optionsList.empty())
+			return results;
+
+		const MountOptions &firstOptions = *optionsList.front();
+
+		// Hardware acceleration, worker placement and the I/O engine are process-wide settings applied when a volume
+		// is opened. Volumes whose settings differ from those of the batch are therefore mounted one at a time.
+		foreach (shared_ptr <MountOptions> options, optionsList)
 		{
-			// Reject if the mount point is a system directory
-			if (IsProtectedSystemDirectory(*options.MountPoint))
-				throw MountPointBlocked (SRC_POS);
+			if (options->NoHardwareCrypto != firstOptions.NoHardwareCrypto
+				|| options->WorkerPlacement != firstOptions.WorkerPlacement
+				|| options->IoEngine != firstOptions.IoEngine)
+			{
+				foreach (shared_ptr <MountOptions> volumeOptions, optionsList)
+				{
+					shared_ptr <MountResult> result (new MountResult);
 
-			// Reject if the mount point is in the user's PATH and the user has not explicitly allowed insecure mount points
-			if (!GetAllowInsecureMount() && IsDirectoryOnUserPath(*options.MountPoint))
-				throw MountPointNotAllowed (SRC_POS);
+					try
+					{
+						result->MountedVolume = MountVolume (*volumeOptions);
+					}
+					catch (Exception &e)
+					{
+						result->Error.reset (e.CloneNew());
+					}
+					catch (exception &e)
+					{
+						result->Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+					}
+
+					results.push_back (result);
+				}
+
+				return results;
+			}
 		}
 
-		Cipher::EnableHwSupport (!options.NoHardwareCrypto);
+		Cipher::EnableHwSupport (!firstOptions.NoHardwareCrypto);
+		EncryptionThreadPool::SetPlacementPolicy (firstOptions.WorkerPlacement);
+		FileIoBatch::SetDefaultEngine (firstOptions.IoEngine);
+
+		struct OpenJob
+		{
+			shared_ptr <Exception> Error;
+			uint64 MemoryCost;
+			shared_ptr <Volume> OpenedVolume;
+			shared_ptr <MountOptions> Options;
+		};
+
+		vector <OpenJob> jobs;
+		foreach (shared_ptr <MountOptions> options, optionsList)
+		{
+			OpenJob job;
+			job.MemoryCost = GetOpenVolumeMemoryCost (*options);
+			job.Options = options;
+
+			if (IsVolumeMounted (*options->Path))
+				job.Error.reset (new VolumeAlreadyMounted (SRC_POS));
+
+			jobs.push_back (job);
+		}
+
+		// Headers of the volumes are opened concurrently in list order. A volume is started only if the memory of the key
+		// derivations in progress, which is dominated by Argon2, stays within the budget; a volume is always started when
+		// no other is being opened.
+		const size_t jobCount = GetMountJobCount (firstOptions.MountJobs);
+		const uint64 memoryBudget = GetKeyDerivationMemoryBudget();
+
+		Mutex stateMutex;
+		SyncEvent jobFinishedEvent;
+		size_t runningJobCount = 0;
+		uint64 runningMemoryCost = 0;
+
+		struct OpenFunctor : public Functor
+		{
+			OpenFunctor (const CoreUnix &core, OpenJob &job, Mutex &stateMutex, SyncEvent &jobFinishedEvent, size_t &runningJobCount, uint64 &runningMemoryCost)
+				: Core (core), Job (job), JobFinishedEvent (jobFinishedEvent), RunningJobCount (runningJobCount), RunningMemoryCost (runningMemoryCost), StateMutex (stateMutex) { }
+
+			virtual void operator() ()
+			{
+				try
+				{
+					Job.OpenedVolume = Core.OpenVolumeForMount (*Job.Options);
+				}
+				catch (Exception &e)
+				{
+					Job.Error.reset (e.CloneNew());
+				}
+				catch (exception &e)
+				{
+					Job.Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+				}
+				catch (...)
+				{
+					Job.Error.reset (new UnknownException (SRC_POS));
+				}
+
+				ScopeLock lock (StateMutex);
+				--RunningJobCount;
+				RunningMemoryCost -= Job.MemoryCost;
+				JobFinishedEvent.Signal();
+			}
+
+			const CoreUnix &Core;
+			OpenJob &Job;
+			SyncEvent &JobFinishedEvent;
+			size_t &RunningJobCount;
+			uint64 &RunningMemoryCost;
+			Mutex &StateMutex;
+		};
+
+		list < shared_ptr <Thread> > threads;
+		finally_do_arg (list < shared_ptr <Thread> > *, &threads,
+		{
+			foreach_ref (const Thread &thread, *finally_arg)
+				thread.Join();
+		});
+
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			if (jobs[i].Error)
+				continue;
+
+			while (true)
+			{
+				{
+					ScopeLock lock (stateMutex);
+					if (runningJobCount == 0 || (runningJobCount < jobCount && runningMemoryCost + jobs[i].MemoryCost <= memoryBudget))
+					{
+						++runningJobCount;
+						runningMemoryCost += jobs[i].MemoryCost;
+						break;
+					}
+				}
+
+				jobFinishedEvent.Wait();
+			}
+
+			make_shared_auto (Thread, thread);
+			try
+			{
+				thread->Start (new OpenFunctor (*this, jobs[i], stateMutex, jobFinishedEvent, runningJobCount, runningMemoryCost));
+			}
+			catch (...)
+			{
+				ScopeLock lock (stateMutex);
+				--runningJobCount;
+				runningMemoryCost -= jobs[i].MemoryCost;
+				throw;
+			}
+
+			threads.push_back (thread);
+		}
+
+		foreach_ref (const Thread &thread, threads)
+			thread.Join();
+		threads.clear();
+
+		// Filesystems are mounted one at a time in list order, which makes the assignment of slots deterministic
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			OpenJob &job = jobs[i];
+			MountOptions &options = *job.Options;
+			shared_ptr <MountResult> result (new MountResult);
+
+			try
+			{
+				if (job.Error)
+					job.Error->Throw();
+
+				if (IsVolumeMounted (*options.Path))
+					throw VolumeAlreadyMounted (SRC_POS);
+
+				if (!options.MountPoint || options.MountPoint->IsEmpty())
+					options.SlotNumber = GetFirstFreeSlotNumber (options.SlotNumber);
+
+				CoalesceSlotNumberAndMountPoint (options);
+				ValidateMountPoint (options);
+
+				result->MountedVolume = MountOpenedVolume (job.OpenedVolume, options);
+			}
+			catch (Exception &e)
+			{
+				result->Error.reset (e.CloneNew());
+			}
+			catch (exception &e)
+			{
+				result->Error.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+			}
+
+			job.OpenedVolume.reset();
+			results.push_back (result);
+		}
+
+		return results;
+	}
+
+	uint64 CoreUnix::GetKeyDerivationMemoryBudget () const
+	{
+		// Half of the physical memory
+#ifdef _SC_PHYS_PAGES
+		long pageCount = sysconf (_SC_PHYS_PAGES);
+		long pageSize = sysconf (_SC_PAGESIZE);
+
+		if (pageCount > 0 && pageSize > 0)
+			return (uint64) pageCount * (uint64) pageSize / 2;
+#endif
+		return 1024ULL * 1024 * 1024;
+	}
+
+	size_t CoreUnix::GetMountJobCount (int requestedJobCount) const
+	{
+		if (requestedJobCount > 0)
+			return min ((size_t) requestedJobCount, MaxMountJobCount);
 
+		long cpuCount = sysconf (_SC_NPROCESSORS_ONLN);
+		return cpuCount > 0 ? min ((size_t) cpuCount, MaxMountJobCount) : 1;
+	}
+
+	uint64 CoreUnix::GetOpenVolumeMemoryCost (const MountOptions &options)
+	{
+		// Without the encryption thread pool, key derivations of a volume run one at a time. Otherwise, the keys of
+		// the normal and hidden volume headers are derived with all algorithms at once.
+		bool concurrentDerivation = EncryptionThreadPool::IsRunning();
+		uint64 memoryCost = 0;
+
+		foreach (shared_ptr <Pkcs5Kdf> kdf, Pkcs5Kdf::GetAvailableAlgorithms())
+		{
+			if (options.Kdf && options.Kdf->GetName() != kdf->GetName())
+				continue;
+
+			uint64 kdfMemoryCost = kdf->GetMemoryCost (options.Pim);
+
+			if (concurrentDerivation)
+				memoryCost += kdfMemoryCost * 2;
+			else
+				memoryCost = max (memoryCost, kdfMemoryCost);
+		}
+
+		return memoryCost;
+	}
+
+	shared_ptr <Volume> CoreUnix::OpenVolumeForMount (MountOptions &options) const
+	{
 		shared_ptr <Volume> volume;
 
 		while (true)
@@ -1099,7 +1343,8 @@ namespace VeraCrypt
 					options.SharedAccessAllowed,
 					VolumeType::Unknown,
 					options.UseBackupHeaders,
-					options.PartitionInSystemEncryptionScope
+					options.PartitionInSystemEncryptionScope,
+					options.HeaderHint
 					);
 
 				options.Password.reset();
@@ -1121,6 +1366,8 @@ namespace VeraCrypt
 			break;
 		}
 
+		volume->SetReadChunkSize ((size_t) options.ReadChunkSize);
+
 		if (options.Path->IsDevice())
 		{
 			const uint32 devSectorSize = volume->GetFile()->GetDeviceSectorSize();
@@ -1129,6 +1376,11 @@ namespace VeraCrypt
 				throw DeviceSectorSizeMismatch (SRC_POS, StringConverter::ToWide(devSectorSize) + L" != " + StringConverter::ToWide((uint32) volSectorSize));
 		}
 
+		return volume;
+	}
+
+	shared_ptr <VolumeInfo> CoreUnix::MountOpenedVolume (shared_ptr <Volume> volume, MountOptions &options)
+	{
 		// Find a free mount point for FUSE service
 		MountedFilesystemList mountedFilesystems = GetMountedFilesystems ();
 		string fuseMountPoint;
@@ -1171,7 +1423,7 @@ namespace VeraCrypt
 
 		try
 		{
-			FuseService::Mount (volume, options.SlotNumber, fuseMountPoint);
+			FuseService::Mount (volume, options.SlotNumber, fuseMountPoint, options);
 		}
 		catch (...)
 		{
@@ -1332,19 +1584,43 @@ namespace VeraCrypt
 
 	DevicePath CoreUnix::MountAuxVolumeImage (const DirectoryPath &auxMountPoint, const MountOptions &options) const
 	{
-		DevicePath loopDev = AttachFileToLoopDevice (string (auxMountPoint) + FuseService::GetVolumeImagePath(), options.Protection == VolumeProtection::ReadOnly);
+		DevicePath virtualDev;
+		DevicePath loopDev;
+
+#ifdef TC_LINUX
+		if (options.UseUblk)
+		{
+			try
+			{
+				virtualDev = FuseService::StartUblkDevice (auxMountPoint);
+			}
+			catch (exception &e)
+			{
+				// Fall back to a loop device
+				SystemLog::WriteException (e);
+			}
+		}
+#endif
+		if (virtualDev.IsEmpty())
+		{
+			loopDev = AttachFileToLoopDevice (string (auxMountPoint) + FuseService::GetVolumeImagePath(), options.Protection == VolumeProtection::ReadOnly);
+			virtualDev = loopDev;
+		}
 
 		try
 		{
-			FuseService::SendAuxDeviceInfo (auxMountPoint, loopDev, loopDev);
+			FuseService::SendAuxDeviceInfo (auxMountPoint, virtualDev, loopDev);
 		}
 		catch (...)
 		{
-			try
+			if (!loopDev.IsEmpty())
 			{
-				DetachLoopDevice (loopDev);
+				try
+				{
+					DetachLoopDevice (loopDev);
+				}
+				catch (...) { }
 			}
-			catch (...) { }
 			throw;
 		}
 
@@ -1356,17 +1632,17 @@ namespace VeraCrypt
 #ifdef TC_LINUX
 			bool allowFilesystemTypeFallback = filesystemType.empty();
 
-			ResolveNtfsKernelMountOptions (loopDev, options.MountNtfsWithKernelDriver, filesystemType, internalMountOnly);
+			ResolveNtfsKernelMountOptions (virtualDev, options.MountNtfsWithKernelDriver, filesystemType, internalMountOnly);
 			allowFilesystemTypeFallback = allowFilesystemTypeFallback && filesystemType.empty() && !internalMountOnly;
 
-			MountFilesystemWithFallback (loopDev, *options.MountPoint,
+			MountFilesystemWithFallback (virtualDev, *options.MountPoint,
 				StringConverter::ToSingle (filesystemType),
 				allowFilesystemTypeFallback,
 				options.Protection == VolumeProtection::ReadOnly,
 				StringConverter::ToSingle (options.FilesystemOptions),
 				internalMountOnly);
 #else
-			MountFilesystem (loopDev, *options.MountPoint,
+			MountFilesystem (virtualDev, *options.MountPoint,
 				StringConverter::ToSingle (filesystemType),
 				options.Protection == VolumeProtection::ReadOnly,
 				StringConverter::ToSingle (options.FilesystemOptions),
@@ -1374,7 +1650,7 @@ namespace VeraCrypt
 #endif
 		}
 
-		return loopDev;
+		return virtualDev;
 	}
 
 	void CoreUnix::SetFileOwner (const FilesystemPath &path, const UserId &owner) const
@@ -1382,6 +1658,20 @@ namespace VeraCrypt
 		throw_sys_if (chown (string (path).c_str(), owner.SystemId, (gid_t) -1) == -1);
 	}
 
+	void CoreUnix::ValidateMountPoint (const MountOptions &options) const
+	{
+		if (options.MountPoint && !options.MountPoint->IsEmpty())
+		{
+			// Reject if the mount point is a system directory
+			if (IsProtectedSystemDirectory(*options.MountPoint))
+				throw MountPointBlocked (SRC_POS);
+
+			// Reject if the mount point is in the user's PATH and the user has not explicitly allowed insecure mount points
+			if (!GetAllowInsecureMount() && IsDirectoryOnUserPath(*options.MountPoint))
+				throw MountPointNotAllowed (SRC_POS);
+		}
+	}
+
 	DirectoryPath CoreUnix::SlotNumberToMountPoint (VolumeSlotNumber slotNumber) const
 	{
 		if (slotNumber < GetFirstSlotNumber() || slotNumber > GetLastSlotNumber())
@@ -48,6 +48,7 @@ namespace VeraCrypt
 		virtual bool HasAdminPrivileges () const { return getuid() == 0 || geteuid() == 0; }
 		virtual VolumeSlotNumber MountPointToSlotNumber (const DirectoryPath &mountPoint) const;
 		virtual shared_ptr <VolumeInfo> MountVolume (MountOptions &options);
+		virtual MountResultList MountVolumes (MountOptionsList &optionsList);
 		virtual void SetFileOwner (const FilesystemPath &path, const UserId &owner) const;
 		virtual DirectoryPath SlotNumberToMountPoint (VolumeSlotNumber slotNumber) const;
 		virtual void WipePasswordCache () const { throw NotApplicable (SRC_POS); }
@@ -66,15 +67,21 @@ namespace VeraCrypt
 		virtual bool FilesystemSupportsUnixPermissions (const DevicePath &devicePath) const;
 		virtual string GetDefaultMountPointPrefix () const;
 		virtual string GetFuseMountDirPrefix () const { return ".veracrypt_aux_mnt"; }
+		virtual uint64 GetKeyDerivationMemoryBudget () const;
 		virtual MountedFilesystemList GetMountedFilesystems (const DevicePath &devicePath = DevicePath(), const DirectoryPath &mountPoint = DirectoryPath()) const = 0;
+		virtual size_t GetMountJobCount (int requestedJobCount) const;
+		static uint64 GetOpenVolumeMemoryCost (const MountOptions &options);
 		virtual uid_t GetRealUserId () const;
 		virtual gid_t GetRealGroupId () const;
 		virtual string GetTempDirectory () const;
 		// internalMountOnly maps to mount(8) -i and suppresses /sbin/mount.<type> helpers.
 		virtual void MountFilesystem (const DevicePath &devicePath, const DirectoryPath &mountPoint, const string &filesystemType, bool readOnly, const string &systemMountOptions, bool internalMountOnly = false) const;
 		virtual DevicePath MountAuxVolumeImage (const DirectoryPath &auxMountPoint, const MountOptions &options) const;
+		virtual shared_ptr <VolumeInfo> MountOpenedVolume (shared_ptr <Volume> volume, MountOptions &options);
 		virtual void MountVolumeNative (shared_ptr <Volume> volume, MountOptions &options, const DirectoryPath &auxMountPoint) const { throw NotApplicable (SRC_POS); }
+		virtual shared_ptr <Volume> OpenVolumeForMount (MountOptions &options) const;
 		virtual void UpdateMountedVolumeInfo (shared_ptr <VolumeInfo> mountedVolume) const { (void) mountedVolume; }
+		virtual void ValidateMountPoint (const MountOptions &options) const;
 #ifdef TC_LINUX
 		string DetectFilesystemType (const DevicePath &devicePath) const;
 		bool IsFilesystemTypeRegistered (const string &filesystemType) const;
@@ -89,6 +96,8 @@ namespace VeraCrypt
 		string SelectNtfsKernelFilesystemType () const;
 #endif
 
+		static const size_t MaxMountJobCount = 16;
+
 	private:
 		CoreUnix (const CoreUnix &);
 		CoreUnix &operator= (const CoreUnix &);
@@ -15,6 +15,7 @@
 #ifdef WOLFCRYPT_BACKEND
 #include "Volume/EncryptionModeWolfCryptXTS.h"
 #endif
+#include "Platform/FileIoBatch.h"
 #include "Core.h"
 
 #ifdef TC_UNIX
@@ -119,21 +120,50 @@ namespace VeraCrypt
 				// Empty sectors are encrypted with different key to randomize plaintext
 				Core->RandomizeEncryptionAlgorithmKey (Options->EA);
 
-				SecureBuffer outputBuffer (File::GetOptimalWriteSize());
-				uint64 dataFragmentLength = outputBuffer.Size();
+				// Two output buffers are used alternately so that, with an asynchronous I/O engine,
+				// a fragment is written while the next one is being encrypted
+				SecureBuffer outputBuffers[2];
+				unique_ptr <FileIoBatch> pendingWrites[2];
+				outputBuffers[0].Allocate (File::GetOptimalWriteSize());
+				outputBuffers[1].Allocate (File::GetOptimalWriteSize());
+
+				uint64 dataFragmentLength = outputBuffers[0].Size();
+				size_t bufferIndex = 0;
 
 				while (!AbortRequested && WriteOffset < endOffset)
 				{
 					if (WriteOffset + dataFragmentLength > endOffset)
 						dataFragmentLength = endOffset - WriteOffset;
 
+					if (pendingWrites[bufferIndex].get())
+					{
+						pendingWrites[bufferIndex]->WaitAll();
+						pendingWrites[bufferIndex].reset();
+					}
+
+					SecureBuffer &outputBuffer = outputBuffers[bufferIndex];
 					outputBuffer.Zero();
 					Options->EA->EncryptSectors (outputBuffer, WriteOffset / ENCRYPTION_DATA_UNIT_SIZE, dataFragmentLength / ENCRYPTION_DATA_UNIT_SIZE, ENCRYPTION_DATA_UNIT_SIZE);
-					VolumeFile->Write (outputBuffer, (size_t) dataFragmentLength);
+
+					pendingWrites[bufferIndex].reset (new FileIoBatch (*VolumeFile));
+					pendingWrites[bufferIndex]->AddWrite (outputBuffer.GetRange (0, (size_t) dataFragmentLength), WriteOffset);
+					pendingWrites[bufferIndex]->Submit();
 
 					WriteOffset += dataFragmentLength;
 					SizeDone.Set (WriteOffset - DataStart);
+					bufferIndex ^= 1;
 				}
+
+				for (size_t i = 0; i < array_capacity (pendingWrites); ++i)
+				{
+					if (pendingWrites[bufferIndex].get())
+						pendingWrites[bufferIndex]->WaitAll();
+
+					bufferIndex ^= 1;
+				}
+
+				// Fragments were written at explicit offsets; the backup header is written at the current position
+				VolumeFile->SeekAt (WriteOffset);
 			}
 
 			if (!AbortRequested)
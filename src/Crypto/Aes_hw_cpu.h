@@ -29,6 +29,11 @@ void VC_CDECL aes_hw_cpu_decrypt_32_blocks (const uint8 *ks, uint8 *data);
 void aes_hw_cpu_encrypt (const uint8 *ks, uint8 *data);
 void VC_CDECL aes_hw_cpu_encrypt_32_blocks (const uint8 *ks, uint8 *data);
 
+/* AES-256 XTS of blockCount blocks starting with the first block of data unit dataUnitNo, with
+   whitening values derived in registers (see Aes_hw_vaes.h for the parameters). */
+void aes_hw_cpu_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+void aes_hw_cpu_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,165 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* AES-256 XTS using VAES on 256-bit vectors (two blocks per instruction).
+   Must be compiled with AVX2, VAES and VPCLMULQDQ enabled. */
+
+#include "Aes_hw_vaes.h"
+
+#if CRYPTOPP_VAES_AVAILABLE
+
+#include <immintrin.h>
+
+#define AES_VAES_ROUND_KEY_COUNT 15
+#define AES_VAES_UNIT_BLOCK_COUNT 32
+
+/* Multiplies the tweak in each 128-bit lane by x^e in GF(2^128) modulo x^128 + x^7 + x^2 + x + 1,
+   where e (0 <= e <= 56) is given for both 64-bit halves of the lane. The bits shifted out of the
+   lane are reduced by a carry-less multiplication by 0x87. */
+VC_INLINE __m256i MultiplyTweaks (__m256i tweak, __m256i exponents, __m256i poly)
+{
+	__m256i carry = _mm256_srlv_epi64 (tweak, _mm256_sub_epi64 (_mm256_set1_epi64x (64), exponents));
+	__m256i product = _mm256_sllv_epi64 (tweak, exponents);
+
+	return _mm256_xor_si256 (_mm256_xor_si256 (product, _mm256_bslli_epi128 (carry, 8)), _mm256_clmulepi64_epi128 (carry, poly, 0x01));
+}
+
+#define AES_VAES_ROUND(block, roundKey) block = decrypt ? _mm256_aesdec_epi128 (block, roundKey) : _mm256_aesenc_epi128 (block, roundKey)
+#define AES_VAES_LAST_ROUND(block, roundKey) block = decrypt ? _mm256_aesdeclast_epi128 (block, roundKey) : _mm256_aesenclast_epi128 (block, roundKey)
+
+VC_INLINE __m256i AesXtsVaesBlocks (__m256i block, __m256i tweak, const __m256i *roundKeys, int decrypt)
+{
+	int round;
+
+	block = _mm256_xor_si256 (block, _mm256_xor_si256 (tweak, roundKeys[0]));
+
+	for (round = 1; round < AES_VAES_ROUND_KEY_COUNT - 1; round++)
+		AES_VAES_ROUND (block, roundKeys[round]);
+
+	AES_VAES_LAST_ROUND (block, _mm256_xor_si256 (roundKeys[AES_VAES_ROUND_KEY_COUNT - 1], tweak));
+	return block;
+}
+
+VC_INLINE void AesXtsVaes (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo, int decrypt)
+{
+	__m256i roundKeys[AES_VAES_ROUND_KEY_COUNT];
+	__m256i tweakKeys[AES_VAES_ROUND_KEY_COUNT];
+	const __m256i poly = _mm256_set1_epi64x (0x87);
+	const __m256i laneExponents = _mm256_set_epi64x (1, 1, 0, 0);
+	const __m256i exponentStep = _mm256_set1_epi64x (2);
+	const __m256i firstBlockMask = _mm256_set_epi64x (0, 0, -1, -1);
+	int round, unit;
+
+	for (round = 0; round < AES_VAES_ROUND_KEY_COUNT; round++)
+	{
+		roundKeys[round] = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) (ks + 16 * round)));
+		tweakKeys[round] = _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) (tweakKs + 16 * round)));
+	}
+
+	while (blockCount > 0)
+	{
+		/* Initial tweaks of the next two data units (little-endian data unit numbers encrypted with the tweak key) */
+		__m256i unitTweaks = _mm256_set_epi64x (0, (long long) (dataUnitNo + 1), 0, (long long) dataUnitNo);
+
+		unitTweaks = _mm256_xor_si256 (unitTweaks, tweakKeys[0]);
+		for (round = 1; round < AES_VAES_ROUND_KEY_COUNT - 1; round++)
+			unitTweaks = _mm256_aesenc_epi128 (unitTweaks, tweakKeys[round]);
+		unitTweaks = _mm256_aesenclast_epi128 (unitTweaks, tweakKeys[AES_VAES_ROUND_KEY_COUNT - 1]);
+
+		for (unit = 0; unit < 2 && blockCount > 0; unit++)
+		{
+			__m256i tweak = unit == 0 ? _mm256_permute2x128_si256 (unitTweaks, unitTweaks, 0x00) : _mm256_permute2x128_si256 (unitTweaks, unitTweaks, 0x11);
+			__m256i exponents = laneExponents;
+			uint64 unitBlockCount = blockCount < AES_VAES_UNIT_BLOCK_COUNT ? blockCount : AES_VAES_UNIT_BLOCK_COUNT;
+
+			blockCount -= unitBlockCount;
+
+			while (unitBlockCount >= 8)
+			{
+				__m256i t0, t1, t2, t3, b0, b1, b2, b3;
+
+				t0 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm256_add_epi64 (exponents, exponentStep);
+				t1 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm256_add_epi64 (exponents, exponentStep);
+				t2 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm256_add_epi64 (exponents, exponentStep);
+				t3 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm256_add_epi64 (exponents, exponentStep);
+
+				/* Pre-whitening is combined with the first round key */
+				b0 = _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *) data), _mm256_xor_si256 (t0, roundKeys[0]));
+				b1 = _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *) (data + 32)), _mm256_xor_si256 (t1, roundKeys[0]));
+				b2 = _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *) (data + 64)), _mm256_xor_si256 (t2, roundKeys[0]));
+				b3 = _mm256_xor_si256 (_mm256_loadu_si256 ((const __m256i *) (data + 96)), _mm256_xor_si256 (t3, roundKeys[0]));
+
+				for (round = 1; round < AES_VAES_ROUND_KEY_COUNT - 1; round++)
+				{
+					AES_VAES_ROUND (b0, roundKeys[round]);
+					AES_VAES_ROUND (b1, roundKeys[round]);
+					AES_VAES_ROUND (b2, roundKeys[round]);
+					AES_VAES_ROUND (b3, roundKeys[round]);
+				}
+
+				/* Post-whitening is combined with the last round key */
+				AES_VAES_LAST_ROUND (b0, _mm256_xor_si256 (roundKeys[AES_VAES_ROUND_KEY_COUNT - 1], t0));
+				AES_VAES_LAST_ROUND (b1, _mm256_xor_si256 (roundKeys[AES_VAES_ROUND_KEY_COUNT - 1], t1));
+				AES_VAES_LAST_ROUND (b2, _mm256_xor_si256 (roundKeys[AES_VAES_ROUND_KEY_COUNT - 1], t2));
+				AES_VAES_LAST_ROUND (b3, _mm256_xor_si256 (roundKeys[AES_VAES_ROUND_KEY_COUNT - 1], t3));
+
+				_mm256_storeu_si256 ((__m256i *) data, b0);
+				_mm256_storeu_si256 ((__m256i *) (data + 32), b1);
+				_mm256_storeu_si256 ((__m256i *) (data + 64), b2);
+				_mm256_storeu_si256 ((__m256i *) (data + 96), b3);
+
+				data += 128;
+				unitBlockCount -= 8;
+			}
+
+			/* Remaining blocks of a partial data unit */
+			while (unitBlockCount >= 2)
+			{
+				__m256i t = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm256_add_epi64 (exponents, exponentStep);
+
+				_mm256_storeu_si256 ((__m256i *) data, AesXtsVaesBlocks (_mm256_loadu_si256 ((const __m256i *) data), t, roundKeys, decrypt));
+
+				data += 32;
+				unitBlockCount -= 2;
+			}
+
+			if (unitBlockCount > 0)
+			{
+				__m256i t = MultiplyTweaks (tweak, exponents, poly);
+
+				_mm256_maskstore_epi64 ((long long *) data, firstBlockMask,
+					AesXtsVaesBlocks (_mm256_maskload_epi64 ((const long long *) data, firstBlockMask), t, roundKeys, decrypt));
+
+				data += 16;
+			}
+
+			dataUnitNo++;
+		}
+	}
+
+	burn (roundKeys, sizeof (roundKeys));
+	burn (tweakKeys, sizeof (tweakKeys));
+}
+
+void aes_hw_vaes_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsVaes (ks, tweakKs, data, blockCount, dataUnitNo, 1);
+}
+
+void aes_hw_vaes_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsVaes (ks, tweakKs, data, blockCount, dataUnitNo, 0);
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Crypto_Aes_Hw_Vaes
+#define TC_HEADER_Crypto_Aes_Hw_Vaes
+
+#include "Common/Tcdefs.h"
+#include "cpu.h"
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+#if CRYPTOPP_VAES_AVAILABLE
+
+/* AES-256 XTS of blockCount 16-byte blocks starting with the first block of data unit dataUnitNo.
+   Consecutive data units are 512 bytes long. ks is the encryption (or decryption) key schedule
+   of the data key and tweakKs is the encryption key schedule of the tweak key, both in the
+   format used by aes_hw_cpu_encrypt() and aes_hw_cpu_decrypt(). Tweaks of data units are
+   computed in the kernel, so no whitening values are stored in memory. */
+
+/* VAES with 256-bit vectors (requires HasVAES()) */
+void aes_hw_vaes_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+void aes_hw_vaes_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+
+/* VAES with 512-bit vectors (requires HasVAES() and HasSAVX512()) */
+void aes_hw_vaes512_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+void aes_hw_vaes512_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo);
+
+#endif
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TC_HEADER_Crypto_Aes_Hw_Vaes
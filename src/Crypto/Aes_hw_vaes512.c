@@ -0,0 +1,149 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* AES-256 XTS using VAES on 512-bit vectors (four blocks per instruction).
+   Must be compiled with AVX-512 (F, BW, VL), VAES and VPCLMULQDQ enabled. */
+
+#include "Aes_hw_vaes.h"
+
+#if CRYPTOPP_VAES_AVAILABLE
+
+#include <immintrin.h>
+
+#define AES_VAES512_ROUND_KEY_COUNT 15
+#define AES_VAES512_UNIT_BLOCK_COUNT 32
+
+/* Multiplies the tweak in each 128-bit lane by x^e in GF(2^128) modulo x^128 + x^7 + x^2 + x + 1,
+   where e (0 <= e <= 56) is given for both 64-bit halves of the lane. The bits shifted out of the
+   lane are reduced by a carry-less multiplication by 0x87. */
+VC_INLINE __m512i MultiplyTweaks (__m512i tweak, __m512i exponents, __m512i poly)
+{
+	__m512i carry = _mm512_srlv_epi64 (tweak, _mm512_sub_epi64 (_mm512_set1_epi64 (64), exponents));
+	__m512i product = _mm512_sllv_epi64 (tweak, exponents);
+
+	return _mm512_ternarylogic_epi64 (product, _mm512_bslli_epi128 (carry, 8), _mm512_clmulepi64_epi128 (carry, poly, 0x01), 0x96);
+}
+
+#define AES_VAES512_ROUND(block, roundKey) block = decrypt ? _mm512_aesdec_epi128 (block, roundKey) : _mm512_aesenc_epi128 (block, roundKey)
+#define AES_VAES512_LAST_ROUND(block, roundKey) block = decrypt ? _mm512_aesdeclast_epi128 (block, roundKey) : _mm512_aesenclast_epi128 (block, roundKey)
+
+VC_INLINE void AesXtsVaes512 (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo, int decrypt)
+{
+	__m512i roundKeys[AES_VAES512_ROUND_KEY_COUNT];
+	__m512i tweakKeys[AES_VAES512_ROUND_KEY_COUNT];
+	const __m512i poly = _mm512_set1_epi64 (0x87);
+	const __m512i laneExponents = _mm512_set_epi64 (3, 3, 2, 2, 1, 1, 0, 0);
+	const __m512i exponentStep = _mm512_set1_epi64 (4);
+	int round, unit;
+
+	for (round = 0; round < AES_VAES512_ROUND_KEY_COUNT; round++)
+	{
+		roundKeys[round] = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) (ks + 16 * round)));
+		tweakKeys[round] = _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) (tweakKs + 16 * round)));
+	}
+
+	while (blockCount > 0)
+	{
+		/* Initial tweaks of the next four data units (little-endian data unit numbers encrypted with the tweak key) */
+		__m512i unitTweaks = _mm512_add_epi64 (_mm512_set_epi64 (0, 3, 0, 2, 0, 1, 0, 0), _mm512_maskz_set1_epi64 (0x55, (long long) dataUnitNo));
+
+		unitTweaks = _mm512_xor_si512 (unitTweaks, tweakKeys[0]);
+		for (round = 1; round < AES_VAES512_ROUND_KEY_COUNT - 1; round++)
+			unitTweaks = _mm512_aesenc_epi128 (unitTweaks, tweakKeys[round]);
+		unitTweaks = _mm512_aesenclast_epi128 (unitTweaks, tweakKeys[AES_VAES512_ROUND_KEY_COUNT - 1]);
+
+		for (unit = 0; unit < 4 && blockCount > 0; unit++)
+		{
+			__m512i tweak = _mm512_permutexvar_epi64 (_mm512_add_epi64 (_mm512_set_epi64 (1, 0, 1, 0, 1, 0, 1, 0), _mm512_set1_epi64 (2 * unit)), unitTweaks);
+			__m512i exponents = laneExponents;
+			uint64 unitBlockCount = blockCount < AES_VAES512_UNIT_BLOCK_COUNT ? blockCount : AES_VAES512_UNIT_BLOCK_COUNT;
+
+			blockCount -= unitBlockCount;
+
+			while (unitBlockCount >= 16)
+			{
+				__m512i t0, t1, t2, t3, b0, b1, b2, b3;
+
+				t0 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm512_add_epi64 (exponents, exponentStep);
+				t1 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm512_add_epi64 (exponents, exponentStep);
+				t2 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm512_add_epi64 (exponents, exponentStep);
+				t3 = MultiplyTweaks (tweak, exponents, poly);
+				exponents = _mm512_add_epi64 (exponents, exponentStep);
+
+				/* Pre-whitening is combined with the first round key */
+				b0 = _mm512_ternarylogic_epi64 (_mm512_loadu_si512 (data), t0, roundKeys[0], 0x96);
+				b1 = _mm512_ternarylogic_epi64 (_mm512_loadu_si512 (data + 64), t1, roundKeys[0], 0x96);
+				b2 = _mm512_ternarylogic_epi64 (_mm512_loadu_si512 (data + 128), t2, roundKeys[0], 0x96);
+				b3 = _mm512_ternarylogic_epi64 (_mm512_loadu_si512 (data + 192), t3, roundKeys[0], 0x96);
+
+				for (round = 1; round < AES_VAES512_ROUND_KEY_COUNT - 1; round++)
+				{
+					AES_VAES512_ROUND (b0, roundKeys[round]);
+					AES_VAES512_ROUND (b1, roundKeys[round]);
+					AES_VAES512_ROUND (b2, roundKeys[round]);
+					AES_VAES512_ROUND (b3, roundKeys[round]);
+				}
+
+				/* Post-whitening is combined with the last round key */
+				AES_VAES512_LAST_ROUND (b0, _mm512_xor_si512 (roundKeys[AES_VAES512_ROUND_KEY_COUNT - 1], t0));
+				AES_VAES512_LAST_ROUND (b1, _mm512_xor_si512 (roundKeys[AES_VAES512_ROUND_KEY_COUNT - 1], t1));
+				AES_VAES512_LAST_ROUND (b2, _mm512_xor_si512 (roundKeys[AES_VAES512_ROUND_KEY_COUNT - 1], t2));
+				AES_VAES512_LAST_ROUND (b3, _mm512_xor_si512 (roundKeys[AES_VAES512_ROUND_KEY_COUNT - 1], t3));
+
+				_mm512_storeu_si512 (data, b0);
+				_mm512_storeu_si512 (data + 64, b1);
+				_mm512_storeu_si512 (data + 128, b2);
+				_mm512_storeu_si512 (data + 192, b3);
+
+				data += 256;
+				unitBlockCount -= 16;
+			}
+
+			/* Remaining blocks of a partial data unit */
+			while (unitBlockCount > 0)
+			{
+				unsigned int count = unitBlockCount < 4 ? (unsigned int) unitBlockCount : 4;
+				__mmask8 mask = (__mmask8) ((1 << (2 * count)) - 1);
+				__m512i t = MultiplyTweaks (tweak, exponents, poly);
+				__m512i b = _mm512_ternarylogic_epi64 (_mm512_maskz_loadu_epi64 (mask, data), t, roundKeys[0], 0x96);
+
+				exponents = _mm512_add_epi64 (exponents, exponentStep);
+
+				for (round = 1; round < AES_VAES512_ROUND_KEY_COUNT - 1; round++)
+					AES_VAES512_ROUND (b, roundKeys[round]);
+
+				AES_VAES512_LAST_ROUND (b, _mm512_xor_si512 (roundKeys[AES_VAES512_ROUND_KEY_COUNT - 1], t));
+				_mm512_mask_storeu_epi64 (data, mask, b);
+
+				data += 16 * count;
+				unitBlockCount -= count;
+			}
+
+			dataUnitNo++;
+		}
+	}
+
+	burn (roundKeys, sizeof (roundKeys));
+	burn (tweakKeys, sizeof (tweakKeys));
+}
+
+void aes_hw_vaes512_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsVaes512 (ks, tweakKs, data, blockCount, dataUnitNo, 1);
+}
+
+void aes_hw_vaes512_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsVaes512 (ks, tweakKs, data, blockCount, dataUnitNo, 0);
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* AES-256 XTS using AES-NI: whitening values are derived in registers and applied around
+   the rounds of eight interleaved blocks, so each block is loaded and stored only once. */
+
+#include "Aes_hw_cpu.h"
+#include "Xts_simd.h"
+
+#if CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE && !defined (TC_WINDOWS_DRIVER) && !defined (_UEFI)
+
+#define AES_HW_XTS_ROUND_KEY_COUNT 15
+#define AES_HW_XTS_UNIT_BLOCK_COUNT 32
+
+#define AES_HW_XTS_ROUND(block, roundKey) block = decrypt ? _mm_aesdec_si128 (block, roundKey) : _mm_aesenc_si128 (block, roundKey)
+#define AES_HW_XTS_LAST_ROUND(block, roundKey) block = decrypt ? _mm_aesdeclast_si128 (block, roundKey) : _mm_aesenclast_si128 (block, roundKey)
+
+VC_INLINE void AesXtsHw (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo, int decrypt)
+{
+	__m128i roundKeys[AES_HW_XTS_ROUND_KEY_COUNT];
+	__m128i tweaks[8];
+	__m128i blocks[8];
+	int round, i;
+
+	for (round = 0; round < AES_HW_XTS_ROUND_KEY_COUNT; round++)
+		roundKeys[round] = _mm_loadu_si128 ((const __m128i *) (ks + 16 * round));
+
+	while (blockCount > 0)
+	{
+		/* Initial tweak of the data unit (little-endian data unit number encrypted with the tweak key) */
+		__m128i tweak = _mm_xor_si128 (_mm_set_epi64x (0, (long long) dataUnitNo), _mm_loadu_si128 ((const __m128i *) tweakKs));
+		uint64 unitBlockCount = blockCount < AES_HW_XTS_UNIT_BLOCK_COUNT ? blockCount : AES_HW_XTS_UNIT_BLOCK_COUNT;
+
+		for (round = 1; round < AES_HW_XTS_ROUND_KEY_COUNT - 1; round++)
+			tweak = _mm_aesenc_si128 (tweak, _mm_loadu_si128 ((const __m128i *) (tweakKs + 16 * round)));
+		tweak = _mm_aesenclast_si128 (tweak, _mm_loadu_si128 ((const __m128i *) (tweakKs + 16 * (AES_HW_XTS_ROUND_KEY_COUNT - 1))));
+
+		blockCount -= unitBlockCount;
+
+		while (unitBlockCount >= 8)
+		{
+			for (i = 0; i < 8; i++)
+			{
+				tweaks[i] = tweak;
+				tweak = xts_mul_alpha_sse2 (tweak);
+
+				/* Pre-whitening is combined with the first round key */
+				blocks[i] = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) (data + 16 * i)), _mm_xor_si128 (tweaks[i], roundKeys[0]));
+			}
+
+			for (round = 1; round < AES_HW_XTS_ROUND_KEY_COUNT - 1; round++)
+			{
+				AES_HW_XTS_ROUND (blocks[0], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[1], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[2], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[3], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[4], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[5], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[6], roundKeys[round]);
+				AES_HW_XTS_ROUND (blocks[7], roundKeys[round]);
+			}
+
+			/* Post-whitening is combined with the last round key */
+			for (i = 0; i < 8; i++)
+			{
+				AES_HW_XTS_LAST_ROUND (blocks[i], _mm_xor_si128 (roundKeys[AES_HW_XTS_ROUND_KEY_COUNT - 1], tweaks[i]));
+				_mm_storeu_si128 ((__m128i *) (data + 16 * i), blocks[i]);
+			}
+
+			data += 16 * 8;
+			unitBlockCount -= 8;
+		}
+
+		/* Remaining blocks of a partial data unit */
+		for (; unitBlockCount > 0; unitBlockCount--)
+		{
+			__m128i block = _mm_xor_si128 (_mm_loadu_si128 ((const __m128i *) data), _mm_xor_si128 (tweak, roundKeys[0]));
+
+			for (round = 1; round < AES_HW_XTS_ROUND_KEY_COUNT - 1; round++)
+				AES_HW_XTS_ROUND (block, roundKeys[round]);
+
+			AES_HW_XTS_LAST_ROUND (block, _mm_xor_si128 (roundKeys[AES_HW_XTS_ROUND_KEY_COUNT - 1], tweak));
+			_mm_storeu_si128 ((__m128i *) data, block);
+
+			tweak = xts_mul_alpha_sse2 (tweak);
+			data += 16;
+		}
+
+		dataUnitNo++;
+	}
+
+	burn (roundKeys, sizeof (roundKeys));
+	burn (tweaks, sizeof (tweaks));
+}
+
+void aes_hw_cpu_xts_decrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsHw (ks, tweakKs, data, blockCount, dataUnitNo, 1);
+}
+
+void aes_hw_cpu_xts_encrypt (const uint8 *ks, const uint8 *tweakKs, uint8 *data, uint64 blockCount, uint64 dataUnitNo)
+{
+	AesXtsHw (ks, tweakKs, data, blockCount, dataUnitNo, 0);
+}
+
+#endif
@@ -174,6 +174,13 @@ typedef enum Argon2_ErrorCodes {
 typedef int (*allocate_fptr)(uint8_t **memory, size_t bytes_to_allocate);
 typedef void (*deallocate_fptr)(uint8_t *memory, size_t bytes_to_allocate);
 
+/* Lane executor types for VeraCrypt --- run_lanes_fptr must call fill_lane
+ * once for each lane in [0, lanes), possibly from several threads, and
+ * return when all calls have returned */
+typedef void (*fill_lane_fptr)(void *lane_data, uint32_t lane);
+typedef void (*run_lanes_fptr)(fill_lane_fptr fill_lane, void *lane_data,
+                               uint32_t lanes, void *run_lanes_data);
+
 /* Argon2 external data structures */
 
 /*
@@ -227,6 +234,10 @@ typedef struct Argon2_Context {
     /* Cancellation token for VeraCrypt */
     long volatile *pAbortKeyDerivation;
 
+    /* Lane executor for VeraCrypt (lanes are filled in turn if NULL) */
+    run_lanes_fptr run_lanes_cbk;
+    void *run_lanes_data;
+
     allocate_fptr allocate_cbk; /* pointer to memory allocator */
     deallocate_fptr free_cbk;   /* pointer to memory deallocator */
 
@@ -295,6 +306,24 @@ ARGON2_PUBLIC int argon2id_hash_raw(const uint32_t t_cost,
                                     const size_t saltlen, void *hash,
                                     const size_t hashlen, long volatile *pAbortKeyDerivation);
 
+/**
+ * Hashes a password with Argon2id, filling the lanes of each slice through
+ * the given lane executor (VeraCrypt)
+ * @param run_lanes_cbk Lane executor, or NULL to fill lanes in turn
+ * @param run_lanes_data Argument passed to run_lanes_cbk
+ * @pre   The result does not depend on the lane executor
+ */
+ARGON2_PUBLIC int argon2id_hash_raw_lanes(const uint32_t t_cost,
+                                          const uint32_t m_cost,
+                                          const uint32_t parallelism,
+                                          const void *pwd, const size_t pwdlen,
+                                          const void *salt,
+                                          const size_t saltlen, void *hash,
+                                          const size_t hashlen,
+                                          long volatile *pAbortKeyDerivation,
+                                          run_lanes_fptr run_lanes_cbk,
+                                          void *run_lanes_data);
+
 /* generic function underlying the above ones */
 ARGON2_PUBLIC int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
                               const uint32_t parallelism, const void *pwd,
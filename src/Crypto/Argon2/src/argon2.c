@@ -105,11 +105,12 @@ int argon2_ctx(argon2_context *context, argon2_type type) {
     return ARGON2_OK;
 }
 
-int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
+static int argon2_hash_lanes(const uint32_t t_cost, const uint32_t m_cost,
                 const uint32_t parallelism, const void *pwd,
                 const size_t pwdlen, const void *salt, const size_t saltlen,
                 void *hash, const size_t hashlen, argon2_type type,
-                const uint32_t version, long volatile *pAbortKeyDerivation){
+                const uint32_t version, long volatile *pAbortKeyDerivation,
+                run_lanes_fptr run_lanes_cbk, void *run_lanes_data){
 
     argon2_context context;
     int result;
@@ -155,6 +156,8 @@ int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
     context.flags = ARGON2_DEFAULT_FLAGS;
     context.version = version;
     context.pAbortKeyDerivation = pAbortKeyDerivation;
+    context.run_lanes_cbk = run_lanes_cbk;
+    context.run_lanes_data = run_lanes_data;
 
     result = argon2_ctx(&context, type);
 
@@ -175,6 +178,17 @@ int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
     return ARGON2_OK;
 }
 
+int argon2_hash(const uint32_t t_cost, const uint32_t m_cost,
+                const uint32_t parallelism, const void *pwd,
+                const size_t pwdlen, const void *salt, const size_t saltlen,
+                void *hash, const size_t hashlen, argon2_type type,
+                const uint32_t version, long volatile *pAbortKeyDerivation){
+
+    return argon2_hash_lanes(t_cost, m_cost, parallelism, pwd, pwdlen, salt,
+                             saltlen, hash, hashlen, type, version,
+                             pAbortKeyDerivation, NULL, NULL);
+}
+
 int argon2i_hash_raw(const uint32_t t_cost, const uint32_t m_cost,
                      const uint32_t parallelism, const void *pwd,
                      const size_t pwdlen, const void *salt,
@@ -202,6 +216,20 @@ int argon2id_hash_raw(const uint32_t t_cost, const uint32_t m_cost,
                        ARGON2_VERSION_NUMBER, pAbortKeyDerivation);
 }
 
+int argon2id_hash_raw_lanes(const uint32_t t_cost, const uint32_t m_cost,
+                            const uint32_t parallelism, const void *pwd,
+                            const size_t pwdlen, const void *salt,
+                            const size_t saltlen, void *hash,
+                            const size_t hashlen,
+                            long volatile *pAbortKeyDerivation,
+                            run_lanes_fptr run_lanes_cbk,
+                            void *run_lanes_data) {
+    return argon2_hash_lanes(t_cost, m_cost, parallelism, pwd, pwdlen, salt,
+                             saltlen, hash, hashlen, Argon2_id,
+                             ARGON2_VERSION_NUMBER, pAbortKeyDerivation,
+                             run_lanes_cbk, run_lanes_data);
+}
+
 int argon2d_ctx(argon2_context *context) {
     return argon2_ctx(context, Argon2_d);
 }
@@ -232,6 +232,63 @@ static int fill_memory_blocks_st(argon2_instance_t *instance) {
     return ARGON2_OK;
 }
 
+/* Version handing the lanes of each slice to the lane executor of the context */
+typedef struct Argon2_slice_data {
+    const argon2_instance_t *instance;
+    uint32_t pass;
+    uint8_t slice;
+    int *results;
+} argon2_slice_data;
+
+static void fill_lane_segment(void *lane_data, uint32_t lane) {
+    argon2_slice_data *data = (argon2_slice_data *)lane_data;
+    argon2_position_t position;
+
+    position.pass = data->pass;
+    position.lane = lane;
+    position.slice = data->slice;
+    position.index = 0;
+    data->results[lane] = fill_segment(data->instance, position);
+}
+
+static int fill_memory_blocks_cbk(argon2_instance_t *instance) {
+    argon2_context *context = instance->context_ptr;
+    argon2_slice_data data;
+    uint32_t r, s, l;
+    int rc = ARGON2_OK;
+
+    data.instance = instance;
+    data.results = TCalloc(instance->lanes * sizeof(int));
+    if (data.results == NULL) {
+        return ARGON2_MEMORY_ALLOCATION_ERROR;
+    }
+
+    for (r = 0; r < instance->passes && rc == ARGON2_OK; ++r) {
+        for (s = 0; s < ARGON2_SYNC_POINTS && rc == ARGON2_OK; ++s) {
+            data.pass = r;
+            data.slice = (uint8_t)s;
+
+            /* All lanes of a slice must be filled before the next slice
+             * references them */
+            context->run_lanes_cbk(fill_lane_segment, &data, instance->lanes,
+                                   context->run_lanes_data);
+
+            for (l = 0; l < instance->lanes; ++l) {
+                if (data.results[l] != ARGON2_OK) {
+                    rc = data.results[l];
+                    break;
+                }
+            }
+        }
+#ifdef GENKAT
+        internal_kat(instance, r); /* Print all memory blocks */
+#endif
+    }
+
+    TCfree(data.results);
+    return rc;
+}
+
 #if !defined(ARGON2_NO_THREADS)
 
 #ifdef _WIN32
@@ -335,6 +392,9 @@ int fill_memory_blocks(argon2_instance_t *instance) {
 	if (instance == NULL || instance->lanes == 0) {
 	    return ARGON2_INCORRECT_PARAMETER;
     }
+    if (instance->lanes > 1 && instance->context_ptr->run_lanes_cbk) {
+        return fill_memory_blocks_cbk(instance);
+    }
 #if defined(ARGON2_NO_THREADS)
     return fill_memory_blocks_st(instance);
 #else
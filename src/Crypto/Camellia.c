@@ -1095,6 +1095,31 @@ void camellia_decrypt(const unsigned __int8 *inBlock,  unsigned __int8 *outBlock
 
 void camellia_encrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#ifdef CAMELLIA_VAES
+	if ((blockCount >= 32) && IsAesHwCpuSupported () && HasVAES())
+	{
+		uint32 vaesBlockCount;
+
+		if ((blockCount >= 64) && HasSAVX512())
+		{
+			vaesBlockCount = blockCount & ~63U;
+			camellia_vaes512_encrypt_blocks (instance, in_blk, out_blk, vaesBlockCount);
+			in_blk += vaesBlockCount * 16;
+			out_blk += vaesBlockCount * 16;
+			blockCount -= vaesBlockCount;
+		}
+
+		if (blockCount >= 32)
+		{
+			vaesBlockCount = blockCount & ~31U;
+			camellia_vaes_encrypt_blocks (instance, in_blk, out_blk, vaesBlockCount);
+			in_blk += vaesBlockCount * 16;
+			out_blk += vaesBlockCount * 16;
+			blockCount -= vaesBlockCount;
+		}
+	}
+#endif
+
 #if !defined (_UEFI)
 	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX() && HasSSSE3()) /* on AMD cpu, AVX is too slow */
 	{
@@ -1131,6 +1156,31 @@ void camellia_encrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uin
 
 void camellia_decrypt_blocks(unsigned __int8 *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#ifdef CAMELLIA_VAES
+	if ((blockCount >= 32) && IsAesHwCpuSupported () && HasVAES())
+	{
+		uint32 vaesBlockCount;
+
+		if ((blockCount >= 64) && HasSAVX512())
+		{
+			vaesBlockCount = blockCount & ~63U;
+			camellia_vaes512_decrypt_blocks (instance, in_blk, out_blk, vaesBlockCount);
+			in_blk += vaesBlockCount * 16;
+			out_blk += vaesBlockCount * 16;
+			blockCount -= vaesBlockCount;
+		}
+
+		if (blockCount >= 32)
+		{
+			vaesBlockCount = blockCount & ~31U;
+			camellia_vaes_decrypt_blocks (instance, in_blk, out_blk, vaesBlockCount);
+			in_blk += vaesBlockCount * 16;
+			out_blk += vaesBlockCount * 16;
+			blockCount -= vaesBlockCount;
+		}
+	}
+#endif
+
 #if !defined (_UEFI)
 	if ((blockCount >= 16) && IsCpuIntel() && IsAesHwCpuSupported () && HasSAVX() && HasSSSE3()) /* on AMD cpu, AVX is too slow */
 	{
@@ -20,6 +20,16 @@ void camellia_decrypt(const unsigned __int8 *inBlock,  unsigned __int8 *outBlock
 #if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
 void camellia_encrypt_blocks(unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
 void camellia_decrypt_blocks(unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
+
+#if CRYPTOPP_VAES_AVAILABLE && !defined(TC_WINDOWS_DRIVER) && !defined(_UEFI)
+#define CAMELLIA_VAES
+/* byte-sliced VAES implementations: blockCount must be a multiple of 32 with 256-bit vectors (requires HasVAES())
+   and a multiple of 64 with 512-bit vectors (requires HasVAES() and HasSAVX512()) */
+void camellia_vaes_encrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
+void camellia_vaes_decrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
+void camellia_vaes512_encrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
+void camellia_vaes512_decrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount);
+#endif
 #endif
 
 #ifdef __cplusplus
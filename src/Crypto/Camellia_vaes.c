@@ -0,0 +1,63 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Camellia-256 processing 32 blocks in parallel using VAES on 256-bit vectors.
+   Must be compiled with AVX2 and VAES enabled. */
+
+#include "Camellia.h"
+
+#ifdef CAMELLIA_VAES
+
+#include <immintrin.h>
+
+#define CAMELLIA_VEC __m256i
+#define CAMELLIA_VEC_BLOCK_COUNT 32
+
+#define CAMELLIA_VEC_LOADU(p) _mm256_loadu_si256 ((const __m256i *) (p))
+#define CAMELLIA_VEC_STOREU(p, x) _mm256_storeu_si256 ((__m256i *) (p), x)
+#define CAMELLIA_VEC_BROADCAST128(p) _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) (p)))
+#define CAMELLIA_VEC_SET1_8(b) _mm256_set1_epi8 (b)
+#define CAMELLIA_VEC_ZERO() _mm256_setzero_si256 ()
+#define CAMELLIA_VEC_XOR(a, b) _mm256_xor_si256 (a, b)
+#define CAMELLIA_VEC_AND(a, b) _mm256_and_si256 (a, b)
+#define CAMELLIA_VEC_ANDNOT(a, b) _mm256_andnot_si256 (a, b)
+#define CAMELLIA_VEC_OR(a, b) _mm256_or_si256 (a, b)
+#define CAMELLIA_VEC_ADD8(a, b) _mm256_add_epi8 (a, b)
+#define CAMELLIA_VEC_SRL16(x, n) _mm256_srli_epi16 (x, n)
+#define CAMELLIA_VEC_SRL32(x, n) _mm256_srli_epi32 (x, n)
+#define CAMELLIA_VEC_SHUFB(x, i) _mm256_shuffle_epi8 (x, i)
+#define CAMELLIA_VEC_AESENCLAST(x, k) _mm256_aesenclast_epi128 (x, k)
+#define CAMELLIA_VEC_UNPACKLO32(a, b) _mm256_unpacklo_epi32 (a, b)
+#define CAMELLIA_VEC_UNPACKHI32(a, b) _mm256_unpackhi_epi32 (a, b)
+#define CAMELLIA_VEC_UNPACKLO64(a, b) _mm256_unpacklo_epi64 (a, b)
+#define CAMELLIA_VEC_UNPACKHI64(a, b) _mm256_unpackhi_epi64 (a, b)
+
+#include "Camellia_vaes_simd.h"
+
+void camellia_vaes_encrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
+{
+	for (; blockCount >= CAMELLIA_VEC_BLOCK_COUNT; blockCount -= CAMELLIA_VEC_BLOCK_COUNT)
+	{
+		CamelliaVaesBlocks (ks, in_blk, out_blk, 0);
+		in_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+		out_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+	}
+}
+
+void camellia_vaes_decrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
+{
+	for (; blockCount >= CAMELLIA_VEC_BLOCK_COUNT; blockCount -= CAMELLIA_VEC_BLOCK_COUNT)
+	{
+		CamelliaVaesBlocks (ks, in_blk, out_blk, 1);
+		in_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+		out_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+	}
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Camellia-256 processing 64 blocks in parallel using VAES on 512-bit vectors.
+   Must be compiled with AVX-512 (F, BW) and VAES enabled. */
+
+#include "Camellia.h"
+
+#ifdef CAMELLIA_VAES
+
+#include <immintrin.h>
+
+#define CAMELLIA_VEC __m512i
+#define CAMELLIA_VEC_BLOCK_COUNT 64
+
+#define CAMELLIA_VEC_LOADU(p) _mm512_loadu_si512 ((const void *) (p))
+#define CAMELLIA_VEC_STOREU(p, x) _mm512_storeu_si512 ((void *) (p), x)
+#define CAMELLIA_VEC_BROADCAST128(p) _mm512_broadcast_i32x4 (_mm_loadu_si128 ((const __m128i *) (p)))
+#define CAMELLIA_VEC_SET1_8(b) _mm512_set1_epi8 (b)
+#define CAMELLIA_VEC_ZERO() _mm512_setzero_si512 ()
+#define CAMELLIA_VEC_XOR(a, b) _mm512_xor_si512 (a, b)
+#define CAMELLIA_VEC_AND(a, b) _mm512_and_si512 (a, b)
+#define CAMELLIA_VEC_ANDNOT(a, b) _mm512_andnot_si512 (a, b)
+#define CAMELLIA_VEC_OR(a, b) _mm512_or_si512 (a, b)
+#define CAMELLIA_VEC_ADD8(a, b) _mm512_add_epi8 (a, b)
+#define CAMELLIA_VEC_SRL16(x, n) _mm512_srli_epi16 (x, n)
+#define CAMELLIA_VEC_SRL32(x, n) _mm512_srli_epi32 (x, n)
+#define CAMELLIA_VEC_SHUFB(x, i) _mm512_shuffle_epi8 (x, i)
+#define CAMELLIA_VEC_AESENCLAST(x, k) _mm512_aesenclast_epi128 (x, k)
+#define CAMELLIA_VEC_UNPACKLO32(a, b) _mm512_unpacklo_epi32 (a, b)
+#define CAMELLIA_VEC_UNPACKHI32(a, b) _mm512_unpackhi_epi32 (a, b)
+#define CAMELLIA_VEC_UNPACKLO64(a, b) _mm512_unpacklo_epi64 (a, b)
+#define CAMELLIA_VEC_UNPACKHI64(a, b) _mm512_unpackhi_epi64 (a, b)
+
+#include "Camellia_vaes_simd.h"
+
+void camellia_vaes512_encrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
+{
+	for (; blockCount >= CAMELLIA_VEC_BLOCK_COUNT; blockCount -= CAMELLIA_VEC_BLOCK_COUNT)
+	{
+		CamelliaVaesBlocks (ks, in_blk, out_blk, 0);
+		in_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+		out_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+	}
+}
+
+void camellia_vaes512_decrypt_blocks(const unsigned __int8 *ks, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
+{
+	for (; blockCount >= CAMELLIA_VEC_BLOCK_COUNT; blockCount -= CAMELLIA_VEC_BLOCK_COUNT)
+	{
+		CamelliaVaesBlocks (ks, in_blk, out_blk, 1);
+		in_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+		out_blk += CAMELLIA_VEC_BLOCK_COUNT * 16;
+	}
+}
+
+#endif
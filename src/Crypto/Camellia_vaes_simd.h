@@ -0,0 +1,305 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Byte-sliced Camellia-256 using AES instructions for the S-boxes, shared by the VAES
+   implementations on 256-bit (Camellia_vaes.c) and 512-bit (Camellia_vaes512.c) vectors.
+   Each 128-bit lane of a vector processes 16 blocks in the same way as the 16-way AES-NI
+   implementation in Camellia_aesni_x64.S, whose byte-slicing, S-box filters and key table
+   layout are used here.
+
+   The including file defines CAMELLIA_VEC (the vector type), CAMELLIA_VEC_BLOCK_COUNT
+   (16 blocks per 128-bit lane) and the CAMELLIA_VEC_* operations below. */
+
+#ifndef TC_HEADER_Crypto_Camellia_Vaes_Simd
+#define TC_HEADER_Crypto_Camellia_Vaes_Simd
+
+#include "Common/Tcdefs.h"
+
+/* Affine transforms mapping the Camellia S-boxes onto the AES S-box (lookups of the low and high nibbles) */
+static const uint8 CamelliaVaesPreLoS1[16] = { 0x45, 0xe8, 0x40, 0xed, 0x2e, 0x83, 0x2b, 0x86, 0x4b, 0xe6, 0x4e, 0xe3, 0x20, 0x8d, 0x25, 0x88 };
+static const uint8 CamelliaVaesPreHiS1[16] = { 0x00, 0x51, 0xf1, 0xa0, 0x8a, 0xdb, 0x7b, 0x2a, 0x09, 0x58, 0xf8, 0xa9, 0x83, 0xd2, 0x72, 0x23 };
+static const uint8 CamelliaVaesPreLoS4[16] = { 0x45, 0x40, 0x2e, 0x2b, 0x4b, 0x4e, 0x20, 0x25, 0x14, 0x11, 0x7f, 0x7a, 0x1a, 0x1f, 0x71, 0x74 };
+static const uint8 CamelliaVaesPreHiS4[16] = { 0x00, 0xf1, 0x8a, 0x7b, 0x09, 0xf8, 0x83, 0x72, 0xad, 0x5c, 0x27, 0xd6, 0xa4, 0x55, 0x2e, 0xdf };
+static const uint8 CamelliaVaesPostLoS1[16] = { 0x3c, 0xcc, 0xcf, 0x3f, 0x32, 0xc2, 0xc1, 0x31, 0xdc, 0x2c, 0x2f, 0xdf, 0xd2, 0x22, 0x21, 0xd1 };
+static const uint8 CamelliaVaesPostHiS1[16] = { 0x00, 0xf9, 0x86, 0x7f, 0xd7, 0x2e, 0x51, 0xa8, 0xa4, 0x5d, 0x22, 0xdb, 0x73, 0x8a, 0xf5, 0x0c };
+static const uint8 CamelliaVaesPostLoS2[16] = { 0x78, 0x99, 0x9f, 0x7e, 0x64, 0x85, 0x83, 0x62, 0xb9, 0x58, 0x5e, 0xbf, 0xa5, 0x44, 0x42, 0xa3 };
+static const uint8 CamelliaVaesPostHiS2[16] = { 0x00, 0xf3, 0x0d, 0xfe, 0xaf, 0x5c, 0xa2, 0x51, 0x49, 0xba, 0x44, 0xb7, 0xe6, 0x15, 0xeb, 0x18 };
+static const uint8 CamelliaVaesPostLoS3[16] = { 0x1e, 0x66, 0xe7, 0x9f, 0x19, 0x61, 0xe0, 0x98, 0x6e, 0x16, 0x97, 0xef, 0x69, 0x11, 0x90, 0xe8 };
+static const uint8 CamelliaVaesPostHiS3[16] = { 0x00, 0xfc, 0x43, 0xbf, 0xeb, 0x17, 0xa8, 0x54, 0x52, 0xae, 0x11, 0xed, 0xb9, 0x45, 0xfa, 0x06 };
+
+/* Cancels the ShiftRows step of AESENCLAST */
+static const uint8 CamelliaVaesInvShiftRow[16] = { 0x00, 0x0d, 0x0a, 0x07, 0x04, 0x01, 0x0e, 0x0b, 0x08, 0x05, 0x02, 0x0f, 0x0c, 0x09, 0x06, 0x03 };
+
+/* Transposes the bytes of a 4x4 matrix of 32-bit words */
+static const uint8 CamelliaVaesShufb16x16[16] = { 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15 };
+
+typedef struct
+{
+	CAMELLIA_VEC PreLoS1, PreHiS1, PreLoS4, PreHiS4;
+	CAMELLIA_VEC PostLoS1, PostHiS1, PostLoS2, PostHiS2, PostLoS3, PostHiS3;
+	CAMELLIA_VEC InvShiftRow, Mask4Bit, One, Zero;
+} CamelliaVaesConstants;
+
+#define CAMELLIA_VAES_TRANSPOSE_4X4(x0, x1, x2, x3) \
+	{ \
+		CAMELLIA_VEC t0 = CAMELLIA_VEC_UNPACKLO32 (x0, x1); \
+		CAMELLIA_VEC t1 = CAMELLIA_VEC_UNPACKLO32 (x2, x3); \
+		CAMELLIA_VEC t2 = CAMELLIA_VEC_UNPACKHI32 (x0, x1); \
+		CAMELLIA_VEC t3 = CAMELLIA_VEC_UNPACKHI32 (x2, x3); \
+		x0 = CAMELLIA_VEC_UNPACKLO64 (t0, t1); \
+		x1 = CAMELLIA_VEC_UNPACKHI64 (t0, t1); \
+		x2 = CAMELLIA_VEC_UNPACKLO64 (t2, t3); \
+		x3 = CAMELLIA_VEC_UNPACKHI64 (t2, t3); \
+	}
+
+/* Applies an 8-bit affine transform given by its nibble lookup tables */
+#define CAMELLIA_VAES_FILTER(x, lo, hi) \
+	x = CAMELLIA_VEC_XOR (CAMELLIA_VEC_SHUFB (c->lo, CAMELLIA_VEC_AND (x, c->Mask4Bit)), \
+		CAMELLIA_VEC_SHUFB (c->hi, CAMELLIA_VEC_SRL32 (CAMELLIA_VEC_ANDNOT (c->Mask4Bit, x), 4)))
+
+/* Byte j (big-endian) of a 32-bit key word, broadcast to all bytes */
+#define CAMELLIA_VAES_KEY_BYTE(w, j) CAMELLIA_VEC_SET1_8 ((char) ((w) >> (24 - 8 * (j))))
+
+static void CamelliaVaesInitConstants (CamelliaVaesConstants *c)
+{
+	c->PreLoS1 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPreLoS1);
+	c->PreHiS1 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPreHiS1);
+	c->PreLoS4 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPreLoS4);
+	c->PreHiS4 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPreHiS4);
+	c->PostLoS1 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostLoS1);
+	c->PostHiS1 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostHiS1);
+	c->PostLoS2 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostLoS2);
+	c->PostHiS2 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostHiS2);
+	c->PostLoS3 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostLoS3);
+	c->PostHiS3 = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesPostHiS3);
+	c->InvShiftRow = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesInvShiftRow);
+	c->Mask4Bit = CAMELLIA_VEC_SET1_8 (0x0f);
+	c->One = CAMELLIA_VEC_SET1_8 (1);
+	c->Zero = CAMELLIA_VEC_ZERO ();
+}
+
+/* Loads 16 vectors and converts them to byte slices: on return, v[j] holds byte j of the blocks
+   of each 128-bit lane */
+VC_INLINE void CamelliaVaesByteslice (const uint8 *in, CAMELLIA_VEC v[16], const CamelliaVaesConstants *c)
+{
+	CAMELLIA_VEC x[16];
+	CAMELLIA_VEC shufb = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesShufb16x16);
+	int i;
+
+	for (i = 0; i < 16; i++)
+		x[i] = CAMELLIA_VEC_LOADU (in + i * sizeof (CAMELLIA_VEC));
+
+	for (i = 0; i < 16; i += 4)
+		CAMELLIA_VAES_TRANSPOSE_4X4 (x[i], x[i + 1], x[i + 2], x[i + 3]);
+
+	for (i = 0; i < 16; i++)
+		x[i] = CAMELLIA_VEC_SHUFB (x[i], shufb);
+
+	for (i = 0; i < 4; i++)
+		CAMELLIA_VAES_TRANSPOSE_4X4 (x[i], x[i + 4], x[i + 8], x[i + 12]);
+
+	for (i = 0; i < 16; i++)
+		v[i] = x[4 * (i % 4) + i / 4];
+}
+
+/* Inverse of CamelliaVaesByteslice */
+VC_INLINE void CamelliaVaesUnbyteslice (CAMELLIA_VEC v[16], uint8 *out, const CamelliaVaesConstants *c)
+{
+	CAMELLIA_VEC x[16];
+	CAMELLIA_VEC shufb = CAMELLIA_VEC_BROADCAST128 (CamelliaVaesShufb16x16);
+	int i;
+
+	for (i = 0; i < 16; i++)
+		x[4 * (i % 4) + i / 4] = v[i];
+
+	for (i = 0; i < 4; i++)
+		CAMELLIA_VAES_TRANSPOSE_4X4 (x[i], x[i + 4], x[i + 8], x[i + 12]);
+
+	for (i = 0; i < 16; i++)
+		x[i] = CAMELLIA_VEC_SHUFB (x[i], shufb);
+
+	for (i = 0; i < 16; i += 4)
+		CAMELLIA_VAES_TRANSPOSE_4X4 (x[i], x[i + 1], x[i + 2], x[i + 3]);
+
+	for (i = 0; i < 16; i++)
+		CAMELLIA_VEC_STOREU (out + i * sizeof (CAMELLIA_VEC), x[i]);
+}
+
+/* y ^= F(x) followed by the key of the next round (the key table stores the subkeys in this form) */
+VC_INLINE void CamelliaVaesRound (const CAMELLIA_VEC x[8], CAMELLIA_VEC y[8], const uint8 *ks, int keyIndex, const CamelliaVaesConstants *c)
+{
+	uint32 keyL = ((const uint32 *) ks)[2 * keyIndex];
+	uint32 keyR = ((const uint32 *) ks)[2 * keyIndex + 1];
+	CAMELLIA_VEC x0, x1, x2, x3, x4, x5, x6, x7;
+
+	/* S-function: AES SubBytes between affine transforms; the AES ShiftRows step is cancelled in advance */
+	x0 = CAMELLIA_VEC_SHUFB (x[0], c->InvShiftRow);
+	x1 = CAMELLIA_VEC_SHUFB (x[1], c->InvShiftRow);
+	x2 = CAMELLIA_VEC_SHUFB (x[2], c->InvShiftRow);
+	x3 = CAMELLIA_VEC_SHUFB (x[3], c->InvShiftRow);
+	x4 = CAMELLIA_VEC_SHUFB (x[4], c->InvShiftRow);
+	x5 = CAMELLIA_VEC_SHUFB (x[5], c->InvShiftRow);
+	x6 = CAMELLIA_VEC_SHUFB (x[6], c->InvShiftRow);
+	x7 = CAMELLIA_VEC_SHUFB (x[7], c->InvShiftRow);
+
+	/* Sboxes 1, 2 and 3 are based on sbox 1, sbox 4 on rotated input bytes */
+	CAMELLIA_VAES_FILTER (x0, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x7, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x1, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x4, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x2, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x5, PreLoS1, PreHiS1);
+	CAMELLIA_VAES_FILTER (x3, PreLoS4, PreHiS4);
+	CAMELLIA_VAES_FILTER (x6, PreLoS4, PreHiS4);
+
+	x0 = CAMELLIA_VEC_AESENCLAST (x0, c->Zero);
+	x1 = CAMELLIA_VEC_AESENCLAST (x1, c->Zero);
+	x2 = CAMELLIA_VEC_AESENCLAST (x2, c->Zero);
+	x3 = CAMELLIA_VEC_AESENCLAST (x3, c->Zero);
+	x4 = CAMELLIA_VEC_AESENCLAST (x4, c->Zero);
+	x5 = CAMELLIA_VEC_AESENCLAST (x5, c->Zero);
+	x6 = CAMELLIA_VEC_AESENCLAST (x6, c->Zero);
+	x7 = CAMELLIA_VEC_AESENCLAST (x7, c->Zero);
+
+	CAMELLIA_VAES_FILTER (x0, PostLoS1, PostHiS1);
+	CAMELLIA_VAES_FILTER (x7, PostLoS1, PostHiS1);
+	CAMELLIA_VAES_FILTER (x3, PostLoS1, PostHiS1);
+	CAMELLIA_VAES_FILTER (x6, PostLoS1, PostHiS1);
+	CAMELLIA_VAES_FILTER (x2, PostLoS3, PostHiS3);
+	CAMELLIA_VAES_FILTER (x5, PostLoS3, PostHiS3);
+	CAMELLIA_VAES_FILTER (x1, PostLoS2, PostHiS2);
+	CAMELLIA_VAES_FILTER (x4, PostLoS2, PostHiS2);
+
+	/* P-function */
+	x0 = CAMELLIA_VEC_XOR (x0, x5);
+	x1 = CAMELLIA_VEC_XOR (x1, x6);
+	x2 = CAMELLIA_VEC_XOR (x2, x7);
+	x3 = CAMELLIA_VEC_XOR (x3, x4);
+
+	x4 = CAMELLIA_VEC_XOR (x4, x2);
+	x5 = CAMELLIA_VEC_XOR (x5, x3);
+	x6 = CAMELLIA_VEC_XOR (x6, x0);
+	x7 = CAMELLIA_VEC_XOR (x7, x1);
+
+	x0 = CAMELLIA_VEC_XOR (x0, x7);
+	x1 = CAMELLIA_VEC_XOR (x1, x4);
+	x2 = CAMELLIA_VEC_XOR (x2, x5);
+	x3 = CAMELLIA_VEC_XOR (x3, x6);
+
+	x4 = CAMELLIA_VEC_XOR (x4, x3);
+	x5 = CAMELLIA_VEC_XOR (x5, x0);
+	x6 = CAMELLIA_VEC_XOR (x6, x1);
+	x7 = CAMELLIA_VEC_XOR (x7, x2);
+
+	/* The halves of the result are swapped */
+	y[0] = CAMELLIA_VEC_XOR (y[0], CAMELLIA_VEC_XOR (x4, CAMELLIA_VAES_KEY_BYTE (keyL, 0)));
+	y[1] = CAMELLIA_VEC_XOR (y[1], CAMELLIA_VEC_XOR (x5, CAMELLIA_VAES_KEY_BYTE (keyL, 1)));
+	y[2] = CAMELLIA_VEC_XOR (y[2], CAMELLIA_VEC_XOR (x6, CAMELLIA_VAES_KEY_BYTE (keyL, 2)));
+	y[3] = CAMELLIA_VEC_XOR (y[3], CAMELLIA_VEC_XOR (x7, CAMELLIA_VAES_KEY_BYTE (keyL, 3)));
+	y[4] = CAMELLIA_VEC_XOR (y[4], CAMELLIA_VEC_XOR (x0, CAMELLIA_VAES_KEY_BYTE (keyR, 0)));
+	y[5] = CAMELLIA_VEC_XOR (y[5], CAMELLIA_VEC_XOR (x1, CAMELLIA_VAES_KEY_BYTE (keyR, 1)));
+	y[6] = CAMELLIA_VEC_XOR (y[6], CAMELLIA_VEC_XOR (x2, CAMELLIA_VAES_KEY_BYTE (keyR, 2)));
+	y[7] = CAMELLIA_VEC_XOR (y[7], CAMELLIA_VEC_XOR (x3, CAMELLIA_VAES_KEY_BYTE (keyR, 3)));
+}
+
+/* x[4..7] ^= rotl32 (x[0..3] & key, 1) on byte-sliced 32-bit words (x[0] holds the most significant bytes) */
+VC_INLINE void CamelliaVaesAndRotXor (CAMELLIA_VEC x[8], uint32 key, const CamelliaVaesConstants *c)
+{
+	CAMELLIA_VEC t0 = CAMELLIA_VEC_AND (x[0], CAMELLIA_VAES_KEY_BYTE (key, 0));
+	CAMELLIA_VEC t1 = CAMELLIA_VEC_AND (x[1], CAMELLIA_VAES_KEY_BYTE (key, 1));
+	CAMELLIA_VEC t2 = CAMELLIA_VEC_AND (x[2], CAMELLIA_VAES_KEY_BYTE (key, 2));
+	CAMELLIA_VEC t3 = CAMELLIA_VEC_AND (x[3], CAMELLIA_VAES_KEY_BYTE (key, 3));
+
+	/* Most significant bits of the bytes, moved to the least significant bit */
+	CAMELLIA_VEC c0 = CAMELLIA_VEC_AND (CAMELLIA_VEC_SRL16 (t0, 7), c->One);
+	CAMELLIA_VEC c1 = CAMELLIA_VEC_AND (CAMELLIA_VEC_SRL16 (t1, 7), c->One);
+	CAMELLIA_VEC c2 = CAMELLIA_VEC_AND (CAMELLIA_VEC_SRL16 (t2, 7), c->One);
+	CAMELLIA_VEC c3 = CAMELLIA_VEC_AND (CAMELLIA_VEC_SRL16 (t3, 7), c->One);
+
+	x[4] = CAMELLIA_VEC_XOR (x[4], CAMELLIA_VEC_OR (CAMELLIA_VEC_ADD8 (t0, t0), c1));
+	x[5] = CAMELLIA_VEC_XOR (x[5], CAMELLIA_VEC_OR (CAMELLIA_VEC_ADD8 (t1, t1), c2));
+	x[6] = CAMELLIA_VEC_XOR (x[6], CAMELLIA_VEC_OR (CAMELLIA_VEC_ADD8 (t2, t2), c3));
+	x[7] = CAMELLIA_VEC_XOR (x[7], CAMELLIA_VEC_OR (CAMELLIA_VEC_ADD8 (t3, t3), c0));
+}
+
+/* x[0..3] ^= x[4..7] | key */
+VC_INLINE void CamelliaVaesOrXor (CAMELLIA_VEC x[8], uint32 key)
+{
+	x[0] = CAMELLIA_VEC_XOR (x[0], CAMELLIA_VEC_OR (x[4], CAMELLIA_VAES_KEY_BYTE (key, 0)));
+	x[1] = CAMELLIA_VEC_XOR (x[1], CAMELLIA_VEC_OR (x[5], CAMELLIA_VAES_KEY_BYTE (key, 1)));
+	x[2] = CAMELLIA_VEC_XOR (x[2], CAMELLIA_VEC_OR (x[6], CAMELLIA_VAES_KEY_BYTE (key, 2)));
+	x[3] = CAMELLIA_VEC_XOR (x[3], CAMELLIA_VEC_OR (x[7], CAMELLIA_VAES_KEY_BYTE (key, 3)));
+}
+
+/* XORs a 64-bit subkey of the key table into the first half of the blocks */
+VC_INLINE void CamelliaVaesXorKey (CAMELLIA_VEC x[8], const uint8 *ks, int keyIndex)
+{
+	uint32 keyL = ((const uint32 *) ks)[2 * keyIndex];
+	uint32 keyR = ((const uint32 *) ks)[2 * keyIndex + 1];
+	int j;
+
+	for (j = 0; j < 4; j++)
+	{
+		x[j] = CAMELLIA_VEC_XOR (x[j], CAMELLIA_VAES_KEY_BYTE (keyL, j));
+		x[j + 4] = CAMELLIA_VEC_XOR (x[j + 4], CAMELLIA_VAES_KEY_BYTE (keyR, j));
+	}
+}
+
+/* Processes CAMELLIA_VEC_BLOCK_COUNT blocks. The key table layout is that of camellia_set_key() for 256-bit keys. */
+VC_INLINE void CamelliaVaesBlocks (const uint8 *ks, const uint8 *in, uint8 *out, int decrypt)
+{
+	const uint32 *ks32 = (const uint32 *) ks;
+	CamelliaVaesConstants c;
+	CAMELLIA_VEC v[16], *ab = v, *cd = v + 8;
+	int i, r;
+
+	CamelliaVaesInitConstants (&c);
+	CamelliaVaesByteslice (in, v, &c);
+
+	CamelliaVaesXorKey (ab, ks, decrypt ? 32 : 0);
+
+	for (i = 0; i < 4; i++)
+	{
+		int k = decrypt ? 8 * (3 - i) : 8 * i;
+
+		for (r = 0; r < 3; r++)
+		{
+			CamelliaVaesRound (ab, cd, ks, decrypt ? k + 7 - 2 * r : k + 2 + 2 * r, &c);
+			CamelliaVaesRound (cd, ab, ks, decrypt ? k + 6 - 2 * r : k + 3 + 2 * r, &c);
+		}
+
+		if (i == 3)
+			break;
+
+		/* FL on the first half and FL^-1 on the second half; the FL keys follow the preceding six rounds */
+		k = decrypt ? k : k + 8;
+		CamelliaVaesAndRotXor (ab, ks32[2 * k + (decrypt ? 2 : 0)], &c);
+		CamelliaVaesOrXor (ab, ks32[2 * k + (decrypt ? 3 : 1)]);
+		CamelliaVaesOrXor (cd, ks32[2 * k + (decrypt ? 1 : 3)]);
+		CamelliaVaesAndRotXor (cd, ks32[2 * k + (decrypt ? 0 : 2)], &c);
+	}
+
+	CamelliaVaesXorKey (cd, ks, decrypt ? 0 : 32);
+
+	/* Output block is (cd, ab) */
+	for (i = 0; i < 8; i++)
+	{
+		CAMELLIA_VEC t = ab[i];
+		ab[i] = cd[i];
+		cd[i] = t;
+	}
+
+	CamelliaVaesUnbyteslice (v, out, &c);
+}
+
+#undef CAMELLIA_VAES_TRANSPOSE_4X4
+#undef CAMELLIA_VAES_FILTER
+#undef CAMELLIA_VAES_KEY_BYTE
+
+#endif // TC_HEADER_Crypto_Camellia_Vaes_Simd
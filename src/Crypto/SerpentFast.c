@@ -36,6 +36,22 @@
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
 extern void serpent_simd_encrypt_blocks_4(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
 extern void serpent_simd_decrypt_blocks_4(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+extern void serpent_simd_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+extern void serpent_simd_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+#endif
+
+#if CRYPTOPP_AVX2_AVAILABLE && !defined(TC_WINDOWS_DRIVER) && !defined(_UEFI)
+#define SERPENT_WIDE_SIMD
+extern void serpent_avx2_encrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+extern void serpent_avx2_decrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+extern void serpent_avx2_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+extern void serpent_avx2_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+#if CRYPTOPP_AVX512_AVAILABLE
+extern void serpent_avx512_encrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+extern void serpent_avx512_decrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key);
+extern void serpent_avx512_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+extern void serpent_avx512_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key);
+#endif
 #endif
 
 /*
@@ -80,6 +96,30 @@ void serpent_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, siz
    unsigned __int32 B0, B1, B2, B3;
    unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
    size_t i;
+#ifdef SERPENT_WIDE_SIMD
+#if CRYPTOPP_AVX512_AVAILABLE
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      while(blocks >= 16)
+      {
+         serpent_avx512_encrypt_blocks_16(in, out, round_key);
+         in += 16 * 16;
+         out += 16 * 16;
+         blocks -= 16;
+      }
+   }
+#endif
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      while(blocks >= 8)
+      {
+         serpent_avx2_encrypt_blocks_8(in, out, round_key);
+         in += 8 * 16;
+         out += 8 * 16;
+         blocks -= 8;
+      }
+   }
+#endif
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
    if(HasSSE2() && (blocks >= 4))
    {
@@ -159,6 +199,30 @@ void serpent_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, siz
    unsigned __int32 B0, B1, B2, B3;
    unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
    size_t i;
+#ifdef SERPENT_WIDE_SIMD
+#if CRYPTOPP_AVX512_AVAILABLE
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      while(blocks >= 16)
+      {
+         serpent_avx512_decrypt_blocks_16(in, out, round_key);
+         in += 16 * 16;
+         out += 16 * 16;
+         blocks -= 16;
+      }
+   }
+#endif
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      while(blocks >= 8)
+      {
+         serpent_avx2_decrypt_blocks_8(in, out, round_key);
+         in += 8 * 16;
+         out += 8 * 16;
+         blocks -= 8;
+      }
+   }
+#endif
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
    if(HasSSE2() && (blocks >= 4))
    {
@@ -234,6 +298,64 @@ void serpent_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, siz
 #undef transform
 #undef i_transform
 
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
+/*
+* Serpent XTS Encryption of blocks within a data unit (requires SSE2)
+*/
+void serpent_xts_encrypt_blocks(unsigned __int8* data, size_t blocks, unsigned __int8 *tweak, unsigned __int8 *ks)
+{
+   unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
+#ifdef SERPENT_WIDE_SIMD
+   size_t wideBlocks;
+#if CRYPTOPP_AVX512_AVAILABLE
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      wideBlocks = blocks & ~((size_t) 15);
+      serpent_avx512_xts_encrypt_blocks(data, wideBlocks, tweak, round_key);
+      data += wideBlocks * 16;
+      blocks -= wideBlocks;
+   }
+#endif
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      wideBlocks = blocks & ~((size_t) 7);
+      serpent_avx2_xts_encrypt_blocks(data, wideBlocks, tweak, round_key);
+      data += wideBlocks * 16;
+      blocks -= wideBlocks;
+   }
+#endif
+   serpent_simd_xts_encrypt_blocks(data, blocks, tweak, round_key);
+}
+
+/*
+* Serpent XTS Decryption of blocks within a data unit (requires SSE2)
+*/
+void serpent_xts_decrypt_blocks(unsigned __int8* data, size_t blocks, unsigned __int8 *tweak, unsigned __int8 *ks)
+{
+   unsigned __int32* round_key = ((unsigned __int32*) ks) + 8;
+#ifdef SERPENT_WIDE_SIMD
+   size_t wideBlocks;
+#if CRYPTOPP_AVX512_AVAILABLE
+   if(HasSAVX512() && (blocks >= 16))
+   {
+      wideBlocks = blocks & ~((size_t) 15);
+      serpent_avx512_xts_decrypt_blocks(data, wideBlocks, tweak, round_key);
+      data += wideBlocks * 16;
+      blocks -= wideBlocks;
+   }
+#endif
+   if(HasSAVX2() && (blocks >= 8))
+   {
+      wideBlocks = blocks & ~((size_t) 7);
+      serpent_avx2_xts_decrypt_blocks(data, wideBlocks, tweak, round_key);
+      data += wideBlocks * 16;
+      blocks -= wideBlocks;
+   }
+#endif
+   serpent_simd_xts_decrypt_blocks(data, blocks, tweak, round_key);
+}
+#endif
+
 /*
 * Serpent Key Schedule
 */
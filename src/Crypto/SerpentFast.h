@@ -18,6 +18,10 @@ extern "C"
 void serpent_set_key(const unsigned __int8 userKey[], unsigned __int8 *ks);
 void serpent_encrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks);
 void serpent_decrypt_blocks(const unsigned __int8* in, unsigned __int8* out, size_t blocks, unsigned __int8 *ks);
+/* XTS of blocks within a data unit: tweak holds the whitening value of the first block on entry and
+   the one of the block following the last one on return (SSE2 builds only) */
+void serpent_xts_encrypt_blocks(unsigned __int8* data, size_t blocks, unsigned __int8 *tweak, unsigned __int8 *ks);
+void serpent_xts_decrypt_blocks(unsigned __int8* data, size_t blocks, unsigned __int8 *tweak, unsigned __int8 *ks);
 
 #define serpent_encrypt(inBlock,outBlock,ks)	serpent_encrypt_blocks(inBlock,outBlock,1,ks)
 #define serpent_decrypt(inBlock,outBlock,ks)	serpent_decrypt_blocks(inBlock,outBlock,1,ks)
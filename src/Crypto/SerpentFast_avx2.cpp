@@ -0,0 +1,249 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Bitsliced Serpent processing 8 blocks in parallel with AVX2, based on the SSE2
+   implementation in SerpentFast_simd.cpp. Must be compiled with AVX2 enabled. */
+
+#include "SerpentFast.h"
+#if !defined(_UEFI)
+#include <memory.h>
+#include <stdlib.h>
+#endif
+#include "cpu.h"
+#include "misc.h"
+#include "Xts_simd.h"
+
+#if CRYPTOPP_AVX2_AVAILABLE && !defined(TC_WINDOWS_DRIVER) && !defined(_UEFI)
+
+#include <immintrin.h>
+
+/**
+* Eight 32-bit words of two blocks, with the operations needed by the Serpent
+* round macros (see SIMD_4x32 in SerpentFast_simd.cpp).
+*/
+class SIMD_8x32
+{
+public:
+
+    SIMD_8x32() // zero initialized
+        {
+        m_reg = _mm256_setzero_si256();
+        }
+
+    explicit SIMD_8x32(unsigned __int32 B)
+        {
+        m_reg = _mm256_set1_epi32(B);
+        }
+
+    static SIMD_8x32 load_le(const void* in)
+        {
+        return SIMD_8x32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm256_or_si256(_mm256_slli_epi32(m_reg, static_cast<int>(rot)),
+                                _mm256_srli_epi32(m_reg, static_cast<int>(32-rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_xor_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator^(const SIMD_8x32& other) const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_or_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator&(const SIMD_8x32& other)
+        {
+        return SIMD_8x32(_mm256_and_si256(m_reg, other.m_reg));
+        }
+
+    void operator&=(const SIMD_8x32& other)
+        {
+        m_reg = _mm256_and_si256(m_reg, other.m_reg);
+        }
+
+    SIMD_8x32 operator<<(size_t shift) const
+        {
+        return SIMD_8x32(_mm256_slli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_8x32 operator>>(size_t shift) const
+        {
+        return SIMD_8x32(_mm256_srli_epi32(m_reg, static_cast<int>(shift)));
+        }
+
+    SIMD_8x32 operator~() const
+        {
+        return SIMD_8x32(_mm256_xor_si256(m_reg, _mm256_set1_epi32(0xFFFFFFFF)));
+        }
+
+    // Transposes the 4x4 matrices of 32-bit words in each 128-bit lane
+    static void transpose(SIMD_8x32& B0, SIMD_8x32& B1,
+                          SIMD_8x32& B2, SIMD_8x32& B3)
+        {
+        __m256i T0 = _mm256_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m256i T1 = _mm256_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m256i T2 = _mm256_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m256i T3 = _mm256_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm256_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm256_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm256_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm256_unpackhi_epi64(T2, T3);
+        }
+
+    static SIMD_8x32 from_raw(__m256i in)
+        {
+        return SIMD_8x32(in);
+        }
+
+    __m256i raw() const
+        {
+        return m_reg;
+        }
+
+private:
+
+    explicit SIMD_8x32(__m256i in) { m_reg = in; }
+
+    __m256i m_reg;
+
+};
+
+typedef SIMD_8x32 SIMD_32;
+
+#include "SerpentFast_simd.h"
+
+/*
+* AVX2 Serpent Encryption of 8 blocks in parallel
+*/
+extern "C" void serpent_avx2_encrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key)
+{
+   SIMD_32 B0 = SIMD_32::load_le(in);
+   SIMD_32 B1 = SIMD_32::load_le(in + 32);
+   SIMD_32 B2 = SIMD_32::load_le(in + 64);
+   SIMD_32 B3 = SIMD_32::load_le(in + 96);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   encrypt_rounds(B0,B1,B2,B3);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   B0.store_le(out);
+   B1.store_le(out + 32);
+   B2.store_le(out + 64);
+   B3.store_le(out + 96);
+}
+
+/*
+* AVX2 Serpent Decryption of 8 blocks in parallel
+*/
+extern "C" void serpent_avx2_decrypt_blocks_8(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key)
+{
+   SIMD_32 B0 = SIMD_32::load_le(in);
+   SIMD_32 B1 = SIMD_32::load_le(in + 32);
+   SIMD_32 B2 = SIMD_32::load_le(in + 64);
+   SIMD_32 B3 = SIMD_32::load_le(in + 96);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   decrypt_rounds(B0,B1,B2,B3);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   B0.store_le(out);
+   B1.store_le(out + 32);
+   B2.store_le(out + 64);
+   B3.store_le(out + 96);
+}
+
+/*
+* AVX2 Serpent XTS of a multiple of 8 blocks within a data unit. On return, tweak
+* holds the whitening value of the block following the last one.
+*/
+VC_INLINE void serpent_avx2_xts_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key, bool decrypt)
+{
+   __m128i T = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tweak));
+
+   for(; blocks >= 8; blocks -= 8, data += 8 * 16)
+      {
+      __m128i T0 = T;
+      __m128i T1 = xts_mul_alpha_sse2(T0);
+      __m128i T2 = xts_mul_alpha_sse2(T1);
+      __m128i T3 = xts_mul_alpha_sse2(T2);
+      __m128i T4 = xts_mul_alpha_sse2(T3);
+      __m128i T5 = xts_mul_alpha_sse2(T4);
+      __m128i T6 = xts_mul_alpha_sse2(T5);
+      __m128i T7 = xts_mul_alpha_sse2(T6);
+      T = xts_mul_alpha_sse2(T7);
+
+      __m256i W0 = _mm256_inserti128_si256(_mm256_castsi128_si256(T0), T1, 1);
+      __m256i W1 = _mm256_inserti128_si256(_mm256_castsi128_si256(T2), T3, 1);
+      __m256i W2 = _mm256_inserti128_si256(_mm256_castsi128_si256(T4), T5, 1);
+      __m256i W3 = _mm256_inserti128_si256(_mm256_castsi128_si256(T6), T7, 1);
+
+      SIMD_32 B0 = SIMD_32::from_raw(_mm256_xor_si256(SIMD_32::load_le(data).raw(), W0));
+      SIMD_32 B1 = SIMD_32::from_raw(_mm256_xor_si256(SIMD_32::load_le(data + 32).raw(), W1));
+      SIMD_32 B2 = SIMD_32::from_raw(_mm256_xor_si256(SIMD_32::load_le(data + 64).raw(), W2));
+      SIMD_32 B3 = SIMD_32::from_raw(_mm256_xor_si256(SIMD_32::load_le(data + 96).raw(), W3));
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      if(decrypt)
+         decrypt_rounds(B0,B1,B2,B3)
+      else
+         encrypt_rounds(B0,B1,B2,B3)
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      SIMD_32::from_raw(_mm256_xor_si256(B0.raw(), W0)).store_le(data);
+      SIMD_32::from_raw(_mm256_xor_si256(B1.raw(), W1)).store_le(data + 32);
+      SIMD_32::from_raw(_mm256_xor_si256(B2.raw(), W2)).store_le(data + 64);
+      SIMD_32::from_raw(_mm256_xor_si256(B3.raw(), W3)).store_le(data + 96);
+      }
+
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(tweak), T);
+}
+
+extern "C" void serpent_avx2_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_avx2_xts_blocks(data, blocks, tweak, round_key, false);
+}
+
+extern "C" void serpent_avx2_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_avx2_xts_blocks(data, blocks, tweak, round_key, true);
+}
+
+#undef key_xor
+#undef transform
+#undef i_transform
+#undef encrypt_rounds
+#undef decrypt_rounds
+
+#endif
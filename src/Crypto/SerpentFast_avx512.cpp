@@ -0,0 +1,254 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Bitsliced Serpent processing 16 blocks in parallel with AVX-512, based on the SSE2
+   implementation in SerpentFast_simd.cpp. Must be compiled with AVX-512 (F, BW, VL) enabled. */
+
+// GCC reports the deliberately undefined vectors of the inlined AVX-512 intrinsics (e.g. _mm512_undefined_epi32)
+// as uninitialized. Intrinsics headers may already be included by the headers below.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include "SerpentFast.h"
+#if !defined(_UEFI)
+#include <memory.h>
+#include <stdlib.h>
+#endif
+#include "cpu.h"
+#include "misc.h"
+#include "Xts_simd.h"
+
+#if CRYPTOPP_AVX512_AVAILABLE && !defined(TC_WINDOWS_DRIVER) && !defined(_UEFI)
+
+#include <immintrin.h>
+
+/**
+* Sixteen 32-bit words of four blocks, with the operations needed by the Serpent
+* round macros (see SIMD_4x32 in SerpentFast_simd.cpp).
+*/
+class SIMD_16x32
+{
+public:
+
+    SIMD_16x32() // zero initialized
+        {
+        m_reg = _mm512_setzero_si512();
+        }
+
+    explicit SIMD_16x32(unsigned __int32 B)
+        {
+        m_reg = _mm512_set1_epi32(B);
+        }
+
+    static SIMD_16x32 load_le(const void* in)
+        {
+        return SIMD_16x32(_mm512_loadu_si512(in));
+        }
+
+    void store_le(unsigned __int8 out[]) const
+        {
+        _mm512_storeu_si512(out, m_reg);
+        }
+
+    void rotate_left(size_t rot)
+        {
+        m_reg = _mm512_rolv_epi32(m_reg, _mm512_set1_epi32(static_cast<int>(rot)));
+        }
+
+    void rotate_right(size_t rot)
+        {
+        rotate_left(32 - rot);
+        }
+
+    void operator^=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_xor_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator^(const SIMD_16x32& other) const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, other.m_reg));
+        }
+
+    void operator|=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_or_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator&(const SIMD_16x32& other)
+        {
+        return SIMD_16x32(_mm512_and_si512(m_reg, other.m_reg));
+        }
+
+    void operator&=(const SIMD_16x32& other)
+        {
+        m_reg = _mm512_and_si512(m_reg, other.m_reg);
+        }
+
+    SIMD_16x32 operator<<(size_t shift) const
+        {
+        return SIMD_16x32(_mm512_sll_epi32(m_reg, _mm_cvtsi32_si128(static_cast<int>(shift))));
+        }
+
+    SIMD_16x32 operator>>(size_t shift) const
+        {
+        return SIMD_16x32(_mm512_srl_epi32(m_reg, _mm_cvtsi32_si128(static_cast<int>(shift))));
+        }
+
+    SIMD_16x32 operator~() const
+        {
+        return SIMD_16x32(_mm512_xor_si512(m_reg, _mm512_set1_epi32(0xFFFFFFFF)));
+        }
+
+    // Transposes the 4x4 matrices of 32-bit words in each 128-bit lane
+    static void transpose(SIMD_16x32& B0, SIMD_16x32& B1,
+                          SIMD_16x32& B2, SIMD_16x32& B3)
+        {
+        __m512i T0 = _mm512_unpacklo_epi32(B0.m_reg, B1.m_reg);
+        __m512i T1 = _mm512_unpacklo_epi32(B2.m_reg, B3.m_reg);
+        __m512i T2 = _mm512_unpackhi_epi32(B0.m_reg, B1.m_reg);
+        __m512i T3 = _mm512_unpackhi_epi32(B2.m_reg, B3.m_reg);
+        B0.m_reg = _mm512_unpacklo_epi64(T0, T1);
+        B1.m_reg = _mm512_unpackhi_epi64(T0, T1);
+        B2.m_reg = _mm512_unpacklo_epi64(T2, T3);
+        B3.m_reg = _mm512_unpackhi_epi64(T2, T3);
+        }
+
+    static SIMD_16x32 from_raw(__m512i in)
+        {
+        return SIMD_16x32(in);
+        }
+
+    __m512i raw() const
+        {
+        return m_reg;
+        }
+
+private:
+
+    explicit SIMD_16x32(__m512i in) { m_reg = in; }
+
+    __m512i m_reg;
+
+};
+
+typedef SIMD_16x32 SIMD_32;
+
+#include "SerpentFast_simd.h"
+
+/*
+* AVX-512 Serpent Encryption of 16 blocks in parallel
+*/
+extern "C" void serpent_avx512_encrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key)
+{
+   SIMD_32 B0 = SIMD_32::load_le(in);
+   SIMD_32 B1 = SIMD_32::load_le(in + 64);
+   SIMD_32 B2 = SIMD_32::load_le(in + 128);
+   SIMD_32 B3 = SIMD_32::load_le(in + 192);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   encrypt_rounds(B0,B1,B2,B3);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   B0.store_le(out);
+   B1.store_le(out + 64);
+   B2.store_le(out + 128);
+   B3.store_le(out + 192);
+}
+
+/*
+* AVX-512 Serpent Decryption of 16 blocks in parallel
+*/
+extern "C" void serpent_avx512_decrypt_blocks_16(const unsigned __int8 in[], unsigned __int8 out[], unsigned __int32* round_key)
+{
+   SIMD_32 B0 = SIMD_32::load_le(in);
+   SIMD_32 B1 = SIMD_32::load_le(in + 64);
+   SIMD_32 B2 = SIMD_32::load_le(in + 128);
+   SIMD_32 B3 = SIMD_32::load_le(in + 192);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   decrypt_rounds(B0,B1,B2,B3);
+
+   SIMD_32::transpose(B0, B1, B2, B3);
+
+   B0.store_le(out);
+   B1.store_le(out + 64);
+   B2.store_le(out + 128);
+   B3.store_le(out + 192);
+}
+
+/*
+* AVX-512 Serpent XTS of a multiple of 16 blocks within a data unit. On return, tweak
+* holds the whitening value of the block following the last one.
+*/
+VC_INLINE void serpent_avx512_xts_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key, bool decrypt)
+{
+   __m128i T = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tweak));
+   __m512i W[4];
+   int i;
+
+   for(; blocks >= 16; blocks -= 16, data += 16 * 16)
+      {
+      for(i = 0; i < 4; ++i)
+         {
+         __m128i T0 = T;
+         __m128i T1 = xts_mul_alpha_sse2(T0);
+         __m128i T2 = xts_mul_alpha_sse2(T1);
+         __m128i T3 = xts_mul_alpha_sse2(T2);
+         T = xts_mul_alpha_sse2(T3);
+
+         W[i] = _mm512_inserti32x4(_mm512_inserti32x4(_mm512_inserti32x4(_mm512_castsi128_si512(T0), T1, 1), T2, 2), T3, 3);
+         }
+
+      SIMD_32 B0 = SIMD_32::from_raw(_mm512_xor_si512(SIMD_32::load_le(data).raw(), W[0]));
+      SIMD_32 B1 = SIMD_32::from_raw(_mm512_xor_si512(SIMD_32::load_le(data + 64).raw(), W[1]));
+      SIMD_32 B2 = SIMD_32::from_raw(_mm512_xor_si512(SIMD_32::load_le(data + 128).raw(), W[2]));
+      SIMD_32 B3 = SIMD_32::from_raw(_mm512_xor_si512(SIMD_32::load_le(data + 192).raw(), W[3]));
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      if(decrypt)
+         decrypt_rounds(B0,B1,B2,B3)
+      else
+         encrypt_rounds(B0,B1,B2,B3)
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      SIMD_32::from_raw(_mm512_xor_si512(B0.raw(), W[0])).store_le(data);
+      SIMD_32::from_raw(_mm512_xor_si512(B1.raw(), W[1])).store_le(data + 64);
+      SIMD_32::from_raw(_mm512_xor_si512(B2.raw(), W[2])).store_le(data + 128);
+      SIMD_32::from_raw(_mm512_xor_si512(B3.raw(), W[3])).store_le(data + 192);
+      }
+
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(tweak), T);
+   burn(W, sizeof(W));
+}
+
+extern "C" void serpent_avx512_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_avx512_xts_blocks(data, blocks, tweak, round_key, false);
+}
+
+extern "C" void serpent_avx512_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_avx512_xts_blocks(data, blocks, tweak, round_key, true);
+}
+
+#undef key_xor
+#undef transform
+#undef i_transform
+#undef encrypt_rounds
+#undef decrypt_rounds
+
+#endif
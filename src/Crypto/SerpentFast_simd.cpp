@@ -13,6 +13,7 @@
 #endif
 #include "cpu.h"
 #include "misc.h"
+#include "Xts_simd.h"
 
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
 
@@ -168,6 +169,16 @@ class SIMD_4x32
         B3.m_reg = _mm_unpackhi_epi64(T2, T3);
         }
 
+    static SIMD_4x32 from_raw(__m128i in)
+        {
+        return SIMD_4x32(in);
+        }
+
+    __m128i raw() const
+        {
+        return m_reg;
+        }
+
 private:
 
     explicit SIMD_4x32(__m128i in) { m_reg = in; }
@@ -178,45 +189,7 @@ class SIMD_4x32
 
 typedef SIMD_4x32 SIMD_32;
 
-#define key_xor(round, B0, B1, B2, B3)                             \
-   do {                                                            \
-      B0 ^= SIMD_32(round_key[4*round  ]);                       \
-      B1 ^= SIMD_32(round_key[4*round+1]);                       \
-      B2 ^= SIMD_32(round_key[4*round+2]);                       \
-      B3 ^= SIMD_32(round_key[4*round+3]);                       \
-   } while(0);
-
-/*
-* Serpent's linear transformations
-*/
-#define transform(B0, B1, B2, B3)                                  \
-   do {                                                            \
-      B0.rotate_left(13);                                          \
-      B2.rotate_left(3);                                           \
-      B1 ^= B0 ^ B2;                                               \
-      B3 ^= B2 ^ (B0 << 3);                                        \
-      B1.rotate_left(1);                                           \
-      B3.rotate_left(7);                                           \
-      B0 ^= B1 ^ B3;                                               \
-      B2 ^= B3 ^ (B1 << 7);                                        \
-      B0.rotate_left(5);                                           \
-      B2.rotate_left(22);                                          \
-   } while(0);
-
-#define i_transform(B0, B1, B2, B3)                                \
-   do {                                                            \
-      B2.rotate_right(22);                                         \
-      B0.rotate_right(5);                                          \
-      B2 ^= B3 ^ (B1 << 7);                                        \
-      B0 ^= B1 ^ B3;                                               \
-      B3.rotate_right(7);                                          \
-      B1.rotate_right(1);                                          \
-      B3 ^= B2 ^ (B0 << 3);                                        \
-      B1 ^= B0 ^ B2;                                               \
-      B2.rotate_right(3);                                          \
-      B0.rotate_right(13);                                         \
-   } while(0);
-
+#include "SerpentFast_simd.h"
 
 #if (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
 /*
@@ -231,41 +204,7 @@ extern "C" void serpent_simd_encrypt_blocks_4(const unsigned __int8 in[], unsign
 
    SIMD_32::transpose(B0, B1, B2, B3);
 
-   key_xor( 0,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 1,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 2,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 3,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 4,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 5,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 6,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 7,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-
-   key_xor( 8,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor( 9,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(10,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(11,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(12,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(13,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(14,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(15,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-
-   key_xor(16,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(17,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(18,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(19,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(20,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(21,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(22,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(23,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-
-   key_xor(24,B0,B1,B2,B3); SBoxE1(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(25,B0,B1,B2,B3); SBoxE2(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(26,B0,B1,B2,B3); SBoxE3(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(27,B0,B1,B2,B3); SBoxE4(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(28,B0,B1,B2,B3); SBoxE5(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(29,B0,B1,B2,B3); SBoxE6(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(30,B0,B1,B2,B3); SBoxE7(SIMD_32,B0,B1,B2,B3); transform(B0,B1,B2,B3);
-   key_xor(31,B0,B1,B2,B3); SBoxE8(SIMD_32,B0,B1,B2,B3); key_xor(32,B0,B1,B2,B3);
+   encrypt_rounds(B0,B1,B2,B3);
 
    SIMD_32::transpose(B0, B1, B2, B3);
 
@@ -287,41 +226,7 @@ extern "C" void serpent_simd_decrypt_blocks_4(const unsigned __int8 in[], unsign
 
    SIMD_32::transpose(B0, B1, B2, B3);
 
-   key_xor(32,B0,B1,B2,B3);  SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(31,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(30,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(29,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(28,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(27,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(26,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(25,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(24,B0,B1,B2,B3);
-
-   i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(23,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(22,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(21,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(20,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(19,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(18,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor(17,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor(16,B0,B1,B2,B3);
-
-   i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor(15,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor(14,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor(13,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor(12,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor(11,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor(10,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 9,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 8,B0,B1,B2,B3);
-
-   i_transform(B0,B1,B2,B3); SBoxD8(SIMD_32,B0,B1,B2,B3); key_xor( 7,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD7(SIMD_32,B0,B1,B2,B3); key_xor( 6,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD6(SIMD_32,B0,B1,B2,B3); key_xor( 5,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD5(SIMD_32,B0,B1,B2,B3); key_xor( 4,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD4(SIMD_32,B0,B1,B2,B3); key_xor( 3,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD3(SIMD_32,B0,B1,B2,B3); key_xor( 2,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD2(SIMD_32,B0,B1,B2,B3); key_xor( 1,B0,B1,B2,B3);
-   i_transform(B0,B1,B2,B3); SBoxD1(SIMD_32,B0,B1,B2,B3); key_xor( 0,B0,B1,B2,B3);
+   decrypt_rounds(B0,B1,B2,B3);
 
    SIMD_32::transpose(B0, B1, B2, B3);
 
@@ -330,9 +235,80 @@ extern "C" void serpent_simd_decrypt_blocks_4(const unsigned __int8 in[], unsign
    B2.store_le(out + 32);
    B3.store_le(out + 48);
 }
+
+/*
+* SIMD Serpent XTS of blocks within a data unit, 4 blocks in parallel. Whitening values
+* are derived from tweak and applied in registers; on return, tweak holds the whitening
+* value of the block following the last one.
+*/
+VC_INLINE void serpent_simd_xts_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key, bool decrypt)
+{
+   __m128i T = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tweak));
+   unsigned __int8 tail[4 * 16];
+
+   while(blocks > 0)
+      {
+      size_t n = blocks < 4 ? blocks : 4;
+      unsigned __int8* p = data;
+
+      // A partial group of blocks is processed in a zero-padded copy
+      if(n < 4)
+         {
+         memset(tail, 0, sizeof(tail));
+         memcpy(tail, data, n * 16);
+         p = tail;
+         }
+
+      __m128i T0 = T;
+      __m128i T1 = xts_mul_alpha_sse2(T0);
+      __m128i T2 = xts_mul_alpha_sse2(T1);
+      __m128i T3 = xts_mul_alpha_sse2(T2);
+
+      SIMD_32 B0 = SIMD_32::from_raw(_mm_xor_si128(SIMD_32::load_le(p).raw(), T0));
+      SIMD_32 B1 = SIMD_32::from_raw(_mm_xor_si128(SIMD_32::load_le(p + 16).raw(), T1));
+      SIMD_32 B2 = SIMD_32::from_raw(_mm_xor_si128(SIMD_32::load_le(p + 32).raw(), T2));
+      SIMD_32 B3 = SIMD_32::from_raw(_mm_xor_si128(SIMD_32::load_le(p + 48).raw(), T3));
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      if(decrypt)
+         decrypt_rounds(B0,B1,B2,B3)
+      else
+         encrypt_rounds(B0,B1,B2,B3)
+
+      SIMD_32::transpose(B0, B1, B2, B3);
+
+      SIMD_32::from_raw(_mm_xor_si128(B0.raw(), T0)).store_le(p);
+      SIMD_32::from_raw(_mm_xor_si128(B1.raw(), T1)).store_le(p + 16);
+      SIMD_32::from_raw(_mm_xor_si128(B2.raw(), T2)).store_le(p + 32);
+      SIMD_32::from_raw(_mm_xor_si128(B3.raw(), T3)).store_le(p + 48);
+
+      if(n < 4)
+         memcpy(data, tail, n * 16);
+
+      T = (n == 1) ? T1 : (n == 2) ? T2 : (n == 3) ? T3 : xts_mul_alpha_sse2(T3);
+      data += n * 16;
+      blocks -= n;
+      }
+
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(tweak), T);
+   burn(tail, sizeof(tail));
+}
+
+extern "C" void serpent_simd_xts_encrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_simd_xts_blocks(data, blocks, tweak, round_key, false);
+}
+
+extern "C" void serpent_simd_xts_decrypt_blocks(unsigned __int8 data[], size_t blocks, unsigned __int8 tweak[16], unsigned __int32* round_key)
+{
+   serpent_simd_xts_blocks(data, blocks, tweak, round_key, true);
+}
 #endif
 #undef key_xor
 #undef transform
 #undef i_transform
+#undef encrypt_rounds
+#undef decrypt_rounds
 
 #endif
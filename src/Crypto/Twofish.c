@@ -43,6 +43,7 @@
 #ifndef TC_MINIMIZE_CODE_SIZE
 
 #include "misc.h"
+#include "cpu.h"
 
 /* C implementation based on code written by kerukuro for cppcrypto library 
    (http://cppcrypto.sourceforge.net/) and released into public domain.
@@ -75,8 +76,26 @@ void twofish_dec_blk3(TwofishInstance *ks, uint8 *dst, const uint8 *src);
 }
 #endif
 
+#if CRYPTOPP_AVX2_AVAILABLE && !defined (TC_WINDOWS_DRIVER) && !defined (_UEFI)
+#define TWOFISH_AVX2
+void twofish_avx2_encrypt_blocks(TwofishInstance *ks, const uint8* in_blk, uint8* out_blk, size_t blockCount);
+void twofish_avx2_decrypt_blocks(TwofishInstance *ks, const uint8* in_blk, uint8* out_blk, size_t blockCount);
+#endif
+
 void twofish_encrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#ifdef TWOFISH_AVX2
+	if (HasSAVX2() && blockCount >= 16)
+	{
+		uint32 avx2BlockCount = blockCount & ~15U;
+
+		twofish_avx2_encrypt_blocks (instance, in_blk, out_blk, avx2BlockCount);
+		out_blk += avx2BlockCount * 16;
+		in_blk += avx2BlockCount * 16;
+		blockCount -= avx2BlockCount;
+	}
+#endif
+
 	while (blockCount >= 3)
 	{
 		twofish_enc_blk3 (instance, out_blk, in_blk);
@@ -98,6 +117,18 @@ void twofish_encrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint
 
 void twofish_decrypt_blocks(TwofishInstance *instance, const uint8* in_blk, uint8* out_blk, uint32 blockCount)
 {
+#ifdef TWOFISH_AVX2
+	if (HasSAVX2() && blockCount >= 16)
+	{
+		uint32 avx2BlockCount = blockCount & ~15U;
+
+		twofish_avx2_decrypt_blocks (instance, in_blk, out_blk, avx2BlockCount);
+		out_blk += avx2BlockCount * 16;
+		in_blk += avx2BlockCount * 16;
+		blockCount -= avx2BlockCount;
+	}
+#endif
+
 	while (blockCount >= 3)
 	{
 		twofish_dec_blk3 (instance, out_blk, in_blk);
@@ -0,0 +1,156 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Twofish processing 16 blocks in parallel with AVX2. Each 32-bit word of eight blocks is held
+   in one register and the key-dependent S-box/MDS tables (mk_tab) are read with gathers. Two
+   sets of eight blocks are interleaved to hide the gather latency. Must be compiled with AVX2 enabled. */
+
+#include "Twofish.h"
+#include "cpu.h"
+#include "misc.h"
+
+#if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM) && CRYPTOPP_AVX2_AVAILABLE && !defined (TC_WINDOWS_DRIVER) && !defined (_UEFI)
+
+#include <immintrin.h>
+
+#define TWOFISH_AVX2_XOR(a, b) _mm256_xor_si256 (a, b)
+#define TWOFISH_AVX2_ROTL(x, n) _mm256_or_si256 (_mm256_slli_epi32 (x, n), _mm256_srli_epi32 (x, 32 - (n)))
+#define TWOFISH_AVX2_ROTR(x, n) TWOFISH_AVX2_ROTL (x, 32 - (n))
+#define TWOFISH_AVX2_LOOKUP(t, i) _mm256_i32gather_epi32 ((const int *) ks->mk_tab[t], i, 4)
+
+/* g function of word x, bytes b0..b3 of x selecting tables 0..3 */
+#define TWOFISH_AVX2_G0(x) \
+	TWOFISH_AVX2_XOR (TWOFISH_AVX2_XOR (TWOFISH_AVX2_LOOKUP (0, _mm256_and_si256 (x, byteMask)), TWOFISH_AVX2_LOOKUP (1, _mm256_and_si256 (_mm256_srli_epi32 (x, 8), byteMask))), \
+		TWOFISH_AVX2_XOR (TWOFISH_AVX2_LOOKUP (2, _mm256_and_si256 (_mm256_srli_epi32 (x, 16), byteMask)), TWOFISH_AVX2_LOOKUP (3, _mm256_srli_epi32 (x, 24))))
+
+/* g function of x rotated left by 8 bits */
+#define TWOFISH_AVX2_G1(x) \
+	TWOFISH_AVX2_XOR (TWOFISH_AVX2_XOR (TWOFISH_AVX2_LOOKUP (0, _mm256_srli_epi32 (x, 24)), TWOFISH_AVX2_LOOKUP (1, _mm256_and_si256 (x, byteMask))), \
+		TWOFISH_AVX2_XOR (TWOFISH_AVX2_LOOKUP (2, _mm256_and_si256 (_mm256_srli_epi32 (x, 8), byteMask)), TWOFISH_AVX2_LOOKUP (3, _mm256_and_si256 (_mm256_srli_epi32 (x, 16), byteMask))))
+
+#define TWOFISH_AVX2_ROUNDT(s, x0, x1, r) \
+	f0[s] = TWOFISH_AVX2_G0 (x[s][x0]); \
+	f1[s] = TWOFISH_AVX2_G1 (x[s][x1]); \
+	f0[s] = _mm256_add_epi32 (f0[s], f1[s]); \
+	f1[s] = _mm256_add_epi32 (_mm256_add_epi32 (f1[s], f0[s]), _mm256_set1_epi32 ((int) ks->k[2 * (r) + 1])); \
+	f0[s] = _mm256_add_epi32 (f0[s], _mm256_set1_epi32 ((int) ks->k[2 * (r)]));
+
+/* Encryption round r, applied to both sets of blocks */
+#define TWOFISH_AVX2_ENC_ROUND(x0, x1, x2, x3, r) \
+	for (s = 0; s < 2; s++) \
+	{ \
+		TWOFISH_AVX2_ROUNDT (s, x0, x1, r) \
+		x[s][x2] = TWOFISH_AVX2_ROTR (TWOFISH_AVX2_XOR (x[s][x2], f0[s]), 1); \
+		x[s][x3] = TWOFISH_AVX2_XOR (TWOFISH_AVX2_ROTL (x[s][x3], 1), f1[s]); \
+	}
+
+#define TWOFISH_AVX2_DEC_ROUND(x0, x1, x2, x3, r) \
+	for (s = 0; s < 2; s++) \
+	{ \
+		TWOFISH_AVX2_ROUNDT (s, x0, x1, r) \
+		x[s][x2] = TWOFISH_AVX2_XOR (TWOFISH_AVX2_ROTL (x[s][x2], 1), f0[s]); \
+		x[s][x3] = TWOFISH_AVX2_ROTR (TWOFISH_AVX2_XOR (x[s][x3], f1[s]), 1); \
+	}
+
+/* Transposes the 4x4 matrices of 32-bit words in each 128-bit lane: eight blocks loaded two per
+   register become one register per word (block order within the registers is permuted, which
+   is undone by the same transposition) */
+#define TWOFISH_AVX2_TRANSPOSE(b0, b1, b2, b3) \
+	{ \
+		__m256i t0 = _mm256_unpacklo_epi32 (b0, b1); \
+		__m256i t1 = _mm256_unpacklo_epi32 (b2, b3); \
+		__m256i t2 = _mm256_unpackhi_epi32 (b0, b1); \
+		__m256i t3 = _mm256_unpackhi_epi32 (b2, b3); \
+		b0 = _mm256_unpacklo_epi64 (t0, t1); \
+		b1 = _mm256_unpackhi_epi64 (t0, t1); \
+		b2 = _mm256_unpacklo_epi64 (t2, t3); \
+		b3 = _mm256_unpackhi_epi64 (t2, t3); \
+	}
+
+/* Loads 16 blocks and applies the input whitening keys w[wk], ..., w[wk + 3] */
+VC_INLINE void TwofishAvx2Load (const TwofishInstance *ks, const uint8 *in, __m256i x[2][4], int wk)
+{
+	int s, i;
+
+	for (s = 0; s < 2; s++)
+	{
+		for (i = 0; i < 4; i++)
+			x[s][i] = _mm256_loadu_si256 ((const __m256i *) (in + 128 * s + 32 * i));
+
+		TWOFISH_AVX2_TRANSPOSE (x[s][0], x[s][1], x[s][2], x[s][3]);
+
+		for (i = 0; i < 4; i++)
+			x[s][i] = TWOFISH_AVX2_XOR (x[s][i], _mm256_set1_epi32 ((int) ks->w[wk + i]));
+	}
+}
+
+/* Applies the output whitening keys and stores 16 blocks, whose words are in x[.][2], x[.][3], x[.][0], x[.][1] */
+VC_INLINE void TwofishAvx2Store (const TwofishInstance *ks, uint8 *out, __m256i x[2][4], int wk)
+{
+	int s;
+
+	for (s = 0; s < 2; s++)
+	{
+		__m256i y0 = TWOFISH_AVX2_XOR (x[s][2], _mm256_set1_epi32 ((int) ks->w[wk]));
+		__m256i y1 = TWOFISH_AVX2_XOR (x[s][3], _mm256_set1_epi32 ((int) ks->w[wk + 1]));
+		__m256i y2 = TWOFISH_AVX2_XOR (x[s][0], _mm256_set1_epi32 ((int) ks->w[wk + 2]));
+		__m256i y3 = TWOFISH_AVX2_XOR (x[s][1], _mm256_set1_epi32 ((int) ks->w[wk + 3]));
+
+		TWOFISH_AVX2_TRANSPOSE (y0, y1, y2, y3);
+
+		_mm256_storeu_si256 ((__m256i *) (out + 128 * s), y0);
+		_mm256_storeu_si256 ((__m256i *) (out + 128 * s + 32), y1);
+		_mm256_storeu_si256 ((__m256i *) (out + 128 * s + 64), y2);
+		_mm256_storeu_si256 ((__m256i *) (out + 128 * s + 96), y3);
+	}
+}
+
+/* blockCount must be a multiple of 16 */
+void twofish_avx2_encrypt_blocks (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, size_t blockCount)
+{
+	const __m256i byteMask = _mm256_set1_epi32 (0xFF);
+	__m256i x[2][4], f0[2], f1[2];
+	int s, r;
+
+	for (; blockCount >= 16; blockCount -= 16, in_blk += 16 * 16, out_blk += 16 * 16)
+	{
+		TwofishAvx2Load (ks, in_blk, x, 0);
+
+		for (r = 0; r < 16; r += 2)
+		{
+			TWOFISH_AVX2_ENC_ROUND (0, 1, 2, 3, r);
+			TWOFISH_AVX2_ENC_ROUND (2, 3, 0, 1, r + 1);
+		}
+
+		TwofishAvx2Store (ks, out_blk, x, 4);
+	}
+}
+
+/* blockCount must be a multiple of 16 */
+void twofish_avx2_decrypt_blocks (TwofishInstance *ks, const uint8 *in_blk, uint8 *out_blk, size_t blockCount)
+{
+	const __m256i byteMask = _mm256_set1_epi32 (0xFF);
+	__m256i x[2][4], f0[2], f1[2];
+	int s, r;
+
+	for (; blockCount >= 16; blockCount -= 16, in_blk += 16 * 16, out_blk += 16 * 16)
+	{
+		TwofishAvx2Load (ks, in_blk, x, 4);
+
+		for (r = 15; r > 0; r -= 2)
+		{
+			TWOFISH_AVX2_DEC_ROUND (0, 1, 2, 3, r);
+			TWOFISH_AVX2_DEC_ROUND (2, 3, 0, 1, r - 1);
+		}
+
+		TwofishAvx2Store (ks, out_blk, x, 0);
+	}
+}
+
+#endif
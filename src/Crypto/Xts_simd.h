@@ -0,0 +1,30 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Crypto_Xts_Simd
+#define TC_HEADER_Crypto_Xts_Simd
+
+#include "Common/Tcdefs.h"
+#include "cpu.h"
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+
+/* Returns the XTS whitening value of the next block, i.e. the tweak multiplied by x in
+   GF(2^128) modulo x^128 + x^7 + x^2 + x + 1. The tweak is stored in little-endian order. */
+VC_INLINE __m128i xts_mul_alpha_sse2 (__m128i tweak)
+{
+	/* Replicate the top bit of each 64-bit half into the other half */
+	__m128i carry = _mm_srai_epi32 (_mm_shuffle_epi32 (tweak, _MM_SHUFFLE (1, 1, 3, 3)), 31);
+
+	return _mm_xor_si128 (_mm_slli_epi64 (tweak, 1), _mm_and_si128 (carry, _mm_set_epi32 (0, 1, 0, 0x87)));
+}
+
+#endif
+
+#endif // TC_HEADER_Crypto_Xts_Simd
@@ -208,6 +208,32 @@
 	#define CRYPTOPP_SHANI_AVAILABLE 0
 #endif
 
+// AVX2 and AVX-512 (F, BW, VL) intrinsics. Require GCC 4.7 (5 for AVX-512), Clang 3.1 (3.9) or Visual Studio 2012 (2017)
+#if !defined(CRYPTOPP_DISABLE_AVX2) && !defined(CRYPTOPP_DISABLE_ASM) && CRYPTOPP_BOOL_X64 && \
+	(defined(__AVX2__) || (CRYPTOPP_GCC_VERSION >= 40700) || (CRYPTOPP_LLVM_CLANG_VERSION >= 30100) || \
+	(CRYPTOPP_APPLE_CLANG_VERSION >= 40600) || (CRYPTOPP_MSC_VERSION >= 1700))
+	#define CRYPTOPP_AVX2_AVAILABLE 1
+#else
+	#define CRYPTOPP_AVX2_AVAILABLE 0
+#endif
+
+#if !defined(CRYPTOPP_DISABLE_AVX512) && CRYPTOPP_AVX2_AVAILABLE && \
+	(defined(__AVX512BW__) || (CRYPTOPP_GCC_VERSION >= 50000) || (CRYPTOPP_LLVM_CLANG_VERSION >= 30900) || \
+	(CRYPTOPP_APPLE_CLANG_VERSION >= 80000) || (CRYPTOPP_MSC_VERSION >= 1910))
+	#define CRYPTOPP_AVX512_AVAILABLE 1
+#else
+	#define CRYPTOPP_AVX512_AVAILABLE 0
+#endif
+
+// VAES and VPCLMULQDQ with AVX2 and AVX-512. Requires GCC 8, Clang 6 or Visual Studio 2019
+#if !defined(CRYPTOPP_DISABLE_VAES) && !defined(CRYPTOPP_DISABLE_AESNI) && !defined(CRYPTOPP_DISABLE_ASM) && CRYPTOPP_BOOL_X64 && \
+	(defined(__VAES__) || (CRYPTOPP_GCC_VERSION >= 80000) || (CRYPTOPP_LLVM_CLANG_VERSION >= 60000) || \
+	(CRYPTOPP_APPLE_CLANG_VERSION >= 100000) || (CRYPTOPP_MSC_VERSION >= 1920))
+	#define CRYPTOPP_VAES_AVAILABLE 1
+#else
+	#define CRYPTOPP_VAES_AVAILABLE 0
+#endif
+
 #if defined(__arm64__) || defined(__aarch64__) || defined(_M_ARM64)
 	#define CRYPTOPP_BOOL_ARMV8 1
 	#define CRYPTOPP_BOOL_ARM64 1
@@ -198,9 +198,10 @@ static uint64 xgetbv()
 
 volatile int g_x86DetectionDone = 0;
 volatile int g_hasISSE = 0, g_hasSSE2 = 0, g_hasSSSE3 = 0, g_hasMMX = 0, g_hasAESNI = 0, g_hasCLMUL = 0, g_isP4 = 0;
-volatile int g_hasAVX = 0, g_hasAVX2 = 0, g_hasBMI2 = 0, g_hasSSE42 = 0, g_hasSSE41 = 0, g_isIntel = 0, g_isAMD = 0;
+volatile int g_hasAVX = 0, g_hasAVX2 = 0, g_hasAVX512 = 0, g_hasBMI2 = 0, g_hasSSE42 = 0, g_hasSSE41 = 0, g_isIntel = 0, g_isAMD = 0;
 volatile int g_hasRDRAND = 0, g_hasRDSEED = 0;
 volatile int g_hasSHA256 = 0;
+volatile int g_hasVAES = 0;
 volatile uint32 g_cacheLineSize = CRYPTOPP_L1_CACHE_LINE_SIZE;
 
 VC_INLINE int IsIntel(const uint32 output[4])
@@ -327,8 +328,11 @@ void DetectX86Features()
 {
 	uint32 cpuid[4] = {0}, cpuid1[4] = {0}, cpuid2[4] = {0};
 	uint32 max_basic_leaf;
+	uint64 xcrFeatureMask = 0;
 	int leaf7_avx2 = 0;
 	int leaf7_bmi2 = 0;
+	int leaf7_avx512 = 0;
+	int leaf7_vaes = 0;
 	if (!CpuId(0, cpuid))
 		return;
 	max_basic_leaf = cpuid[0];
@@ -343,7 +347,7 @@ void DetectX86Features()
 		g_hasSSE2 = (cpuid1[2] & (1 << 27)) || TrySSE2();
 	if (g_hasSSE2 && (cpuid1[2] & (1 << 28)) && (cpuid1[2] & (1 << 27)) && (cpuid1[2] & (1 << 26))) /* CPU has AVX and OS supports XSAVE/XRSTORE */
 	{
-      uint64 xcrFeatureMask = xgetbv();
+      xcrFeatureMask = xgetbv();
       g_hasAVX = (xcrFeatureMask & 0x6) == 0x6;
 	}
 	g_hasAVX2 = 0;
@@ -399,6 +403,10 @@ void DetectX86Features()
 				g_hasRDSEED = (cpuid2[1] & (1 << 18)) != 0;
 				leaf7_avx2 = (cpuid2[1] & (1 <<  5)) != 0;
 				leaf7_bmi2 = (cpuid2[1] & (1 <<  8)) != 0;
+				/* AVX512F, AVX512BW and AVX512VL */
+				leaf7_avx512 = (cpuid2[1] & ((1 << 16) | (1 << 30) | (1U << 31))) == ((1 << 16) | (1 << 30) | (1U << 31));
+				/* VAES and VPCLMULQDQ */
+				leaf7_vaes = (cpuid2[2] & ((1 << 9) | (1 << 10))) == ((1 << 9) | (1 << 10));
 			}
 		}
 	}
@@ -416,11 +424,18 @@ void DetectX86Features()
 				g_hasRDSEED = (cpuid2[1] & (1 << 18)) != 0;
 				leaf7_avx2 = (cpuid2[1] & (1 <<  5)) != 0;
 				leaf7_bmi2 = (cpuid2[1] & (1 <<  8)) != 0;
+				/* AVX512F, AVX512BW and AVX512VL */
+				leaf7_avx512 = (cpuid2[1] & ((1 << 16) | (1 << 30) | (1U << 31))) == ((1 << 16) | (1 << 30) | (1U << 31));
+				/* VAES and VPCLMULQDQ */
+				leaf7_vaes = (cpuid2[2] & ((1 << 9) | (1 << 10))) == ((1 << 9) | (1 << 10));
 			}
 		}
 	}
 	g_hasAVX2 = g_hasAVX && leaf7_avx2;
 	g_hasBMI2 = leaf7_bmi2;
+	/* OS must save opmask and ZMM registers (XCR0 bits 5 to 7) */
+	g_hasAVX512 = g_hasAVX2 && leaf7_avx512 && ((xcrFeatureMask & 0xE6) == 0xE6);
+	g_hasVAES = g_hasAVX2 && g_hasAESNI && g_hasCLMUL && leaf7_vaes;
 #if defined(_MSC_VER) && !defined(_UEFI)
 	/* Add check fur buggy RDRAND (AMD Ryzen case) even if we always use RDSEED instead of RDRAND when RDSEED available */
 	if (g_hasRDRAND)
@@ -464,6 +479,7 @@ void DisableCPUExtendedFeatures ()
 	g_hasMMX = 0;
 	g_hasAVX = 0;
 	g_hasAVX2 = 0;
+	g_hasAVX512 = 0;
 	g_hasBMI2 = 0;
 	g_hasSSE42 = 0;
 	g_hasSSE41 = 0;
@@ -471,6 +487,7 @@ void DisableCPUExtendedFeatures ()
 	g_hasAESNI = 0;
 	g_hasCLMUL = 0;
 	g_hasSHA256 = 0;
+	g_hasVAES = 0;
 }
 
 #endif
@@ -247,6 +247,7 @@ extern volatile int g_hasISSE;
 extern volatile int g_hasMMX;
 extern volatile int g_hasAVX;
 extern volatile int g_hasAVX2;
+extern volatile int g_hasAVX512;
 extern volatile int g_hasBMI2;
 extern volatile int g_hasSSE42;
 extern volatile int g_hasSSE41;
@@ -257,6 +258,7 @@ extern volatile int g_isP4;
 extern volatile int g_hasRDRAND;
 extern volatile int g_hasRDSEED;
 extern volatile int g_hasSHA256;
+extern volatile int g_hasVAES;
 extern volatile int g_isIntel;
 extern volatile int g_isAMD;
 extern volatile uint32 g_cacheLineSize;
@@ -278,6 +280,7 @@ void DisableCPUExtendedFeatures ();
 #define HasSSE41() g_hasSSE41
 #define HasSAVX() g_hasAVX
 #define HasSAVX2() g_hasAVX2
+#define HasSAVX512() g_hasAVX512
 #define HasSBMI2() g_hasBMI2
 #define HasSSSE3() g_hasSSSE3
 #define HasAESNI() g_hasAESNI
@@ -286,6 +289,7 @@ void DisableCPUExtendedFeatures ();
 #define HasRDRAND() g_hasRDRAND
 #define HasRDSEED() g_hasRDSEED
 #define HasSHA256() g_hasSHA256
+#define HasVAES() g_hasVAES
 #define IsCpuIntel() g_isIntel
 #define IsCpuAMD() g_isAMD
 #define GetCacheLineSize() g_cacheLineSize
@@ -324,6 +328,7 @@ void DetectArmFeatures();
 #define HasSSE41() 0
 #define HasSAVX() 0
 #define HasSAVX2() 0
+#define HasSAVX512() 0
 #define HasSBMI2() 0
 #define HasSSSE3() 0
 #define HasAESNI() 0
@@ -331,6 +336,7 @@ void DetectArmFeatures();
 #define IsP4() 0
 #define HasRDRAND() 0
 #define HasRDSEED() 0
+#define HasVAES() 0
 #define IsCpuIntel() 0
 #define IsCpuAMD() 0
 #define GetCacheLineSize()	CRYPTOPP_L1_CACHE_LINE_SIZE
@@ -0,0 +1,51 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Multi-buffer PBKDF2-HMAC cores running independent PBKDF2 chains of the same password in the
+   lanes of SIMD vectors (one chain per lane). */
+
+#ifndef TC_HEADER_Crypto_Hmac_Mb
+#define TC_HEADER_Crypto_Hmac_Mb
+
+#include "Common/Tcdefs.h"
+#include "config.h"
+
+#if CRYPTOPP_AVX2_AVAILABLE && !defined(TC_WINDOWS_DRIVER) && !defined(_UEFI)
+#define HMAC_MB_AVAILABLE
+
+/* largest number of chains accepted by any implementation */
+#define HMAC_MB_MAX_CHAINS 16
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Run 'iterations' further PBKDF2 iterations of 'chains' chains sharing the HMAC key pwd, which must not be
+   longer than the block size of the hash. For chain i, u + i * digest size holds the last HMAC output and
+   x + i * digest size the XOR of all outputs of the chain; both are updated.
+   AVX2 versions accept up to 8 chains (4 with SHA-512), AVX-512 versions up to 16 chains (8 with SHA-512). */
+void pbkdf2_sha256_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+void pbkdf2_sha512_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+void pbkdf2_blake2s_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+
+#if CRYPTOPP_AVX512_AVAILABLE
+#define HMAC_MB_AVX512_AVAILABLE
+void pbkdf2_sha256_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+void pbkdf2_sha512_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+void pbkdf2_blake2s_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif // TC_HEADER_Crypto_Hmac_Mb
@@ -0,0 +1,60 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Multi-buffer PBKDF2 running 8 HMAC-SHA-256 or HMAC-BLAKE2s chains (4 HMAC-SHA-512 chains)
+   in parallel using AVX2. Must be compiled with AVX2 enabled. */
+
+#include "hmac_mb.h"
+
+#ifdef HMAC_MB_AVAILABLE
+
+#include <immintrin.h>
+
+#define HMAC_MB_VEC __m256i
+#define HMAC_MB_LANES32 8
+#define HMAC_MB_LANES64 4
+
+#define HMAC_MB_LOAD(p) _mm256_load_si256 ((const __m256i *) (p))
+#define HMAC_MB_STORE(p, x) _mm256_store_si256 ((__m256i *) (p), x)
+#define HMAC_MB_SET1_32(w) _mm256_set1_epi32 ((int) (w))
+#define HMAC_MB_SET1_64(w) _mm256_set1_epi64x ((long long) (w))
+#define HMAC_MB_ZERO() _mm256_setzero_si256 ()
+#define HMAC_MB_XOR(a, b) _mm256_xor_si256 (a, b)
+#define HMAC_MB_XOR3(a, b, c) _mm256_xor_si256 (_mm256_xor_si256 (a, b), c)
+#define HMAC_MB_CH(x, y, z) _mm256_xor_si256 (_mm256_and_si256 (x, y), _mm256_andnot_si256 (x, z))
+#define HMAC_MB_MAJ(x, y, z) _mm256_or_si256 (_mm256_and_si256 (x, y), _mm256_and_si256 (z, _mm256_or_si256 (x, y)))
+#define HMAC_MB_ADD32(a, b) _mm256_add_epi32 (a, b)
+#define HMAC_MB_ADD64(a, b) _mm256_add_epi64 (a, b)
+#define HMAC_MB_SHR32(x, n) _mm256_srli_epi32 (x, n)
+#define HMAC_MB_SHR64(x, n) _mm256_srli_epi64 (x, n)
+#define HMAC_MB_ROR32(x, n) _mm256_or_si256 (_mm256_srli_epi32 (x, n), _mm256_slli_epi32 (x, 32 - (n)))
+#define HMAC_MB_ROR64(x, n) _mm256_or_si256 (_mm256_srli_epi64 (x, n), _mm256_slli_epi64 (x, 64 - (n)))
+#define HMAC_MB_ROR32_16(x) _mm256_shuffle_epi8 (x, _mm256_set_epi8 (13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2, \
+	13, 12, 15, 14, 9, 8, 11, 10, 5, 4, 7, 6, 1, 0, 3, 2))
+#define HMAC_MB_ROR32_8(x) _mm256_shuffle_epi8 (x, _mm256_set_epi8 (12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1, \
+	12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1))
+
+#include "hmac_mb_simd.h"
+
+void pbkdf2_sha256_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbSha256Pbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+void pbkdf2_sha512_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbSha512Pbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+void pbkdf2_blake2s_mb_avx2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbBlake2sPbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Multi-buffer PBKDF2 running 16 HMAC-SHA-256 or HMAC-BLAKE2s chains (8 HMAC-SHA-512 chains)
+   in parallel using AVX-512. Must be compiled with AVX-512 (F) enabled. */
+
+#include "hmac_mb.h"
+
+#ifdef HMAC_MB_AVX512_AVAILABLE
+
+#include <immintrin.h>
+
+#define HMAC_MB_VEC __m512i
+#define HMAC_MB_LANES32 16
+#define HMAC_MB_LANES64 8
+
+#define HMAC_MB_LOAD(p) _mm512_load_si512 ((const void *) (p))
+#define HMAC_MB_STORE(p, x) _mm512_store_si512 ((void *) (p), x)
+#define HMAC_MB_SET1_32(w) _mm512_set1_epi32 ((int) (w))
+#define HMAC_MB_SET1_64(w) _mm512_set1_epi64 ((long long) (w))
+#define HMAC_MB_ZERO() _mm512_setzero_si512 ()
+#define HMAC_MB_XOR(a, b) _mm512_xor_si512 (a, b)
+#define HMAC_MB_XOR3(a, b, c) _mm512_ternarylogic_epi32 (a, b, c, 0x96)
+#define HMAC_MB_CH(x, y, z) _mm512_ternarylogic_epi32 (x, y, z, 0xca)
+#define HMAC_MB_MAJ(x, y, z) _mm512_ternarylogic_epi32 (x, y, z, 0xe8)
+#define HMAC_MB_ADD32(a, b) _mm512_add_epi32 (a, b)
+#define HMAC_MB_ADD64(a, b) _mm512_add_epi64 (a, b)
+#define HMAC_MB_SHR32(x, n) _mm512_srli_epi32 (x, n)
+#define HMAC_MB_SHR64(x, n) _mm512_srli_epi64 (x, n)
+#define HMAC_MB_ROR32(x, n) _mm512_ror_epi32 (x, n)
+#define HMAC_MB_ROR64(x, n) _mm512_ror_epi64 (x, n)
+#define HMAC_MB_ROR32_16(x) _mm512_ror_epi32 (x, 16)
+#define HMAC_MB_ROR32_8(x) _mm512_ror_epi32 (x, 8)
+
+#include "hmac_mb_simd.h"
+
+void pbkdf2_sha256_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbSha256Pbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+void pbkdf2_sha512_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbSha512Pbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+void pbkdf2_blake2s_mb_avx512 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HmacMbBlake2sPbkdf2 (pwd, pwd_len, u, x, chains, iterations);
+}
+
+#endif
@@ -0,0 +1,525 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Multi-buffer PBKDF2 with HMAC-SHA-256, HMAC-SHA-512 and HMAC-BLAKE2s, shared by the AVX2
+   (hmac_mb_avx2.c) and AVX-512 (hmac_mb_avx512.c) implementations. Each vector lane runs one
+   PBKDF2 chain. An HMAC output consists of the state words of the hash, which are the message
+   words of the next iteration, so chains are only transposed into lanes on entry and exit.
+
+   The including file defines HMAC_MB_VEC (the vector type), HMAC_MB_LANES32 and HMAC_MB_LANES64
+   (lanes of 32-bit and 64-bit words) and the HMAC_MB_* operations below. */
+
+#ifndef TC_HEADER_Crypto_Hmac_Mb_Simd
+#define TC_HEADER_Crypto_Hmac_Mb_Simd
+
+#include "Common/Tcdefs.h"
+#include "Crypto/misc.h"
+
+static const uint32 HmacMbSha256K[64] =
+{
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint64 HmacMbSha512K[80] =
+{
+	LL(0x428a2f98d728ae22), LL(0x7137449123ef65cd), LL(0xb5c0fbcfec4d3b2f), LL(0xe9b5dba58189dbbc),
+	LL(0x3956c25bf348b538), LL(0x59f111f1b605d019), LL(0x923f82a4af194f9b), LL(0xab1c5ed5da6d8118),
+	LL(0xd807aa98a3030242), LL(0x12835b0145706fbe), LL(0x243185be4ee4b28c), LL(0x550c7dc3d5ffb4e2),
+	LL(0x72be5d74f27b896f), LL(0x80deb1fe3b1696b1), LL(0x9bdc06a725c71235), LL(0xc19bf174cf692694),
+	LL(0xe49b69c19ef14ad2), LL(0xefbe4786384f25e3), LL(0x0fc19dc68b8cd5b5), LL(0x240ca1cc77ac9c65),
+	LL(0x2de92c6f592b0275), LL(0x4a7484aa6ea6e483), LL(0x5cb0a9dcbd41fbd4), LL(0x76f988da831153b5),
+	LL(0x983e5152ee66dfab), LL(0xa831c66d2db43210), LL(0xb00327c898fb213f), LL(0xbf597fc7beef0ee4),
+	LL(0xc6e00bf33da88fc2), LL(0xd5a79147930aa725), LL(0x06ca6351e003826f), LL(0x142929670a0e6e70),
+	LL(0x27b70a8546d22ffc), LL(0x2e1b21385c26c926), LL(0x4d2c6dfc5ac42aed), LL(0x53380d139d95b3df),
+	LL(0x650a73548baf63de), LL(0x766a0abb3c77b2a8), LL(0x81c2c92e47edaee6), LL(0x92722c851482353b),
+	LL(0xa2bfe8a14cf10364), LL(0xa81a664bbc423001), LL(0xc24b8b70d0f89791), LL(0xc76c51a30654be30),
+	LL(0xd192e819d6ef5218), LL(0xd69906245565a910), LL(0xf40e35855771202a), LL(0x106aa07032bbd1b8),
+	LL(0x19a4c116b8d2d0c8), LL(0x1e376c085141ab53), LL(0x2748774cdf8eeb99), LL(0x34b0bcb5e19b48a8),
+	LL(0x391c0cb3c5c95a63), LL(0x4ed8aa4ae3418acb), LL(0x5b9cca4f7763e373), LL(0x682e6ff3d6b2b8a3),
+	LL(0x748f82ee5defb2fc), LL(0x78a5636f43172f60), LL(0x84c87814a1f0ab72), LL(0x8cc702081a6439ec),
+	LL(0x90befffa23631e28), LL(0xa4506cebde82bde9), LL(0xbef9a3f7b2c67915), LL(0xc67178f2e372532b),
+	LL(0xca273eceea26619c), LL(0xd186b8c721c0c207), LL(0xeada7dd6cde0eb1e), LL(0xf57d4f7fee6ed178),
+	LL(0x06f067aa72176fba), LL(0x0a637dc5a2c898a6), LL(0x113f9804bef90dae), LL(0x1b710b35131c471b),
+	LL(0x28db77f523047d84), LL(0x32caab7b40c72493), LL(0x3c9ebe0a15c9bebc), LL(0x431d67c49c100d4c),
+	LL(0x4cc5d4becb3e42b6), LL(0x597f299cfc657e2a), LL(0x5fcb6fab3ad6faec), LL(0x6c44198c4a475817)
+};
+
+/* Initial hash values of SHA-256 and BLAKE2s */
+static const uint32 HmacMbSha256IV[8] =
+{
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint64 HmacMbSha512IV[8] =
+{
+	LL(0x6a09e667f3bcc908), LL(0xbb67ae8584caa73b), LL(0x3c6ef372fe94f82b), LL(0xa54ff53a5f1d36f1),
+	LL(0x510e527fade682d1), LL(0x9b05688c2b3e6c1f), LL(0x1f83d9abfb41bd6b), LL(0x5be0cd19137e2179)
+};
+
+static const uint8 HmacMbBlake2sSigma[10][16] =
+{
+	{  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15 },
+	{ 14, 10,  4,  8,  9, 15, 13,  6,  1, 12,  0,  2, 11,  7,  5,  3 },
+	{ 11,  8, 12,  0,  5,  2, 15, 13, 10, 14,  3,  6,  7,  1,  9,  4 },
+	{  7,  9,  3,  1, 13, 12, 11, 14,  2,  6,  5, 10,  4,  0, 15,  8 },
+	{  9,  0,  5,  7,  2,  4, 10, 15, 14,  1, 11, 12,  6,  8,  3, 13 },
+	{  2, 12,  6, 10,  0, 11,  8,  3,  4, 13,  7,  5, 15, 14,  1,  9 },
+	{ 12,  5,  1, 15, 14, 13,  4, 10,  0,  7,  6,  3,  9,  2,  8, 11 },
+	{ 13, 11,  7, 14, 12,  1,  3,  9,  5,  0, 15,  4,  8,  6,  2, 10 },
+	{  6, 15, 14,  9, 11,  3,  0,  8, 12,  2, 13,  7,  1,  4, 10,  5 },
+	{ 10,  2,  8,  4,  7,  6,  1,  5, 15, 11,  9, 14,  3, 12, 13,  0 }
+};
+
+/* BLAKE2s parameter block word 0 of HMAC-BLAKE2s-256: 32-byte digest, no key, fanout 1, depth 1 */
+#define HMAC_MB_BLAKE2S_PARAM0 0x01010020
+
+/* Loads word w of each chain (chains beyond 'chains' are zero) */
+static void HmacMbLoad32 (HMAC_MB_VEC *v, const unsigned char *data, int chains, int wordCount, int bigEndian)
+{
+	CRYPTOPP_ALIGN_DATA(64) uint32 lanes[HMAC_MB_LANES32];
+	int w, i;
+
+	for (w = 0; w < wordCount; w++)
+	{
+		for (i = 0; i < HMAC_MB_LANES32; i++)
+		{
+			uint32 word = 0;
+			if (i < chains)
+			{
+				memcpy (&word, data + (i * wordCount + w) * 4, 4);
+				if (bigEndian)
+					word = bswap_32 (word);
+			}
+			lanes[i] = word;
+		}
+
+		v[w] = HMAC_MB_LOAD (lanes);
+	}
+
+	burn (lanes, sizeof (lanes));
+}
+
+static void HmacMbStore32 (unsigned char *data, const HMAC_MB_VEC *v, int chains, int wordCount, int bigEndian)
+{
+	CRYPTOPP_ALIGN_DATA(64) uint32 lanes[HMAC_MB_LANES32];
+	int w, i;
+
+	for (w = 0; w < wordCount; w++)
+	{
+		HMAC_MB_STORE (lanes, v[w]);
+
+		for (i = 0; i < chains; i++)
+		{
+			uint32 word = bigEndian ? bswap_32 (lanes[i]) : lanes[i];
+			memcpy (data + (i * wordCount + w) * 4, &word, 4);
+		}
+	}
+
+	burn (lanes, sizeof (lanes));
+}
+
+static void HmacMbLoad64 (HMAC_MB_VEC *v, const unsigned char *data, int chains)
+{
+	CRYPTOPP_ALIGN_DATA(64) uint64 lanes[HMAC_MB_LANES64];
+	int w, i;
+
+	for (w = 0; w < 8; w++)
+	{
+		for (i = 0; i < HMAC_MB_LANES64; i++)
+		{
+			uint64 word = 0;
+			if (i < chains)
+			{
+				memcpy (&word, data + (i * 8 + w) * 8, 8);
+				word = bswap_64 (word);
+			}
+			lanes[i] = word;
+		}
+
+		v[w] = HMAC_MB_LOAD (lanes);
+	}
+
+	burn (lanes, sizeof (lanes));
+}
+
+static void HmacMbStore64 (unsigned char *data, const HMAC_MB_VEC *v, int chains)
+{
+	CRYPTOPP_ALIGN_DATA(64) uint64 lanes[HMAC_MB_LANES64];
+	int w, i;
+
+	for (w = 0; w < 8; w++)
+	{
+		HMAC_MB_STORE (lanes, v[w]);
+
+		for (i = 0; i < chains; i++)
+		{
+			uint64 word = bswap_64 (lanes[i]);
+			memcpy (data + (i * 8 + w) * 8, &word, 8);
+		}
+	}
+
+	burn (lanes, sizeof (lanes));
+}
+
+/* HMAC key block (key XOR ipad or opad, zero-padded) as broadcast message words */
+static void HmacMbKeyBlock (HMAC_MB_VEC *m, const unsigned char *pwd, int pwd_len, unsigned char pad, int blockSize, int wordSize, int bigEndian)
+{
+	unsigned char block[128];
+	int i;
+
+	for (i = 0; i < blockSize; i++)
+		block[i] = (unsigned char) ((i < pwd_len ? pwd[i] : 0) ^ pad);
+
+	for (i = 0; i < blockSize / wordSize; i++)
+	{
+		if (wordSize == 4)
+		{
+			uint32 word;
+			memcpy (&word, block + i * 4, 4);
+			m[i] = HMAC_MB_SET1_32 (bigEndian ? bswap_32 (word) : word);
+		}
+		else
+		{
+			uint64 word;
+			memcpy (&word, block + i * 8, 8);
+			m[i] = HMAC_MB_SET1_64 (bswap_64 (word));
+		}
+	}
+
+	burn (block, sizeof (block));
+}
+
+/* SHA-256 */
+
+#define HMAC_MB_SHA256_SUM0(x) HMAC_MB_XOR3 (HMAC_MB_ROR32 (x, 2), HMAC_MB_ROR32 (x, 13), HMAC_MB_ROR32 (x, 22))
+#define HMAC_MB_SHA256_SUM1(x) HMAC_MB_XOR3 (HMAC_MB_ROR32 (x, 6), HMAC_MB_ROR32 (x, 11), HMAC_MB_ROR32 (x, 25))
+#define HMAC_MB_SHA256_SIGMA0(x) HMAC_MB_XOR3 (HMAC_MB_ROR32 (x, 7), HMAC_MB_ROR32 (x, 18), HMAC_MB_SHR32 (x, 3))
+#define HMAC_MB_SHA256_SIGMA1(x) HMAC_MB_XOR3 (HMAC_MB_ROR32 (x, 17), HMAC_MB_ROR32 (x, 19), HMAC_MB_SHR32 (x, 10))
+
+#define HMAC_MB_SHA256_ROUND(a, b, c, d, e, f, g, h, j) \
+	{ \
+		if (i + j >= 16) \
+			w[j] = HMAC_MB_ADD32 (HMAC_MB_ADD32 (w[j], HMAC_MB_SHA256_SIGMA1 (w[(j + 14) & 15])), \
+				HMAC_MB_ADD32 (w[(j + 9) & 15], HMAC_MB_SHA256_SIGMA0 (w[(j + 1) & 15]))); \
+		t = HMAC_MB_ADD32 (HMAC_MB_ADD32 (h, HMAC_MB_SHA256_SUM1 (e)), \
+			HMAC_MB_ADD32 (HMAC_MB_CH (e, f, g), HMAC_MB_ADD32 (HMAC_MB_SET1_32 (HmacMbSha256K[i + j]), w[j]))); \
+		d = HMAC_MB_ADD32 (d, t); \
+		h = HMAC_MB_ADD32 (t, HMAC_MB_ADD32 (HMAC_MB_SHA256_SUM0 (a), HMAC_MB_MAJ (a, b, c))); \
+	}
+
+/* Compresses message block w (modified) into state s */
+static void HmacMbSha256Compress (HMAC_MB_VEC s[8], HMAC_MB_VEC w[16])
+{
+	HMAC_MB_VEC a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7], t;
+	int i;
+
+	for (i = 0; i < 64; i += 16)
+	{
+		HMAC_MB_SHA256_ROUND (a, b, c, d, e, f, g, h, 0);
+		HMAC_MB_SHA256_ROUND (h, a, b, c, d, e, f, g, 1);
+		HMAC_MB_SHA256_ROUND (g, h, a, b, c, d, e, f, 2);
+		HMAC_MB_SHA256_ROUND (f, g, h, a, b, c, d, e, 3);
+		HMAC_MB_SHA256_ROUND (e, f, g, h, a, b, c, d, 4);
+		HMAC_MB_SHA256_ROUND (d, e, f, g, h, a, b, c, 5);
+		HMAC_MB_SHA256_ROUND (c, d, e, f, g, h, a, b, 6);
+		HMAC_MB_SHA256_ROUND (b, c, d, e, f, g, h, a, 7);
+		HMAC_MB_SHA256_ROUND (a, b, c, d, e, f, g, h, 8);
+		HMAC_MB_SHA256_ROUND (h, a, b, c, d, e, f, g, 9);
+		HMAC_MB_SHA256_ROUND (g, h, a, b, c, d, e, f, 10);
+		HMAC_MB_SHA256_ROUND (f, g, h, a, b, c, d, e, 11);
+		HMAC_MB_SHA256_ROUND (e, f, g, h, a, b, c, d, 12);
+		HMAC_MB_SHA256_ROUND (d, e, f, g, h, a, b, c, 13);
+		HMAC_MB_SHA256_ROUND (c, d, e, f, g, h, a, b, 14);
+		HMAC_MB_SHA256_ROUND (b, c, d, e, f, g, h, a, 15);
+	}
+
+	s[0] = HMAC_MB_ADD32 (s[0], a);
+	s[1] = HMAC_MB_ADD32 (s[1], b);
+	s[2] = HMAC_MB_ADD32 (s[2], c);
+	s[3] = HMAC_MB_ADD32 (s[3], d);
+	s[4] = HMAC_MB_ADD32 (s[4], e);
+	s[5] = HMAC_MB_ADD32 (s[5], f);
+	s[6] = HMAC_MB_ADD32 (s[6], g);
+	s[7] = HMAC_MB_ADD32 (s[7], h);
+}
+
+/* Computes the hash of a digest-sized message from the state after the HMAC key block */
+static void HmacMbSha256Digest (HMAC_MB_VEC s[8], const HMAC_MB_VEC state[8], const HMAC_MB_VEC message[8])
+{
+	HMAC_MB_VEC w[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+	{
+		w[i] = message[i];
+		s[i] = state[i];
+	}
+
+	w[8] = HMAC_MB_SET1_32 (0x80000000);
+	for (i = 9; i < 15; i++)
+		w[i] = HMAC_MB_ZERO ();
+	w[15] = HMAC_MB_SET1_32 ((64 + 32) * 8);
+
+	HmacMbSha256Compress (s, w);
+}
+
+static void HmacMbSha256Pbkdf2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HMAC_MB_VEC innerState[8], outerState[8], uv[8], xv[8], s[8], m[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		innerState[i] = outerState[i] = HMAC_MB_SET1_32 (HmacMbSha256IV[i]);
+
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x36, 64, 4, 1);
+	HmacMbSha256Compress (innerState, m);
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x5c, 64, 4, 1);
+	HmacMbSha256Compress (outerState, m);
+
+	HmacMbLoad32 (uv, u, chains, 8, 1);
+	HmacMbLoad32 (xv, x, chains, 8, 1);
+
+	while (iterations-- > 0)
+	{
+		HmacMbSha256Digest (s, innerState, uv);
+		HmacMbSha256Digest (uv, outerState, s);
+
+		for (i = 0; i < 8; i++)
+			xv[i] = HMAC_MB_XOR (xv[i], uv[i]);
+	}
+
+	HmacMbStore32 (u, uv, chains, 8, 1);
+	HmacMbStore32 (x, xv, chains, 8, 1);
+
+	burn (innerState, sizeof (innerState));
+	burn (outerState, sizeof (outerState));
+	burn (uv, sizeof (uv));
+	burn (xv, sizeof (xv));
+	burn (s, sizeof (s));
+	burn (m, sizeof (m));
+}
+
+/* SHA-512 */
+
+#define HMAC_MB_SHA512_SUM0(x) HMAC_MB_XOR3 (HMAC_MB_ROR64 (x, 28), HMAC_MB_ROR64 (x, 34), HMAC_MB_ROR64 (x, 39))
+#define HMAC_MB_SHA512_SUM1(x) HMAC_MB_XOR3 (HMAC_MB_ROR64 (x, 14), HMAC_MB_ROR64 (x, 18), HMAC_MB_ROR64 (x, 41))
+#define HMAC_MB_SHA512_SIGMA0(x) HMAC_MB_XOR3 (HMAC_MB_ROR64 (x, 1), HMAC_MB_ROR64 (x, 8), HMAC_MB_SHR64 (x, 7))
+#define HMAC_MB_SHA512_SIGMA1(x) HMAC_MB_XOR3 (HMAC_MB_ROR64 (x, 19), HMAC_MB_ROR64 (x, 61), HMAC_MB_SHR64 (x, 6))
+
+#define HMAC_MB_SHA512_ROUND(a, b, c, d, e, f, g, h, j) \
+	{ \
+		if (i + j >= 16) \
+			w[j] = HMAC_MB_ADD64 (HMAC_MB_ADD64 (w[j], HMAC_MB_SHA512_SIGMA1 (w[(j + 14) & 15])), \
+				HMAC_MB_ADD64 (w[(j + 9) & 15], HMAC_MB_SHA512_SIGMA0 (w[(j + 1) & 15]))); \
+		t = HMAC_MB_ADD64 (HMAC_MB_ADD64 (h, HMAC_MB_SHA512_SUM1 (e)), \
+			HMAC_MB_ADD64 (HMAC_MB_CH (e, f, g), HMAC_MB_ADD64 (HMAC_MB_SET1_64 (HmacMbSha512K[i + j]), w[j]))); \
+		d = HMAC_MB_ADD64 (d, t); \
+		h = HMAC_MB_ADD64 (t, HMAC_MB_ADD64 (HMAC_MB_SHA512_SUM0 (a), HMAC_MB_MAJ (a, b, c))); \
+	}
+
+static void HmacMbSha512Compress (HMAC_MB_VEC s[8], HMAC_MB_VEC w[16])
+{
+	HMAC_MB_VEC a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7], t;
+	int i;
+
+	for (i = 0; i < 80; i += 16)
+	{
+		HMAC_MB_SHA512_ROUND (a, b, c, d, e, f, g, h, 0);
+		HMAC_MB_SHA512_ROUND (h, a, b, c, d, e, f, g, 1);
+		HMAC_MB_SHA512_ROUND (g, h, a, b, c, d, e, f, 2);
+		HMAC_MB_SHA512_ROUND (f, g, h, a, b, c, d, e, 3);
+		HMAC_MB_SHA512_ROUND (e, f, g, h, a, b, c, d, 4);
+		HMAC_MB_SHA512_ROUND (d, e, f, g, h, a, b, c, 5);
+		HMAC_MB_SHA512_ROUND (c, d, e, f, g, h, a, b, 6);
+		HMAC_MB_SHA512_ROUND (b, c, d, e, f, g, h, a, 7);
+		HMAC_MB_SHA512_ROUND (a, b, c, d, e, f, g, h, 8);
+		HMAC_MB_SHA512_ROUND (h, a, b, c, d, e, f, g, 9);
+		HMAC_MB_SHA512_ROUND (g, h, a, b, c, d, e, f, 10);
+		HMAC_MB_SHA512_ROUND (f, g, h, a, b, c, d, e, 11);
+		HMAC_MB_SHA512_ROUND (e, f, g, h, a, b, c, d, 12);
+		HMAC_MB_SHA512_ROUND (d, e, f, g, h, a, b, c, 13);
+		HMAC_MB_SHA512_ROUND (c, d, e, f, g, h, a, b, 14);
+		HMAC_MB_SHA512_ROUND (b, c, d, e, f, g, h, a, 15);
+	}
+
+	s[0] = HMAC_MB_ADD64 (s[0], a);
+	s[1] = HMAC_MB_ADD64 (s[1], b);
+	s[2] = HMAC_MB_ADD64 (s[2], c);
+	s[3] = HMAC_MB_ADD64 (s[3], d);
+	s[4] = HMAC_MB_ADD64 (s[4], e);
+	s[5] = HMAC_MB_ADD64 (s[5], f);
+	s[6] = HMAC_MB_ADD64 (s[6], g);
+	s[7] = HMAC_MB_ADD64 (s[7], h);
+}
+
+static void HmacMbSha512Digest (HMAC_MB_VEC s[8], const HMAC_MB_VEC state[8], const HMAC_MB_VEC message[8])
+{
+	HMAC_MB_VEC w[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+	{
+		w[i] = message[i];
+		s[i] = state[i];
+	}
+
+	w[8] = HMAC_MB_SET1_64 (LL(0x8000000000000000));
+	for (i = 9; i < 15; i++)
+		w[i] = HMAC_MB_ZERO ();
+	w[15] = HMAC_MB_SET1_64 ((128 + 64) * 8);
+
+	HmacMbSha512Compress (s, w);
+}
+
+static void HmacMbSha512Pbkdf2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HMAC_MB_VEC innerState[8], outerState[8], uv[8], xv[8], s[8], m[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		innerState[i] = outerState[i] = HMAC_MB_SET1_64 (HmacMbSha512IV[i]);
+
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x36, 128, 8, 1);
+	HmacMbSha512Compress (innerState, m);
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x5c, 128, 8, 1);
+	HmacMbSha512Compress (outerState, m);
+
+	HmacMbLoad64 (uv, u, chains);
+	HmacMbLoad64 (xv, x, chains);
+
+	while (iterations-- > 0)
+	{
+		HmacMbSha512Digest (s, innerState, uv);
+		HmacMbSha512Digest (uv, outerState, s);
+
+		for (i = 0; i < 8; i++)
+			xv[i] = HMAC_MB_XOR (xv[i], uv[i]);
+	}
+
+	HmacMbStore64 (u, uv, chains);
+	HmacMbStore64 (x, xv, chains);
+
+	burn (innerState, sizeof (innerState));
+	burn (outerState, sizeof (outerState));
+	burn (uv, sizeof (uv));
+	burn (xv, sizeof (xv));
+	burn (s, sizeof (s));
+	burn (m, sizeof (m));
+}
+
+/* BLAKE2s */
+
+#define HMAC_MB_BLAKE2S_G(a, b, c, d, x, y) \
+	{ \
+		a = HMAC_MB_ADD32 (HMAC_MB_ADD32 (a, b), x); \
+		d = HMAC_MB_ROR32_16 (HMAC_MB_XOR (d, a)); \
+		c = HMAC_MB_ADD32 (c, d); \
+		b = HMAC_MB_ROR32 (HMAC_MB_XOR (b, c), 12); \
+		a = HMAC_MB_ADD32 (HMAC_MB_ADD32 (a, b), y); \
+		d = HMAC_MB_ROR32_8 (HMAC_MB_XOR (d, a)); \
+		c = HMAC_MB_ADD32 (c, d); \
+		b = HMAC_MB_ROR32 (HMAC_MB_XOR (b, c), 7); \
+	}
+
+/* Compresses message block m into state h; t0 is the byte counter, f0 the last block flag */
+static void HmacMbBlake2sCompress (HMAC_MB_VEC h[8], const HMAC_MB_VEC m[16], uint32 t0, uint32 f0)
+{
+	HMAC_MB_VEC v[16];
+	int r, i;
+
+	for (i = 0; i < 8; i++)
+		v[i] = h[i];
+
+	v[8] = HMAC_MB_SET1_32 (HmacMbSha256IV[0]);
+	v[9] = HMAC_MB_SET1_32 (HmacMbSha256IV[1]);
+	v[10] = HMAC_MB_SET1_32 (HmacMbSha256IV[2]);
+	v[11] = HMAC_MB_SET1_32 (HmacMbSha256IV[3]);
+	v[12] = HMAC_MB_SET1_32 (HmacMbSha256IV[4] ^ t0);
+	v[13] = HMAC_MB_SET1_32 (HmacMbSha256IV[5]);
+	v[14] = HMAC_MB_SET1_32 (HmacMbSha256IV[6] ^ f0);
+	v[15] = HMAC_MB_SET1_32 (HmacMbSha256IV[7]);
+
+	for (r = 0; r < 10; r++)
+	{
+		const uint8 *s = HmacMbBlake2sSigma[r];
+
+		HMAC_MB_BLAKE2S_G (v[0], v[4], v[8], v[12], m[s[0]], m[s[1]]);
+		HMAC_MB_BLAKE2S_G (v[1], v[5], v[9], v[13], m[s[2]], m[s[3]]);
+		HMAC_MB_BLAKE2S_G (v[2], v[6], v[10], v[14], m[s[4]], m[s[5]]);
+		HMAC_MB_BLAKE2S_G (v[3], v[7], v[11], v[15], m[s[6]], m[s[7]]);
+		HMAC_MB_BLAKE2S_G (v[0], v[5], v[10], v[15], m[s[8]], m[s[9]]);
+		HMAC_MB_BLAKE2S_G (v[1], v[6], v[11], v[12], m[s[10]], m[s[11]]);
+		HMAC_MB_BLAKE2S_G (v[2], v[7], v[8], v[13], m[s[12]], m[s[13]]);
+		HMAC_MB_BLAKE2S_G (v[3], v[4], v[9], v[14], m[s[14]], m[s[15]]);
+	}
+
+	for (i = 0; i < 8; i++)
+		h[i] = HMAC_MB_XOR3 (h[i], v[i], v[i + 8]);
+}
+
+/* Computes the hash of a digest-sized message from the state after the HMAC key block */
+static void HmacMbBlake2sDigest (HMAC_MB_VEC s[8], const HMAC_MB_VEC state[8], const HMAC_MB_VEC message[8])
+{
+	HMAC_MB_VEC m[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+	{
+		m[i] = message[i];
+		m[i + 8] = HMAC_MB_ZERO ();
+		s[i] = state[i];
+	}
+
+	HmacMbBlake2sCompress (s, m, 64 + 32, 0xffffffff);
+}
+
+static void HmacMbBlake2sPbkdf2 (const unsigned char *pwd, int pwd_len, unsigned char *u, unsigned char *x, int chains, uint32 iterations)
+{
+	HMAC_MB_VEC innerState[8], outerState[8], uv[8], xv[8], s[8], m[16];
+	int i;
+
+	for (i = 0; i < 8; i++)
+		innerState[i] = outerState[i] = HMAC_MB_SET1_32 (HmacMbSha256IV[i] ^ (i == 0 ? HMAC_MB_BLAKE2S_PARAM0 : 0));
+
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x36, 64, 4, 0);
+	HmacMbBlake2sCompress (innerState, m, 64, 0);
+	HmacMbKeyBlock (m, pwd, pwd_len, 0x5c, 64, 4, 0);
+	HmacMbBlake2sCompress (outerState, m, 64, 0);
+
+	HmacMbLoad32 (uv, u, chains, 8, 0);
+	HmacMbLoad32 (xv, x, chains, 8, 0);
+
+	while (iterations-- > 0)
+	{
+		HmacMbBlake2sDigest (s, innerState, uv);
+		HmacMbBlake2sDigest (uv, outerState, s);
+
+		for (i = 0; i < 8; i++)
+			xv[i] = HMAC_MB_XOR (xv[i], uv[i]);
+	}
+
+	HmacMbStore32 (u, uv, chains, 8, 0);
+	HmacMbStore32 (x, xv, chains, 8, 0);
+
+	burn (innerState, sizeof (innerState));
+	burn (outerState, sizeof (outerState));
+	burn (uv, sizeof (uv));
+	burn (xv, sizeof (xv));
+	burn (s, sizeof (s));
+	burn (m, sizeof (m));
+}
+
+#endif // TC_HEADER_Crypto_Hmac_Mb_Simd
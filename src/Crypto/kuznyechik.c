@@ -19,6 +19,12 @@ void kuznyechik_decrypt_block_simd(uint8* out, const uint8* in, kuznyechik_kds*
 void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
 #endif
 
+#if CRYPTOPP_AVX2_AVAILABLE && !defined (TC_WINDOWS_DRIVER) && !defined (_UEFI)
+#define KUZNYECHIK_AVX2
+void kuznyechik_avx2_encrypt_blocks(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
+void kuznyechik_avx2_decrypt_blocks(uint8* out, const uint8* in, size_t blocks, kuznyechik_kds* kds);
+#endif
+
 //#define CPPCRYPTO_DEBUG
 
 	static const uint8 S[256] = {
@@ -2310,6 +2316,17 @@ void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks,
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(_UEFI) && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
 		if(HasSSE2())
 		{
+#ifdef KUZNYECHIK_AVX2
+			if (HasSAVX2() && blocks >= 8)
+			{
+				size_t avx2Blocks = blocks & ~(size_t) 7;
+
+				kuznyechik_avx2_encrypt_blocks (out, in, avx2Blocks, kds);
+				out += avx2Blocks * 16;
+				in += avx2Blocks * 16;
+				blocks -= avx2Blocks;
+			}
+#endif
 			kuznyechik_encrypt_blocks_simd (out, in, blocks, kds);
 		}
 		else
@@ -2380,6 +2397,17 @@ void kuznyechik_decrypt_blocks_simd(uint8* out, const uint8* in, size_t blocks,
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(_UEFI) && (!defined (DEBUG) || !defined (TC_WINDOWS_DRIVER))
 		if(HasSSE2())
 		{
+#ifdef KUZNYECHIK_AVX2
+			if (HasSAVX2() && blocks >= 8)
+			{
+				size_t avx2Blocks = blocks & ~(size_t) 7;
+
+				kuznyechik_avx2_decrypt_blocks (out, in, avx2Blocks, kds);
+				out += avx2Blocks * 16;
+				in += avx2Blocks * 16;
+				blocks -= avx2Blocks;
+			}
+#endif
 			kuznyechik_decrypt_blocks_simd (out, in, blocks, kds);
 		}
 		else
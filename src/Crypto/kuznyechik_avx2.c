@@ -0,0 +1,142 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+/* Kuznyechik processing 8 blocks in parallel with AVX2, using the precomputed LS tables of
+   kuznyechik_simd.c. Two blocks are held in each register: round keys are applied and table
+   offsets are computed for both at once, and the table lookups of the eight blocks are
+   interleaved. Must be compiled with AVX2 enabled. */
+
+#include "kuznyechik.h"
+#include "misc.h"
+
+#if CRYPTOPP_AVX2_AVAILABLE && !defined (TC_WINDOWS_DRIVER) && !defined (_UEFI)
+
+#include <immintrin.h>
+
+/* defined in kuznyechik_simd.c */
+extern const uint8 Pi[256];
+extern const uint8 InversedPi[256];
+extern const uint8 precomputedLSTable[16 * 256 * 16];
+extern const uint8 precomputedInversedLSTable[16 * 256 * 16];
+
+#define KUZNYECHIK_AVX2_VECTOR_COUNT 4
+#define KUZNYECHIK_AVX2_BLOCK_COUNT (2 * KUZNYECHIK_AVX2_VECTOR_COUNT)
+
+/* Replaces each block with the XOR of the table entries selected by its 16 bytes. Table j (of
+   256 16-byte entries) is indexed by byte j; the byte offsets of the entries are computed with
+   vector shifts and read back from memory (offsets must be 32-byte aligned). */
+VC_INLINE void KuznyechikAvx2LS (__m256i x[KUZNYECHIK_AVX2_VECTOR_COUNT], const uint8 *table, uint16 offsets[KUZNYECHIK_AVX2_VECTOR_COUNT][32])
+{
+	const __m256i highByteMask = _mm256_set1_epi16 ((short) 0xff00);
+	int v, j;
+
+	for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+	{
+		/* offsets of odd bytes in the first 16 words, of even bytes in the last 16 words */
+		_mm256_store_si256 ((__m256i *) offsets[v], _mm256_srli_epi16 (_mm256_and_si256 (x[v], highByteMask), 4));
+		_mm256_store_si256 ((__m256i *) offsets[v] + 1, _mm256_slli_epi16 (_mm256_andnot_si256 (highByteMask, x[v]), 4));
+	}
+
+	for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+	{
+		__m128i odd0 = _mm_setzero_si128 (), even0 = _mm_setzero_si128 ();
+		__m128i odd1 = _mm_setzero_si128 (), even1 = _mm_setzero_si128 ();
+
+		for (j = 0; j < 8; j++)
+		{
+			const uint8 *oddTable = table + (2 * j + 1) * 0x1000;
+			const uint8 *evenTable = table + 2 * j * 0x1000;
+
+			odd0 = _mm_xor_si128 (odd0, _mm_load_si128 ((const __m128i *) (oddTable + offsets[v][j])));
+			odd1 = _mm_xor_si128 (odd1, _mm_load_si128 ((const __m128i *) (oddTable + offsets[v][8 + j])));
+			even0 = _mm_xor_si128 (even0, _mm_load_si128 ((const __m128i *) (evenTable + offsets[v][16 + j])));
+			even1 = _mm_xor_si128 (even1, _mm_load_si128 ((const __m128i *) (evenTable + offsets[v][24 + j])));
+		}
+
+		x[v] = _mm256_inserti128_si256 (_mm256_castsi128_si256 (_mm_xor_si128 (odd0, even0)), _mm_xor_si128 (odd1, even1), 1);
+	}
+}
+
+VC_INLINE __m256i KuznyechikAvx2RoundKey (const uint64 *roundKeys, int round)
+{
+	return _mm256_broadcastsi128_si256 (_mm_loadu_si128 ((const __m128i *) &roundKeys[2 * round]));
+}
+
+/* blockCount must be a multiple of 8 */
+void kuznyechik_avx2_encrypt_blocks (uint8 *out, const uint8 *in, size_t blockCount, kuznyechik_kds *kds)
+{
+	CRYPTOPP_ALIGN_DATA(32) uint16 offsets[KUZNYECHIK_AVX2_VECTOR_COUNT][32];
+	__m256i x[KUZNYECHIK_AVX2_VECTOR_COUNT], key;
+	int round, v;
+
+	for (; blockCount >= KUZNYECHIK_AVX2_BLOCK_COUNT; blockCount -= KUZNYECHIK_AVX2_BLOCK_COUNT)
+	{
+		for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+			x[v] = _mm256_loadu_si256 ((const __m256i *) (in + 32 * v));
+
+		for (round = 0; round < 9; round++)
+		{
+			key = KuznyechikAvx2RoundKey (kds->rke, round);
+			for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+				x[v] = _mm256_xor_si256 (x[v], key);
+
+			KuznyechikAvx2LS (x, precomputedLSTable, offsets);
+		}
+
+		key = KuznyechikAvx2RoundKey (kds->rke, 9);
+		for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+			_mm256_storeu_si256 ((__m256i *) (out + 32 * v), _mm256_xor_si256 (x[v], key));
+
+		in += KUZNYECHIK_AVX2_BLOCK_COUNT * 16;
+		out += KUZNYECHIK_AVX2_BLOCK_COUNT * 16;
+	}
+
+	burn (offsets, sizeof (offsets));
+}
+
+/* blockCount must be a multiple of 8 */
+void kuznyechik_avx2_decrypt_blocks (uint8 *out, const uint8 *in, size_t blockCount, kuznyechik_kds *kds)
+{
+	CRYPTOPP_ALIGN_DATA(32) uint16 offsets[KUZNYECHIK_AVX2_VECTOR_COUNT][32];
+	CRYPTOPP_ALIGN_DATA(32) uint8 data[KUZNYECHIK_AVX2_BLOCK_COUNT * 16];
+	__m256i x[KUZNYECHIK_AVX2_VECTOR_COUNT], key;
+	int round, v, i;
+
+	for (; blockCount >= KUZNYECHIK_AVX2_BLOCK_COUNT; blockCount -= KUZNYECHIK_AVX2_BLOCK_COUNT)
+	{
+		for (i = 0; i < (int) sizeof (data); i++)
+			data[i] = Pi[in[i]];
+
+		for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+			x[v] = _mm256_load_si256 ((const __m256i *) data + v);
+
+		for (round = 9; round > 0; round--)
+		{
+			KuznyechikAvx2LS (x, precomputedInversedLSTable, offsets);
+
+			key = KuznyechikAvx2RoundKey (kds->rkd, round);
+			for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+				x[v] = _mm256_xor_si256 (x[v], key);
+		}
+
+		for (v = 0; v < KUZNYECHIK_AVX2_VECTOR_COUNT; v++)
+			_mm256_store_si256 ((__m256i *) data + v, x[v]);
+
+		for (i = 0; i < (int) sizeof (data); i++)
+			out[i] = InversedPi[data[i]] ^ ((const uint8 *) kds->rkd)[i % 16];
+
+		in += KUZNYECHIK_AVX2_BLOCK_COUNT * 16;
+		out += KUZNYECHIK_AVX2_BLOCK_COUNT * 16;
+	}
+
+	burn (offsets, sizeof (offsets));
+	burn (data, sizeof (data));
+}
+
+#endif
@@ -53,6 +53,9 @@
 #include "Platform/Unix/Pipe.h"
 #include "Platform/Unix/Poller.h"
 #include "Core/Unix/UnixUser.h"
+#ifdef TC_LINUX
+#include "Driver/Ublk/UblkService.h"
+#endif
 #include "Volume/EncryptionThreadPool.h"
 #include "Core/Core.h"
 
@@ -62,6 +65,7 @@ namespace VeraCrypt
 	static const ino_t VC_FUSE_INODE_VOLUME = 2;
 	static const ino_t VC_FUSE_INODE_CONTROL = 3;
 	static const ino_t VC_FUSE_INODE_AUX_DEVICE_INFO = 4;
+	static const ino_t VC_FUSE_INODE_UBLK_DEVICE = 5;
 	static const uint64 VC_FUSE_BLOCK_SIZE = 4096;
 	static const uint64 VC_FUSE_METADATA_SIZE = 64 * 1024;
 	static const uint64 VC_FUSE_STAT_BLOCK_SIZE = 512;
@@ -155,6 +159,19 @@ namespace VeraCrypt
 			cfg->use_ino = 1;
 		}
 
+		if (conn)
+		{
+			if (FuseService::GetMaxRequestSize() > 0)
+				conn->max_write = FuseService::GetMaxRequestSize();
+
+			// Capabilities not supported by the kernel are not requested
+			if (FuseService::IsSpliceEnabled())
+				conn->want |= conn->capable & (FUSE_CAP_SPLICE_READ | FUSE_CAP_SPLICE_WRITE | FUSE_CAP_SPLICE_MOVE);
+
+			if (FuseService::IsWritebackCacheEnabled())
+				conn->want |= conn->capable & FUSE_CAP_WRITEBACK_CACHE;
+		}
+
 		return fuse_service_init_common ();
 	}
 #elif defined(TC_OPENBSD) || (FUSE_USE_VERSION >= 26)
@@ -234,6 +251,16 @@ namespace VeraCrypt
 					statData->st_ino = VC_FUSE_INODE_CONTROL;
 					fuse_service_set_stat_blocks (statData);
 				}
+#ifdef TC_LINUX
+				else if (strcmp (path, FuseService::GetUblkDevicePath()) == 0)
+				{
+					statData->st_mode = S_IFREG | 0600;
+					statData->st_nlink = 1;
+					statData->st_size = VC_FUSE_METADATA_SIZE;
+					statData->st_ino = VC_FUSE_INODE_UBLK_DEVICE;
+					fuse_service_set_stat_blocks (statData);
+				}
+#endif
 				else
 				{
 					return -ENOENT;
@@ -330,6 +357,15 @@ namespace VeraCrypt
 				fi->direct_io = 1;
 				return 0;
 			}
+#ifdef TC_LINUX
+			// Opening the file starts serving the volume as a ublk block device
+			if (strcmp (path, FuseService::GetUblkDevicePath()) == 0)
+			{
+				fi->fh = reinterpret_cast <uint64> (new shared_ptr <Buffer> (FuseService::GetUblkDeviceInfo()));
+				fi->direct_io = 1;
+				return 0;
+			}
+#endif
 		}
 		catch (...)
 		{
@@ -365,7 +401,7 @@ namespace VeraCrypt
 						if (alignedSize % sectorSize != 0)
 							alignedSize += sectorSize - (alignedSize % sectorSize);
 
-						SecureBuffer alignedBuffer (alignedSize);
+						PooledSecureBuffer alignedBuffer (FuseService::GetScratchBufferPool(), alignedSize);
 
 						FuseService::ReadVolumeSectors (alignedBuffer, alignedOffset);
 						BufferPtr ((uint8 *) buf, size).CopyFrom (alignedBuffer.GetRange (offset % sectorSize, size));
@@ -412,6 +448,22 @@ namespace VeraCrypt
 				outBuf.CopyFrom (infoBuf->GetRange (offset, size));
 				return size;
 			}
+#ifdef TC_LINUX
+			if (strcmp (path, FuseService::GetUblkDevicePath()) == 0 && fi && fi->fh)
+			{
+				shared_ptr <Buffer> infoBuf = *reinterpret_cast <shared_ptr <Buffer> *> (fi->fh);
+				BufferPtr outBuf ((uint8 *)buf, size);
+
+				if (offset >= (off_t) infoBuf->Size())
+					return 0;
+
+				if (offset + size > infoBuf->Size())
+					size = infoBuf->Size () - offset;
+
+				outBuf.CopyFrom (infoBuf->GetRange (offset, size));
+				return size;
+			}
+#endif
 		}
 		catch (...)
 		{
@@ -425,7 +477,11 @@ namespace VeraCrypt
 	{
 		try
 		{
-			if (strcmp (path, FuseService::GetControlPath()) == 0 && fi && fi->fh)
+			if ((strcmp (path, FuseService::GetControlPath()) == 0
+#ifdef TC_LINUX
+				|| strcmp (path, FuseService::GetUblkDevicePath()) == 0
+#endif
+				) && fi && fi->fh)
 			{
 				delete reinterpret_cast <shared_ptr <Buffer> *> (fi->fh);
 				fi->fh = 0;
@@ -461,6 +517,10 @@ namespace VeraCrypt
 				return 0;
 			if (fuse_service_fill_dir_entry (buf, filler, FuseService::GetAuxDeviceInfoPath() + 1, S_IFREG | 0600, VC_FUSE_INODE_AUX_DEVICE_INFO, 0) != 0)
 				return 0;
+#ifdef TC_LINUX
+			if (fuse_service_fill_dir_entry (buf, filler, FuseService::GetUblkDevicePath() + 1, S_IFREG | 0600, VC_FUSE_INODE_UBLK_DEVICE, 0) != 0)
+				return 0;
+#endif
 		}
 		catch (...)
 		{
@@ -548,6 +608,9 @@ namespace VeraCrypt
 
 	void FuseService::Dismount ()
 	{
+#ifdef TC_LINUX
+		UblkService::Stop();
+#endif
 		CloseMountedVolume();
 
 		if (EncryptionThreadPool::IsRunning())
@@ -613,6 +676,24 @@ namespace VeraCrypt
 		return outBuf;
 	}
 
+#ifdef TC_LINUX
+	shared_ptr <Buffer> FuseService::GetUblkDeviceInfo ()
+	{
+		if (!MountedVolume)
+			throw NotInitialized (SRC_POS);
+
+		shared_ptr <Stream> stream (new MemoryStream);
+		Serializer sr (stream);
+		sr.Serialize ("VirtualDevice", string (UblkService::Start (MountedVolume)));
+
+		ConstBufferPtr infoBuf = dynamic_cast <MemoryStream&> (*stream);
+		shared_ptr <Buffer> outBuf (new Buffer (infoBuf.Size()));
+		outBuf->CopyFrom (infoBuf);
+
+		return outBuf;
+	}
+#endif
+
 	shared_ptr <Buffer> FuseService::GetVolumeInfo ()
 	{
 		shared_ptr <Stream> stream (new MemoryStream);
@@ -650,8 +731,16 @@ namespace VeraCrypt
 		return MountedVolume->GetSize();
 	}
 
-	void FuseService::Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint)
+	void FuseService::Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint, const MountOptions &options)
 	{
+		// Inherited by the FUSE service process
+		MaxRequestSize = options.FuseMaxRequestSize;
+		if (MaxRequestSize > MountOptions::MaxFuseRequestSize)
+			MaxRequestSize = MountOptions::MaxFuseRequestSize;
+
+		SpliceEnabled = options.FuseSplice;
+		WritebackCacheEnabled = options.FuseWritebackCache;
+
 		list <string> args;
 		args.push_back (FuseService::GetDeviceType());
 		args.push_back (fuseMountPoint);
@@ -686,6 +775,43 @@ namespace VeraCrypt
 		args.push_back ("use_ino");
 #endif
 
+#ifdef VC_FUSE3
+		// Keep the worker threads of the multithreaded loop alive so that concurrent requests of
+		// the loop device do not wait for thread creation. Older libfuse versions reject max_threads.
+		if (options.FuseMaxThreads > 0)
+		{
+#if defined (FUSE_VERSION) && defined (FUSE_MAKE_VERSION) && FUSE_VERSION >= FUSE_MAKE_VERSION (3, 12)
+			args.push_back ("-o");
+			args.push_back ("max_threads=" + StringConverter::ToSingle ((uint32) options.FuseMaxThreads));
+#endif
+			args.push_back ("-o");
+			args.push_back ("max_idle_threads=" + StringConverter::ToSingle ((uint32) options.FuseMaxThreads));
+		}
+#endif
+
+#ifndef TC_MACOSX
+		// Large requests let the loop device pass big sequential transfers through unsplit.
+		// FUSE 3 negotiates the write size and the splice and writeback cache capabilities in fuse_service_init().
+		if (MaxRequestSize > 0)
+		{
+			args.push_back ("-o");
+			args.push_back ("max_read=" + StringConverter::ToSingle (MaxRequestSize));
+#ifndef VC_FUSE3
+			args.push_back ("-o");
+			args.push_back ("max_write=" + StringConverter::ToSingle (MaxRequestSize));
+			args.push_back ("-o");
+			args.push_back ("big_writes");
+#endif
+		}
+#if defined(TC_LINUX) && !defined(VC_FUSE3)
+		if (SpliceEnabled)
+		{
+			args.push_back ("-o");
+			args.push_back ("splice_read,splice_write,splice_move");
+		}
+#endif
+#endif
+
 		ExecFunctor execFunctor (openVolume, slotNumber);
 		Process::Execute ("fuse", args, -1, &execFunctor);
 
@@ -742,6 +868,23 @@ namespace VeraCrypt
 		fuseServiceControl.Close();
 	}
 
+#ifdef TC_LINUX
+	DevicePath FuseService::StartUblkDevice (const DirectoryPath &fuseMountPoint)
+	{
+		shared_ptr <File> deviceInfoFile (new File);
+		deviceInfoFile->Open (string (fuseMountPoint) + GetUblkDevicePath());
+
+		FileStream deviceInfoReader (deviceInfoFile);
+		string deviceInfo = deviceInfoReader.ReadToEnd();
+		if (deviceInfo.empty())
+			throw ParameterIncorrect (SRC_POS);
+
+		shared_ptr <Stream> stream (new MemoryStream (ConstBufferPtr ((const uint8 *) deviceInfo.data(), deviceInfo.size())));
+		Serializer sr (stream);
+		return sr.DeserializeString ("VirtualDevice");
+	}
+#endif
+
 	void FuseService::WriteVolumeSectors (const ConstBufferPtr &buffer, uint64 byteOffset)
 	{
 		if (!MountedVolume)
@@ -846,6 +989,9 @@ namespace VeraCrypt
 
 		SignalHandlerPipe->GetWriteFD();
 
+		// fuse_main() runs the multithreaded loop as no -s option is passed. Volume sector I/O is
+		// safe for concurrent callers: it uses positional reads and writes, per-request buffers
+		// and atomic statistics.
 #ifdef VC_FUSE3
 		_exit (fuse_main (argc, argv, &fuse_service_oper, nullptr));
 #elif defined(TC_OPENBSD)
@@ -855,10 +1001,13 @@ namespace VeraCrypt
 #endif
 	}
 
+	uint32 FuseService::MaxRequestSize;
 	VolumeInfo FuseService::OpenVolumeInfo;
 	Mutex FuseService::OpenVolumeInfoMutex;
 	shared_ptr <Volume> FuseService::MountedVolume;
 	VolumeSlotNumber FuseService::SlotNumber;
+	bool FuseService::SpliceEnabled;
+	bool FuseService::WritebackCacheEnabled;
 	uid_t FuseService::UserId;
 	gid_t FuseService::GroupId;
 	unique_ptr <Pipe> FuseService::SignalHandlerPipe;
@@ -16,6 +16,7 @@
 #include "Platform/Platform.h"
 #include "Platform/Unix/Pipe.h"
 #include "Platform/Unix/Process.h"
+#include "Core/MountOptions.h"
 #include "Volume/VolumeInfo.h"
 #include "Volume/Volume.h"
 
@@ -50,15 +51,26 @@ namespace VeraCrypt
 		static const char *GetVolumeImagePath ();
 		static string GetDeviceType () { return "veracrypt"; }
 		static gid_t GetGroupId () { return GroupId; }
+		static uint32 GetMaxRequestSize () { return MaxRequestSize; }
+		static SecureBufferPool &GetScratchBufferPool () { return MountedVolume->GetScratchBufferPool(); }
 		static uid_t GetUserId () { return UserId; }
 		static shared_ptr <Buffer> GetAuxDeviceInfo ();
+#ifdef TC_LINUX
+		static const char *GetUblkDevicePath () { return "/ublk-device"; }
+		static shared_ptr <Buffer> GetUblkDeviceInfo ();
+#endif
 		static shared_ptr <Buffer> GetVolumeInfo ();
 		static uint64 GetVolumeSize ();
 		static uint64 GetVolumeSectorSize () { return MountedVolume->GetSectorSize(); }
-		static void Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint);
+		static bool IsSpliceEnabled () { return SpliceEnabled; }
+		static bool IsWritebackCacheEnabled () { return WritebackCacheEnabled; }
+		static void Mount (shared_ptr <Volume> openVolume, VolumeSlotNumber slotNumber, const string &fuseMountPoint, const MountOptions &options);
 		static void ReadVolumeSectors (const BufferPtr &buffer, uint64 byteOffset);
 		static void ReceiveAuxDeviceInfo (const ConstBufferPtr &buffer);
 		static void SendAuxDeviceInfo (const DirectoryPath &fuseMountPoint, const DevicePath &virtualDevice, const DevicePath &loopDevice = DevicePath());
+#ifdef TC_LINUX
+		static DevicePath StartUblkDevice (const DirectoryPath &fuseMountPoint);
+#endif
 		static void WriteVolumeSectors (const ConstBufferPtr &buffer, uint64 byteOffset);
 
 	protected:
@@ -66,10 +78,13 @@ namespace VeraCrypt
 		static void CloseMountedVolume ();
 		static void OnSignal (int signal);
 
+		static uint32 MaxRequestSize;
 		static VolumeInfo OpenVolumeInfo;
 		static Mutex OpenVolumeInfoMutex;
 		static shared_ptr <Volume> MountedVolume;
 		static VolumeSlotNumber SlotNumber;
+		static bool SpliceEnabled;
+		static bool WritebackCacheEnabled;
 		static uid_t UserId;
 		static gid_t GroupId;
 		static unique_ptr <Pipe> SignalHandlerPipe;
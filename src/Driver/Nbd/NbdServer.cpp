@@ -0,0 +1,632 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include <algorithm>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "NbdServer.h"
+#include "Platform/SystemLog.h"
+#include "Platform/Unix/Poller.h"
+
+#ifndef MSG_NOSIGNAL
+#	define MSG_NOSIGNAL 0
+#endif
+
+namespace VeraCrypt
+{
+	// Protocol constants as defined by the NBD protocol specification
+	static const uint64 NbdMagic = 0x4e42444d41474943ULL;
+	static const uint64 NbdOptionMagic = 0x49484156454F5054ULL;
+	static const uint64 NbdOptionReplyMagic = 0x3e889045565a9ULL;
+	static const uint32 NbdRequestMagic = 0x25609513;
+	static const uint32 NbdSimpleReplyMagic = 0x67446698;
+	static const uint32 NbdStructuredReplyMagic = 0x668e33ef;
+
+	static const uint16 NbdFlagFixedNewstyle = 1 << 0;
+	static const uint16 NbdFlagNoZeroes = 1 << 1;
+	static const uint32 NbdFlagClientFixedNewstyle = 1 << 0;
+	static const uint32 NbdFlagClientNoZeroes = 1 << 1;
+
+	static const uint16 NbdFlagHasFlags = 1 << 0;
+	static const uint16 NbdFlagReadOnly = 1 << 1;
+	static const uint16 NbdFlagSendFlush = 1 << 2;
+	static const uint16 NbdFlagSendFua = 1 << 3;
+	static const uint16 NbdFlagSendTrim = 1 << 5;
+	static const uint16 NbdFlagSendWriteZeroes = 1 << 6;
+	static const uint16 NbdFlagCanMultiConn = 1 << 8;
+
+	static const uint32 NbdOptExportName = 1;
+	static const uint32 NbdOptAbort = 2;
+	static const uint32 NbdOptList = 3;
+	static const uint32 NbdOptInfo = 6;
+	static const uint32 NbdOptGo = 7;
+	static const uint32 NbdOptStructuredReply = 8;
+
+	static const uint32 NbdRepAck = 1;
+	static const uint32 NbdRepServer = 2;
+	static const uint32 NbdRepInfo = 3;
+	static const uint32 NbdRepErrUnsup = 0x80000001;
+	static const uint32 NbdRepErrInvalid = 0x80000003;
+
+	static const uint16 NbdInfoExport = 0;
+	static const uint16 NbdInfoBlockSize = 3;
+
+	static const uint16 NbdCmdRead = 0;
+	static const uint16 NbdCmdWrite = 1;
+	static const uint16 NbdCmdDisconnect = 2;
+	static const uint16 NbdCmdFlush = 3;
+	static const uint16 NbdCmdTrim = 4;
+	static const uint16 NbdCmdWriteZeroes = 6;
+	static const uint16 NbdCmdFlagFua = 1 << 0;
+
+	static const uint16 NbdReplyFlagDone = 1 << 0;
+	static const uint16 NbdReplyTypeNone = 0;
+	static const uint16 NbdReplyTypeOffsetData = 1;
+	static const uint16 NbdReplyTypeError = 0x8001;
+
+	static const uint32 NbdEPerm = 1;
+	static const uint32 NbdEIo = 5;
+	static const uint32 NbdENoMem = 12;
+	static const uint32 NbdEInval = 22;
+	static const uint32 NbdENoSpc = 28;
+
+	static const uint32 NbdMaxOptionSize = 64 * 1024;
+
+	static void nbd_put16 (uint8 *buffer, uint16 value) { value = Endian::Big (value); memcpy (buffer, &value, sizeof (value)); }
+	static void nbd_put32 (uint8 *buffer, uint32 value) { value = Endian::Big (value); memcpy (buffer, &value, sizeof (value)); }
+	static void nbd_put64 (uint8 *buffer, uint64 value) { value = Endian::Big (value); memcpy (buffer, &value, sizeof (value)); }
+	static uint16 nbd_get16 (const uint8 *buffer) { uint16 value; memcpy (&value, buffer, sizeof (value)); return Endian::Big (value); }
+	static uint32 nbd_get32 (const uint8 *buffer) { uint32 value; memcpy (&value, buffer, sizeof (value)); return Endian::Big (value); }
+	static uint64 nbd_get64 (const uint8 *buffer) { uint64 value; memcpy (&value, buffer, sizeof (value)); return Endian::Big (value); }
+
+	NbdServer::NbdServer (shared_ptr <Volume> volume, const FilePath &socketPath)
+		: ListenSocket (-1), MountedVolume (volume), SocketPath (socketPath)
+	{
+		string path = socketPath;
+
+		sockaddr_un address;
+		Memory::Zero (&address, sizeof (address));
+		address.sun_family = AF_UNIX;
+
+		if (path.empty() || path.size() >= sizeof (address.sun_path))
+			throw ParameterIncorrect (SRC_POS);
+
+		strcpy (address.sun_path, path.c_str());
+
+		ListenSocket = socket (AF_UNIX, SOCK_STREAM, 0);
+		throw_sys_if (ListenSocket == -1);
+
+		try
+		{
+			// The socket gives access to decrypted data and must not be accessible by other users
+			mode_t previousMask = umask (S_IRWXG | S_IRWXO);
+			int bindResult = bind (ListenSocket, (const sockaddr *) &address, sizeof (address));
+			umask (previousMask);
+
+			throw_sys_sub_if (bindResult == -1, path);
+			throw_sys_sub_if (listen (ListenSocket, 16) == -1, path);
+		}
+		catch (...)
+		{
+			close (ListenSocket);
+			throw;
+		}
+	}
+
+	NbdServer::~NbdServer ()
+	{
+		try
+		{
+			ReapConnections (true);
+		}
+		catch (...) { }
+
+		close (ListenSocket);
+		unlink (string (SocketPath).c_str());
+	}
+
+	TC_THREAD_PROC NbdServer::ConnectionThreadProc (void *parameter)
+	{
+		Connection *connection = reinterpret_cast <Connection *> (parameter);
+		connection->Server.HandleConnection (*connection);
+		connection->Finished = true;
+		return 0;
+	}
+
+	uint32 NbdServer::ExceptionToErrorCode ()
+	{
+		try
+		{
+			throw;
+		}
+		catch (std::bad_alloc&)
+		{
+			return NbdENoMem;
+		}
+		catch (VolumeProtected&)
+		{
+			return NbdEPerm;
+		}
+		catch (VolumeReadOnly&)
+		{
+			return NbdEPerm;
+		}
+		catch (SystemException &e)
+		{
+			SystemLog::WriteException (e);
+
+			switch (e.GetErrorCode())
+			{
+			case EPERM:
+			case EACCES:
+			case EROFS:		return NbdEPerm;
+			case ENOMEM:	return NbdENoMem;
+			case EINVAL:	return NbdEInval;
+			case ENOSPC:	return NbdENoSpc;
+			default:		return NbdEIo;
+			}
+		}
+		catch (std::exception &e)
+		{
+			SystemLog::WriteException (e);
+			return NbdEIo;
+		}
+		catch (...)
+		{
+			SystemLog::WriteException (UnknownException (SRC_POS));
+			return NbdEIo;
+		}
+	}
+
+	uint32 NbdServer::ExecuteRequest (Connection &connection, uint16 type, uint16 flags, uint64 offset, uint32 length)
+	{
+		try
+		{
+			switch (type)
+			{
+			case NbdCmdRead:
+				MountedVolume->ReadSectors (connection.RequestBuffer.GetRange (0, length), offset);
+				break;
+
+			case NbdCmdWrite:
+				MountedVolume->WriteSectors (connection.RequestBuffer.GetRange (0, length), offset);
+
+				if (flags & NbdCmdFlagFua)
+					MountedVolume->GetFile()->Flush();
+				break;
+
+			case NbdCmdWriteZeroes:
+				{
+					size_t chunkSize = connection.RequestBuffer.Size();
+					if (chunkSize > length)
+						chunkSize = length;
+
+					connection.RequestBuffer.GetRange (0, chunkSize).Zero();
+
+					for (uint64 done = 0; done < length; done += chunkSize)
+					{
+						if (length - done < chunkSize)
+							chunkSize = (size_t) (length - done);
+
+						MountedVolume->WriteSectors (connection.RequestBuffer.GetRange (0, chunkSize), offset + done);
+					}
+
+					if (flags & NbdCmdFlagFua)
+						MountedVolume->GetFile()->Flush();
+				}
+				break;
+
+			case NbdCmdFlush:
+				MountedVolume->GetFile()->Flush();
+				break;
+
+			case NbdCmdTrim:
+				// Discarding sectors of the host file would reveal which parts of the volume are unused
+				break;
+
+			default:
+				return NbdEInval;
+			}
+		}
+		catch (...)
+		{
+			return ExceptionToErrorCode();
+		}
+
+		return 0;
+	}
+
+	uint16 NbdServer::GetTransmissionFlags () const
+	{
+		uint16 flags = NbdFlagHasFlags | NbdFlagSendFlush | NbdFlagSendFua | NbdFlagSendTrim | NbdFlagSendWriteZeroes | NbdFlagCanMultiConn;
+
+		if (MountedVolume->GetProtectionType() == VolumeProtection::ReadOnly)
+			flags |= NbdFlagReadOnly;
+
+		return flags;
+	}
+
+	void NbdServer::HandleConnection (Connection &connection)
+	{
+		try
+		{
+			if (Negotiate (connection))
+				Transmit (connection);
+		}
+		catch (exception &e)
+		{
+			SystemLog::WriteException (e);
+		}
+		catch (...)
+		{
+			SystemLog::WriteException (UnknownException (SRC_POS));
+		}
+
+		shutdown (connection.Socket, SHUT_RDWR);
+	}
+
+	bool NbdServer::Negotiate (Connection &connection)
+	{
+		uint8 greeting[18];
+		nbd_put64 (greeting, NbdMagic);
+		nbd_put64 (greeting + 8, NbdOptionMagic);
+		nbd_put16 (greeting + 16, NbdFlagFixedNewstyle | NbdFlagNoZeroes);
+		SendData (connection.Socket, greeting, sizeof (greeting));
+
+		uint8 clientFlags[4];
+		if (!ReceiveData (connection.Socket, clientFlags, sizeof (clientFlags)))
+			return false;
+
+		if (!(nbd_get32 (clientFlags) & NbdFlagClientFixedNewstyle))
+			return false;
+
+		connection.NoZeroes = (nbd_get32 (clientFlags) & NbdFlagClientNoZeroes) != 0;
+
+		while (true)
+		{
+			uint8 header[16];
+			if (!ReceiveData (connection.Socket, header, sizeof (header)))
+				return false;
+
+			if (nbd_get64 (header) != NbdOptionMagic)
+				return false;
+
+			uint32 option = nbd_get32 (header + 8);
+			uint32 optionSize = nbd_get32 (header + 12);
+
+			if (optionSize > NbdMaxOptionSize)
+				return false;
+
+			Buffer optionData (optionSize > 0 ? optionSize : 1);
+			if (optionSize > 0 && !ReceiveData (connection.Socket, optionData.Ptr(), optionSize))
+				return false;
+
+			switch (option)
+			{
+			case NbdOptExportName:
+				{
+					// Only a single unnamed export is served, so any name selects the volume
+					uint8 exportInfo[10 + 124];
+					Memory::Zero (exportInfo, sizeof (exportInfo));
+					nbd_put64 (exportInfo, MountedVolume->GetSize());
+					nbd_put16 (exportInfo + 8, GetTransmissionFlags());
+
+					SendData (connection.Socket, exportInfo, connection.NoZeroes ? 10 : sizeof (exportInfo));
+				}
+				return true;
+
+			case NbdOptAbort:
+				SendOptionReply (connection, option, NbdRepAck);
+				return false;
+
+			case NbdOptList:
+				{
+					uint8 exportName[4];
+					nbd_put32 (exportName, 0);
+					SendOptionReply (connection, option, NbdRepServer, ConstBufferPtr (exportName, sizeof (exportName)));
+					SendOptionReply (connection, option, NbdRepAck);
+				}
+				break;
+
+			case NbdOptInfo:
+			case NbdOptGo:
+				{
+					if (optionSize < 6 || optionSize < 6 + (uint64) nbd_get32 (optionData.Ptr())
+						|| optionSize != 6 + nbd_get32 (optionData.Ptr()) + 2 * (uint64) nbd_get16 (optionData.Ptr() + 4 + nbd_get32 (optionData.Ptr())))
+					{
+						SendOptionReply (connection, option, NbdRepErrInvalid);
+						break;
+					}
+
+					SendExportInfo (connection, option);
+					SendOptionReply (connection, option, NbdRepAck);
+
+					if (option == NbdOptGo)
+						return true;
+				}
+				break;
+
+			case NbdOptStructuredReply:
+				if (optionSize != 0)
+				{
+					SendOptionReply (connection, option, NbdRepErrInvalid);
+					break;
+				}
+
+				connection.StructuredReplies = true;
+				SendOptionReply (connection, option, NbdRepAck);
+				break;
+
+			default:
+				SendOptionReply (connection, option, NbdRepErrUnsup);
+				break;
+			}
+		}
+	}
+
+	void NbdServer::ReapConnections (bool stopAll)
+	{
+		for (list < shared_ptr <Connection> >::iterator i = Connections.begin(); i != Connections.end();)
+		{
+			Connection &connection = **i;
+
+			if (stopAll)
+				shutdown (connection.Socket, SHUT_RDWR);
+
+			if (stopAll || connection.Finished)
+			{
+				connection.ConnectionThread.Join();
+				close (connection.Socket);
+				i = Connections.erase (i);
+			}
+			else
+				++i;
+		}
+	}
+
+	bool NbdServer::ReceiveData (int socket, void *data, size_t size)
+	{
+		uint8 *buffer = (uint8 *) data;
+		size_t received = 0;
+
+		while (received < size)
+		{
+			ssize_t result = recv (socket, buffer + received, size - received, 0);
+
+			if (result == -1 && errno == EINTR)
+				continue;
+
+			throw_sys_if (result == -1);
+
+			if (result == 0)
+			{
+				if (received == 0)
+					return false;
+
+				throw ParameterIncorrect (SRC_POS);
+			}
+
+			received += (size_t) result;
+		}
+
+		return true;
+	}
+
+	void NbdServer::Run ()
+	{
+		Poller poller (ListenSocket, StopPipe.PeekReadFD());
+
+		while (true)
+		{
+			list <int> readyDescriptors = poller.WaitForData();
+
+			if (find (readyDescriptors.begin(), readyDescriptors.end(), StopPipe.PeekReadFD()) != readyDescriptors.end())
+				break;
+
+			if (find (readyDescriptors.begin(), readyDescriptors.end(), ListenSocket) == readyDescriptors.end())
+				continue;
+
+			int clientSocket = accept (ListenSocket, nullptr, nullptr);
+			if (clientSocket == -1)
+			{
+				if (errno == EINTR || errno == ECONNABORTED)
+					continue;
+
+				throw SystemException (SRC_POS);
+			}
+
+			ReapConnections (false);
+
+			shared_ptr <Connection> connection (new Connection (*this, clientSocket));
+			Connections.push_back (connection);
+
+			try
+			{
+				connection->ConnectionThread.Start (ConnectionThreadProc, connection.get());
+			}
+			catch (...)
+			{
+				Connections.pop_back();
+				close (clientSocket);
+				throw;
+			}
+		}
+
+		ReapConnections (true);
+	}
+
+	void NbdServer::SendData (int socket, const void *data, size_t size)
+	{
+		const uint8 *buffer = (const uint8 *) data;
+		size_t sent = 0;
+
+		while (sent < size)
+		{
+			ssize_t result = send (socket, buffer + sent, size - sent, MSG_NOSIGNAL);
+
+			if (result == -1 && errno == EINTR)
+				continue;
+
+			throw_sys_if (result == -1);
+			sent += (size_t) result;
+		}
+	}
+
+	void NbdServer::SendExportInfo (Connection &connection, uint32 option)
+	{
+		uint8 exportInfo[12];
+		nbd_put16 (exportInfo, NbdInfoExport);
+		nbd_put64 (exportInfo + 2, MountedVolume->GetSize());
+		nbd_put16 (exportInfo + 10, GetTransmissionFlags());
+		SendOptionReply (connection, option, NbdRepInfo, ConstBufferPtr (exportInfo, sizeof (exportInfo)));
+
+		// Requests must be aligned to the sector size of the volume
+		uint32 sectorSize = (uint32) MountedVolume->GetSectorSize();
+
+		uint8 blockSizeInfo[14];
+		nbd_put16 (blockSizeInfo, NbdInfoBlockSize);
+		nbd_put32 (blockSizeInfo + 2, sectorSize);
+		nbd_put32 (blockSizeInfo + 6, sectorSize > 4096 ? sectorSize : 4096);
+		nbd_put32 (blockSizeInfo + 10, MaxRequestSize);
+		SendOptionReply (connection, option, NbdRepInfo, ConstBufferPtr (blockSizeInfo, sizeof (blockSizeInfo)));
+	}
+
+	void NbdServer::SendOptionReply (Connection &connection, uint32 option, uint32 type, const ConstBufferPtr &data)
+	{
+		uint8 header[20];
+		nbd_put64 (header, NbdOptionReplyMagic);
+		nbd_put32 (header + 8, option);
+		nbd_put32 (header + 12, type);
+		nbd_put32 (header + 16, (uint32) data.Size());
+
+		SendData (connection.Socket, header, sizeof (header));
+		if (data.Size() > 0)
+			SendData (connection.Socket, data.Get(), data.Size());
+	}
+
+	void NbdServer::SendReply (Connection &connection, uint64 handle, uint64 offset, uint32 error, const ConstBufferPtr &data)
+	{
+		if (!connection.StructuredReplies)
+		{
+			uint8 header[16];
+			nbd_put32 (header, NbdSimpleReplyMagic);
+			nbd_put32 (header + 4, error);
+			nbd_put64 (header + 8, handle);
+
+			SendData (connection.Socket, header, sizeof (header));
+			if (error == 0 && data.Size() > 0)
+				SendData (connection.Socket, data.Get(), data.Size());
+			return;
+		}
+
+		uint8 header[20 + 8];
+		nbd_put32 (header, NbdStructuredReplyMagic);
+		nbd_put16 (header + 4, NbdReplyFlagDone);
+		nbd_put64 (header + 8, handle);
+
+		if (error != 0)
+		{
+			nbd_put16 (header + 6, NbdReplyTypeError);
+			nbd_put32 (header + 16, 6);
+			nbd_put32 (header + 20, error);
+			nbd_put16 (header + 24, 0);
+			SendData (connection.Socket, header, 26);
+		}
+		else if (data.Size() > 0)
+		{
+			nbd_put16 (header + 6, NbdReplyTypeOffsetData);
+			nbd_put32 (header + 16, (uint32) (8 + data.Size()));
+			nbd_put64 (header + 20, offset);
+			SendData (connection.Socket, header, 28);
+			SendData (connection.Socket, data.Get(), data.Size());
+		}
+		else
+		{
+			nbd_put16 (header + 6, NbdReplyTypeNone);
+			nbd_put32 (header + 16, 0);
+			SendData (connection.Socket, header, 20);
+		}
+	}
+
+	void NbdServer::Stop ()
+	{
+		// May be called by a signal handler
+		uint8 stop = 1;
+		if (write (StopPipe.PeekWriteFD(), &stop, sizeof (stop)) == -1) { } // Errors ignored
+	}
+
+	void NbdServer::Transmit (Connection &connection)
+	{
+		size_t defaultBufferSize = 1024 * 1024;
+		connection.RequestBuffer.Allocate (defaultBufferSize, MountedVolume->GetSectorSize());
+
+		while (true)
+		{
+			uint8 request[28];
+			if (!ReceiveData (connection.Socket, request, sizeof (request)))
+				return;
+
+			if (nbd_get32 (request) != NbdRequestMagic)
+				throw ParameterIncorrect (SRC_POS);
+
+			uint16 flags = nbd_get16 (request + 4);
+			uint16 type = nbd_get16 (request + 6);
+			uint64 handle = nbd_get64 (request + 8);
+			uint64 offset = nbd_get64 (request + 16);
+			uint32 length = nbd_get32 (request + 24);
+
+			if (type == NbdCmdDisconnect)
+				return;
+
+			bool payload = (type == NbdCmdRead || type == NbdCmdWrite);
+			if (payload && length > MaxRequestSize)
+				throw ParameterTooLarge (SRC_POS);
+
+			if (payload && length > connection.RequestBuffer.Size())
+			{
+				connection.RequestBuffer.Free();
+				connection.RequestBuffer.Allocate (length, MountedVolume->GetSectorSize());
+			}
+
+			if (type == NbdCmdWrite && length > 0 && !ReceiveData (connection.Socket, connection.RequestBuffer.Ptr(), length))
+				throw ParameterIncorrect (SRC_POS);
+
+			uint32 error = 0;
+			if (type == NbdCmdRead || type == NbdCmdWrite || type == NbdCmdTrim || type == NbdCmdWriteZeroes)
+				error = ValidateRange (offset, length, type != NbdCmdRead);
+
+			if (error == 0 && (length > 0 || type == NbdCmdFlush))
+				error = ExecuteRequest (connection, type, flags, offset, length);
+
+			if (type == NbdCmdRead)
+				SendReply (connection, handle, offset, error, connection.RequestBuffer.GetRange (0, length));
+			else
+				SendReply (connection, handle, offset, error);
+		}
+	}
+
+	uint32 NbdServer::ValidateRange (uint64 offset, uint32 length, bool write) const
+	{
+		if (write && MountedVolume->GetProtectionType() == VolumeProtection::ReadOnly)
+			return NbdEPerm;
+
+		uint64 sectorSize = MountedVolume->GetSectorSize();
+		if (offset % sectorSize != 0 || length % sectorSize != 0)
+			return NbdEInval;
+
+		if (offset > MountedVolume->GetSize() || length > MountedVolume->GetSize() - offset)
+			return write ? NbdENoSpc : NbdEInval;
+
+		return 0;
+	}
+}
@@ -0,0 +1,80 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Driver_Nbd_NbdServer
+#define TC_HEADER_Driver_Nbd_NbdServer
+
+#include <atomic>
+#include "Platform/Platform.h"
+#include "Platform/Unix/Pipe.h"
+#include "Volume/Volume.h"
+
+namespace VeraCrypt
+{
+	// Serves the decrypted sectors of an open volume to NBD clients (e.g. nbd-client, qemu)
+	// connecting to a local UNIX socket. Each connection is handled by its own thread; requests
+	// of a connection may be pipelined and are answered in order.
+	class NbdServer
+	{
+	public:
+		NbdServer (shared_ptr <Volume> volume, const FilePath &socketPath);
+		virtual ~NbdServer ();
+
+		const FilePath &GetSocketPath () const { return SocketPath; }
+		void Run ();
+		void Stop ();
+
+		static const uint32 MaxRequestSize = 32 * 1024 * 1024;
+
+	protected:
+		struct Connection
+		{
+			Connection (NbdServer &server, int socket) : Server (server), Socket (socket), Finished (false), NoZeroes (false), StructuredReplies (false) { }
+
+			NbdServer &Server;
+			int Socket;
+			atomic <bool> Finished;
+			bool NoZeroes;
+			bool StructuredReplies;
+			SecureBuffer RequestBuffer;
+			Thread ConnectionThread;
+
+		private:
+			Connection (const Connection &);
+			Connection &operator= (const Connection &);
+		};
+
+		static TC_THREAD_PROC ConnectionThreadProc (void *parameter);
+		static uint32 ExceptionToErrorCode ();
+		uint32 ExecuteRequest (Connection &connection, uint16 type, uint16 flags, uint64 offset, uint32 length);
+		uint16 GetTransmissionFlags () const;
+		void HandleConnection (Connection &connection);
+		bool Negotiate (Connection &connection);
+		void ReapConnections (bool stopAll);
+		static bool ReceiveData (int socket, void *data, size_t size);
+		static void SendData (int socket, const void *data, size_t size);
+		void SendExportInfo (Connection &connection, uint32 option);
+		void SendOptionReply (Connection &connection, uint32 option, uint32 type, const ConstBufferPtr &data = ConstBufferPtr());
+		void SendReply (Connection &connection, uint64 handle, uint64 offset, uint32 error, const ConstBufferPtr &data = ConstBufferPtr());
+		void Transmit (Connection &connection);
+		uint32 ValidateRange (uint64 offset, uint32 length, bool write) const;
+
+		list < shared_ptr <Connection> > Connections;
+		int ListenSocket;
+		shared_ptr <Volume> MountedVolume;
+		FilePath SocketPath;
+		Pipe StopPipe;
+
+	private:
+		NbdServer (const NbdServer &);
+		NbdServer &operator= (const NbdServer &);
+	};
+}
+
+#endif // TC_HEADER_Driver_Nbd_NbdServer
@@ -0,0 +1,415 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include "UblkService.h"
+
+#ifdef TC_LINUX
+#ifdef TC_UBLK_SUPPORTED
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <linux/ublk_cmd.h>
+#include "Platform/SystemLog.h"
+
+namespace VeraCrypt
+{
+	static const char *UblkControlDevicePath = "/dev/ublk-control";
+	static const size_t SubmissionEntrySize = 2 * sizeof (io_uring_sqe);	// IORING_SETUP_SQE128
+
+	void UblkService::CloseDevice ()
+	{
+		if (DeviceId != -1)
+		{
+			// Pending fetch commands of all queues are completed with UBLK_IO_RES_ABORT
+			try
+			{
+				ControlCommand (UBLK_CMD_STOP_DEV);
+			}
+			catch (exception &e)
+			{
+				SystemLog::WriteException (e);
+			}
+		}
+
+		foreach_ref (Queue &queue, Queues)
+		{
+			if (queue.ThreadStarted)
+				queue.QueueThread.Join();
+
+			if (queue.Descriptors)
+				munmap ((void *) queue.Descriptors, queue.DescriptorsSize);
+		}
+		Queues.clear();
+
+		if (CharDeviceFD != -1)
+		{
+			close (CharDeviceFD);
+			CharDeviceFD = -1;
+		}
+
+		if (DeviceId != -1)
+		{
+			try
+			{
+				ControlCommand (UBLK_CMD_DEL_DEV);
+			}
+			catch (exception &e)
+			{
+				SystemLog::WriteException (e);
+			}
+
+			DeviceId = -1;
+		}
+
+		ControlRing.reset();
+
+		if (ControlFD != -1)
+		{
+			close (ControlFD);
+			ControlFD = -1;
+		}
+
+		MountedVolume.reset();
+	}
+
+	void UblkService::ControlCommand (uint32 command, void *buffer, uint16 bufferSize, uint64 data)
+	{
+		io_uring_sqe *entry = ControlRing->GetSubmissionEntry();
+		if (!entry)
+			throw ParameterIncorrect (SRC_POS);
+
+		entry->opcode = IORING_OP_URING_CMD;
+		entry->fd = ControlFD;
+		entry->cmd_op = command;
+
+		ublksrv_ctrl_cmd *cmd = (ublksrv_ctrl_cmd *) entry->cmd;
+		cmd->dev_id = (uint32) DeviceId;
+		cmd->queue_id = (uint16) -1;
+		cmd->addr = (uint64) buffer;
+		cmd->len = bufferSize;
+		cmd->data[0] = data;
+
+		IoUringCompletion completion;
+		ControlRing->Submit (1);
+
+		if (ControlRing->GetCompletions (&completion, 1) != 1)
+			throw ParameterIncorrect (SRC_POS);
+
+		if (completion.Result < 0)
+			throw SystemException (SRC_POS, -completion.Result);
+	}
+
+	int UblkService::ExceptionToErrorCode ()
+	{
+		try
+		{
+			throw;
+		}
+		catch (std::bad_alloc&)
+		{
+			return -ENOMEM;
+		}
+		catch (VolumeProtected&)
+		{
+			return -EPERM;
+		}
+		catch (VolumeReadOnly&)
+		{
+			return -EPERM;
+		}
+		catch (SystemException &e)
+		{
+			SystemLog::WriteException (e);
+			return -static_cast <int> (e.GetErrorCode());
+		}
+		catch (std::exception &e)
+		{
+			SystemLog::WriteException (e);
+			return -EIO;
+		}
+		catch (...)
+		{
+			SystemLog::WriteException (UnknownException (SRC_POS));
+			return -EIO;
+		}
+	}
+
+	DevicePath UblkService::GetDevicePath ()
+	{
+		if (DeviceId == -1)
+			throw NotInitialized (SRC_POS);
+
+		return DevicePath (string ("/dev/ublkb") + StringConverter::ToSingle ((uint32) DeviceId));
+	}
+
+	int32 UblkService::HandleRequest (Queue &queue, uint16 tag)
+	{
+		const ublksrv_io_desc &desc = queue.Descriptors[tag];
+		uint64 byteOffset = desc.start_sector << 9;
+		size_t length = (size_t) desc.nr_sectors << 9;
+
+		try
+		{
+			switch (ublksrv_get_op (&desc))
+			{
+			case UBLK_IO_OP_READ:
+				MountedVolume->ReadSectors (queue.Buffers.GetRange ((size_t) tag * MaxRequestSize, length), byteOffset);
+				return (int32) length;
+
+			case UBLK_IO_OP_WRITE:
+				MountedVolume->WriteSectors (queue.Buffers.GetRange ((size_t) tag * MaxRequestSize, length), byteOffset);
+				return (int32) length;
+
+			case UBLK_IO_OP_FLUSH:
+				MountedVolume->GetFile()->Flush();
+				return 0;
+
+			default:
+				return -EOPNOTSUPP;
+			}
+		}
+		catch (...)
+		{
+			return ExceptionToErrorCode();
+		}
+	}
+
+	bool UblkService::IsAvailable ()
+	{
+		return IoUring::IsSupported() && access (UblkControlDevicePath, R_OK | W_OK) == 0;
+	}
+
+	TC_THREAD_PROC UblkService::QueueThreadProc (void *parameter)
+	{
+		Queue &queue = *reinterpret_cast <Queue *> (parameter);
+
+		try
+		{
+			IoUring ring (QueueDepth, IORING_SETUP_SQE128, SubmissionEntrySize);
+
+			for (uint16 tag = 0; tag < QueueDepth; ++tag)
+				SubmitIoCommand (ring, queue, UBLK_IO_FETCH_REQ, tag, -1);
+
+			ring.Submit();
+
+			queue.FetchSubmitted = true;
+			queue.FetchSubmittedEvent.Signal();
+
+			// Completed requests are committed together with the fetch of the next request
+			// of the same tag, so that each wait submits all commits of the previous batch
+			IoUringCompletion completions[QueueDepth];
+			size_t activeCount = QueueDepth;
+
+			while (activeCount > 0)
+			{
+				ring.Submit (1);
+				size_t completionCount = ring.GetCompletions (completions, QueueDepth);
+
+				for (size_t i = 0; i < completionCount; ++i)
+				{
+					uint16 tag = (uint16) completions[i].UserData;
+
+					if (completions[i].Result != UBLK_IO_RES_OK)
+					{
+						if (completions[i].Result != UBLK_IO_RES_ABORT)
+							SystemLog::WriteException (SystemException (SRC_POS, -completions[i].Result));
+
+						--activeCount;
+						continue;
+					}
+
+					SubmitIoCommand (ring, queue, UBLK_IO_COMMIT_AND_FETCH_REQ, tag, HandleRequest (queue, tag));
+				}
+			}
+		}
+		catch (exception &e)
+		{
+			SystemLog::WriteException (e);
+		}
+		catch (...)
+		{
+			SystemLog::WriteException (UnknownException (SRC_POS));
+		}
+
+		if (!queue.FetchSubmitted)
+			queue.FetchSubmittedEvent.Signal();
+
+		return 0;
+	}
+
+	DevicePath UblkService::Start (shared_ptr <Volume> volume)
+	{
+		ScopeLock lock (ServiceMutex);
+
+		if (DeviceId != -1)
+			return GetDevicePath();
+
+		if (!IsAvailable())
+			throw NotApplicable (SRC_POS);
+
+		try
+		{
+			MountedVolume = volume;
+
+			ControlFD = open (UblkControlDevicePath, O_RDWR | O_CLOEXEC);
+			throw_sys_sub_if (ControlFD == -1, UblkControlDevicePath);
+
+			ControlRing.reset (new IoUring (4, IORING_SETUP_SQE128, SubmissionEntrySize));
+
+			long cpuCount = sysconf (_SC_NPROCESSORS_ONLN);
+			uint16 queueCount = MaxQueueCount;
+			if (cpuCount > 0 && (uint32) cpuCount < MaxQueueCount)
+				queueCount = (uint16) cpuCount;
+
+			ublksrv_ctrl_dev_info devInfo;
+			Memory::Zero (&devInfo, sizeof (devInfo));
+			devInfo.nr_hw_queues = queueCount;
+			devInfo.queue_depth = QueueDepth;
+			devInfo.max_io_buf_bytes = MaxRequestSize;
+			devInfo.dev_id = (uint32) -1;
+			devInfo.ublksrv_pid = getpid();
+
+			ControlCommand (UBLK_CMD_ADD_DEV, &devInfo, sizeof (devInfo));
+			DeviceId = (int) devInfo.dev_id;
+
+			uint8 sectorSizeShift = 9;
+			while (((size_t) 1 << sectorSizeShift) < volume->GetSectorSize())
+				++sectorSizeShift;
+
+			ublk_params params;
+			Memory::Zero (&params, sizeof (params));
+			params.len = sizeof (params);
+			params.types = UBLK_PARAM_TYPE_BASIC;
+			params.basic.attrs = UBLK_ATTR_VOLATILE_CACHE;
+			if (volume->GetProtectionType() == VolumeProtection::ReadOnly)
+				params.basic.attrs |= UBLK_ATTR_READ_ONLY;
+			params.basic.logical_bs_shift = sectorSizeShift;
+			params.basic.physical_bs_shift = sectorSizeShift < 12 ? 12 : sectorSizeShift;
+			params.basic.io_min_shift = params.basic.physical_bs_shift;
+			params.basic.io_opt_shift = params.basic.physical_bs_shift;
+			params.basic.max_sectors = MaxRequestSize >> 9;
+			params.basic.dev_sectors = volume->GetSize() >> 9;
+
+			ControlCommand (UBLK_CMD_SET_PARAMS, &params, sizeof (params));
+
+			// The character device node is created asynchronously by udev
+			string charDevicePath = string ("/dev/ublkc") + StringConverter::ToSingle ((uint32) DeviceId);
+			for (int t = 0; CharDeviceFD == -1; t++)
+			{
+				CharDeviceFD = open (charDevicePath.c_str(), O_RDWR | O_CLOEXEC);
+				if (CharDeviceFD == -1)
+				{
+					throw_sys_sub_if (errno != ENOENT || t > 50, charDevicePath);
+					Thread::Sleep (100);
+				}
+			}
+
+			size_t pageSize = (size_t) sysconf (_SC_PAGESIZE);
+			for (uint16 queueId = 0; queueId < queueCount; ++queueId)
+			{
+				shared_ptr <Queue> queue (new Queue (queueId));
+				Queues.push_back (queue);
+
+				queue->DescriptorsSize = ((QueueDepth * sizeof (ublksrv_io_desc) + pageSize - 1) / pageSize) * pageSize;
+				off_t descriptorsOffset = UBLKSRV_CMD_BUF_OFFSET + (off_t) queueId * UBLK_MAX_QUEUE_DEPTH * sizeof (ublksrv_io_desc);
+
+				void *descriptors = mmap (nullptr, queue->DescriptorsSize, PROT_READ, MAP_SHARED | MAP_POPULATE, CharDeviceFD, descriptorsOffset);
+				throw_sys_sub_if (descriptors == MAP_FAILED, charDevicePath);
+				queue->Descriptors = (const ublksrv_io_desc *) descriptors;
+
+				queue->Buffers.Allocate ((size_t) QueueDepth * MaxRequestSize, pageSize);
+
+				queue->QueueThread.Start (QueueThreadProc, queue.get());
+				queue->ThreadStarted = true;
+			}
+
+			foreach_ref (Queue &queue, Queues)
+			{
+				queue.FetchSubmittedEvent.Wait();
+				if (!queue.FetchSubmitted)
+					throw ParameterIncorrect (SRC_POS);
+			}
+
+			// Waits until all queues have fetched their requests and adds the block device
+			ControlCommand (UBLK_CMD_START_DEV, nullptr, 0, (uint64) getpid());
+		}
+		catch (...)
+		{
+			CloseDevice();
+			throw;
+		}
+
+		return GetDevicePath();
+	}
+
+	void UblkService::Stop ()
+	{
+		ScopeLock lock (ServiceMutex);
+
+		if (ControlFD != -1)
+			CloseDevice();
+	}
+
+	void UblkService::SubmitIoCommand (IoUring &ring, const Queue &queue, uint32 command, uint16 tag, int32 result)
+	{
+		io_uring_sqe *entry = ring.GetSubmissionEntry();
+		if (!entry)
+			throw ParameterIncorrect (SRC_POS);
+
+		entry->opcode = IORING_OP_URING_CMD;
+		entry->fd = CharDeviceFD;
+		entry->cmd_op = command;
+		entry->user_data = tag;
+
+		ublksrv_io_cmd *cmd = (ublksrv_io_cmd *) entry->cmd;
+		cmd->q_id = queue.Id;
+		cmd->tag = tag;
+		cmd->result = result;
+		cmd->addr = (uint64) (queue.Buffers.Ptr() + (size_t) tag * MaxRequestSize);
+	}
+
+	int UblkService::CharDeviceFD = -1;
+	int UblkService::ControlFD = -1;
+	unique_ptr <IoUring> UblkService::ControlRing;
+	int UblkService::DeviceId = -1;
+	shared_ptr <Volume> UblkService::MountedVolume;
+	vector < shared_ptr <UblkService::Queue> > UblkService::Queues;
+	Mutex UblkService::ServiceMutex;
+}
+
+#else // TC_UBLK_SUPPORTED
+
+namespace VeraCrypt
+{
+	DevicePath UblkService::GetDevicePath ()
+	{
+		throw NotApplicable (SRC_POS);
+	}
+
+	bool UblkService::IsAvailable ()
+	{
+		return false;
+	}
+
+	DevicePath UblkService::Start (shared_ptr <Volume> volume)
+	{
+		throw NotApplicable (SRC_POS);
+	}
+
+	void UblkService::Stop ()
+	{
+	}
+
+	int UblkService::DeviceId = -1;
+}
+
+#endif // TC_UBLK_SUPPORTED
+#endif // TC_LINUX
@@ -0,0 +1,85 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Driver_Ublk_UblkService
+#define TC_HEADER_Driver_Ublk_UblkService
+
+#include "Platform/Platform.h"
+#include "Platform/Unix/IoUring.h"
+#include "Volume/Volume.h"
+
+#ifdef TC_LINUX
+
+// ublk commands (IORING_OP_URING_CMD on rings with 128-byte entries) require Linux 6.0 kernel headers
+#if defined (__has_include)
+#	if __has_include (<linux/ublk_cmd.h>)
+#		define TC_UBLK_SUPPORTED
+#	endif
+#endif
+
+struct ublksrv_io_desc;
+
+namespace VeraCrypt
+{
+	// Serves the decrypted sectors of an open volume as a ublk block device (/dev/ublkbN).
+	// Requests are fetched by one thread per hardware queue through io_uring commands and
+	// passed to Volume::ReadSectors() and Volume::WriteSectors() of the serving process.
+	class UblkService
+	{
+	public:
+		static DevicePath GetDevicePath ();
+		static bool IsAvailable ();
+		static bool IsRunning () { return DeviceId != -1; }
+		static DevicePath Start (shared_ptr <Volume> volume);
+		static void Stop ();
+
+		static const uint32 MaxQueueCount = 4;
+		static const uint32 MaxRequestSize = 512 * 1024;
+		static const uint16 QueueDepth = 32;
+
+	protected:
+		struct Queue
+		{
+			Queue (uint16 id) : Id (id), Descriptors (nullptr), DescriptorsSize (0), FetchSubmitted (false), ThreadStarted (false) { }
+
+			uint16 Id;
+			const ublksrv_io_desc *Descriptors;
+			size_t DescriptorsSize;
+			SecureBuffer Buffers;
+			bool FetchSubmitted;
+			SyncEvent FetchSubmittedEvent;
+			Thread QueueThread;
+			bool ThreadStarted;
+
+		private:
+			Queue (const Queue &);
+			Queue &operator= (const Queue &);
+		};
+
+		UblkService ();
+		static void CloseDevice ();
+		static void ControlCommand (uint32 command, void *buffer = nullptr, uint16 bufferSize = 0, uint64 data = 0);
+		static int ExceptionToErrorCode ();
+		static int32 HandleRequest (Queue &queue, uint16 tag);
+		static TC_THREAD_PROC QueueThreadProc (void *parameter);
+		static void SubmitIoCommand (IoUring &ring, const Queue &queue, uint32 command, uint16 tag, int32 result);
+
+		static int CharDeviceFD;
+		static int ControlFD;
+		static unique_ptr <IoUring> ControlRing;
+		static int DeviceId;
+		static shared_ptr <Volume> MountedVolume;
+		static vector < shared_ptr <Queue> > Queues;
+		static Mutex ServiceMutex;
+	};
+}
+
+#endif // TC_LINUX
+
+#endif // TC_HEADER_Driver_Ublk_UblkService
@@ -795,7 +795,7 @@ static BOOL CreatingHiddenSysVol (void)
 static const char *GetPimHelpStringId (int pkcs5Prf, BOOL systemEncryption)
 {
 #if !defined (WOLFCRYPT_BACKEND) && !defined (VC_DCS_DISABLE_ARGON2)
-	if (pkcs5Prf == ARGON2)
+	if (pkcs5Prf == ARGON2 || pkcs5Prf == ARGON2_P4)
 		return "PIM_ARGON2_HELP";
 #endif
 #ifndef WOLFCRYPT_BACKEND
@@ -4233,7 +4233,7 @@ BOOL CALLBACK PageDialogProc (HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
 
 					for (hid = FIRST_PRF_ID; hid <= LAST_PRF_ID; hid++)
 					{
-						if ((!HashIsDeprecated (hid)) && (bSystemIsGPT || HashForSystemEncryption (hid)) && (hid != ARGON2)) // We don't support Argon2 for system encryption
+						if ((!HashIsDeprecated (hid)) && (bSystemIsGPT || HashForSystemEncryption (hid)) && (hid != ARGON2) && (hid != ARGON2_P4)) // We don't support Argon2 for system encryption
 							AddComboPair (GetDlgItem (hwndDlg, IDC_COMBO_BOX_HASH_ALGO), get_kdf_name(hid), hid);
 					}
 				}
@@ -6025,7 +6025,7 @@ BOOL CALLBACK PageDialogProc (HWND hwndDlg, UINT uMsg, WPARAM wParam, LPARAM lPa
 				{
 					HWND hHashAlgoItem = GetDlgItem (hwndDlg, IDC_COMBO_BOX_HASH_ALGO);
 					int selectedAlgo = (int) SendMessage (hHashAlgoItem, CB_GETITEMDATA, SendMessage (hHashAlgoItem, CB_GETCURSEL, 0, 0), 0);
-					if ((!bSystemIsGPT && !HashForSystemEncryption(selectedAlgo)) || (selectedAlgo == ARGON2))
+					if ((!bSystemIsGPT && !HashForSystemEncryption(selectedAlgo)) || (selectedAlgo == ARGON2) || (selectedAlgo == ARGON2_P4))
 					{
 						hash_algo = DEFAULT_HASH_ALGORITHM_BOOT;
 						RandSetHashFunction (DEFAULT_HASH_ALGORITHM_BOOT);
@@ -9329,6 +9329,8 @@ void ExtractCommandLine (HWND hwndDlg, wchar_t *lpszCommandLine)
 							CmdVolumePkcs5 = BLAKE2S;
 						else if ((_wcsicmp(szTmp, L"argon2") == 0))
 							CmdVolumePkcs5 = ARGON2;
+						else if ((_wcsicmp(szTmp, L"argon2-p4") == 0))
+							CmdVolumePkcs5 = ARGON2_P4;
 						else
 						{
 							/* match using internal hash names */
@@ -111,6 +111,7 @@ static int MapHashAlgorithm(const wchar_t* hashName)
 	if (_wcsicmp(hashName, L"sha512") == 0) return SHA512;
 	if (_wcsicmp(hashName, L"argon2") == 0) return ARGON2;
 	if (_wcsicmp(hashName, L"argon2id") == 0) return ARGON2;
+	if (_wcsicmp(hashName, L"argon2-p4") == 0) return ARGON2_P4;
 	if (_wcsicmp(hashName, L"BLAKE2b") == 0) return ARGON2;
 	if (_wcsicmp(hashName, L"BLAKE2b-512") == 0) return ARGON2;
 	return 0; // Not found
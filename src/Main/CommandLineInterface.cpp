@@ -17,6 +17,7 @@
 #include "Application.h"
 #include "CommandLineInterface.h"
 #include "LanguageStrings.h"
+#include "Platform/TextReader.h"
 #include "UserInterfaceException.h"
 #include "Volume/Pkcs5Kdf.h"
 
@@ -73,6 +74,9 @@ namespace VeraCrypt
 		parser.AddOption (L"",  L"auto-mount",			_("Auto mount device-hosted/favorite volumes"));
 		parser.AddSwitch (L"",  L"backup-headers",		_("Backup volume headers"));
 		parser.AddSwitch (L"",  L"background-task",		_("Start Background Task"));
+		parser.AddSwitch (L"",	L"benchmark-header-trials",	_("Benchmark trials of wrong header keys"));
+		parser.AddSwitch (L"",	L"benchmark-io",		_("Benchmark file I/O engines"));
+		parser.AddSwitch (L"",	L"benchmark-thread-pool",	_("Benchmark the encryption thread pool"));
 #ifdef TC_WINDOWS
 		parser.AddSwitch (L"",  L"cache",				_("Cache passwords and keyfiles"));
 #endif
@@ -94,7 +98,11 @@ namespace VeraCrypt
 #if !defined(TC_WINDOWS) && !defined(TC_MACOSX)
 		parser.AddOption (L"",	L"fs-options",			_("Filesystem mount options"));
 #endif
+		parser.AddOption (L"",	L"fuse-max-threads",	_("Maximum number of FUSE service threads"));
+		parser.AddOption (L"",	L"fuse-options",		_("FUSE service request options"));
 		parser.AddOption (L"",	L"hash",				_("Header key derivation algorithm"));
+		parser.AddSwitch (L"",	L"header-hint-stats",	_("Display statistics of volume header hints"));
+		parser.AddOption (L"",	L"io-engine",			_("File I/O engine"));
 		parser.AddSwitch (L"h", L"help",				_("Display detailed command line help"), wxCMD_LINE_OPTION_HELP);
 		parser.AddSwitch (L"",	L"import-token-keyfiles", _("Import keyfiles to security token"));
 		parser.AddOption (L"k", L"keyfiles",			_("Keyfiles"));
@@ -104,6 +112,7 @@ namespace VeraCrypt
 		parser.AddSwitch (L"",	L"list-emvtoken-keyfiles",	_("List EMV token keyfiles"));
 		parser.AddSwitch (L"",	L"load-preferences",	_("Load user preferences"));
 		parser.AddSwitch (L"",	L"mount",				_("Mount volume interactively"));
+		parser.AddOption (L"",	L"mount-jobs",			_("Maximum number of volumes opened at the same time"));
 		parser.AddOption (L"m", L"mount-options",		_("VeraCrypt volume mount options"));
 		parser.AddOption (L"",	L"new-hash",			_("New header key derivation algorithm"));
 		parser.AddOption (L"",	L"new-keyfiles",		_("New keyfiles"));
@@ -119,8 +128,12 @@ namespace VeraCrypt
 		parser.AddOption (L"",	L"protection-password",	_("Password for protected hidden volume"));
 		parser.AddOption (L"",	L"protection-pim",		_("PIM for protected hidden volume"));
 		parser.AddOption (L"",	L"random-source",		_("Use file as source of random data"));
+		parser.AddOption (L"",	L"read-chunk-size",		_("Chunk size of pipelined reads in KiB"));
 		parser.AddSwitch (L"",  L"restore-headers",		_("Restore volume headers"));
 		parser.AddSwitch (L"",	L"save-preferences",	_("Save user preferences"));
+#ifdef TC_UNIX
+		parser.AddOption (L"",	L"serve-nbd",			_("Serve volume to NBD clients on UNIX socket"));
+#endif
 		parser.AddSwitch (L"",	L"quick",				_("Enable quick format"));
 		parser.AddOption (L"",	L"size",				_("Size in bytes"));
 		parser.AddOption (L"",	L"slot",				_("Volume slot number"));
@@ -130,8 +143,10 @@ namespace VeraCrypt
         parser.AddOption (L"",	L"token-pin",			_("Security token PIN"));
 		parser.AddSwitch (L"v", L"verbose",				_("Enable verbose output"));
 		parser.AddSwitch (L"",	L"version",				_("Display version information"));
+		parser.AddOption (L"",	L"volume-list",			_("File listing volumes to change"));
 		parser.AddSwitch (L"",	L"volume-properties",	_("Display volume properties"));
 		parser.AddOption (L"",	L"volume-type",			_("Volume type"));
+		parser.AddOption (L"",	L"worker-placement",	_("Placement policy of encryption threads"));
 		parser.AddParam (								_("Volume path"), wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
 		parser.AddParam (								_("Mount point"), wxCMD_LINE_VAL_STRING, wxCMD_LINE_PARAM_OPTIONAL);
 		parser.AddSwitch (L"",	L"no-size-check",		_("Disable check of container size against disk free space."));
@@ -223,6 +238,25 @@ namespace VeraCrypt
 			param1IsVolume = true;
 		}
 
+		if (parser.Found (L"benchmark-header-trials"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::BenchmarkHeaderTrials;
+		}
+
+		if (parser.Found (L"benchmark-io"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::BenchmarkIo;
+			param1IsFile = true;
+		}
+
+		if (parser.Found (L"benchmark-thread-pool"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::BenchmarkThreadPool;
+		}
+
 		if (parser.Found (L"change"))
 		{
 			CheckCommandSingle();
@@ -263,6 +297,12 @@ namespace VeraCrypt
 			ArgCommand = CommandId::ExportTokenKeyfile;
 		}
 
+		if (parser.Found (L"header-hint-stats"))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::DisplayHeaderHintStatistics;
+		}
+
 		if (parser.Found (L"import-token-keyfiles"))
 		{
 			CheckCommandSingle();
@@ -305,6 +345,19 @@ namespace VeraCrypt
 			ArgCommand = CommandId::SavePreferences;
 		}
 
+#ifdef TC_UNIX
+		if (parser.Found (L"serve-nbd", &str))
+		{
+			CheckCommandSingle();
+			ArgCommand = CommandId::ServeNbd;
+			param1IsVolume = true;
+
+			wxFileName socketPath (str);
+			socketPath.Normalize (wxPATH_NORM_ABSOLUTE | wxPATH_NORM_DOTS);
+			ArgNbdSocketPath.reset (new FilePath (wstring (socketPath.GetFullPath())));
+		}
+#endif
+
 		if (parser.Found (L"test"))
 		{
 			CheckCommandSingle();
@@ -442,6 +495,69 @@ namespace VeraCrypt
 			ArgMountOptions.FilesystemOptions = str;
 #endif
 
+		if (parser.Found (L"fuse-max-threads", &str))
+		{
+			try
+			{
+				ArgMountOptions.FuseMaxThreads = StringConverter::ToUInt32 (wstring (str));
+			}
+			catch (...)
+			{
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+			}
+		}
+
+		if (parser.Found (L"mount-jobs", &str))
+		{
+			try
+			{
+				ArgMountOptions.MountJobs = StringConverter::ToUInt32 (wstring (str));
+			}
+			catch (...)
+			{
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+			}
+		}
+
+		if (parser.Found (L"fuse-options", &str))
+		{
+			wxStringTokenizer tokenizer (str, L",");
+			while (tokenizer.HasMoreTokens())
+			{
+				wxString token = tokenizer.GetNextToken();
+
+				if (token.StartsWith (L"max_request="))
+				{
+					uint64 maxRequestSize = 0;
+					try
+					{
+						maxRequestSize = StringConverter::ToUInt64 (wstring (token.Mid (12))) * BYTES_PER_KB;
+					}
+					catch (...)
+					{
+						throw_err (LangString["PARAMETER_INCORRECT"] + L": " + token);
+					}
+
+					if (maxRequestSize > MountOptions::MaxFuseRequestSize)
+						throw_err (LangString["PARAMETER_INCORRECT"] + L": " + token);
+
+					ArgMountOptions.FuseMaxRequestSize = (uint32) maxRequestSize;
+				}
+				else if (token == L"splice")
+					ArgMountOptions.FuseSplice = true;
+				else if (token == L"nosplice")
+					ArgMountOptions.FuseSplice = false;
+				else if (token == L"writeback_cache")
+					ArgMountOptions.FuseWritebackCache = true;
+				else if (token == L"nowriteback_cache")
+					ArgMountOptions.FuseWritebackCache = false;
+				else
+				{
+					throw_err (LangString["UNKNOWN_OPTION"] + L": " + token);
+				}
+			}
+		}
+
 		if (parser.Found (L"hash", &str))
 		{
 			ArgHash = FindKdfAlgorithm (str);
@@ -481,6 +597,8 @@ namespace VeraCrypt
 #ifdef TC_LINUX
 				else if (token == L"kernelntfs" || token == L"kernel-ntfs")
 					ArgMountOptions.MountNtfsWithKernelDriver = true;
+				else if (token == L"ublk")
+					ArgMountOptions.UseUblk = true;
 #endif
 #ifdef TC_WINDOWS
 				else if (token == L"removable" || token == L"rm")
@@ -607,6 +725,18 @@ namespace VeraCrypt
 		if (parser.Found (L"random-source", &str))
 			ArgRandomSourcePath = FilesystemPath (str.wc_str());
 
+		if (parser.Found (L"read-chunk-size", &str))
+		{
+			try
+			{
+				ArgMountOptions.ReadChunkSize = StringConverter::ToUInt64 (wstring (str)) * BYTES_PER_KB;
+			}
+			catch (...)
+			{
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+			}
+		}
+
 		if (parser.Found (L"restore-headers"))
 		{
 			CheckCommandSingle();
@@ -688,6 +818,31 @@ namespace VeraCrypt
 		if (parser.Found (L"verbose"))
 			Preferences.Verbose = true;
 
+		if (parser.Found (L"volume-list", &str))
+		{
+			if (ArgCommand != CommandId::ChangePassword)
+				throw_err (L"--volume-list is supported only with --change");
+
+			TextReader reader (FilePath (str.wc_str()));
+			string line;
+
+			while (reader.ReadLine (line))
+			{
+				wxString volumePath (StringConverter::ToWide (line));
+				volumePath.Trim (true).Trim (false);
+
+				if (volumePath.empty())
+					continue;
+
+				wxFileName volPath (volumePath);
+				volPath.Normalize (wxPATH_NORM_ABSOLUTE | wxPATH_NORM_DOTS);
+				ArgVolumePaths.push_back (VolumePath (wstring (volPath.GetFullPath())));
+			}
+
+			if (ArgVolumePaths.empty())
+				throw_err (LangString["PARAMETER_INCORRECT"] + L": " + str);
+		}
+
 		if (parser.Found (L"volume-type", &str))
 		{
 			if (str.IsSameAs (L"normal", false))
@@ -698,6 +853,29 @@ namespace VeraCrypt
 				throw_err (LangString["UNKNOWN_OPTION"] + L": " + str);
 		}
 
+		if (parser.Found (L"io-engine", &str))
+		{
+			if (str.IsSameAs (L"blocking", false))
+				ArgMountOptions.IoEngine = FileIoEngine::Blocking;
+			else if (str.IsSameAs (L"io_uring", false))
+				ArgMountOptions.IoEngine = FileIoEngine::IoUring;
+			else
+				throw_err (LangString["UNKNOWN_OPTION"] + L": " + str);
+
+			// Also used by operations other than mounting (e.g. volume creation)
+			Preferences.DefaultMountOptions.IoEngine = ArgMountOptions.IoEngine;
+		}
+
+		if (parser.Found (L"worker-placement", &str))
+		{
+			if (str.IsSameAs (L"default", false))
+				ArgMountOptions.WorkerPlacement = EncryptionThreadPool::PlacementPolicy::Default;
+			else if (str.IsSameAs (L"numa", false))
+				ArgMountOptions.WorkerPlacement = EncryptionThreadPool::PlacementPolicy::NumaLocal;
+			else
+				throw_err (LangString["UNKNOWN_OPTION"] + L": " + str);
+		}
+
 		// Parameters
 		if (parser.GetParamCount() > 0)
 		{
@@ -33,11 +33,15 @@ namespace VeraCrypt
 			AutoMountDevicesFavorites,
 			AutoMountFavorites,
 			BackupHeaders,
+			BenchmarkHeaderTrials,
+			BenchmarkIo,
+			BenchmarkThreadPool,
 			ChangePassword,
 			CreateKeyfile,
 			CreateVolume,
 			DeleteSecurityTokenKeyfiles,
 			DismountVolumes,
+			DisplayHeaderHintStatistics,
 			DisplayVersion,
 			DisplayVolumeProperties,
 			ExportTokenKeyfile,
@@ -50,6 +54,7 @@ namespace VeraCrypt
 			MountVolume,
 			RestoreHeaders,
 			SavePreferences,
+			ServeNbd,
 			Test
 		};
 	};
@@ -78,6 +83,9 @@ namespace VeraCrypt
 		shared_ptr <KeyfileList> ArgNewKeyfiles;
 		shared_ptr <VolumePassword> ArgNewPassword;
 		int ArgNewPim;
+#ifdef TC_UNIX
+		shared_ptr <FilePath> ArgNbdSocketPath;
+#endif
 		bool ArgNoHiddenVolumeProtection;
 		shared_ptr <VolumePassword> ArgPassword;
 		int ArgPim;
@@ -85,6 +93,7 @@ namespace VeraCrypt
 		FilesystemPath ArgRandomSourcePath;
 		uint64 ArgSize;
 		shared_ptr <VolumePath> ArgVolumePath;
+		VolumePathList ArgVolumePaths;
 		VolumeInfoList ArgVolumes;
 		VolumeType::Enum ArgVolumeType;
         shared_ptr<SecureBuffer> ArgTokenPin;
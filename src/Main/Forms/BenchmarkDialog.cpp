@@ -12,6 +12,7 @@
 
 #include "System.h"
 #include "Volume/EncryptionModeXTS.h"
+#include "Volume/EncryptionThreadPool.h"
 #ifdef WOLFCRYPT_BACKEND
 #include "Volume/EncryptionModeWolfCryptXTS.h"
 #endif
@@ -202,6 +203,13 @@ namespace VeraCrypt
 		{
 			if (opIndex == 0)
 			{
+				// Per-node throughput of the encryption thread pool is measured over the timed runs of all algorithms
+				vector <EncryptionThreadPool::NodeStatistics> nodeStatistics = EncryptionThreadPool::GetNodeStatistics();
+				vector <uint64> nodeEncryptedBytes (nodeStatistics.size());
+				vector <uint64> nodeDecryptedBytes (nodeStatistics.size());
+				uint64 totalEncryptionTime = 0;
+				uint64 totalDecryptionTime = 0;
+
 				EncryptionAlgorithmList encryptionAlgorithms = EncryptionAlgorithm::GetAvailableAlgorithms();
 				foreach (shared_ptr <EncryptionAlgorithm> ea, encryptionAlgorithms)
 				{
@@ -232,6 +240,7 @@ namespace VeraCrypt
 
 						uint64 size = 0;
 						uint64 time;
+						vector <EncryptionThreadPool::NodeStatistics> statisticsBefore = EncryptionThreadPool::GetNodeStatistics();
 						startTime = wxGetLocalTimeMillis();
 
 						do
@@ -243,6 +252,7 @@ namespace VeraCrypt
 						while (time < 100);
 
 						result.EncryptionSpeed = size * 1000 / time;
+						totalEncryptionTime += time;
 
 						startTime = wxGetLocalTimeMillis();
 						size = 0;
@@ -256,6 +266,14 @@ namespace VeraCrypt
 						while (time < 100);
 
 						result.DecryptionSpeed = size * 1000 / time;
+						totalDecryptionTime += time;
+
+						vector <EncryptionThreadPool::NodeStatistics> statisticsAfter = EncryptionThreadPool::GetNodeStatistics();
+						for (size_t i = 0; i < nodeStatistics.size() && i < statisticsBefore.size() && i < statisticsAfter.size(); ++i)
+						{
+							nodeEncryptedBytes[i] += statisticsAfter[i].EncryptedByteCount - statisticsBefore[i].EncryptedByteCount;
+							nodeDecryptedBytes[i] += statisticsAfter[i].DecryptedByteCount - statisticsBefore[i].DecryptedByteCount;
+						}
 						result.MeanSpeed = (result.EncryptionSpeed + result.DecryptionSpeed) / 2;
 
 						bool inserted = false;
@@ -273,6 +291,20 @@ namespace VeraCrypt
 							results.push_back (result);
 					}
 				}
+
+				if (nodeStatistics.size() > 1 && totalEncryptionTime > 0 && totalDecryptionTime > 0)
+				{
+					for (size_t i = 0; i < nodeStatistics.size(); ++i)
+					{
+						BenchmarkResult result;
+						result.AlgorithmName = L"NUMA node " + StringConverter::ToWide (nodeStatistics[i].NodeId) + L" (" + StringConverter::ToWide ((uint64) nodeStatistics[i].WorkerCount) + L" threads)";
+						result.EncryptionSpeed = nodeEncryptedBytes[i] * 1000 / totalEncryptionTime;
+						result.DecryptionSpeed = nodeDecryptedBytes[i] * 1000 / totalDecryptionTime;
+						result.MeanSpeed = (result.EncryptionSpeed + result.DecryptionSpeed) / 2;
+
+						results.push_back (result);
+					}
+				}
 			}
 			else if (opIndex == 1)
 			{
@@ -25,6 +25,7 @@
 #endif
 
 #include "Common/SecurityToken.h"
+#include "Platform/FileIoBatch.h"
 #include "Application.h"
 #include "GraphicUserInterface.h"
 #include "FatalErrorHandler.h"
@@ -448,12 +449,11 @@ namespace VeraCrypt
 
 			ExecuteWaitThreadRoutine (parent, &routine);
 
-			backupFile.Write (newHeaderBuffer);
-
+			SecureBuffer newHiddenHeaderBuffer (newHeaderBuffer.Size());
 			if (hiddenVolume)
 			{
 				// Re-encrypt hidden volume header
-				ReEncryptHeaderThreadRoutine hiddenRoutine(newHeaderBuffer, hiddenVolume->GetHeader(), hiddenVolumeMountOptions.Password, hiddenVolumeMountOptions.Pim, hiddenVolumeMountOptions.Keyfiles, hiddenVolumeMountOptions.EMVSupportEnabled);
+				ReEncryptHeaderThreadRoutine hiddenRoutine(newHiddenHeaderBuffer, hiddenVolume->GetHeader(), hiddenVolumeMountOptions.Password, hiddenVolumeMountOptions.Pim, hiddenVolumeMountOptions.Keyfiles, hiddenVolumeMountOptions.EMVSupportEnabled);
 
 				ExecuteWaitThreadRoutine (parent, &hiddenRoutine);
 			}
@@ -462,10 +462,14 @@ namespace VeraCrypt
 				// Store random data in place of hidden volume header
 				shared_ptr <EncryptionAlgorithm> ea = normalVolume->GetEncryptionAlgorithm();
 				Core->RandomizeEncryptionAlgorithmKey (ea);
-				ea->Encrypt (newHeaderBuffer);
+				ea->Encrypt (newHiddenHeaderBuffer);
 			}
 
-			backupFile.Write (newHeaderBuffer);
+			FileIoBatch headerWrites (backupFile);
+			headerWrites.AddWrite (newHeaderBuffer, 0);
+			headerWrites.AddWrite (newHiddenHeaderBuffer, newHeaderBuffer.Size());
+			headerWrites.Submit();
+			headerWrites.WaitAll();
 		}
 
 		ShowWarning ("VOL_HEADER_BACKED_UP");
@@ -1806,31 +1810,28 @@ namespace VeraCrypt
 
 			ExecuteWaitThreadRoutine (parent, &routine);
 
-			// Write volume header
-			int headerOffset = decryptedLayout->GetHeaderOffset();
-			if (headerOffset >= 0)
-				volumeFile.SeekAt (headerOffset);
-			else
-				volumeFile.SeekEnd (headerOffset);
+			// Write volume header and backup volume header together
+			uint64 volumeFileLength = volumeFile.Length();
+			FileIoBatch headerWrites (volumeFile);
 
-			volumeFile.Write (newHeaderBuffer);
+			int headerOffset = decryptedLayout->GetHeaderOffset();
+			headerWrites.AddWrite (newHeaderBuffer, headerOffset >= 0 ? headerOffset : volumeFileLength + headerOffset);
 
+			SecureBuffer newBackupHeaderBuffer;
 			if (decryptedLayout->HasBackupHeader())
 			{
 				// Re-encrypt backup volume header
-				ReEncryptHeaderThreadRoutine backupRoutine(newHeaderBuffer, decryptedLayout->GetHeader(), options.Password, options.Pim, options.Keyfiles, options.EMVSupportEnabled);
+				newBackupHeaderBuffer.Allocate (newHeaderBuffer.Size());
+				ReEncryptHeaderThreadRoutine backupRoutine(newBackupHeaderBuffer, decryptedLayout->GetHeader(), options.Password, options.Pim, options.Keyfiles, options.EMVSupportEnabled);
 
 				ExecuteWaitThreadRoutine (parent, &backupRoutine);
 
-				// Write backup volume header
 				headerOffset = decryptedLayout->GetBackupHeaderOffset();
-				if (headerOffset >= 0)
-					volumeFile.SeekAt (headerOffset);
-				else
-					volumeFile.SeekEnd (headerOffset);
-
-				volumeFile.Write (newHeaderBuffer);
+				headerWrites.AddWrite (newBackupHeaderBuffer, headerOffset >= 0 ? headerOffset : volumeFileLength + headerOffset);
 			}
+
+			headerWrites.Submit();
+			headerWrites.WaitAll();
 		}
 
 		ShowInfo ("VOL_HEADER_RESTORED");
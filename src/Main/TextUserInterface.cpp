@@ -25,6 +25,7 @@
 #include "Common/SecurityToken.h"
 #include "Common/EMVToken.h"
 #include "Core/RandomNumberGenerator.h"
+#include "Platform/FileIoBatch.h"
 #include "Application.h"
 #ifdef TC_MACOSX
 #include "Main/MacOSXFormatterDevice.h"
@@ -466,22 +467,25 @@ namespace VeraCrypt
 		SecureBuffer newHeaderBuffer (normalVolume->GetLayout()->GetHeaderSize());
 		Core->ReEncryptVolumeHeaderWithNewSalt (newHeaderBuffer, normalVolume->GetHeader(), normalVolumeMountOptions.Password, normalVolumeMountOptions.Pim, normalVolumeMountOptions.Keyfiles, normalVolumeMountOptions.EMVSupportEnabled);
 
-		backupFile.Write (newHeaderBuffer);
-
+		SecureBuffer newHiddenHeaderBuffer (newHeaderBuffer.Size());
 		if (hiddenVolume)
 		{
 			// Re-encrypt hidden volume header
-			Core->ReEncryptVolumeHeaderWithNewSalt (newHeaderBuffer, hiddenVolume->GetHeader(), hiddenVolumeMountOptions.Password, hiddenVolumeMountOptions.Pim, hiddenVolumeMountOptions.Keyfiles, hiddenVolumeMountOptions.EMVSupportEnabled);
+			Core->ReEncryptVolumeHeaderWithNewSalt (newHiddenHeaderBuffer, hiddenVolume->GetHeader(), hiddenVolumeMountOptions.Password, hiddenVolumeMountOptions.Pim, hiddenVolumeMountOptions.Keyfiles, hiddenVolumeMountOptions.EMVSupportEnabled);
 		}
 		else
 		{
 			// Store random data in place of hidden volume header
 			shared_ptr <EncryptionAlgorithm> ea = normalVolume->GetEncryptionAlgorithm();
 			Core->RandomizeEncryptionAlgorithmKey (ea);
-			ea->Encrypt (newHeaderBuffer);
+			ea->Encrypt (newHiddenHeaderBuffer);
 		}
 
-		backupFile.Write (newHeaderBuffer);
+		FileIoBatch headerWrites (backupFile);
+		headerWrites.AddWrite (newHeaderBuffer, 0);
+		headerWrites.AddWrite (newHiddenHeaderBuffer, newHeaderBuffer.Size());
+		headerWrites.Submit();
+		headerWrites.WaitAll();
 
 		ShowString (L"\n");
 		ShowInfo ("VOL_HEADER_BACKED_UP");
@@ -1851,29 +1855,26 @@ namespace VeraCrypt
 			SecureBuffer newHeaderBuffer (decryptedLayout->GetHeaderSize());
 			Core->ReEncryptVolumeHeaderWithNewSalt (newHeaderBuffer, decryptedLayout->GetHeader(), options.Password, options.Pim, options.Keyfiles, options.EMVSupportEnabled);
 
-			// Write volume header
-			int headerOffset = decryptedLayout->GetHeaderOffset();
-			if (headerOffset >= 0)
-				volumeFile.SeekAt (headerOffset);
-			else
-				volumeFile.SeekEnd (headerOffset);
+			// Write volume header and backup volume header together
+			uint64 volumeFileLength = volumeFile.Length();
+			FileIoBatch headerWrites (volumeFile);
 
-			volumeFile.Write (newHeaderBuffer);
+			int headerOffset = decryptedLayout->GetHeaderOffset();
+			headerWrites.AddWrite (newHeaderBuffer, headerOffset >= 0 ? headerOffset : volumeFileLength + headerOffset);
 
+			SecureBuffer newBackupHeaderBuffer;
 			if (decryptedLayout->HasBackupHeader())
 			{
 				// Re-encrypt backup volume header
-				Core->ReEncryptVolumeHeaderWithNewSalt (newHeaderBuffer, decryptedLayout->GetHeader(), options.Password, options.Pim, options.Keyfiles, options.EMVSupportEnabled);
+				newBackupHeaderBuffer.Allocate (newHeaderBuffer.Size());
+				Core->ReEncryptVolumeHeaderWithNewSalt (newBackupHeaderBuffer, decryptedLayout->GetHeader(), options.Password, options.Pim, options.Keyfiles, options.EMVSupportEnabled);
 
-				// Write backup volume header
 				headerOffset = decryptedLayout->GetBackupHeaderOffset();
-				if (headerOffset >= 0)
-					volumeFile.SeekAt (headerOffset);
-				else
-					volumeFile.SeekEnd (headerOffset);
-
-				volumeFile.Write (newHeaderBuffer);
+				headerWrites.AddWrite (newBackupHeaderBuffer, headerOffset >= 0 ? headerOffset : volumeFileLength + headerOffset);
 			}
+
+			headerWrites.Submit();
+			headerWrites.WaitAll();
 		}
 
 		ShowString (L"\n");
@@ -1885,6 +1886,58 @@ namespace VeraCrypt
 		}
 	}
 
+#ifdef TC_UNIX
+	void TextUserInterface::ServeVolumeOverNbd (MountOptions &options, const FilePath &socketPath) const
+	{
+		// Volume path
+		while (!options.Path || options.Path->IsEmpty())
+		{
+			if (Preferences.NonInteractive)
+				throw MissingArgument (SRC_POS);
+
+			options.Path = AskVolumePath ();
+		}
+
+		if (Core->IsVolumeMounted (*options.Path))
+			throw VolumeAlreadyMounted (SRC_POS);
+
+		options.EMVSupportEnabled = true;
+
+		while (true)
+		{
+			if (!Preferences.NonInteractive)
+			{
+				// Password
+				if (!options.Password)
+					options.Password = AskPassword (StringFormatter (_("Enter password for {0}"), wstring (*options.Path)));
+
+				if (options.Pim < 0)
+					options.Pim = AskPim (StringFormatter (_("Enter PIM for {0}"), wstring (*options.Path)));
+
+				// Keyfiles
+				if (!options.Keyfiles)
+					options.Keyfiles = AskKeyfiles();
+			}
+
+			try
+			{
+				UserInterface::ServeVolumeOverNbd (options, socketPath);
+				return;
+			}
+			catch (PasswordException &e)
+			{
+				if (Preferences.NonInteractive)
+					throw;
+
+				ShowInfo (e);
+				options.Password.reset();
+				options.Pim = -1;
+				ShowString (L"\n");
+			}
+		}
+	}
+#endif
+
 	void TextUserInterface::SetTerminalEcho (bool enable)
 	{
 		if (CmdLine->ArgDisplayPassword)
@@ -69,6 +69,9 @@ namespace VeraCrypt
 #endif
 		virtual int OnRun();
 		virtual void RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const;
+#ifdef TC_UNIX
+		virtual void ServeVolumeOverNbd (MountOptions &options, const FilePath &socketPath) const;
+#endif
 		static void SetTerminalEcho (bool enable);
 		virtual void UserEnrichRandomPool () const;
 		virtual void Yield () const { }
@@ -19,19 +19,27 @@
 #include <wx/apptrait.h>
 #include <wx/cmdline.h>
 #include "Crypto/cpu.h"
+#include "Platform/FileIoBatch.h"
 #include "Platform/PlatformTest.h"
 #include "Common/PCSCException.h"
 #ifdef TC_UNIX
 #include <errno.h>
+#include <signal.h>
+#include "Driver/Nbd/NbdServer.h"
 #include "Platform/Unix/Process.h"
 #endif
 #include "Platform/SystemInfo.h"
 #include "Platform/SystemException.h"
 #include "Common/SecurityToken.h"
 #include "Volume/EncryptionTest.h"
+#include "Volume/EncryptionThreadPool.h"
+#include "Volume/HeaderTrialBenchmark.h"
+#include "Volume/ThreadPoolBenchmark.h"
+#include "Volume/VolumeHeaderHintStore.h"
 #include "Application.h"
 #include "FavoriteVolume.h"
 #include "UserInterface.h"
+#include "VolumeHeaderHints.h"
 
 namespace VeraCrypt
 {
@@ -61,6 +69,104 @@ namespace VeraCrypt
 		catch (...) { }
 	}
 
+	void UserInterface::BenchmarkFileIo (const FilePath &filePath, uint64 dataSize) const
+	{
+		if (filePath.IsEmpty())
+			throw MissingArgument (SRC_POS);
+
+		if (filePath.IsFile() || filePath.IsDevice() || filePath.IsDirectory())
+			throw_err (wxString (L"File already exists: ") + wstring (filePath).c_str());
+
+		if (dataSize == 0)
+			dataSize = DefaultIoBenchmarkSize;
+
+		if (dataSize < FileIoBenchmark::SequentialRequestSize || dataSize == (uint64) -1)
+			throw_err (LangString["PARAMETER_INCORRECT"] + L": --size");
+
+		dataSize -= dataSize % FileIoBenchmark::SequentialRequestSize;
+
+		File benchmarkFile;
+		benchmarkFile.Open (filePath, File::CreateReadWrite);
+		finally_do_arg (FilePath, filePath, { finally_arg.Delete(); });
+
+		wxString report = wxString::Format (L"%-10s %14s %14s %14s %14s\n", L"Engine", L"Seq. read", L"Seq. write", L"4K read", L"4K write");
+
+		for (int engine = FileIoEngine::Blocking; engine <= FileIoEngine::IoUring; ++engine)
+		{
+			if (!FileIoBatch::IsEngineAvailable ((FileIoEngine::Enum) engine))
+				continue;
+
+			BusyScope busy (this);
+			FileIoBenchmark result = FileIoBenchmark::Run (benchmarkFile, dataSize, (FileIoEngine::Enum) engine);
+
+			report += wxString::Format (L"%-10s %14s %14s %14s %14s\n", FileIoBatch::GetEngineName (result.Engine).c_str(),
+				SpeedToString (result.SequentialReadSpeed).c_str(), SpeedToString (result.SequentialWriteSpeed).c_str(),
+				SpeedToString (result.RandomReadSpeed).c_str(), SpeedToString (result.RandomWriteSpeed).c_str());
+		}
+
+		ShowInfo (report);
+	}
+
+	void UserInterface::BenchmarkHeaderTrials () const
+	{
+		BusyScope busy (this);
+		HeaderTrialBenchmark result = HeaderTrialBenchmark::Run();
+
+		ShowInfo (wxString::Format (L"Wrong header key tried with %d algorithms: %.1f us full decryption, %.1f us first block only",
+			(int) result.AlgorithmCount, result.FullDecryptionTime / 1000.0, result.EarlyRejectTime / 1000.0));
+	}
+
+	void UserInterface::BenchmarkThreadPool () const
+	{
+		if (!EncryptionThreadPool::IsRunning())
+			throw_err (L"The encryption thread pool is not running.");
+
+		wxString report = wxString::Format (L"%-12s %14s %14s %8s\n", L"Submitters", L"Ring", L"Work stealing", L"Gain");
+		size_t submitterCounts[] = { 1, 4, 16 };
+
+		for (size_t i = 0; i < array_capacity (submitterCounts); ++i)
+		{
+			BusyScope busy (this);
+			ThreadPoolBenchmark result = ThreadPoolBenchmark::Run (submitterCounts[i]);
+
+			report += wxString::Format (L"%-12d %14s %14s %7.1f%%\n", (int) result.SubmitterCount,
+				SpeedToString (result.RingSpeed).c_str(), SpeedToString (result.WorkStealingSpeed).c_str(),
+				result.RingSpeed ? ((double) result.WorkStealingSpeed / result.RingSpeed - 1) * 100 : 0.0);
+		}
+
+		report += wxString::Format (L"\nAES-XTS, %d KiB requests, %d encryption threads\n", (int) (ThreadPoolBenchmark::DefaultRequestSize / 1024),
+			(int) EncryptionThreadPool::GetThreadCount());
+
+		ShowInfo (report);
+	}
+
+	void UserInterface::ChangePasswords (const VolumePathList &volumePaths, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> currentKdf, shared_ptr <KeyfileList> keyfiles, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, shared_ptr <Pkcs5Kdf> newKdf) const
+	{
+		// Credentials are not requested interactively, as they are shared by all volumes
+		if ((!password || password->IsEmpty()) && (!keyfiles || keyfiles->empty()))
+			throw MissingArgument (SRC_POS);
+
+		if ((!newPassword || newPassword->IsEmpty()) && (!newKeyfiles || newKeyfiles->empty()))
+			throw MissingArgument (SRC_POS);
+
+		// No header is changed unless all volumes can be opened
+		VolumeList volumes;
+
+		foreach_ref (const VolumePath &volumePath, volumePaths)
+		{
+			shared_ptr <Volume> volume = Core->OpenVolume (shared_ptr <VolumePath> (new VolumePath (volumePath)), Preferences.DefaultMountOptions.PreserveTimestamps, password, pim, currentKdf, keyfiles, Preferences.EMVSupportEnabled);
+
+			if (volume->IsMasterKeyVulnerable())
+				ShowWarning (StringFormatter (L"{0}:\n\n{1}", wstring (volumePath), LangString["ERR_XTS_MASTERKEY_VULNERABLE"]));
+
+			volumes.push_back (volume);
+		}
+
+		Core->ChangePasswords (volumes, newPassword, newPim, newKeyfiles, Preferences.EMVSupportEnabled, newKdf);
+
+		ShowInfo ("PASSWORD_CHANGED");
+	}
+
 	void UserInterface::CheckRequirementsForMountingVolume () const
 	{
 #ifdef TC_LINUX
@@ -294,6 +400,26 @@ namespace VeraCrypt
 			ShowInfo (message);
 	}
 
+	void UserInterface::DisplayHeaderHintStatistics () const
+	{
+		VolumeHeaderHintStore::Statistics statistics = VolumeHeaderHintStore::GetStatistics();
+		uint64 hintHits = statistics.HintedMounts - statistics.HintMisses;
+		wstringstream s;
+
+		s << L"Header hints: " << (VolumeHeaderHintStore::IsEnabled() ? L"enabled" : L"disabled (see preference SaveHeaderHints)") << L"\n";
+		s << L"Stored hints: " << VolumeHeaderHintStore::GetHints().size() << L"\n";
+		s << L"Hinted mounts: " << statistics.HintedMounts << L" (" << hintHits << L" hits, " << statistics.HintMisses << L" misses)\n";
+		s << L"Unhinted mounts: " << statistics.UnhintedMounts << L"\n";
+
+		if (statistics.HintedMounts > 0)
+			s << L"Mean hinted mount time: " << statistics.HintedMountTime / statistics.HintedMounts << L" ms\n";
+
+		if (statistics.UnhintedMounts > 0)
+			s << L"Mean unhinted mount time: " << statistics.UnhintedMountTime / statistics.UnhintedMounts << L" ms\n";
+
+		ShowString (s.str());
+	}
+
 	void UserInterface::DisplayVolumeProperties (const VolumeInfoList &volumes) const
 	{
 		if (volumes.size() < 1)
@@ -706,6 +832,30 @@ namespace VeraCrypt
 		foreach_ref (const VolumeInfo &v, Core->GetMountedVolumes())
 			mountedVolumes.insert (v.Path);
 
+		// Unless a single mount job is selected, headers of all devices are opened concurrently first
+		map <wstring, shared_ptr <MountResult> > batchResults;
+		if (options.MountJobs != 1)
+		{
+			MountOptionsList optionsList;
+			foreach_ref (const HostDevice &device, devices)
+			{
+				if (mountedVolumes.find (wstring (device.Path)) != mountedVolumes.end())
+					continue;
+
+				shared_ptr <MountOptions> deviceOptions (new MountOptions (options));
+				deviceOptions->MountPoint.reset (new DirectoryPath);
+				deviceOptions->Path.reset (new VolumePath (device.Path));
+				deviceOptions->SharedAccessAllowed = sharedAccessAllowed;
+				optionsList.push_back (deviceOptions);
+			}
+
+			MountResultList results = Core->MountVolumes (optionsList);
+
+			MountOptionsList::const_iterator deviceOptions = optionsList.begin();
+			for (MountResultList::const_iterator result = results.begin(); result != results.end() && deviceOptions != optionsList.end(); ++result, ++deviceOptions)
+				batchResults[wstring (*(*deviceOptions)->Path)] = *result;
+		}
+
 		bool protectedVolumeMounted = false;
 		bool legacyVolumeMounted = false;
 		bool vulnerableVolumeMounted = false;
@@ -724,8 +874,10 @@ namespace VeraCrypt
 			{
 				try
 				{
+					map <wstring, shared_ptr <MountResult> >::const_iterator batchResult = batchResults.find (wstring (device.Path));
+
 					options.SharedAccessAllowed = sharedAccessAllowed;
-					newMountedVolumes.push_back (Core->MountVolume (options));
+					newMountedVolumes.push_back (MountVolumeOrUseResult (options, batchResult != batchResults.end() ? batchResult->second : shared_ptr <MountResult> ()));
 				}
 				catch (VolumeHostInUse&)
 				{
@@ -792,10 +944,41 @@ namespace VeraCrypt
 	{
 		BusyScope busy (this);
 
+		FavoriteVolumeList favorites = FavoriteVolume::LoadList();
+
+		// Unless a single mount job is selected, headers of all favorites are opened concurrently first.
+		// Favorites that fail to mount are then handled one by one as before.
+		map <const FavoriteVolume *, shared_ptr <MountResult> > batchResults;
+		if (options.MountJobs != 1)
+		{
+			MountOptionsList optionsList;
+			list <const FavoriteVolume *> batchFavorites;
+
+			foreach_ref (const FavoriteVolume &favorite, favorites)
+			{
+				if (Core->IsVolumeMounted (favorite.Path))
+					continue;
+
+				shared_ptr <MountOptions> favoriteOptions (new MountOptions (options));
+				favorite.ToMountOptions (*favoriteOptions);
+				optionsList.push_back (favoriteOptions);
+				batchFavorites.push_back (&favorite);
+			}
+
+			MountResultList results = Core->MountVolumes (optionsList);
+
+			list <const FavoriteVolume *>::const_iterator favorite = batchFavorites.begin();
+			for (MountResultList::const_iterator result = results.begin(); result != results.end() && favorite != batchFavorites.end(); ++result, ++favorite)
+				batchResults[*favorite] = *result;
+		}
+
 		VolumeInfoList newMountedVolumes;
-		foreach_ref (const FavoriteVolume &favorite, FavoriteVolume::LoadList())
+		foreach_ref (const FavoriteVolume &favorite, favorites)
 		{
-			shared_ptr <VolumeInfo> mountedVolume = Core->GetMountedVolume (favorite.Path);
+			map <const FavoriteVolume *, shared_ptr <MountResult> >::const_iterator batchResultEntry = batchResults.find (&favorite);
+			shared_ptr <MountResult> batchResult = batchResultEntry != batchResults.end() ? batchResultEntry->second : shared_ptr <MountResult> ();
+
+			shared_ptr <VolumeInfo> mountedVolume = batchResult && batchResult->MountedVolume ? shared_ptr <VolumeInfo> () : Core->GetMountedVolume (favorite.Path);
 			if (mountedVolume)
 			{
 				if (mountedVolume->MountPoint != favorite.MountPoint)
@@ -809,7 +992,7 @@ namespace VeraCrypt
 			if (Preferences.NonInteractive)
 			{
 				BusyScope busy (this);
-				newMountedVolumes.push_back (Core->MountVolume (options));
+				newMountedVolumes.push_back (MountVolumeOrUseResult (options, batchResult));
 				mountPerformed = true;
 			}
 			else
@@ -817,7 +1000,7 @@ namespace VeraCrypt
 				try
 				{
 					BusyScope busy (this);
-					newMountedVolumes.push_back (Core->MountVolume (options));
+					newMountedVolumes.push_back (MountVolumeOrUseResult (options, batchResult));
 					mountPerformed = true;
 				}
 				catch (...)
@@ -893,6 +1076,17 @@ namespace VeraCrypt
 		return volume;
 	}
 
+	shared_ptr <VolumeInfo> UserInterface::MountVolumeOrUseResult (MountOptions &options, shared_ptr <MountResult> batchResult) const
+	{
+		if (!batchResult)
+			return Core->MountVolume (options);
+
+		if (batchResult->Error)
+			batchResult->Error->Throw();
+
+		return batchResult->MountedVolume;
+	}
+
 	void UserInterface::OnUnhandledException ()
 	{
 		try
@@ -919,6 +1113,9 @@ namespace VeraCrypt
 	{
 		shared_ptr <VolumeInfo> mountedVolume = (dynamic_cast <VolumeEventArgs &> (args)).mVolume;
 
+		if (Preferences.SaveHeaderHints)
+			VolumeHeaderHints::Save();
+
 		if (Preferences.OpenExplorerWindowAfterMount && !mountedVolume->MountPoint.IsEmpty())
 			OpenExplorerWindow (mountedVolume->MountPoint);
 	}
@@ -1204,7 +1401,25 @@ const FileManager fileManagers[] = {
 			BackupVolumeHeaders (cmdLine.ArgVolumePath);
 			return true;
 
+		case CommandId::BenchmarkHeaderTrials:
+			BenchmarkHeaderTrials();
+			return true;
+
+		case CommandId::BenchmarkIo:
+			BenchmarkFileIo (cmdLine.ArgFilePath ? *cmdLine.ArgFilePath : FilePath(), cmdLine.ArgSize);
+			return true;
+
+		case CommandId::BenchmarkThreadPool:
+			BenchmarkThreadPool();
+			return true;
+
 		case CommandId::ChangePassword:
+			if (!cmdLine.ArgVolumePaths.empty())
+			{
+				ChangePasswords (cmdLine.ArgVolumePaths, cmdLine.ArgPassword, cmdLine.ArgPim, cmdLine.ArgHash, cmdLine.ArgKeyfiles, cmdLine.ArgNewPassword, cmdLine.ArgNewPim, cmdLine.ArgNewKeyfiles, cmdLine.ArgNewHash);
+				return true;
+			}
+
 			ChangePassword (cmdLine.ArgVolumePath, cmdLine.ArgPassword, cmdLine.ArgPim, cmdLine.ArgHash, cmdLine.ArgKeyfiles, cmdLine.ArgNewPassword, cmdLine.ArgNewPim, cmdLine.ArgNewKeyfiles, cmdLine.ArgNewHash);
 			return true;
 
@@ -1250,6 +1465,10 @@ const FileManager fileManagers[] = {
 				);
 			return true;
 
+		case CommandId::DisplayHeaderHintStatistics:
+			DisplayHeaderHintStatistics();
+			return true;
+
 		case CommandId::DisplayVersion:
 			ShowString (Application::GetName() + L" " + StringConverter::ToWide (Version::String()) + L"\n");
 			return true;
@@ -1270,13 +1489,30 @@ const FileManager fileManagers[] = {
 					"Commands:\n"
 					"\n"
 					"--auto-mount=devices|favorites\n"
-					" Auto mount device-hosted or favorite volumes.\n"
+					" Auto mount device-hosted or favorite volumes. Headers of several volumes are\n"
+					" opened at the same time (see option --mount-jobs).\n"
 					"\n"
 					"--backup-headers [VOLUME_PATH]\n"
 					" Backup volume headers to a file. All required options are requested from the\n"
 					" user.\n"
 					"\n"
-					"-c, --create [VOLUME_PATH]\n"
+					"--benchmark-header-trials\n"
+					" Measure the time needed to try a wrong header key with all encryption\n"
+					" algorithms when each candidate decrypts the whole header and when candidates\n"
+					" are rejected by the first cipher block.\n"
+					"\n"
+					"--benchmark-io FILE_PATH\n"
+					" Measure random 4 KiB and sequential 1 MiB read and write throughput of the\n"
+					" available file I/O engines (see option --io-engine) using a new temporary\n"
+					" file FILE_PATH, which is deleted afterwards. The size of the file is 256 MiB\n"
+					" unless specified by option --size.\n"
+					"\n"
+					"--benchmark-thread-pool\n"
+					" Measure AES-XTS throughput of 64 KiB requests submitted concurrently by 1, 4\n"
+					" and 16 threads when they are processed by the work-stealing queues of the\n"
+					" encryption thread pool and by the single mutex-guarded ring of work items\n"
+					" used by earlier versions.\n"
+					"\n					"-c, --create [VOLUME_PATH]\n"
 					" Create a new volume. Most options are requested from the user if not specified\n"
 					" on command line. See also options --encryption, -k, --filesystem, --hash, -p,\n"
 					" --random-source, --quick, --size, --volume-type. Note that passing some of the\n"
@@ -1300,7 +1536,7 @@ const FileManager fileManagers[] = {
 					" Change a password and/or keyfile(s) of a volume. Most options are requested\n"
 					" from the user if not specified on command line. KDF hash\n"
 					" algorithm can be changed with option --hash. See also options -k,\n"
-					" --new-keyfiles, --new-password, -p, --random-source.\n"
+					" --new-keyfiles, --new-password, -p, --random-source, --volume-list.\n"
 					"\n"
 					"-u, --unmount [MOUNTED_VOLUME]\n"
 					" Unmount a mounted volume. If MOUNTED_VOLUME is not specified, all\n"
@@ -1312,6 +1548,17 @@ const FileManager fileManagers[] = {
 					"--export-token-keyfile\n"
 					" Export a keyfile from a token. See also command --list-token-keyfiles.\n"
 					"\n"
+					"--header-hint-stats\n"
+					" Display how often volumes were mounted with and without a header hint and\n"
+					" the mean time of these mounts. Volumes mounted together (e.g. by\n"
+					" --auto-mount) update hints but are not counted. Header hints are stored only if the\n"
+					" SaveHeaderHints preference is enabled. A hint records the header key\n"
+					" derivation algorithm and encryption algorithm that last opened the normal\n"
+					" volume header at a given path, which are then tried first. Mounts of hidden\n"
+					" volumes, mounts using backup headers and mounts with hidden volume\n"
+					" protection neither use nor update hints. Hints contain no secrets but\n"
+					" reveal which files and devices hold VeraCrypt volumes.\n"
+					"\n"
 					"--import-token-keyfiles\n"
 					" Import keyfiles to a security token. See also option --token-lib.\n"
 					"\n"
@@ -1342,6 +1589,15 @@ const FileManager fileManagers[] = {
 					"--save-preferences\n"
 					" Save user preferences.\n"
 					"\n"
+					"--serve-nbd=SOCKET [VOLUME_PATH]\n"
+					" Open a volume and serve its decrypted contents to NBD clients (e.g.\n"
+					" nbd-client, qemu-nbd) connecting to UNIX socket SOCKET until interrupted.\n"
+					" Multiple clients may connect at the same time. No filesystem is mounted.\n"
+					" The socket is accessible only to the current user. Password and other\n"
+					" options are requested from the user if not specified on command line.\n"
+					" Example: veracrypt -t --serve-nbd=/run/user/1000/vc.sock volume.hc\n"
+					"          nbd-client -unix /run/user/1000/vc.sock /dev/nbd0\n"
+					"\n"
 					"--test\n"
 					" Test internal algorithms used in the process of encryption and decryption.\n"
 					"\n"
@@ -1414,11 +1670,40 @@ const FileManager fileManagers[] = {
 					" command with option -o when a filesystem on a VeraCrypt volume is mounted.\n"
 					" This option is not available on some platforms.\n"
 					"\n"
+					"--fuse-max-threads=COUNT\n"
+					" Maximum number of threads serving requests to the FUSE service of a mounted\n"
+					" volume. More threads allow more concurrent random I/O requests of the loop\n"
+					" device. 0 selects the default of the FUSE library. This option requires\n"
+					" FUSE 3. With libfuse versions older than 3.12, it sets only the number of\n"
+					" idle threads kept alive, not the maximum number of threads. If it is not\n"
+					" specified, the FuseMaxThreads preference is used.\n"
+					"\n"
+					"--fuse-options=OPTION1[,OPTION2,...]\n"
+					" Tune requests to the FUSE service of a mounted volume. Supported options:\n"
+					" max_request=SIZE: Accept read and write requests of up to SIZE KiB (at most\n"
+					"  1024). Larger requests reduce the number of requests of big sequential\n"
+					"  transfers; sizes above 128 KiB require Linux 4.20 or later.\n"
+					" splice, nosplice: Use splice to move data between the kernel and the FUSE\n"
+					"  service where supported.\n"
+					" writeback_cache, nowriteback_cache: Let the kernel cache writes to the\n"
+					"  volume image (FUSE 3 only). Cached data is written when flushed by the\n"
+					"  kernel, so an unclean shutdown may lose more recent writes.\n"
+					" If an option is not specified, the corresponding preference is used.\n"
+					"\n"
 					"--hash=HASH\n"
 					" Use specified header key derivation algorithm when creating a new volume\n"
 					" or changing password and/or keyfiles. This option also specifies the\n"
 					" mixing hash of the random number generator.\n"
 					"\n"
+					"--io-engine=ENGINE\n"
+					" File I/O engine used to access volumes. ENGINE can be 'blocking' (each\n"
+					" request is performed by a separate system call) or 'io_uring' (on Linux,\n"
+					" multiple requests are submitted at once, which allows a volume to be\n"
+					" written while further data is being encrypted). If the selected engine is\n"
+					" not supported by the kernel, the blocking engine is used. If this option\n"
+					" is not specified, the IoEngine preference is used. See also option\n"
+					" --benchmark-io.\n"
+					"\n"
 					"-k, --keyfiles=KEYFILE1[,KEYFILE2,KEYFILE3,...]\n"
 					" Use specified keyfiles when mounting a volume or when changing password\n"
 					" and/or keyfiles. When a directory is specified, all files inside it will be\n"
@@ -1435,6 +1720,15 @@ const FileManager fileManagers[] = {
 					"--load-preferences\n"
 					" Load user preferences.\n"
 					"\n"
+					"--mount-jobs=COUNT\n"
+					" Maximum number of volumes whose headers are opened at the same time by\n"
+					" --auto-mount. Fewer volumes are opened at once if their header key\n"
+					" derivations (mainly Argon2) would need more than half of the physical memory.\n"
+					" Filesystems are mounted in the order of the volumes, so the slot numbers\n"
+					" assigned do not depend on which header is opened first. 0 selects the number\n"
+					" of CPUs and 1 mounts the volumes one by one. If this option is not\n"
+					" specified, the MountJobs preference is used.\n"
+					"\n"
 					"-m, --mount-options=OPTION1[,OPTION2,OPTION3,...]\n"
 					" Specifies comma-separated mount options for a VeraCrypt volume:\n"
 					"  headerbak: Use backup headers when mounting a volume.\n"
@@ -1448,6 +1742,10 @@ const FileManager fileManagers[] = {
 #ifdef TC_LINUX
 					"  kernelntfs: Use an available in-kernel NTFS driver when NTFS is\n"
 					"   detected and no filesystem type was supplied.\n"
+					"  ublk: Serve a volume that cannot be mapped by the kernel cryptographic\n"
+					"   services as a ublk block device instead of attaching the FUSE volume\n"
+					"   image to a loop device. Requires the ublk_drv kernel module; the loop\n"
+					"   device is used if ublk is not available.\n"
 #endif
 					" See also option --fs-options.\n"
 					"\n"
@@ -1505,6 +1803,12 @@ const FileManager fileManagers[] = {
 					" Use FILE as a source of random data (e.g., when creating a volume) instead\n"
 					" of requiring the user to type random characters.\n"
 					"\n"
+					"--read-chunk-size=SIZE\n"
+					" Split large reads from a mounted volume into chunks of SIZE KiB so that\n"
+					" a chunk is decrypted while the next one is being read. 0 disables\n"
+					" pipelined reads. If this option is not specified, the\n"
+					" PipelinedReadChunkSize preference is used, which is 0 by default.\n"
+					"\n"
 					"--slot=SLOT\n"
 					" Use specified slot number when mounting, unmounting, or listing a volume.\n"
 					"\n"
@@ -1521,6 +1825,13 @@ const FileManager fileManagers[] = {
 					"--token-lib=LIB_PATH\n"
 					" Use specified PKCS #11 security token library.\n"
 					"\n"
+					"--volume-list=FILE\n"
+					" Change the password and/or keyfiles of all volumes listed in FILE (one volume\n"
+					" path per line) with command --change. The volumes share the current and the\n"
+					" new password, PIM and keyfiles, which must be specified on the command line.\n"
+					" All volumes are opened before any header is changed, and the header keys of\n"
+					" all volumes are derived at the same time.\n"
+					"\n"
 					"--volume-type=TYPE\n"
 					" Use specified volume type when creating a new volume. TYPE can be 'normal'\n"
 					" or 'hidden'. See option -c for more information on creating hidden volumes.\n"
@@ -1528,6 +1839,15 @@ const FileManager fileManagers[] = {
 					"-v, --verbose\n"
 					" Enable verbose output.\n"
 					"\n"
+					"--worker-placement=POLICY\n"
+					" Placement of encryption threads when mounting a volume. POLICY can be\n"
+					" 'default' (threads may run on any CPU) or 'numa' (on Linux, threads are\n"
+					" pinned to NUMA nodes and each buffer is processed by threads running on\n"
+					" the node holding its memory). The policy is applied when the encryption\n"
+					" threads of a mounted volume start; threads already running keep their\n"
+					" placement. If this option is not specified, the WorkerPlacement\n"
+					" preference is used.\n"
+					"\n"
 					"\n"
 					"IMPORTANT:\n"
 					"\n"
@@ -1628,6 +1948,20 @@ const FileManager fileManagers[] = {
 			Preferences.Save();
 			return true;
 
+#ifdef TC_UNIX
+		case CommandId::ServeNbd:
+			cmdLine.ArgMountOptions.Path = cmdLine.ArgVolumePath;
+			cmdLine.ArgMountOptions.Password = cmdLine.ArgPassword;
+			cmdLine.ArgMountOptions.Pim = cmdLine.ArgPim;
+			cmdLine.ArgMountOptions.Keyfiles = cmdLine.ArgKeyfiles;
+			cmdLine.ArgMountOptions.SharedAccessAllowed = cmdLine.ArgForce;
+			if (cmdLine.ArgHash)
+				cmdLine.ArgMountOptions.Kdf = cmdLine.ArgHash;
+
+			ServeVolumeOverNbd (cmdLine.ArgMountOptions, *cmdLine.ArgNbdSocketPath);
+			return true;
+#endif
+
 		case CommandId::Test:
 			Test();
 			return true;
@@ -1639,11 +1973,116 @@ const FileManager fileManagers[] = {
 		return false;
 	}
 
+#ifdef TC_UNIX
+	static NbdServer *ActiveNbdServer = nullptr;
+
+	static void OnNbdServerStopSignal (int signal)
+	{
+		if (ActiveNbdServer)
+			ActiveNbdServer->Stop();
+	}
+
+	void UserInterface::ServeVolumeOverNbd (MountOptions &options, const FilePath &socketPath) const
+	{
+		if (!options.Path || options.Path->IsEmpty())
+			throw MissingArgument (SRC_POS);
+
+		Cipher::EnableHwSupport (!options.NoHardwareCrypto);
+		EncryptionThreadPool::SetPlacementPolicy (options.WorkerPlacement);
+		FileIoBatch::SetDefaultEngine (options.IoEngine);
+
+		shared_ptr <Volume> volume;
+
+		while (true)
+		{
+			try
+			{
+				volume = Core->OpenVolume (
+					options.Path,
+					options.PreserveTimestamps,
+					options.Password,
+					options.Pim,
+					options.Kdf,
+					options.Keyfiles,
+					options.EMVSupportEnabled,
+					options.Protection,
+					options.ProtectionPassword,
+					options.ProtectionPim,
+					options.ProtectionKdf,
+					options.ProtectionKeyfiles,
+					options.SharedAccessAllowed,
+					VolumeType::Unknown,
+					options.UseBackupHeaders,
+					options.PartitionInSystemEncryptionScope
+					);
+			}
+			catch (SystemException &e)
+			{
+				if (options.Protection != VolumeProtection::ReadOnly
+					&& (e.GetErrorCode() == EROFS || e.GetErrorCode() == EACCES || e.GetErrorCode() == EPERM))
+				{
+					// Read-only filesystem
+					options.Protection = VolumeProtection::ReadOnly;
+					continue;
+				}
+
+				throw;
+			}
+
+			break;
+		}
+
+		options.Password.reset();
+		volume->SetReadChunkSize ((size_t) options.ReadChunkSize);
+
+		if (GetPreferences().CloseSecurityTokenSessionsAfterMount)
+			SecurityToken::CloseAllSessions();
+
+		NbdServer server (volume, socketPath);
+
+		if (Preferences.Verbose)
+			ShowInfo (StringFormatter (_("Serving volume {0} to NBD clients on {1}."), wstring (*options.Path), wstring (socketPath)));
+
+		// The server runs until it is interrupted
+		struct sigaction action;
+		Memory::Zero (&action, sizeof (action));
+		action.sa_handler = OnNbdServerStopSignal;
+
+		struct sigaction ignoreAction;
+		Memory::Zero (&ignoreAction, sizeof (ignoreAction));
+		ignoreAction.sa_handler = SIG_IGN;
+
+		struct sigaction previousActions[4];
+		ActiveNbdServer = &server;
+
+		throw_sys_if (sigaction (SIGINT, &action, &previousActions[0]) == -1);
+		throw_sys_if (sigaction (SIGTERM, &action, &previousActions[1]) == -1);
+		throw_sys_if (sigaction (SIGHUP, &action, &previousActions[2]) == -1);
+		throw_sys_if (sigaction (SIGPIPE, &ignoreAction, &previousActions[3]) == -1);
+
+		finally_do_arg (struct sigaction *, previousActions,
+		{
+			sigaction (SIGINT, &finally_arg[0], nullptr);
+			sigaction (SIGTERM, &finally_arg[1], nullptr);
+			sigaction (SIGHUP, &finally_arg[2], nullptr);
+			sigaction (SIGPIPE, &finally_arg[3], nullptr);
+			ActiveNbdServer = nullptr;
+		});
+
+		server.Run();
+	}
+#endif
+
 	void UserInterface::SetPreferences (const UserPreferences &preferences)
 	{
 		Preferences = preferences;
 
 		Cipher::EnableHwSupport (!preferences.DefaultMountOptions.NoHardwareCrypto);
+		EncryptionThreadPool::SetPlacementPolicy (preferences.DefaultMountOptions.WorkerPlacement);
+		FileIoBatch::SetDefaultEngine (preferences.DefaultMountOptions.IoEngine);
+
+		if (preferences.SaveHeaderHints != VolumeHeaderHintStore::IsEnabled())
+			VolumeHeaderHints::Load (preferences.SaveHeaderHints);
 
 		PreferencesUpdatedEvent.Raise();
 	}
@@ -33,7 +33,11 @@ namespace VeraCrypt
 		virtual bool AskYesNo (const wxString &message, bool defaultYes = false, bool warning = false) const = 0;
 		virtual void BackupVolumeHeaders (shared_ptr <VolumePath> volumePath) const = 0;
 		virtual void BeginBusyState () const = 0;
+		virtual void BenchmarkFileIo (const FilePath &filePath, uint64 dataSize = 0) const;
+		virtual void BenchmarkHeaderTrials () const;
+		virtual void BenchmarkThreadPool () const;
 		virtual void ChangePassword (shared_ptr <VolumePath> volumePath = shared_ptr <VolumePath>(), shared_ptr <VolumePassword> password = shared_ptr <VolumePassword>(), int pim = 0, shared_ptr <Pkcs5Kdf> currentKdf = shared_ptr <Pkcs5Kdf>(), shared_ptr <KeyfileList> keyfiles = shared_ptr <KeyfileList>(), shared_ptr <VolumePassword> newPassword = shared_ptr <VolumePassword>(), int newPim = 0, shared_ptr <KeyfileList> newKeyfiles = shared_ptr <KeyfileList>(), shared_ptr <Pkcs5Kdf> newKdf = shared_ptr <Pkcs5Kdf>()) const = 0;
+		virtual void ChangePasswords (const VolumePathList &volumePaths, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> currentKdf, shared_ptr <KeyfileList> keyfiles, shared_ptr <VolumePassword> newPassword, int newPim, shared_ptr <KeyfileList> newKeyfiles, shared_ptr <Pkcs5Kdf> newKdf) const;
 		virtual void CheckRequirementsForMountingVolume () const;
 		virtual void CloseExplorerWindows (shared_ptr <VolumeInfo> mountedVolume) const;
 		virtual void CreateKeyfile (shared_ptr <FilePath> keyfilePath = shared_ptr <FilePath>()) const = 0;
@@ -42,6 +46,7 @@ namespace VeraCrypt
 		virtual void DismountAllVolumes (bool ignoreOpenFiles = false, bool interactive = true) const;
 		virtual void DismountVolume (shared_ptr <VolumeInfo> volume, bool ignoreOpenFiles = false, bool interactive = true) const;
 		virtual void DismountVolumes (VolumeInfoList volumes, bool ignoreOpenFiles = false, bool interactive = true, bool emergencyCleanup = false) const;
+		virtual void DisplayHeaderHintStatistics () const;
 		virtual void DisplayVolumeProperties (const VolumeInfoList &volumes) const;
 		virtual void DoShowError (const wxString &message) const = 0;
 		virtual void DoShowInfo (const wxString &message) const = 0;
@@ -65,6 +70,9 @@ namespace VeraCrypt
 		virtual VolumeInfoList MountAllFavoriteVolumes (MountOptions &options);
 		virtual void OpenExplorerWindow (const DirectoryPath &path);
 		virtual void RestoreVolumeHeaders (shared_ptr <VolumePath> volumePath) const = 0;
+#ifdef TC_UNIX
+		virtual void ServeVolumeOverNbd (MountOptions &options, const FilePath &socketPath) const;
+#endif
 		virtual void SetPreferences (const UserPreferences &preferences);
 		virtual void ShowError (const exception &ex) const;
 		virtual void ShowError (const char *langStringId) const { DoShowError (LangString[langStringId]); }
@@ -101,7 +109,10 @@ namespace VeraCrypt
 		static void ThrowException (Exception* ex);
 
 	protected:
+		static const uint64 DefaultIoBenchmarkSize = 256 * 1024 * 1024;
+
 		UserInterface ();
+		virtual shared_ptr <VolumeInfo> MountVolumeOrUseResult (MountOptions &options, shared_ptr <MountResult> batchResult) const;
 		virtual bool OnExceptionInMainLoop () { throw; }
 		virtual void OnUnhandledException ();
 		virtual void OnVolumeMounted (EventArgs &args);
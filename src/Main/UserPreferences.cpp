@@ -95,11 +95,19 @@ namespace VeraCrypt
 			TC_CONFIG_SET (BackgroundTaskEnabled);
 			if (configMap.count(L"FilesystemOptions") > 0) { SetValue (configMap[L"FilesystemOptions"], DefaultMountOptions.FilesystemOptions); configMap.erase (L"FilesystemOptions"); }
 			TC_CONFIG_SET (ForceAutoDismount);
+			int fuseMaxRequestSize = 0;
+			if (configMap.count(L"FuseMaxRequestSize") > 0) { SetValue (configMap[L"FuseMaxRequestSize"], fuseMaxRequestSize); configMap.erase (L"FuseMaxRequestSize"); }
+			DefaultMountOptions.FuseMaxRequestSize = (uint32) fuseMaxRequestSize;
+
+			if (configMap.count(L"FuseMaxThreads") > 0) { SetValue (configMap[L"FuseMaxThreads"], DefaultMountOptions.FuseMaxThreads); configMap.erase (L"FuseMaxThreads"); }
+			if (configMap.count(L"FuseSplice") > 0) { SetValue (configMap[L"FuseSplice"], DefaultMountOptions.FuseSplice); configMap.erase (L"FuseSplice"); }
+			if (configMap.count(L"FuseWritebackCache") > 0) { SetValue (configMap[L"FuseWritebackCache"], DefaultMountOptions.FuseWritebackCache); configMap.erase (L"FuseWritebackCache"); }
 			TC_CONFIG_SET (Language);
 			TC_CONFIG_SET (LastSelectedSlotNumber);
 			TC_CONFIG_SET (MaxVolumeIdleTime);
 			TC_CONFIG_SET (MountDevicesOnLogon);
 			TC_CONFIG_SET (MountFavoritesOnLogon);
+			if (configMap.count(L"MountJobs") > 0) { SetValue (configMap[L"MountJobs"], DefaultMountOptions.MountJobs); configMap.erase (L"MountJobs"); }
 
 			bool readOnly = false;
 			if (configMap.count(L"MountVolumesReadOnly") > 0) { SetValue (configMap[L"MountVolumesReadOnly"], readOnly); configMap.erase (L"MountVolumesReadOnly"); }
@@ -109,12 +117,15 @@ namespace VeraCrypt
 			if (configMap.count(L"MountNtfsWithKernelDriver") > 0) { SetValue (configMap[L"MountNtfsWithKernelDriver"], DefaultMountOptions.MountNtfsWithKernelDriver); configMap.erase (L"MountNtfsWithKernelDriver"); }
 			else if (configMap.count(L"MountNtfsWithNtfs3") > 0) { SetValue (configMap[L"MountNtfsWithNtfs3"], DefaultMountOptions.MountNtfsWithKernelDriver); }
 			configMap.erase (L"MountNtfsWithNtfs3");
+			if (configMap.count(L"UseUblk") > 0) { SetValue (configMap[L"UseUblk"], DefaultMountOptions.UseUblk); configMap.erase (L"UseUblk"); }
 #endif
 			if (configMap.count(L"MountVolumesRemovable") > 0) { SetValue (configMap[L"MountVolumesRemovable"], DefaultMountOptions.Removable); configMap.erase (L"MountVolumesRemovable"); }
 			if (configMap.count(L"NoHardwareCrypto") > 0) { SetValue (configMap[L"NoHardwareCrypto"], DefaultMountOptions.NoHardwareCrypto); configMap.erase (L"NoHardwareCrypto"); }
 			if (configMap.count(L"NoKernelCrypto") > 0) { SetValue (configMap[L"NoKernelCrypto"], DefaultMountOptions.NoKernelCrypto); configMap.erase (L"NoKernelCrypto"); }
 			TC_CONFIG_SET (OpenExplorerWindowAfterMount);
+			if (configMap.count(L"PipelinedReadChunkSize") > 0) { SetValue (configMap[L"PipelinedReadChunkSize"], DefaultMountOptions.ReadChunkSize); configMap.erase (L"PipelinedReadChunkSize"); }
 			if (configMap.count(L"PreserveTimestamps") > 0) { SetValue (configMap[L"PreserveTimestamps"], DefaultMountOptions.PreserveTimestamps); configMap.erase (L"PreserveTimestamps"); }
+			TC_CONFIG_SET (SaveHeaderHints);
 			TC_CONFIG_SET (SaveHistory);
 			if (configMap.count(L"SecurityTokenLibrary") > 0) { SetValue (configMap[L"SecurityTokenLibrary"], SecurityTokenModule); configMap.erase (L"SecurityTokenLibrary"); }
 			TC_CONFIG_SET (StartOnLogon);
@@ -122,6 +133,14 @@ namespace VeraCrypt
 			TC_CONFIG_SET (WipeCacheOnAutoDismount);
 			TC_CONFIG_SET (WipeCacheOnClose);
 
+			int ioEngine = FileIoEngine::Blocking;
+			if (configMap.count(L"IoEngine") > 0) { SetValue (configMap[L"IoEngine"], ioEngine); configMap.erase (L"IoEngine"); }
+			DefaultMountOptions.IoEngine = (ioEngine == FileIoEngine::IoUring) ? FileIoEngine::IoUring : FileIoEngine::Blocking;
+
+			int workerPlacement = EncryptionThreadPool::PlacementPolicy::Default;
+			if (configMap.count(L"WorkerPlacement") > 0) { SetValue (configMap[L"WorkerPlacement"], workerPlacement); configMap.erase (L"WorkerPlacement"); }
+			DefaultMountOptions.WorkerPlacement = (workerPlacement == EncryptionThreadPool::PlacementPolicy::NumaLocal) ? EncryptionThreadPool::PlacementPolicy::NumaLocal : EncryptionThreadPool::PlacementPolicy::Default;
+
 			wstring defaultPrf;
 			if (configMap.count(L"DefaultPRF") > 0) { SetValue (configMap[L"DefaultPRF"], defaultPrf); configMap.erase (L"DefaultPRF"); }
 
@@ -225,27 +244,37 @@ namespace VeraCrypt
 		TC_CONFIG_ADD (DisplayMessageAfterHotkeyDismount);
 		TC_CONFIG_ADD (BackgroundTaskEnabled);
 		formatter.AddEntry (L"FilesystemOptions", DefaultMountOptions.FilesystemOptions);
+		formatter.AddEntry (L"FuseMaxRequestSize", (int) DefaultMountOptions.FuseMaxRequestSize);
+		formatter.AddEntry (L"FuseMaxThreads", DefaultMountOptions.FuseMaxThreads);
+		formatter.AddEntry (L"FuseSplice", DefaultMountOptions.FuseSplice);
+		formatter.AddEntry (L"FuseWritebackCache", DefaultMountOptions.FuseWritebackCache);
 		TC_CONFIG_ADD (ForceAutoDismount);
+		formatter.AddEntry (L"IoEngine", (int) DefaultMountOptions.IoEngine);
 		TC_CONFIG_ADD (Language);
 		TC_CONFIG_ADD (LastSelectedSlotNumber);
 		TC_CONFIG_ADD (MaxVolumeIdleTime);
 		TC_CONFIG_ADD (MountDevicesOnLogon);
 		TC_CONFIG_ADD (MountFavoritesOnLogon);
+		formatter.AddEntry (L"MountJobs", DefaultMountOptions.MountJobs);
 		formatter.AddEntry (L"MountVolumesReadOnly", DefaultMountOptions.Protection == VolumeProtection::ReadOnly);
 #ifdef TC_LINUX
 		formatter.AddEntry (L"MountNtfsWithKernelDriver", DefaultMountOptions.MountNtfsWithKernelDriver);
+		formatter.AddEntry (L"UseUblk", DefaultMountOptions.UseUblk);
 #endif
 		formatter.AddEntry (L"MountVolumesRemovable", DefaultMountOptions.Removable);
 		formatter.AddEntry (L"NoHardwareCrypto", DefaultMountOptions.NoHardwareCrypto);
 		formatter.AddEntry (L"NoKernelCrypto", DefaultMountOptions.NoKernelCrypto);
 		TC_CONFIG_ADD (OpenExplorerWindowAfterMount);
+		formatter.AddEntry (L"PipelinedReadChunkSize", DefaultMountOptions.ReadChunkSize);
 		formatter.AddEntry (L"PreserveTimestamps", DefaultMountOptions.PreserveTimestamps);
+		TC_CONFIG_ADD (SaveHeaderHints);
 		TC_CONFIG_ADD (SaveHistory);
 		formatter.AddEntry (L"SecurityTokenLibrary", wstring (SecurityTokenModule));
 		TC_CONFIG_ADD (StartOnLogon);
 		TC_CONFIG_ADD (UseKeyfiles);
 		TC_CONFIG_ADD (WipeCacheOnAutoDismount);
 		TC_CONFIG_ADD (WipeCacheOnClose);
+		formatter.AddEntry (L"WorkerPlacement", (int) DefaultMountOptions.WorkerPlacement);
 
 		wstring defaultPrf = L"autodetection";
 		if (DefaultMountOptions.Kdf)
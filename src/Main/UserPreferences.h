@@ -48,6 +48,7 @@ namespace VeraCrypt
 			NonInteractive (false),
 			UseStandardInput (false),
 			OpenExplorerWindowAfterMount (false),
+			SaveHeaderHints (false),
 			SaveHistory (false),
 			StartOnLogon (false),
 			UseKeyfiles (false),
@@ -92,6 +93,7 @@ namespace VeraCrypt
 		bool NonInteractive;
 		bool UseStandardInput;
 		bool OpenExplorerWindowAfterMount;
+		bool SaveHeaderHints;
 		bool SaveHistory;
 		FilePath SecurityTokenModule;
 		bool StartOnLogon;
@@ -0,0 +1,109 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#include "System.h"
+#include "Application.h"
+#include "Volume/VolumeHeaderHintStore.h"
+#include "VolumeHeaderHints.h"
+#include "Xml.h"
+
+namespace VeraCrypt
+{
+	void VolumeHeaderHints::Load (bool enabled)
+	{
+		ScopeLock lock (AccessMutex);
+		FilePath hintsCfgPath = Application::GetConfigFilePath (GetFileName());
+
+		VolumeHeaderHintStore::Enable (enabled);
+
+		if (!enabled)
+		{
+			VolumeHeaderHintStore::Clear();
+
+			if (hintsCfgPath.IsFile())
+				hintsCfgPath.Delete();
+
+			return;
+		}
+
+		VolumeHeaderHintMap hints;
+		VolumeHeaderHintStore::Statistics statistics;
+
+		if (hintsCfgPath.IsFile())
+		{
+			XmlParser parser (hintsCfgPath);
+
+			foreach (XmlNode node, parser.GetNodes (L"statistics"))
+			{
+#define TC_HINT_STATISTICS_GET(NAME) if (!wstring (node.Attributes[L###NAME]).empty()) statistics.NAME = StringConverter::ToUInt64 (wstring (node.Attributes[L###NAME]))
+
+				TC_HINT_STATISTICS_GET (HintedMounts);
+				TC_HINT_STATISTICS_GET (HintMisses);
+				TC_HINT_STATISTICS_GET (UnhintedMounts);
+				TC_HINT_STATISTICS_GET (HintedMountTime);
+				TC_HINT_STATISTICS_GET (UnhintedMountTime);
+			}
+
+			foreach (XmlNode node, parser.GetNodes (L"volume"))
+			{
+				// Hints stored with a header fingerprint by earlier versions may refer to hidden volume headers
+				if (!wstring (node.Attributes[L"fingerprint"]).empty())
+					continue;
+
+				VolumeHeaderHint hint;
+				hint.Pkcs5PrfName = wstring (node.Attributes[L"prf"]);
+				hint.EncryptionAlgorithmName = wstring (node.Attributes[L"ea"]);
+
+				if (!hint.IsEmpty() && hints.size() < VolumeHeaderHintStore::Capacity)
+					hints[wstring (node.InnerText)] = hint;
+			}
+		}
+
+		VolumeHeaderHintStore::SetHints (hints, statistics);
+	}
+
+	void VolumeHeaderHints::Save ()
+	{
+		ScopeLock lock (AccessMutex);
+
+		if (!VolumeHeaderHintStore::IsEnabled())
+			return;
+
+		FilePath hintsCfgPath = Application::GetConfigFilePath (GetFileName(), true);
+		VolumeHeaderHintStore::Statistics statistics = VolumeHeaderHintStore::GetStatistics();
+
+		XmlNode hintsXml (L"headerhints");
+		XmlNode statisticsNode (L"statistics");
+
+#define TC_HINT_STATISTICS_SET(NAME) statisticsNode.Attributes[L###NAME] = StringConverter::FromNumber (statistics.NAME)
+
+		TC_HINT_STATISTICS_SET (HintedMounts);
+		TC_HINT_STATISTICS_SET (HintMisses);
+		TC_HINT_STATISTICS_SET (UnhintedMounts);
+		TC_HINT_STATISTICS_SET (HintedMountTime);
+		TC_HINT_STATISTICS_SET (UnhintedMountTime);
+		hintsXml.InnerNodes.push_back (statisticsNode);
+
+		VolumeHeaderHintMap hints = VolumeHeaderHintStore::GetHints();
+		for (VolumeHeaderHintMap::const_iterator hint = hints.begin(); hint != hints.end(); ++hint)
+		{
+			XmlNode node (L"volume", hint->first);
+			node.Attributes[L"prf"] = hint->second.Pkcs5PrfName;
+			node.Attributes[L"ea"] = hint->second.EncryptionAlgorithmName;
+
+			hintsXml.InnerNodes.push_back (node);
+		}
+
+		XmlWriter hintsWriter (hintsCfgPath);
+		hintsWriter.WriteNode (hintsXml);
+		hintsWriter.Close();
+	}
+
+	Mutex VolumeHeaderHints::AccessMutex;
+}
@@ -0,0 +1,35 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#ifndef TC_HEADER_Main_VolumeHeaderHints
+#define TC_HEADER_Main_VolumeHeaderHints
+
+#include "System.h"
+#include "Main.h"
+
+namespace VeraCrypt
+{
+	// Persists the contents of VolumeHeaderHintStore while the SaveHeaderHints preference is enabled
+	class VolumeHeaderHints
+	{
+	public:
+		static void Load (bool enabled);
+		static void Save ();
+
+	protected:
+		static wxString GetFileName () { return L"Header Hints.xml"; }
+
+		static Mutex AccessMutex;
+
+	private:
+		VolumeHeaderHints ();
+	};
+}
+
+#endif // TC_HEADER_Main_VolumeHeaderHints
@@ -0,0 +1,45 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Platform_CpuTopology
+#define TC_HEADER_Platform_CpuTopology
+
+#include "PlatformBase.h"
+
+namespace VeraCrypt
+{
+	struct CpuTopologyNode
+	{
+		uint32 Id;
+		vector <uint32> Cpus;
+	};
+
+	typedef vector <CpuTopologyNode> CpuTopologyNodeList;
+
+	class CpuTopology
+	{
+	public:
+		// Returns NUMA nodes with at least one CPU usable by this process, ordered by node ID.
+		// An empty list means the topology is unknown.
+		static CpuTopologyNodeList GetNodes ();
+
+		// Returns the NUMA node holding the memory page at the specified address, or -1 if unknown.
+		static int GetMemoryNode (const void *address);
+
+		static bool SetCurrentThreadAffinity (const vector <uint32> &cpus);
+
+	protected:
+		CpuTopology ();
+
+		static vector <uint32> ParseCpuList (const string &cpuList);
+		static vector <uint32> ReadCpuList (const string &path);
+	};
+}
+
+#endif // TC_HEADER_Platform_CpuTopology
@@ -20,6 +20,8 @@
 
 namespace VeraCrypt
 {
+	class FileIoRingPool;
+
 	class File
 	{
 	public:
@@ -93,6 +95,8 @@ namespace VeraCrypt
 		void WriteAt (const ConstBufferPtr &buffer, uint64 position) const;
 
 	protected:
+		friend class FileIoBatch;
+
 		void ValidateState () const;
 
 		static const size_t OptimalReadSize = 256 * 1024;
@@ -109,6 +113,9 @@ namespace VeraCrypt
 		time_t AccTime;
 		time_t ModTime;
 #endif
+#ifdef TC_LINUX
+		mutable shared_ptr <FileIoRingPool> IoRingPool;	// io_uring instances with this file registered, created by FileIoBatch
+#endif
 
 	private:
 		File (const File &);
@@ -0,0 +1,167 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Platform_FileIoBatch
+#define TC_HEADER_Platform_FileIoBatch
+
+#include "PlatformBase.h"
+#include "Buffer.h"
+#include "File.h"
+#include "Mutex.h"
+
+#ifdef TC_LINUX
+#include "Unix/IoUring.h"
+#endif
+
+namespace VeraCrypt
+{
+	class FileIoRing;
+
+	struct FileIoEngine
+	{
+		enum Enum
+		{
+			Blocking,	// Each request is performed by pread()/pwrite() when it is waited for
+			IoUring		// Requests are submitted together to an io_uring instance (Linux)
+		};
+	};
+
+	// Read and write requests on a file which are submitted together and may complete in any order.
+	// Buffers must remain valid until their requests have been waited for. The destructor waits for
+	// requests in progress and discards requests which have not been started, so every request must
+	// be waited for. A batch must not be used by more than one thread at a time; concurrent batches
+	// on the same file are allowed.
+	class FileIoBatch
+	{
+	public:
+		FileIoBatch (const File &file, FileIoEngine::Enum engine = GetDefaultEngine());
+		virtual ~FileIoBatch ();
+
+		size_t AddRead (const BufferPtr &buffer, uint64 position);
+		size_t AddWrite (const ConstBufferPtr &buffer, uint64 position);
+		static FileIoEngine::Enum GetDefaultEngine () { return DefaultEngine; }
+		FileIoEngine::Enum GetEngine () const { return Engine; }
+		static wstring GetEngineName (FileIoEngine::Enum engine);
+		size_t GetRequestCount () const { return Requests.size(); }
+		static bool IsEngineAvailable (FileIoEngine::Enum engine);
+		static void SetDefaultEngine (FileIoEngine::Enum engine) { DefaultEngine = engine; }
+		void Submit ();
+		uint64 Wait (size_t requestIndex);	// Returns the number of bytes transferred, which is lower than requested only for reads past the end of file
+		void WaitAll ();
+
+		static const uint32 RingEntryCount = 64;
+		static const size_t RegisteredBufferCount = 16;
+		static const size_t RegisteredBufferSize = 64 * 1024;
+
+	protected:
+		struct Request
+		{
+			bool Write;
+			uint8 *Data;
+			size_t Size;
+			uint64 Position;
+			size_t Transferred;
+			bool Submitted;
+			bool Completed;
+			int ErrorCode;
+			int RegisteredBuffer;
+		};
+
+		size_t AddRequest (bool write, uint8 *data, size_t size, uint64 position);
+		void CompleteRequest (Request &request, int32 result);
+		void ThrowRequestError (const Request &request) const;
+
+		FileIoEngine::Enum Engine;
+		const File &IoFile;
+		vector <Request> Requests;
+		static FileIoEngine::Enum DefaultEngine;
+
+#ifdef TC_LINUX
+		void AcquireRing ();
+		void PrepareSubmission (size_t requestIndex);
+		void ProcessCompletions ();
+		void SubmitPending (uint32 waitCount);
+
+		size_t InFlightCount;
+		size_t NextSubmission;
+		bool SubmissionPending;
+		shared_ptr <FileIoRing> IoRing;
+		shared_ptr <FileIoRingPool> RingPool;
+		static Mutex RingPoolMutex;
+#endif
+
+	private:
+		FileIoBatch (const FileIoBatch &);
+		FileIoBatch &operator= (const FileIoBatch &);
+	};
+
+	// Throughput of an I/O engine measured on a file filled with data
+	struct FileIoBenchmark
+	{
+		FileIoBenchmark () : Engine (FileIoEngine::Blocking), RandomReadSpeed (0), RandomWriteSpeed (0), SequentialReadSpeed (0), SequentialWriteSpeed (0) { }
+
+		static FileIoBenchmark Run (const File &file, uint64 dataSize, FileIoEngine::Enum engine, size_t queueDepth = DefaultQueueDepth);
+
+		static const size_t DefaultQueueDepth = 32;
+		static const size_t RandomRequestSize = 4 * 1024;
+		static const size_t SequentialRequestSize = 1024 * 1024;
+
+		FileIoEngine::Enum Engine;
+		uint64 RandomReadSpeed;	// Bytes per second
+		uint64 RandomWriteSpeed;
+		uint64 SequentialReadSpeed;
+		uint64 SequentialWriteSpeed;
+	};
+
+#ifdef TC_LINUX
+	// io_uring instance with the descriptor of a file registered as fixed file 0 and a set of registered
+	// buffers used for small requests. Registrations are optional as they may exceed resource limits.
+	class FileIoRing
+	{
+	public:
+		FileIoRing (int fileHandle);
+
+		int GetFileHandle () const { return FixedFile ? 0 : FileHandle; }
+		uint8 *GetRegisteredBuffer (size_t index) const;
+
+		vector <int> FreeBuffers;
+		int FileHandle;
+		bool FixedFile;
+		SecureBuffer RegisteredBuffers;
+		IoUring Ring;	// Destroyed before the registered buffers
+
+	private:
+		FileIoRing (const FileIoRing &);
+		FileIoRing &operator= (const FileIoRing &);
+	};
+
+	// Idle rings of a file, reused by subsequent batches. Rings are not shared with forked processes.
+	class FileIoRingPool
+	{
+	public:
+		FileIoRingPool ();
+
+		shared_ptr <FileIoRing> Acquire (int fileHandle);
+		void Release (shared_ptr <FileIoRing> ring);
+
+		static const size_t MaxIdleRingCount = 16;
+
+	protected:
+		list < shared_ptr <FileIoRing> > IdleRings;
+		pid_t OwnerProcess;
+		Mutex PoolMutex;
+
+	private:
+		FileIoRingPool (const FileIoRingPool &);
+		FileIoRingPool &operator= (const FileIoRingPool &);
+	};
+#endif
+}
+
+#endif // TC_HEADER_Platform_FileIoBatch
@@ -10,13 +10,19 @@
  code distribution packages.
 */
 
+#ifdef TC_UNIX
+#include <stdlib.h>
+#include <unistd.h>
+#endif
 #include "PlatformTest.h"
 #include "Exception.h"
+#include "FileIoBatch.h"
 #include "FileStream.h"
 #include "Finally.h"
 #include "ForEach.h"
 #include "MemoryStream.h"
 #include "Mutex.h"
+#include "SecureBufferPool.h"
 #include "Serializable.h"
 #include "SharedPtr.h"
 #include "StringConverter.h"
@@ -26,7 +32,100 @@
 
 namespace VeraCrypt
 {
+	void PlatformTest::FileIoBatchTest ()
+	{
+#ifdef TC_UNIX
+		char path[] = "/tmp/.veracrypt-test-XXXXXX";
+		int fileHandle = mkstemp (path);
+		throw_sys_if (fileHandle == -1);
+		unlink (path);
+
+		File file;
+		file.AssignSystemHandle (fileHandle, false);
+
+		for (int engine = FileIoEngine::Blocking; engine <= FileIoEngine::IoUring; ++engine)
+		{
+			if (!FileIoBatch::IsEngineAvailable ((FileIoEngine::Enum) engine))
+				continue;
+
+			Buffer data (1024 * 1024 + 512);
+			for (size_t i = 0; i < data.Size(); ++i)
+				data[i] = (uint8) (i * 7 + i / 509 + engine);
+
+			// More requests than ring entries, of sizes below and above the registered buffer size
+			FileIoBatch writeBatch (file, (FileIoEngine::Enum) engine);
+			for (size_t position = 0, i = 0; position < data.Size(); ++i)
+			{
+				size_t size = VC_MIN (data.Size() - position, 512 * (1 + (i * 37) % 300));
+				writeBatch.AddWrite (data.GetRange (position, size), position);
+				position += size;
+			}
+
+			writeBatch.Submit();
+			writeBatch.WaitAll();
+
+			Buffer readData (data.Size());
+			readData.Zero();
+
+			uint8 tail[4096];
+			FileIoBatch readBatch (file, (FileIoEngine::Enum) engine);
+
+			for (size_t position = 0; position < data.Size(); position += 4096)
+				readBatch.AddRead (readData.GetRange (position, VC_MIN (data.Size() - position, (size_t) 4096)), position);
+
+			size_t tailRequest = readBatch.AddRead (BufferPtr (tail, sizeof (tail)), data.Size() - 100);
+			readBatch.Submit();
+
+			if (readBatch.Wait (tailRequest) != 100 || memcmp (tail, data.Ptr() + data.Size() - 100, 100) != 0)
+				throw TestFailed (SRC_POS);
+
+			for (size_t i = readBatch.GetRequestCount() - 1; i > 0; --i)
+				readBatch.Wait (i - 1);
+
+			if (memcmp (readData.Ptr(), data.Ptr(), data.Size()) != 0)
+				throw TestFailed (SRC_POS);
+		}
+#endif
+	}
+
 	// make_shared_auto, File, Stream, MemoryStream, Endian, Serializer, Serializable
+	void PlatformTest::SecureBufferPoolTest ()
+	{
+		SecureBufferPool pool (2, 256 * 1024, 64);
+
+		for (int i = 0; i < 100; ++i)
+		{
+			PooledSecureBuffer buffer1 (pool, 128 * 1024);
+			PooledSecureBuffer buffer2 (pool, 512 + i * 512);
+
+			if (buffer1.Size() != 128 * 1024 || buffer2.Size() != 512 + (size_t) i * 512
+				|| (size_t) buffer1.Ptr() % 64 != 0 || buffer1.Ptr() == buffer2.Ptr())
+				throw TestFailed (SRC_POS);
+
+			buffer1.CopyFrom (ConstBufferPtr ((const uint8 *) "test", 4));
+			buffer2.GetRange (0, buffer2.Size()).Zero();
+		}
+
+		// Steady state must not allocate buffers or free list storage
+		if (pool.GetRequestCount() != 200 || pool.GetAllocationCount() != 2 || pool.GetPooledBufferCount() != 2)
+			throw TestFailed (SRC_POS);
+
+		// Returned buffers are erased
+		{
+			PooledSecureBuffer buffer (pool, 128 * 1024);
+			if (memcmp (buffer.Ptr(), "\0\0\0\0", 4) != 0)
+				throw TestFailed (SRC_POS);
+		}
+
+		// Buffers exceeding the size limit are not pooled
+		{
+			PooledSecureBuffer buffer (pool, 1024 * 1024);
+		}
+
+		if (pool.GetAllocationCount() != 3 || pool.GetPooledBufferCount() != 2)
+			throw TestFailed (SRC_POS);
+	}
+
 	void PlatformTest::SerializerTest ()
 	{
 		shared_ptr <Stream> stream (new MemoryStream);
@@ -344,6 +443,8 @@ namespace VeraCrypt
 			testList.pop_front();
 		}
 
+		FileIoBatchTest();
+		SecureBufferPoolTest();
 		SerializerTest();
 		ThreadTest();
 
@@ -0,0 +1,135 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#include "SecureBufferPool.h"
+#include "Exception.h"
+#include "ForEach.h"
+
+namespace VeraCrypt
+{
+	SecureBufferPool::SecureBufferPool (size_t maxBufferCount, size_t maxBufferSize, size_t alignment)
+		: Alignment (alignment), AllocationCount (0), MaxBufferCount (maxBufferCount), MaxBufferSize (maxBufferSize), RequestCount (0)
+	{
+		FreeBuffers.reserve (maxBufferCount);
+	}
+
+	SecureBufferPool::~SecureBufferPool ()
+	{
+		foreach (SecureBuffer *buffer, FreeBuffers)
+		{
+			delete buffer;
+		}
+	}
+
+	SecureBuffer *SecureBufferPool::Acquire (size_t size)
+	{
+		if (size < 1)
+			throw ParameterIncorrect (SRC_POS);
+
+		{
+			ScopeLock lock (PoolMutex);
+			++RequestCount;
+
+			// Smallest sufficient buffer
+			size_t best = FreeBuffers.size();
+			for (size_t i = 0; i < FreeBuffers.size(); ++i)
+			{
+				if (FreeBuffers[i]->Size() >= size && (best == FreeBuffers.size() || FreeBuffers[i]->Size() < FreeBuffers[best]->Size()))
+					best = i;
+			}
+
+			if (best != FreeBuffers.size())
+			{
+				// The order of free buffers is irrelevant, so the last one fills the gap
+				SecureBuffer *buffer = FreeBuffers[best];
+				FreeBuffers[best] = FreeBuffers.back();
+				FreeBuffers.pop_back();
+				return buffer;
+			}
+
+			++AllocationCount;
+		}
+
+		// Rounding up lets a buffer serve requests of slightly varying sizes
+		size_t allocationSize = size;
+		if (size <= MaxBufferSize && size % SizeGranularity != 0)
+			allocationSize = VC_MIN (size + SizeGranularity - size % SizeGranularity, MaxBufferSize);
+
+		return new SecureBuffer (allocationSize, Alignment);
+	}
+
+	uint64 SecureBufferPool::GetAllocationCount () const
+	{
+		ScopeLock lock (PoolMutex);
+		return AllocationCount;
+	}
+
+	size_t SecureBufferPool::GetPooledBufferCount () const
+	{
+		ScopeLock lock (PoolMutex);
+		return FreeBuffers.size();
+	}
+
+	uint64 SecureBufferPool::GetRequestCount () const
+	{
+		ScopeLock lock (PoolMutex);
+		return RequestCount;
+	}
+
+	void SecureBufferPool::Release (SecureBuffer *buffer, size_t usedSize)
+	{
+		buffer->GetRange (0, usedSize).Erase();
+
+		if (buffer->Size() > MaxBufferSize)
+		{
+			delete buffer;
+			return;
+		}
+
+		SecureBuffer *discardedBuffer = buffer;
+		{
+			ScopeLock lock (PoolMutex);
+
+			if (FreeBuffers.size() < MaxBufferCount)
+			{
+				if (FreeBuffers.size() == FreeBuffers.capacity())
+					++AllocationCount;
+
+				FreeBuffers.push_back (buffer);
+				return;
+			}
+
+			// The pool is full: keep the larger buffer
+			vector <SecureBuffer *>::iterator smallest = FreeBuffers.begin();
+			for (vector <SecureBuffer *>::iterator i = FreeBuffers.begin(); i != FreeBuffers.end(); ++i)
+			{
+				if ((*i)->Size() < (*smallest)->Size())
+					smallest = i;
+			}
+
+			if (smallest != FreeBuffers.end() && (*smallest)->Size() < buffer->Size())
+			{
+				discardedBuffer = *smallest;
+				*smallest = buffer;
+			}
+		}
+
+		delete discardedBuffer;
+	}
+
+	PooledSecureBuffer::PooledSecureBuffer (SecureBufferPool &pool, size_t size)
+		: DataSize (size), Pool (pool), PoolBuffer (pool.Acquire (size))
+	{
+	}
+
+	PooledSecureBuffer::~PooledSecureBuffer ()
+	{
+		Pool.Release (PoolBuffer, DataSize);
+	}
+}
@@ -0,0 +1,82 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#ifndef TC_HEADER_Platform_SecureBufferPool
+#define TC_HEADER_Platform_SecureBufferPool
+
+#include "PlatformBase.h"
+#include "Buffer.h"
+#include "Mutex.h"
+
+namespace VeraCrypt
+{
+	// Bounded pool of aligned scratch buffers. Used ranges are erased when a buffer is returned,
+	// and pooled buffers are erased and freed when the pool is destroyed.
+	class SecureBufferPool
+	{
+	public:
+		static const size_t DefaultAlignment = 4096;
+		static const size_t DefaultMaxBufferCount = 16;
+		static const size_t DefaultMaxBufferSize = 1024 * 1024;
+		static const size_t SizeGranularity = 64 * 1024;
+
+		SecureBufferPool (size_t maxBufferCount = DefaultMaxBufferCount, size_t maxBufferSize = DefaultMaxBufferSize, size_t alignment = DefaultAlignment);
+		virtual ~SecureBufferPool ();
+
+		uint64 GetAllocationCount () const;	// Heap allocations of buffers (including those too large to be pooled) and of free list storage
+		size_t GetPooledBufferCount () const;
+		uint64 GetRequestCount () const;
+
+	protected:
+		friend class PooledSecureBuffer;
+
+		SecureBuffer *Acquire (size_t size);
+		void Release (SecureBuffer *buffer, size_t usedSize);
+
+		size_t Alignment;
+		uint64 AllocationCount;
+		vector <SecureBuffer *> FreeBuffers;	// Capacity reserved for MaxBufferCount entries
+		size_t MaxBufferCount;
+		size_t MaxBufferSize;
+		mutable Mutex PoolMutex;
+		uint64 RequestCount;
+
+	private:
+		SecureBufferPool (const SecureBufferPool &);
+		SecureBufferPool &operator= (const SecureBufferPool &);
+	};
+
+	// Scratch buffer borrowed from a pool for the lifetime of the object
+	class PooledSecureBuffer
+	{
+	public:
+		PooledSecureBuffer (SecureBufferPool &pool, size_t size);
+		~PooledSecureBuffer ();
+
+		void CopyFrom (const ConstBufferPtr &bufferPtr) { BufferPtr (*this).CopyFrom (bufferPtr); }
+		BufferPtr GetRange (size_t offset, size_t size) const { return BufferPtr (*this).GetRange (offset, size); }
+		uint8 *Ptr () const { return PoolBuffer->Ptr(); }
+		size_t Size () const { return DataSize; }
+
+		operator uint8 * () const { return PoolBuffer->Ptr(); }
+		operator BufferPtr () const { return BufferPtr (PoolBuffer->Ptr(), DataSize); }
+		operator ConstBufferPtr () const { return ConstBufferPtr (PoolBuffer->Ptr(), DataSize); }
+
+	protected:
+		size_t DataSize;
+		SecureBufferPool &Pool;
+		SecureBuffer *PoolBuffer;
+
+	private:
+		PooledSecureBuffer (const PooledSecureBuffer &);
+		PooledSecureBuffer &operator= (const PooledSecureBuffer &);
+	};
+}
+
+#endif // TC_HEADER_Platform_SecureBufferPool
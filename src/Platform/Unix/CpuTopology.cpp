@@ -0,0 +1,157 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include <algorithm>
+#include <set>
+#ifdef TC_LINUX
+#	include <dirent.h>
+#	include <sched.h>
+#	include <unistd.h>
+#	include <sys/syscall.h>
+#endif
+#include "Platform/CpuTopology.h"
+#include "Platform/ForEach.h"
+#include "Platform/StringConverter.h"
+#include "Platform/TextReader.h"
+
+#ifndef MPOL_F_NODE
+#	define MPOL_F_NODE (1 << 0)
+#endif
+
+#ifndef MPOL_F_ADDR
+#	define MPOL_F_ADDR (1 << 1)
+#endif
+
+namespace VeraCrypt
+{
+	CpuTopologyNodeList CpuTopology::GetNodes ()
+	{
+		CpuTopologyNodeList nodes;
+
+#ifdef TC_LINUX
+		vector <uint32> onlineCpus = ReadCpuList ("/sys/devices/system/cpu/online");
+		if (onlineCpus.empty())
+			return nodes;
+
+		set <uint32> usableCpus;
+		cpu_set_t affinity;
+		CPU_ZERO (&affinity);
+		bool affinityKnown = sched_getaffinity (0, sizeof (affinity), &affinity) == 0;
+
+		foreach (uint32 cpu, onlineCpus)
+		{
+			if (!affinityKnown || (cpu < CPU_SETSIZE && CPU_ISSET (cpu, &affinity)))
+				usableCpus.insert (cpu);
+		}
+
+		DIR *nodeDir = opendir ("/sys/devices/system/node");
+		if (nodeDir)
+		{
+			struct dirent *entry;
+			while ((entry = readdir (nodeDir)) != nullptr)
+			{
+				string name = entry->d_name;
+				if (name.size() < 5 || name.find ("node") != 0 || name.find_first_not_of ("0123456789", 4) != string::npos)
+					continue;
+
+				CpuTopologyNode node;
+				node.Id = StringConverter::ToUInt32 (name.substr (4));
+
+				foreach (uint32 cpu, ReadCpuList ("/sys/devices/system/node/" + name + "/cpulist"))
+				{
+					if (usableCpus.find (cpu) != usableCpus.end())
+						node.Cpus.push_back (cpu);
+				}
+
+				// Memory-only nodes cannot host workers
+				if (!node.Cpus.empty())
+					nodes.push_back (node);
+			}
+
+			closedir (nodeDir);
+		}
+
+		if (nodes.empty() && !usableCpus.empty())
+		{
+			CpuTopologyNode node;
+			node.Id = 0;
+			node.Cpus.assign (usableCpus.begin(), usableCpus.end());
+			nodes.push_back (node);
+		}
+
+		struct NodeIdLess
+		{
+			bool operator() (const CpuTopologyNode &a, const CpuTopologyNode &b) const { return a.Id < b.Id; }
+		};
+
+		sort (nodes.begin(), nodes.end(), NodeIdLess());
+#endif
+		return nodes;
+	}
+
+	int CpuTopology::GetMemoryNode (const void *address)
+	{
+#if defined (TC_LINUX) && defined (SYS_get_mempolicy)
+		int node = -1;
+		if (syscall (SYS_get_mempolicy, &node, nullptr, 0, address, MPOL_F_NODE | MPOL_F_ADDR) == 0)
+			return node;
+#endif
+		return -1;
+	}
+
+	vector <uint32> CpuTopology::ParseCpuList (const string &cpuList)
+	{
+		vector <uint32> cpus;
+
+		foreach (const string &range, StringConverter::Split (StringConverter::Trim (cpuList), ","))
+		{
+			size_t separator = range.find ('-');
+			uint32 first = StringConverter::ToUInt32 (range.substr (0, separator));
+			uint32 last = separator == string::npos ? first : StringConverter::ToUInt32 (range.substr (separator + 1));
+
+			for (uint32 cpu = first; cpu <= last; ++cpu)
+				cpus.push_back (cpu);
+		}
+
+		return cpus;
+	}
+
+	vector <uint32> CpuTopology::ReadCpuList (const string &path)
+	{
+		try
+		{
+			TextReader tr (path);
+			string line;
+
+			if (tr.ReadLine (line))
+				return ParseCpuList (line);
+		}
+		catch (...) { }
+
+		return vector <uint32> ();
+	}
+
+	bool CpuTopology::SetCurrentThreadAffinity (const vector <uint32> &cpus)
+	{
+#ifdef TC_LINUX
+		cpu_set_t cpuSet;
+		CPU_ZERO (&cpuSet);
+
+		foreach (uint32 cpu, cpus)
+		{
+			if (cpu < CPU_SETSIZE)
+				CPU_SET (cpu, &cpuSet);
+		}
+
+		return CPU_COUNT (&cpuSet) > 0 && sched_setaffinity (0, sizeof (cpuSet), &cpuSet) == 0;
+#else
+		return false;
+#endif
+	}
+}
@@ -66,6 +66,10 @@ namespace VeraCrypt
 	{
 		if_debug (ValidateState());
 
+#ifdef TC_LINUX
+		// Registered rings hold a reference to the file
+		IoRingPool.reset();
+#endif
 		if (!SharedHandle)
 		{
 			close (FileHandle);
@@ -0,0 +1,531 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "Platform/FileIoBatch.h"
+#include "Platform/SystemException.h"
+#include "Platform/Time.h"
+
+namespace VeraCrypt
+{
+	FileIoBatch::FileIoBatch (const File &file, FileIoEngine::Enum engine)
+		: Engine (engine), IoFile (file)
+#ifdef TC_LINUX
+		, InFlightCount (0), NextSubmission (0), SubmissionPending (false)
+#endif
+	{
+		if (!IsEngineAvailable (Engine))
+			Engine = FileIoEngine::Blocking;
+	}
+
+	FileIoBatch::~FileIoBatch ()
+	{
+#ifdef TC_LINUX
+		if (IoRing)
+		{
+			// Buffers of requests in progress must not be released before the requests complete
+			try
+			{
+				while (InFlightCount > 0)
+				{
+					IoRing->Ring.Submit (1);
+					SubmissionPending = false;
+					ProcessCompletions();
+				}
+
+				RingPool->Release (IoRing);
+			}
+			catch (...) { }
+		}
+#endif
+	}
+
+	size_t FileIoBatch::AddRead (const BufferPtr &buffer, uint64 position)
+	{
+		return AddRequest (false, buffer.Get(), buffer.Size(), position);
+	}
+
+	size_t FileIoBatch::AddRequest (bool write, uint8 *data, size_t size, uint64 position)
+	{
+		Request request;
+		request.Write = write;
+		request.Data = data;
+		request.Size = size;
+		request.Position = position;
+		request.Transferred = 0;
+		request.Submitted = false;
+		request.Completed = (size == 0);
+		request.ErrorCode = 0;
+		request.RegisteredBuffer = -1;
+
+		Requests.push_back (request);
+		return Requests.size() - 1;
+	}
+
+	size_t FileIoBatch::AddWrite (const ConstBufferPtr &buffer, uint64 position)
+	{
+		return AddRequest (true, const_cast <uint8 *> (buffer.Get()), buffer.Size(), position);
+	}
+
+	wstring FileIoBatch::GetEngineName (FileIoEngine::Enum engine)
+	{
+		switch (engine)
+		{
+		case FileIoEngine::Blocking:	return L"blocking";
+		case FileIoEngine::IoUring:		return L"io_uring";
+		default:
+			throw ParameterIncorrect (SRC_POS);
+		}
+	}
+
+#ifdef TC_LINUX
+	static bool IsIoUringFileIoSupported ()
+	{
+		try
+		{
+			IoUring ring (1);
+
+			io_uring_sqe *entry = ring.GetSubmissionEntry();
+			entry->opcode = IORING_OP_READ;
+			entry->fd = -1;
+			ring.Submit (1);
+
+			// Kernels older than 5.6 reject the opcode rather than the descriptor
+			IoUringCompletion completion;
+			return ring.GetCompletions (&completion, 1) == 1 && completion.Result == -EBADF;
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+#endif
+
+	bool FileIoBatch::IsEngineAvailable (FileIoEngine::Enum engine)
+	{
+		switch (engine)
+		{
+		case FileIoEngine::Blocking:
+			return true;
+
+#ifdef TC_LINUX
+		case FileIoEngine::IoUring:
+			{
+				static const bool supported = IsIoUringFileIoSupported();
+				return supported;
+			}
+#endif
+		default:
+			return false;
+		}
+	}
+
+	void FileIoBatch::Submit ()
+	{
+#ifdef TC_LINUX
+		if (Engine == FileIoEngine::IoUring && !IoRing)
+			AcquireRing();
+
+		if (IoRing)
+			SubmitPending (0);
+#endif
+	}
+
+	void FileIoBatch::ThrowRequestError (const Request &request) const
+	{
+		errno = request.ErrorCode;
+		throw SystemException (SRC_POS, wstring (IoFile.Path));
+	}
+
+	uint64 FileIoBatch::Wait (size_t requestIndex)
+	{
+		if (requestIndex >= Requests.size())
+			throw ParameterIncorrect (SRC_POS);
+
+#ifdef TC_LINUX
+		if (Engine == FileIoEngine::IoUring && !IoRing)
+			AcquireRing();
+
+		if (IoRing)
+		{
+			while (!Requests[requestIndex].Completed)
+			{
+				SubmitPending (1);
+				ProcessCompletions();
+			}
+
+			// Requests prepared while waiting are started before returning to the caller
+			SubmitPending (0);
+
+			const Request &request = Requests[requestIndex];
+			if (request.ErrorCode != 0)
+				ThrowRequestError (request);
+
+			return request.Transferred;
+		}
+#endif
+		Request &request = Requests[requestIndex];
+
+		if (!request.Completed)
+		{
+			if (request.Write)
+			{
+				IoFile.WriteAt (ConstBufferPtr (request.Data, request.Size), request.Position);
+				request.Transferred = request.Size;
+			}
+			else
+				request.Transferred = (size_t) IoFile.ReadAt (BufferPtr (request.Data, request.Size), request.Position);
+
+			request.Completed = true;
+		}
+
+		return request.Transferred;
+	}
+
+	void FileIoBatch::WaitAll ()
+	{
+		for (size_t i = 0; i < Requests.size(); ++i)
+			Wait (i);
+	}
+
+#ifdef TC_LINUX
+	void FileIoBatch::AcquireRing ()
+	{
+		{
+			ScopeLock lock (RingPoolMutex);
+			if (!IoFile.IoRingPool)
+				IoFile.IoRingPool.reset (new FileIoRingPool);
+
+			RingPool = IoFile.IoRingPool;
+		}
+
+		try
+		{
+			IoRing = RingPool->Acquire (IoFile.FileHandle);
+		}
+		catch (SystemException &)
+		{
+			// Resource limits may prevent creation of another ring
+			Engine = FileIoEngine::Blocking;
+		}
+	}
+
+	void FileIoBatch::PrepareSubmission (size_t requestIndex)
+	{
+		Request &request = Requests[requestIndex];
+
+		io_uring_sqe *entry = IoRing->Ring.GetSubmissionEntry();
+		if (!entry)
+			throw ParameterIncorrect (SRC_POS);
+
+		if (!request.Submitted)
+		{
+			request.Submitted = true;
+
+			if (request.Size <= RegisteredBufferSize && !IoRing->FreeBuffers.empty())
+			{
+				request.RegisteredBuffer = IoRing->FreeBuffers.back();
+				IoRing->FreeBuffers.pop_back();
+
+				if (request.Write)
+					memcpy (IoRing->GetRegisteredBuffer (request.RegisteredBuffer), request.Data, request.Size);
+			}
+		}
+
+		uint8 *data = request.Data;
+		if (request.RegisteredBuffer != -1)
+		{
+			data = IoRing->GetRegisteredBuffer (request.RegisteredBuffer);
+			entry->opcode = request.Write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+			entry->buf_index = (uint16) request.RegisteredBuffer;
+		}
+		else
+			entry->opcode = request.Write ? IORING_OP_WRITE : IORING_OP_READ;
+
+		size_t length = request.Size - request.Transferred;
+		if (length > 0x40000000)
+			length = 0x40000000;
+
+		entry->fd = IoRing->GetFileHandle();
+		if (IoRing->FixedFile)
+			entry->flags |= IOSQE_FIXED_FILE;
+
+		entry->addr = (uint64) (data + request.Transferred);
+		entry->len = (uint32) length;
+		entry->off = request.Position + request.Transferred;
+		entry->user_data = requestIndex;
+
+		++InFlightCount;
+		SubmissionPending = true;
+	}
+
+	void FileIoBatch::ProcessCompletions ()
+	{
+		IoUringCompletion completions[RingEntryCount];
+		size_t completionCount;
+
+		while ((completionCount = IoRing->Ring.GetCompletions (completions, array_capacity (completions))) > 0)
+		{
+			for (size_t i = 0; i < completionCount; ++i)
+			{
+				size_t requestIndex = (size_t) completions[i].UserData;
+				Request &request = Requests[requestIndex];
+				int32 result = completions[i].Result;
+
+				--InFlightCount;
+
+				if (result == -EINTR || result == -EAGAIN)
+				{
+					PrepareSubmission (requestIndex);
+					continue;
+				}
+
+				if (result > 0)
+				{
+					request.Transferred += result;
+
+					if (request.Transferred < request.Size)
+					{
+						// Continue a partial transfer
+						PrepareSubmission (requestIndex);
+						continue;
+					}
+				}
+				else if (result < 0)
+					request.ErrorCode = -result;
+				else if (request.Write)
+					request.ErrorCode = ENOSPC;
+
+				if (request.RegisteredBuffer != -1)
+				{
+					uint8 *registeredBuffer = IoRing->GetRegisteredBuffer (request.RegisteredBuffer);
+
+					if (!request.Write && request.Transferred > 0)
+						memcpy (request.Data, registeredBuffer, request.Transferred);
+
+					BufferPtr (registeredBuffer, request.Size).Erase();
+					IoRing->FreeBuffers.push_back (request.RegisteredBuffer);
+					request.RegisteredBuffer = -1;
+				}
+
+				request.Completed = true;
+			}
+		}
+	}
+
+	void FileIoBatch::SubmitPending (uint32 waitCount)
+	{
+		while (NextSubmission < Requests.size() && InFlightCount < RingEntryCount)
+		{
+			if (!Requests[NextSubmission].Completed)
+				PrepareSubmission (NextSubmission);
+
+			++NextSubmission;
+		}
+
+		if (SubmissionPending || waitCount > 0)
+		{
+			IoRing->Ring.Submit (waitCount);
+			SubmissionPending = false;
+		}
+	}
+
+	FileIoRing::FileIoRing (int fileHandle)
+		: FileHandle (fileHandle), FixedFile (false), Ring (FileIoBatch::RingEntryCount)
+	{
+		try
+		{
+			Ring.RegisterFiles (&fileHandle, 1);
+			FixedFile = true;
+		}
+		catch (SystemException &) { }
+
+		try
+		{
+			// Registered memory is charged to RLIMIT_MEMLOCK by older kernels
+			RegisteredBuffers.Allocate (FileIoBatch::RegisteredBufferCount * FileIoBatch::RegisteredBufferSize, 4096);
+
+			iovec buffers[FileIoBatch::RegisteredBufferCount];
+			for (size_t i = 0; i < array_capacity (buffers); ++i)
+			{
+				buffers[i].iov_base = GetRegisteredBuffer (i);
+				buffers[i].iov_len = FileIoBatch::RegisteredBufferSize;
+			}
+
+			Ring.RegisterBuffers (buffers, (uint32) array_capacity (buffers));
+
+			for (int i = (int) array_capacity (buffers) - 1; i >= 0; --i)
+				FreeBuffers.push_back (i);
+		}
+		catch (SystemException &)
+		{
+			RegisteredBuffers.Free();
+		}
+	}
+
+	uint8 *FileIoRing::GetRegisteredBuffer (size_t index) const
+	{
+		return RegisteredBuffers.Ptr() + index * FileIoBatch::RegisteredBufferSize;
+	}
+
+	FileIoRingPool::FileIoRingPool ()
+		: OwnerProcess (getpid())
+	{
+	}
+
+	shared_ptr <FileIoRing> FileIoRingPool::Acquire (int fileHandle)
+	{
+		{
+			ScopeLock lock (PoolMutex);
+
+			if (getpid() != OwnerProcess)
+			{
+				// Rings inherited from the parent process must not be used
+				IdleRings.clear();
+				OwnerProcess = getpid();
+			}
+
+			if (!IdleRings.empty())
+			{
+				shared_ptr <FileIoRing> ring = IdleRings.front();
+				IdleRings.pop_front();
+				return ring;
+			}
+		}
+
+		return shared_ptr <FileIoRing> (new FileIoRing (fileHandle));
+	}
+
+	void FileIoRingPool::Release (shared_ptr <FileIoRing> ring)
+	{
+		ScopeLock lock (PoolMutex);
+
+		if (getpid() == OwnerProcess && IdleRings.size() < MaxIdleRingCount)
+			IdleRings.push_back (ring);
+	}
+
+	Mutex FileIoBatch::RingPoolMutex;
+#endif
+
+	static uint64 GetBenchmarkSpeed (uint64 byteCount, uint64 startTime)
+	{
+		uint64 elapsedTime = Time::GetCurrent() - startTime;
+		if (elapsedTime == 0)
+			elapsedTime = 1;
+
+		// Time is measured in hundreds of nanoseconds
+		return (uint64) ((double) byteCount * 10 * 1000 * 1000 / elapsedTime);
+	}
+
+	FileIoBenchmark FileIoBenchmark::Run (const File &file, uint64 dataSize, FileIoEngine::Enum engine, size_t queueDepth)
+	{
+		dataSize -= dataSize % SequentialRequestSize;
+		if (dataSize == 0 || queueDepth == 0 || !FileIoBatch::IsEngineAvailable (engine))
+			throw ParameterIncorrect (SRC_POS);
+
+		FileIoBenchmark result;
+		result.Engine = engine;
+
+		Buffer buffer (queueDepth * SequentialRequestSize, 4096);
+		for (size_t i = 0; i < buffer.Size(); ++i)
+			buffer[i] = (uint8) (i * 131 + i / 4096);
+
+		// Sequential
+		for (int write = 1; write >= 0; --write)
+		{
+			uint64 startTime = Time::GetCurrent();
+
+			for (uint64 position = 0; position < dataSize; )
+			{
+				FileIoBatch batch (file, engine);
+
+				for (size_t i = 0; i < queueDepth && position < dataSize; ++i, position += SequentialRequestSize)
+				{
+					BufferPtr request = buffer.GetRange (i * SequentialRequestSize, SequentialRequestSize);
+
+					if (write)
+						batch.AddWrite (request, position);
+					else
+						batch.AddRead (request, position);
+				}
+
+				batch.Submit();
+
+				for (size_t i = 0; i < batch.GetRequestCount(); ++i)
+				{
+					if (batch.Wait (i) != SequentialRequestSize)
+						throw ParameterIncorrect (SRC_POS);
+				}
+			}
+
+			if (write)
+			{
+				file.Flush();
+				result.SequentialWriteSpeed = GetBenchmarkSpeed (dataSize, startTime);
+			}
+			else
+				result.SequentialReadSpeed = GetBenchmarkSpeed (dataSize, startTime);
+		}
+
+		// Random
+		uint64 randomRequestCount = dataSize / RandomRequestSize;
+		if (randomRequestCount > 16384)
+			randomRequestCount = 16384;
+
+		uint64 blockCount = dataSize / RandomRequestSize;
+
+		for (int write = 1; write >= 0; --write)
+		{
+			uint64 state = 0x9E3779B97F4A7C15ULL;
+			uint64 startTime = Time::GetCurrent();
+
+			for (uint64 done = 0; done < randomRequestCount; )
+			{
+				FileIoBatch batch (file, engine);
+
+				for (size_t i = 0; i < queueDepth && done < randomRequestCount; ++i, ++done)
+				{
+					state ^= state << 13;
+					state ^= state >> 7;
+					state ^= state << 17;
+
+					BufferPtr request = buffer.GetRange (i * RandomRequestSize, RandomRequestSize);
+					uint64 position = (state % blockCount) * RandomRequestSize;
+
+					if (write)
+						batch.AddWrite (request, position);
+					else
+						batch.AddRead (request, position);
+				}
+
+				batch.Submit();
+
+				for (size_t i = 0; i < batch.GetRequestCount(); ++i)
+				{
+					if (batch.Wait (i) != RandomRequestSize)
+						throw ParameterIncorrect (SRC_POS);
+				}
+			}
+
+			if (write)
+			{
+				file.Flush();
+				result.RandomWriteSpeed = GetBenchmarkSpeed (randomRequestCount * RandomRequestSize, startTime);
+			}
+			else
+				result.RandomReadSpeed = GetBenchmarkSpeed (randomRequestCount * RandomRequestSize, startTime);
+		}
+
+		return result;
+	}
+
+	FileIoEngine::Enum FileIoBatch::DefaultEngine = FileIoEngine::Blocking;
+}
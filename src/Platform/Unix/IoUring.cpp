@@ -0,0 +1,202 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include "IoUring.h"
+
+#ifdef TC_LINUX
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "Platform/SystemException.h"
+
+#ifndef __NR_io_uring_setup
+#	define __NR_io_uring_setup 425
+#endif
+
+#ifndef __NR_io_uring_enter
+#	define __NR_io_uring_enter 426
+#endif
+
+#ifndef __NR_io_uring_register
+#	define __NR_io_uring_register 427
+#endif
+
+namespace VeraCrypt
+{
+	IoUring::IoUring (uint32 entryCount, uint32 setupFlags, size_t submissionEntrySize)
+		: RingFD (-1),
+		SetupFlags (setupFlags),
+		SubmissionEntrySize (submissionEntrySize),
+		SqRing (MAP_FAILED),
+		SqRingSize (0),
+		SubmissionEntries ((uint8 *) MAP_FAILED),
+		SubmissionEntriesSize (0),
+		CqRing (MAP_FAILED),
+		CqRingSize (0)
+	{
+		io_uring_params params;
+		memset (&params, 0, sizeof (params));
+		params.flags = setupFlags;
+
+		RingFD = (int) syscall (__NR_io_uring_setup, entryCount, &params);
+		throw_sys_if (RingFD == -1);
+
+		try
+		{
+			SqRingSize = params.sq_off.array + params.sq_entries * sizeof (uint32);
+			CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof (io_uring_cqe);
+
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				if (CqRingSize > SqRingSize)
+					SqRingSize = CqRingSize;
+				CqRingSize = 0;
+			}
+
+			SqRing = mmap (nullptr, SqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFD, IORING_OFF_SQ_RING);
+			throw_sys_if (SqRing == MAP_FAILED);
+
+			void *cqRing = SqRing;
+			if (CqRingSize != 0)
+			{
+				CqRing = mmap (nullptr, CqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFD, IORING_OFF_CQ_RING);
+				throw_sys_if (CqRing == MAP_FAILED);
+				cqRing = CqRing;
+			}
+
+			SubmissionEntriesSize = params.sq_entries * SubmissionEntrySize;
+			SubmissionEntries = (uint8 *) mmap (nullptr, SubmissionEntriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, RingFD, IORING_OFF_SQES);
+			throw_sys_if (SubmissionEntries == MAP_FAILED);
+
+			uint8 *sq = (uint8 *) SqRing;
+			SqHead = (uint32 *) (sq + params.sq_off.head);
+			SqTail = (uint32 *) (sq + params.sq_off.tail);
+			SqMask = *(uint32 *) (sq + params.sq_off.ring_mask);
+			SqEntryCount = params.sq_entries;
+			SqArray = (uint32 *) (sq + params.sq_off.array);
+			SqPendingTail = *SqTail;
+
+			uint8 *cq = (uint8 *) cqRing;
+			CqHead = (uint32 *) (cq + params.cq_off.head);
+			CqTail = (uint32 *) (cq + params.cq_off.tail);
+			CqMask = *(uint32 *) (cq + params.cq_off.ring_mask);
+			CompletionEntries = (io_uring_cqe *) (cq + params.cq_off.cqes);
+		}
+		catch (...)
+		{
+			Close();
+			throw;
+		}
+	}
+
+	IoUring::~IoUring ()
+	{
+		Close();
+	}
+
+	void IoUring::Close ()
+	{
+		if (SubmissionEntries != MAP_FAILED)
+			munmap (SubmissionEntries, SubmissionEntriesSize);
+
+		if (CqRing != MAP_FAILED)
+			munmap (CqRing, CqRingSize);
+
+		if (SqRing != MAP_FAILED)
+			munmap (SqRing, SqRingSize);
+
+		if (RingFD != -1)
+			close (RingFD);
+
+		SubmissionEntries = (uint8 *) MAP_FAILED;
+		CqRing = MAP_FAILED;
+		SqRing = MAP_FAILED;
+		RingFD = -1;
+	}
+
+	size_t IoUring::GetCompletions (IoUringCompletion *completions, size_t maxCount)
+	{
+		uint32 head = *CqHead;
+		uint32 tail = __atomic_load_n (CqTail, __ATOMIC_ACQUIRE);
+		size_t count = 0;
+
+		while (head != tail && count < maxCount)
+		{
+			const io_uring_cqe &cqe = CompletionEntries[head & CqMask];
+			completions[count].UserData = cqe.user_data;
+			completions[count].Result = cqe.res;
+			completions[count].Flags = cqe.flags;
+
+			++count;
+			++head;
+		}
+
+		__atomic_store_n (CqHead, head, __ATOMIC_RELEASE);
+		return count;
+	}
+
+	io_uring_sqe *IoUring::GetSubmissionEntry ()
+	{
+		if (SqPendingTail - __atomic_load_n (SqHead, __ATOMIC_ACQUIRE) >= SqEntryCount)
+			return nullptr;
+
+		uint32 index = SqPendingTail & SqMask;
+		io_uring_sqe *entry = (io_uring_sqe *) (SubmissionEntries + index * SubmissionEntrySize);
+		memset (entry, 0, SubmissionEntrySize);
+
+		SqArray[index] = index;
+		++SqPendingTail;
+
+		return entry;
+	}
+
+	bool IoUring::IsSupported ()
+	{
+		try
+		{
+			IoUring ring (1);
+			return true;
+		}
+		catch (...)
+		{
+			return false;
+		}
+	}
+
+	void IoUring::RegisterBuffers (const iovec *buffers, uint32 count)
+	{
+		throw_sys_if (syscall (__NR_io_uring_register, RingFD, IORING_REGISTER_BUFFERS, buffers, count) == -1);
+	}
+
+	void IoUring::RegisterFiles (const int *fileDescriptors, uint32 count)
+	{
+		throw_sys_if (syscall (__NR_io_uring_register, RingFD, IORING_REGISTER_FILES, fileDescriptors, count) == -1);
+	}
+
+	int IoUring::Submit (uint32 waitCount)
+	{
+		__atomic_store_n (SqTail, SqPendingTail, __ATOMIC_RELEASE);
+
+		while (true)
+		{
+			uint32 submitCount = SqPendingTail - __atomic_load_n (SqHead, __ATOMIC_ACQUIRE);
+			int result = (int) syscall (__NR_io_uring_enter, RingFD, submitCount, waitCount, waitCount > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+
+			if (result == -1 && errno == EINTR)
+				continue;
+
+			throw_sys_if (result == -1);
+			return result;
+		}
+	}
+}
+
+#endif // TC_LINUX
@@ -0,0 +1,80 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Platform_Unix_IoUring
+#define TC_HEADER_Platform_Unix_IoUring
+
+#include "Platform/PlatformBase.h"
+
+#ifdef TC_LINUX
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+
+namespace VeraCrypt
+{
+	struct IoUringCompletion
+	{
+		uint64 UserData;
+		int32 Result;
+		uint32 Flags;
+	};
+
+	// Submission and completion rings of an io_uring instance, accessed through system calls
+	// without depending on liburing. An instance must not be used by more than one thread at a time.
+	// Callers setting up rings with larger submission entries (e.g. IORING_SETUP_SQE128) pass their size.
+	class IoUring
+	{
+	public:
+		IoUring (uint32 entryCount, uint32 setupFlags = 0, size_t submissionEntrySize = sizeof (io_uring_sqe));
+		virtual ~IoUring ();
+
+		size_t GetCompletions (IoUringCompletion *completions, size_t maxCount);
+		int GetFD () const { return RingFD; }
+		io_uring_sqe *GetSubmissionEntry ();
+		size_t GetSubmissionEntrySize () const { return SubmissionEntrySize; }
+		uint32 GetSubmissionQueueSize () const { return SqEntryCount; }
+		static bool IsSupported ();
+		void RegisterBuffers (const iovec *buffers, uint32 count);
+		void RegisterFiles (const int *fileDescriptors, uint32 count);
+		int Submit (uint32 waitCount = 0);
+
+	protected:
+		void Close ();
+
+		int RingFD;
+		uint32 SetupFlags;
+		size_t SubmissionEntrySize;
+
+		void *SqRing;
+		size_t SqRingSize;
+		uint32 *SqHead;
+		uint32 *SqTail;
+		uint32 SqMask;
+		uint32 SqEntryCount;
+		uint32 *SqArray;
+		uint32 SqPendingTail;
+		uint8 *SubmissionEntries;
+		size_t SubmissionEntriesSize;
+
+		void *CqRing;
+		size_t CqRingSize;
+		uint32 *CqHead;
+		uint32 *CqTail;
+		uint32 CqMask;
+		io_uring_cqe *CompletionEntries;
+
+	private:
+		IoUring (const IoUring &);
+		IoUring &operator= (const IoUring &);
+	};
+}
+
+#endif // TC_LINUX
+
+#endif // TC_HEADER_Platform_Unix_IoUring
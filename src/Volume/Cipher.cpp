@@ -21,6 +21,11 @@
 #ifdef TC_AES_HW_CPU
 #	include "Crypto/Aes_hw_cpu.h"
 #endif
+#if CRYPTOPP_VAES_AVAILABLE
+#	include "Crypto/Aes_hw_vaes.h"
+#endif
+#include "Crypto/Xts_simd.h"
+#include "Common/Crypto.h"
 
 extern "C" int IsAesHwCpuSupported ()
 {
@@ -89,6 +94,92 @@ namespace VeraCrypt
 		}
 	}
 
+#ifndef WOLFCRYPT_BACKEND
+	void Cipher::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		throw NotApplicable (SRC_POS);
+	}
+
+	void Cipher::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		throw NotApplicable (SRC_POS);
+	}
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+	// Whitening value of the first block of a data unit (little-endian data unit number encrypted with the tweak cipher)
+	static void GetInitialXtsTweak (const Cipher &tweakCipher, uint64 dataUnitNo, uint8 *tweak)
+	{
+		*((uint64 *) tweak) = Endian::Little (dataUnitNo);
+		*((uint64 *) tweak + 1) = 0;
+		tweakCipher.EncryptBlock (tweak);
+	}
+
+#ifndef CRYPTOPP_DISABLE_ASM
+	// Initial tweaks of consecutive data units, encrypted in a single multi-block call
+	static void GetInitialXtsTweaks (const Cipher &tweakCipher, uint64 dataUnitNo, size_t count, uint8 *tweaks)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			*((uint64 *) (tweaks + i * BYTES_PER_XTS_BLOCK)) = Endian::Little (dataUnitNo + i);
+			*((uint64 *) (tweaks + i * BYTES_PER_XTS_BLOCK) + 1) = 0;
+		}
+
+		tweakCipher.EncryptBlocks (tweaks, count);
+	}
+#endif
+
+	// XTS for ciphers whose multi-block implementation cannot apply whitening values itself. Blocks are processed
+	// in groups which stay in the L1 cache and may span data units; whitening values are derived in registers and
+	// XORed into a group before and after the cipher processes it, so no whitening table is built for the whole
+	// buffer. The group size is a multiple of the 3-way and 16-way (AVX2) Twofish, 16-, 32- (VAES) and 64-way
+	// (VAES with AVX-512) Camellia and 4-way and 8-way (AVX2) Kuznyechik block functions.
+	static void ProcessDataUnitGroupsXTS (const Cipher &cipher, const Cipher &tweakCipher, uint8 *data, uint64 blockCount, uint64 dataUnitNo, bool decrypt)
+	{
+		const size_t groupBlockCount = 192;
+		__m128i whiteningValues[groupBlockCount];
+		__m128i whiteningValue = _mm_setzero_si128();
+		uint8 tweak[BYTES_PER_XTS_BLOCK];
+		size_t unitBlockNo = 0;
+
+		while (blockCount > 0)
+		{
+			size_t count = blockCount < groupBlockCount ? (size_t) blockCount : groupBlockCount;
+			__m128i *blocks = (__m128i *) data;
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (unitBlockNo == 0)
+				{
+					GetInitialXtsTweak (tweakCipher, dataUnitNo++, tweak);
+					whiteningValue = _mm_loadu_si128 ((const __m128i *) tweak);
+				}
+
+				whiteningValues[i] = whiteningValue;
+				_mm_storeu_si128 (blocks + i, _mm_xor_si128 (_mm_loadu_si128 (blocks + i), whiteningValue));
+
+				whiteningValue = xts_mul_alpha_sse2 (whiteningValue);
+				unitBlockNo = (unitBlockNo + 1) % BLOCKS_PER_XTS_DATA_UNIT;
+			}
+
+			if (decrypt)
+				cipher.DecryptBlocks (data, count);
+			else
+				cipher.EncryptBlocks (data, count);
+
+			for (size_t i = 0; i < count; ++i)
+				_mm_storeu_si128 (blocks + i, _mm_xor_si128 (_mm_loadu_si128 (blocks + i), whiteningValues[i]));
+
+			data += count * BYTES_PER_XTS_BLOCK;
+			blockCount -= count;
+		}
+
+		burn (whiteningValues, sizeof (whiteningValues));
+		burn (&whiteningValue, sizeof (whiteningValue));
+		burn (tweak, sizeof (tweak));
+	}
+#endif
+#endif
+
 	CipherList Cipher::GetAvailableCiphers ()
 	{
 		CipherList l;
@@ -239,6 +330,68 @@ namespace VeraCrypt
 	}
     #endif
 
+#ifndef WOLFCRYPT_BACKEND
+	void CipherAES::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if defined (TC_AES_HW_CPU) && CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+		const CipherAES &aesTweakCipher = dynamic_cast <const CipherAES &> (tweakCipher);
+		const uint8 *ks = ScheduledKey.Ptr() + sizeof (aes_encrypt_ctx);
+
+		if (!aesTweakCipher.Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_VAES_AVAILABLE
+		if (HasVAES() && HasSAVX512())
+			aes_hw_vaes512_xts_decrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+		else if (HasVAES())
+			aes_hw_vaes_xts_decrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+		else
+#endif
+			aes_hw_cpu_xts_decrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	void CipherAES::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if defined (TC_AES_HW_CPU) && CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+		const CipherAES &aesTweakCipher = dynamic_cast <const CipherAES &> (tweakCipher);
+		const uint8 *ks = ScheduledKey.Ptr();
+
+		if (!aesTweakCipher.Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_VAES_AVAILABLE
+		if (HasVAES() && HasSAVX512())
+			aes_hw_vaes512_xts_encrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+		else if (HasVAES())
+			aes_hw_vaes_xts_encrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+		else
+#endif
+			aes_hw_cpu_xts_encrypt (ks, aesTweakCipher.ScheduledKey.Ptr(), data, blockCount, startDataUnitNo);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	bool CipherAES::IsXtsKernelAvailable (const Cipher &tweakCipher) const
+	{
+#if defined (TC_AES_HW_CPU) && CRYPTOPP_BOOL_AESNI_INTRINSICS_AVAILABLE
+		// Kernels use the AES-NI key schedules of both ciphers
+		return IsHwSupportAvailable() && dynamic_cast <const CipherAES *> (&tweakCipher) != nullptr;
+#else
+		return false;
+#endif
+	}
+#endif
+
 	size_t CipherAES::GetScheduledKeySize () const
 	{
 		return sizeof(aes_encrypt_ctx) + sizeof(aes_decrypt_ctx);
@@ -324,6 +477,83 @@ namespace VeraCrypt
 			Cipher::DecryptBlocks (data, blockCount);
 	}
 	
+	void CipherSerpent::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		// Initial tweaks are encrypted in batches so that the tweak cipher can use its multi-block (AVX2/AVX-512) path
+		const size_t tweakBatchSize = 16;
+		uint8 tweaks[tweakBatchSize * BYTES_PER_XTS_BLOCK];
+		finally_do_arg (uint8 *, tweaks, { burn (finally_arg, tweakBatchSize * BYTES_PER_XTS_BLOCK); });
+
+		while (blockCount > 0)
+		{
+			uint64 unitCount = (blockCount + BLOCKS_PER_XTS_DATA_UNIT - 1) / BLOCKS_PER_XTS_DATA_UNIT;
+			size_t tweakCount = unitCount < tweakBatchSize ? (size_t) unitCount : tweakBatchSize;
+
+			GetInitialXtsTweaks (tweakCipher, startDataUnitNo, tweakCount, tweaks);
+			startDataUnitNo += tweakCount;
+
+			for (size_t i = 0; i < tweakCount; ++i)
+			{
+				uint64 unitBlockCount = blockCount < BLOCKS_PER_XTS_DATA_UNIT ? blockCount : BLOCKS_PER_XTS_DATA_UNIT;
+
+				serpent_xts_decrypt_blocks (data, (size_t) unitBlockCount, tweaks + i * BYTES_PER_XTS_BLOCK, ScheduledKey.Ptr());
+
+				data += unitBlockCount * BYTES_PER_XTS_BLOCK;
+				blockCount -= unitBlockCount;
+			}
+		}
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	void CipherSerpent::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		// Initial tweaks are encrypted in batches so that the tweak cipher can use its multi-block (AVX2/AVX-512) path
+		const size_t tweakBatchSize = 16;
+		uint8 tweaks[tweakBatchSize * BYTES_PER_XTS_BLOCK];
+		finally_do_arg (uint8 *, tweaks, { burn (finally_arg, tweakBatchSize * BYTES_PER_XTS_BLOCK); });
+
+		while (blockCount > 0)
+		{
+			uint64 unitCount = (blockCount + BLOCKS_PER_XTS_DATA_UNIT - 1) / BLOCKS_PER_XTS_DATA_UNIT;
+			size_t tweakCount = unitCount < tweakBatchSize ? (size_t) unitCount : tweakBatchSize;
+
+			GetInitialXtsTweaks (tweakCipher, startDataUnitNo, tweakCount, tweaks);
+			startDataUnitNo += tweakCount;
+
+			for (size_t i = 0; i < tweakCount; ++i)
+			{
+				uint64 unitBlockCount = blockCount < BLOCKS_PER_XTS_DATA_UNIT ? blockCount : BLOCKS_PER_XTS_DATA_UNIT;
+
+				serpent_xts_encrypt_blocks (data, (size_t) unitBlockCount, tweaks + i * BYTES_PER_XTS_BLOCK, ScheduledKey.Ptr());
+
+				data += unitBlockCount * BYTES_PER_XTS_BLOCK;
+				blockCount -= unitBlockCount;
+			}
+		}
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	bool CipherSerpent::IsXtsKernelAvailable (const Cipher &tweakCipher) const
+	{
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		return IsHwSupportAvailable();
+#else
+		return false;
+#endif
+	}
+
 	bool CipherSerpent::IsHwSupportAvailable () const
 	{
 #if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
@@ -387,6 +617,39 @@ namespace VeraCrypt
 #endif
 	}
 	
+	void CipherTwofish::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, true);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	void CipherTwofish::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, false);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	bool CipherTwofish::IsXtsKernelAvailable (const Cipher &tweakCipher) const
+	{
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		return IsHwSupportAvailable();
+#else
+		return false;
+#endif
+	}
+
 	bool CipherTwofish::IsHwSupportAvailable () const
 	{
 #if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
@@ -441,6 +704,39 @@ namespace VeraCrypt
 #endif
 	}
 	
+	void CipherCamellia::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, true);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	void CipherCamellia::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, false);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	bool CipherCamellia::IsXtsKernelAvailable (const Cipher &tweakCipher) const
+	{
+#if CRYPTOPP_BOOL_X64 && CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE && !defined(CRYPTOPP_DISABLE_ASM)
+		return IsHwSupportAvailable();
+#else
+		return false;
+#endif
+	}
+
 	bool CipherCamellia::IsHwSupportAvailable () const
 	{
 #if CRYPTOPP_BOOL_X64 && !defined(CRYPTOPP_DISABLE_ASM)
@@ -501,6 +797,39 @@ namespace VeraCrypt
 #endif
 			Cipher::DecryptBlocks (data, blockCount);
 	}
+
+	void CipherKuznyechik::DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, true);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	void CipherKuznyechik::EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const
+	{
+		if (!Initialized)
+			throw NotInitialized (SRC_POS);
+
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		ProcessDataUnitGroupsXTS (*this, tweakCipher, data, blockCount, startDataUnitNo, false);
+#else
+		throw NotApplicable (SRC_POS);
+#endif
+	}
+
+	bool CipherKuznyechik::IsXtsKernelAvailable (const Cipher &tweakCipher) const
+	{
+#if CRYPTOPP_BOOL_SSE2_INTRINSICS_AVAILABLE
+		return IsHwSupportAvailable();
+#else
+		return false;
+#endif
+	}
 	
 	bool CipherKuznyechik::IsHwSupportAvailable () const
 	{
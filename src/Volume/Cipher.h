@@ -30,6 +30,9 @@ namespace VeraCrypt
 		virtual void DecryptBlocks (uint8 *data, size_t blockCount) const;
             #ifndef WOLFCRYPT_BACKEND
                 static void EnableHwSupport (bool enable) { HwSupportEnabled = enable; }
+		virtual void DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const;
+		virtual void EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const;
+		virtual bool IsXtsKernelAvailable (const Cipher &tweakCipher) const { return false; }
 	    #else
                 static void EnableHwSupport (bool enable) { HwSupportEnabled = false; }
                 virtual void EncryptBlockXTS (uint8 *data, uint64 length, uint64 startDataUnitNo) const;
@@ -138,17 +141,30 @@ namespace VeraCrypt
 
 #endif
 
-#define TC_CIPHER_ADD_METHODS \
+#define TC_CIPHER_ADD_BLOCK_METHODS \
 	virtual void DecryptBlocks (uint8 *data, size_t blockCount) const; \
 	virtual void EncryptBlocks (uint8 *data, size_t blockCount) const; \
 	virtual bool IsHwSupportAvailable () const;
 
+#ifdef WOLFCRYPT_BACKEND
+#define TC_CIPHER_ADD_XTS_METHODS
+#else
+#define TC_CIPHER_ADD_XTS_METHODS \
+	virtual void DecryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const; \
+	virtual void EncryptDataUnitsXTS (uint8 *data, uint64 blockCount, uint64 startDataUnitNo, const Cipher &tweakCipher) const; \
+	virtual bool IsXtsKernelAvailable (const Cipher &tweakCipher) const;
+#endif
+
+#define TC_CIPHER_ADD_METHODS TC_CIPHER_ADD_BLOCK_METHODS TC_CIPHER_ADD_XTS_METHODS
+
 	TC_CIPHER (AES, 16, 32);
 	TC_CIPHER (Serpent, 16, 32);
 	TC_CIPHER (Twofish, 16, 32);
 	TC_CIPHER (Camellia, 16, 32);
 	TC_CIPHER (Kuznyechik, 16, 32);
 
+#undef TC_CIPHER_ADD_XTS_METHODS
+#undef TC_CIPHER_ADD_BLOCK_METHODS
 #undef TC_CIPHER_ADD_METHODS
 #define TC_CIPHER_ADD_METHODS
 
@@ -100,6 +100,13 @@ namespace VeraCrypt
 
 		remainingBlocks = length / BYTES_PER_XTS_BLOCK;
 
+		// Single-pass kernel computing whitening values in registers
+		if (startCipherBlockNo == 0 && cipher.IsXtsKernelAvailable (secondaryCipher))
+		{
+			cipher.EncryptDataUnitsXTS (buffer, remainingBlocks, startDataUnitNo, secondaryCipher);
+			return;
+		}
+
 		// Process all blocks in the buffer
 		while (remainingBlocks > 0)
 		{
@@ -272,6 +279,13 @@ namespace VeraCrypt
 
 		remainingBlocks = length / BYTES_PER_XTS_BLOCK;
 
+		// Single-pass kernel computing whitening values in registers
+		if (startCipherBlockNo == 0 && cipher.IsXtsKernelAvailable (secondaryCipher))
+		{
+			cipher.DecryptDataUnitsXTS (buffer, remainingBlocks, startDataUnitNo, secondaryCipher);
+			return;
+		}
+
 		// Process all blocks in the buffer
 		while (remainingBlocks > 0)
 		{
@@ -376,6 +390,25 @@ namespace VeraCrypt
 		FAST_ERASE64 (whiteningValues, sizeof (whiteningValues));
         }
 
+	void EncryptionModeXTS::DecryptPartialDataUnit (uint8 *data, uint64 dataUnitNo, unsigned int startBlockNo, unsigned int blockCount) const
+	{
+		if_debug (ValidateState());
+
+		if (blockCount < 1 || startBlockNo >= BLOCKS_PER_XTS_DATA_UNIT || blockCount > BLOCKS_PER_XTS_DATA_UNIT - startBlockNo)
+			throw ParameterIncorrect (SRC_POS);
+
+		// Each XTS block depends only on its own ciphertext and tweak, so the ciphers of a cascade can be applied to a part of a data unit
+		CipherList::const_iterator iSecondaryCipher = SecondaryCiphers.end();
+
+		for (CipherList::const_reverse_iterator iCipher = Ciphers.rbegin(); iCipher != Ciphers.rend(); ++iCipher)
+		{
+			--iSecondaryCipher;
+			DecryptBufferXTS (**iCipher, **iSecondaryCipher, data, (uint64) blockCount * BYTES_PER_XTS_BLOCK, dataUnitNo, startBlockNo);
+		}
+
+		assert (iSecondaryCipher == SecondaryCiphers.begin());
+	}
+
 	void EncryptionModeXTS::DecryptSectorsCurrentThread (uint8 *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const
 	{
 		DecryptBuffer (data, sectorCount * sectorSize, sectorIndex * sectorSize / ENCRYPTION_DATA_UNIT_SIZE);
@@ -25,6 +25,7 @@ namespace VeraCrypt
 		virtual ~EncryptionModeXTS () { }
 
 		virtual void Decrypt (uint8 *data, uint64 length) const;
+		void DecryptPartialDataUnit (uint8 *data, uint64 dataUnitNo, unsigned int startBlockNo, unsigned int blockCount) const;
 		virtual void DecryptSectorsCurrentThread (uint8 *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
 		virtual void Encrypt (uint8 *data, uint64 length) const;
 		virtual void EncryptSectorsCurrentThread (uint8 *data, uint64 sectorIndex, uint64 sectorCount, size_t sectorSize) const;
@@ -20,6 +20,7 @@
 #include "EncryptionModeWolfCryptXTS.h"
 #endif
 #include "EncryptionTest.h"
+#include "EncryptionThreadPool.h"
 #include "Pkcs5Kdf.h"
 #include "VolumeHeader.h"
 
@@ -83,7 +84,10 @@ namespace VeraCrypt
 
 		TestCiphers();
 		TestXtsAES();
+		TestXtsKernels();
+		TestXtsPartialDataUnits();
 		TestXts();
+		TestEncryptionThreadPool();
 		TestPkcs5();
 	}
 
@@ -223,6 +227,39 @@ namespace VeraCrypt
 		}
 	}
 
+	// Encrypts and decrypts copies of each test vector in a single call so that every multi-block path
+	// (16, 8, 4 and 1 block at a time) processes some of them
+	static void TestCipherBlocks (Cipher &cipher, const CipherTestVector *testVector, size_t testVectorCount)
+	{
+		const size_t blockCount = 64 + 32 + 16 + 8 + 4 + 2 + 1;
+		size_t blockSize = cipher.GetBlockSize();
+		Buffer buffer (blockSize * blockCount);
+
+		for (size_t i = 0; i < testVectorCount; ++i)
+		{
+			cipher.SetKey (ConstBufferPtr (testVector[i].Key, testVector[i].KeyLength));
+
+			for (size_t b = 0; b < blockCount; ++b)
+				buffer.GetRange (b * blockSize, blockSize).CopyFrom (ConstBufferPtr (testVector[i].Plaintext, blockSize));
+
+			cipher.EncryptBlocks (buffer, blockCount);
+
+			for (size_t b = 0; b < blockCount; ++b)
+			{
+				if (memcmp (buffer.Ptr() + b * blockSize, testVector[i].Ciphertext, blockSize) != 0)
+					throw TestFailed (SRC_POS);
+			}
+
+			cipher.DecryptBlocks (buffer, blockCount);
+
+			for (size_t b = 0; b < blockCount; ++b)
+			{
+				if (memcmp (buffer.Ptr() + b * blockSize, testVector[i].Plaintext, blockSize) != 0)
+					throw TestFailed (SRC_POS);
+			}
+		}
+	}
+
 	void EncryptionTest::TestCiphers ()
 	{
 			CipherAES aes;
@@ -250,15 +287,19 @@ namespace VeraCrypt
         #ifndef WOLFCRYPT_BACKEND
 			CipherSerpent serpent;
 			TestCipher (serpent, SerpentTestVectors, array_capacity (SerpentTestVectors));
+			TestCipherBlocks (serpent, SerpentTestVectors, array_capacity (SerpentTestVectors));
 
 			CipherTwofish twofish;
 			TestCipher (twofish, TwofishTestVectors, array_capacity (TwofishTestVectors));
+			TestCipherBlocks (twofish, TwofishTestVectors, array_capacity (TwofishTestVectors));
 			
 			CipherCamellia camellia;
 			TestCipher (camellia, CamelliaTestVectors, array_capacity (CamelliaTestVectors));
+			TestCipherBlocks (camellia, CamelliaTestVectors, array_capacity (CamelliaTestVectors));
 			
 			CipherKuznyechik kuznyechik;
 			TestCipher (kuznyechik, KuznyechikTestVectors, array_capacity (KuznyechikTestVectors));
+			TestCipherBlocks (kuznyechik, KuznyechikTestVectors, array_capacity (KuznyechikTestVectors));
         #endif
 	}
 
@@ -526,6 +567,294 @@ namespace VeraCrypt
 		}
 	}
 
+	void EncryptionTest::TestXtsKernels ()
+	{
+#ifndef WOLFCRYPT_BACKEND
+		// Single-pass XTS kernels of ciphers must match a reference implementation based on single block encryption
+		static const uint64 blockCounts[] = { 1, 2, 3, 5, 7, 8, 15, 16, 17, 31, 32, 33, 47, 64, 96 + 9, 128 };
+		static const uint64 dataUnitNumbers[] = { 0, 1, 0x123456789ULL, 0xfffffffffffffffeULL };
+		const size_t maxBlockCount = 128;
+
+		foreach_ref (const Cipher &prototype, Cipher::GetAvailableCiphers())
+		{
+			shared_ptr <Cipher> cipher = prototype.GetNew();
+			shared_ptr <Cipher> tweakCipher = prototype.GetNew();
+
+			if (!cipher->IsXtsKernelAvailable (*tweakCipher))
+				continue;
+
+			const size_t blockSize = cipher->GetBlockSize();
+			SecureBuffer key (cipher->GetKeySize() * 2);
+			for (size_t i = 0; i < key.Size(); ++i)
+				key.Ptr()[i] = (uint8) (i * 13 + 5);
+
+			cipher->SetKey (key.GetRange (0, cipher->GetKeySize()));
+			tweakCipher->SetKey (key.GetRange (cipher->GetKeySize(), tweakCipher->GetKeySize()));
+
+			Buffer plaintext (maxBlockCount * blockSize);
+			Buffer expected (plaintext.Size());
+			Buffer data (plaintext.Size());
+
+			for (size_t i = 0; i < plaintext.Size(); ++i)
+				plaintext.Ptr()[i] = (uint8) (i * 7 + i / ENCRYPTION_DATA_UNIT_SIZE);
+
+			for (size_t u = 0; u < array_capacity (dataUnitNumbers); ++u)
+			{
+				for (size_t c = 0; c < array_capacity (blockCounts); ++c)
+				{
+					uint64 blockCount = blockCounts[c];
+					uint8 tweak[16];
+					expected.CopyFrom (plaintext);
+
+					for (uint64 block = 0; block < blockCount; ++block)
+					{
+						uint8 *b = expected.Ptr() + block * blockSize;
+
+						if (block % BLOCKS_PER_XTS_DATA_UNIT == 0)
+						{
+							*((uint64 *) tweak) = Endian::Little (dataUnitNumbers[u] + block / BLOCKS_PER_XTS_DATA_UNIT);
+							*((uint64 *) tweak + 1) = 0;
+							tweakCipher->EncryptBlock (tweak);
+						}
+
+						for (size_t i = 0; i < blockSize; ++i)
+							b[i] ^= tweak[i];
+						cipher->EncryptBlock (b);
+						for (size_t i = 0; i < blockSize; ++i)
+							b[i] ^= tweak[i];
+
+						// Multiply the tweak by x in GF(2^128)
+						uint8 carry = 0;
+						for (size_t i = 0; i < sizeof (tweak); ++i)
+						{
+							uint8 nextCarry = tweak[i] >> 7;
+							tweak[i] = (uint8) ((tweak[i] << 1) | carry);
+							carry = nextCarry;
+						}
+
+						if (carry)
+							tweak[0] ^= 0x87;
+					}
+
+					data.CopyFrom (plaintext);
+					cipher->EncryptDataUnitsXTS (data.Ptr(), blockCount, dataUnitNumbers[u], *tweakCipher);
+
+					if (memcmp (data.Ptr(), expected.Ptr(), (size_t) blockCount * blockSize) != 0
+						|| memcmp (data.Ptr() + blockCount * blockSize, plaintext.Ptr() + blockCount * blockSize, data.Size() - (size_t) blockCount * blockSize) != 0)
+						throw TestFailed (SRC_POS);
+
+					cipher->DecryptDataUnitsXTS (data.Ptr(), blockCount, dataUnitNumbers[u], *tweakCipher);
+
+					if (memcmp (data.Ptr(), plaintext.Ptr(), data.Size()) != 0)
+						throw TestFailed (SRC_POS);
+				}
+			}
+		}
+#endif
+	}
+
+	void EncryptionTest::TestXtsPartialDataUnits ()
+	{
+#ifndef WOLFCRYPT_BACKEND
+		// Decryption of a range of blocks must match the same range of a data unit decrypted in full
+		const uint64 dataUnitNo = 0x123456789aULL;
+
+		Buffer ciphertext (ENCRYPTION_DATA_UNIT_SIZE);
+		for (size_t i = 0; i < ciphertext.Size(); ++i)
+			ciphertext.Ptr()[i] = (uint8) (i * 11 + 3);
+
+		Buffer expected (ciphertext.Size());
+		Buffer data (ciphertext.Size());
+
+		foreach (shared_ptr <EncryptionAlgorithm> prototype, EncryptionAlgorithm::GetAvailableAlgorithms())
+		{
+			shared_ptr <EncryptionAlgorithm> ea = prototype->GetNew();
+			shared_ptr <EncryptionModeXTS> xts (new EncryptionModeXTS);
+
+			SecureBuffer key (ea->GetKeySize());
+			for (size_t i = 0; i < key.Size(); ++i)
+				key.Ptr()[i] = (uint8) (i * 17 + 1);
+
+			ea->SetKey (key);
+			xts->SetKey (key);
+			ea->SetMode (xts);
+
+			expected.CopyFrom (ciphertext);
+			xts->DecryptSectorsCurrentThread (expected.Ptr(), dataUnitNo, 1, ENCRYPTION_DATA_UNIT_SIZE);
+
+			const unsigned int ranges[][2] = { { 0, 1 }, { 5, 19 }, { BLOCKS_PER_XTS_DATA_UNIT - 1, 1 }, { 0, BLOCKS_PER_XTS_DATA_UNIT } };
+
+			for (size_t i = 0; i < array_capacity (ranges); ++i)
+			{
+				size_t offset = ranges[i][0] * BYTES_PER_XTS_BLOCK;
+				size_t length = ranges[i][1] * BYTES_PER_XTS_BLOCK;
+
+				memcpy (data.Ptr(), ciphertext.Ptr() + offset, length);
+				xts->DecryptPartialDataUnit (data.Ptr(), dataUnitNo, ranges[i][0], ranges[i][1]);
+
+				if (memcmp (data.Ptr(), expected.Ptr() + offset, length) != 0)
+					throw TestFailed (SRC_POS);
+			}
+
+			try
+			{
+				xts->DecryptPartialDataUnit (data.Ptr(), dataUnitNo, 1, BLOCKS_PER_XTS_DATA_UNIT);
+				throw TestFailed (SRC_POS);
+			}
+			catch (ParameterIncorrect &) { }
+		}
+#endif
+	}
+
+	void EncryptionTest::TestEncryptionThreadPool ()
+	{
+		// Concurrent submitters must obtain the same results as sequential processing
+		AES aes;
+#ifdef WOLFCRYPT_BACKEND
+		shared_ptr <EncryptionMode> xts (new EncryptionModeWolfCryptXTS);
+#else
+		shared_ptr <EncryptionMode> xts (new EncryptionModeXTS);
+#endif
+		aes.SetKey (ConstBufferPtr (XtsTestVectors[0].key1, sizeof (XtsTestVectors[0].key1)));
+#ifdef WOLFCRYPT_BACKEND
+		aes.SetKeyXTS (ConstBufferPtr (XtsTestVectors[0].key2, sizeof (XtsTestVectors[0].key2)));
+#endif
+		xts->SetKey (ConstBufferPtr (XtsTestVectors[0].key2, sizeof (XtsTestVectors[0].key2)));
+		aes.SetMode (xts);
+
+		const size_t sectorCount = EncryptionThreadPool::MaxThreadCount * 2 + 3;
+		const size_t sectorSize = ENCRYPTION_DATA_UNIT_SIZE;
+
+		Buffer plaintext (sectorCount * sectorSize);
+		for (size_t i = 0; i < plaintext.Size(); ++i)
+			plaintext.Ptr()[i] = (uint8) (i * 7 + i / sectorSize);
+
+		Buffer ciphertext (plaintext.Size());
+		ciphertext.CopyFrom (plaintext);
+		xts->EncryptSectorsCurrentThread (ciphertext.Ptr(), 0, sectorCount, sectorSize);
+
+		struct SubmitterFunctor : public Functor
+		{
+			SubmitterFunctor (const EncryptionAlgorithm &ea, const Buffer &plaintext, const Buffer &ciphertext, size_t sectorCount, size_t sectorSize, SharedVal <size_t> &failureCount)
+				: Ciphertext (ciphertext), EA (ea), FailureCount (failureCount), Plaintext (plaintext), SectorCount (sectorCount), SectorSize (sectorSize) { }
+
+			virtual void operator() ()
+			{
+				try
+				{
+					Buffer data (Plaintext.Size());
+
+					for (int iteration = 0; iteration < 20; ++iteration)
+					{
+						for (size_t unitCount = 1 + iteration % 3; unitCount <= SectorCount; unitCount += 5)
+						{
+							size_t startUnit = (SectorCount - unitCount) / 2;
+							size_t offset = startUnit * SectorSize;
+							size_t length = unitCount * SectorSize;
+
+							memcpy (data.Ptr(), Plaintext.Ptr() + offset, length);
+
+							EA.EncryptSectors (data.Ptr(), startUnit, unitCount, SectorSize);
+							if (memcmp (data.Ptr(), Ciphertext.Ptr() + offset, length) != 0)
+								throw TestFailed (SRC_POS);
+
+							EA.DecryptSectors (data.Ptr(), startUnit, unitCount, SectorSize);
+							if (memcmp (data.Ptr(), Plaintext.Ptr() + offset, length) != 0)
+								throw TestFailed (SRC_POS);
+						}
+					}
+				}
+				catch (...)
+				{
+					FailureCount.Increment();
+				}
+			}
+
+			const Buffer &Ciphertext;
+			const EncryptionAlgorithm &EA;
+			SharedVal <size_t> &FailureCount;
+			const Buffer &Plaintext;
+			size_t SectorCount;
+			size_t SectorSize;
+		};
+
+		SharedVal <size_t> failureCount (0);
+		list < shared_ptr <Thread> > submitters;
+
+		for (int i = 0; i < 4; ++i)
+		{
+			make_shared_auto (Thread, thread);
+			thread->Start (new SubmitterFunctor (aes, plaintext, ciphertext, sectorCount, sectorSize, failureCount));
+			submitters.push_back (thread);
+		}
+
+		foreach_ref (const Thread &thread, submitters)
+		{
+			thread.Join();
+		}
+
+		if (failureCount.Get() != 0)
+			throw TestFailed (SRC_POS);
+
+		// Asynchronous batch submission
+		struct CompletionFunctor : public Functor
+		{
+			CompletionFunctor (SharedVal <size_t> &completionCount) : CompletionCount (completionCount) { }
+			virtual void operator() () { CompletionCount.Increment(); }
+
+			SharedVal <size_t> &CompletionCount;
+		};
+
+		const size_t requestCount = 7;
+		const size_t requestUnitCount = sectorCount / requestCount;
+
+		Buffer data (plaintext.Size());
+		data.CopyFrom (plaintext);
+
+		EncryptionThreadPool::AsyncWork works[requestCount];
+		vector <EncryptionThreadPool::WorkRequest> requests;
+		SharedVal <size_t> completionCount (0);
+
+		for (size_t i = 0; i < requestCount; ++i)
+		{
+			works[i].SetCompletionCallback (shared_ptr <Functor> (new CompletionFunctor (completionCount)));
+
+			EncryptionThreadPool::WorkRequest request;
+			request.Work = &works[i];
+			request.Type = EncryptionThreadPool::WorkType::EncryptDataUnits;
+			request.Mode = xts.get();
+			request.Data = data.Ptr() + i * requestUnitCount * sectorSize;
+			request.StartUnitNo = i * requestUnitCount;
+			request.UnitCount = (i == requestCount - 1) ? sectorCount - i * requestUnitCount : requestUnitCount;
+			request.SectorSize = sectorSize;
+
+			requests.push_back (request);
+		}
+
+		EncryptionThreadPool::BeginWork (requests);
+
+		for (size_t i = 0; i < requestCount; ++i)
+			works[i].Wait();
+
+		if (completionCount.Get() != requestCount || memcmp (data.Ptr(), ciphertext.Ptr(), data.Size()) != 0)
+			throw TestFailed (SRC_POS);
+
+		// Tokens are reusable once completed
+		for (size_t i = 0; i < requestCount; ++i)
+			EncryptionThreadPool::BeginWork (works[i], EncryptionThreadPool::WorkType::DecryptDataUnits, xts.get(), requests[i].Data, requests[i].StartUnitNo, requests[i].UnitCount, sectorSize);
+
+		for (size_t i = 0; i < requestCount; ++i)
+		{
+			while (!works[i].IsCompleted())
+				Thread::Sleep (1);
+
+			works[i].Wait();
+		}
+
+		if (completionCount.Get() != requestCount * 2 || memcmp (data.Ptr(), plaintext.Ptr(), data.Size()) != 0)
+			throw TestFailed (SRC_POS);
+	}
+
 	void EncryptionTest::TestXts ()
 	{
 		unsigned char buf [ENCRYPTION_DATA_UNIT_SIZE * 4];
@@ -1200,6 +1529,54 @@ namespace VeraCrypt
 		if (memcmp (derivedKey.Ptr(), "\xd0\x53\xa2\x30", 4) != 0)
 			throw TestFailed (SRC_POS);
 
+		// Keys longer than the hash output (several blocks may be derived together by a multi-buffer core)
+		Buffer longKey (144);
+		if (pkcs5HmacSha256.DeriveKey (longKey, password, salt, 5) != 0)
+			throw TestFailed (SRC_POS);
+		if (memcmp (longKey.Ptr(), "\xf2\xa0\x4f\xb2\xd3\xe9\xa5\xd8\x51\x0b\x5c\x06\xdf\x70\x8e\x24\xe9\xc7\xd9\x15\x3d\x22\xcd\xde\xb8\xa6\xdb\xfd\x71\x85\xc6\x99\x32\xc0\xee\x37\x27\xf7\x24\xcf\xea\xa6\xac\x73\xa1\x4c\x4e\x52\x9b\x94\xf3\x54\x06\xfc\x04\x65\xa1\x0a\x24\xfe\xf0\x98\x1d\xa6\x22\x28\xeb\x24\x55\x74\xce\x6a\x3a\x28\xe2\x04\x3a\x59\x13\xec\x3f\xf2\xdb\xcf\x58\xdd\x53\xd9\xf9\x17\xf6\xda\x74\x06\x3c\x0b\x66\xf5\x0f\xf5\x58\xa3\x27\x52\x8c\x5b\x07\x91\xd0\x81\xeb\xb6\xbc\x30\x69\x42\x71\xf2\xd7\x18\x42\xbe\xe8\x02\x93\x70\x66\xad\x35\x65\xbc\xf7\x96\x8e\x64\xf1\xc6\x92\xda\xe0\xdc\x1f\xb5\xf4", 144) != 0)
+			throw TestFailed (SRC_POS);
+
+		if (pkcs5HmacSha512.DeriveKey (longKey, password, salt, 5) != 0)
+			throw TestFailed (SRC_POS);
+		if (memcmp (longKey.Ptr(), "\x13\x64\xae\xf8\x0d\xf5\x57\x6c\x30\xd5\x71\x4c\xa7\x75\x3f\xfd\x00\xe5\x25\x8b\x39\xc7\x44\x7f\xce\x23\x3d\x08\x75\xe0\x2f\x48\xd6\x30\xd7\x00\xb6\x24\xdb\xe0\x5a\xd7\x47\xef\x52\xca\xa6\x34\x83\x47\xe5\xcb\xe9\x87\xf1\x20\x59\x6a\xe6\xa9\xcf\x51\x78\xc6\xb6\x23\xa6\x74\x0d\xe8\x91\xbe\x1a\xd0\x28\xcc\xce\x16\x98\x9a\xbe\xfb\xdc\x78\xc9\xe1\x7d\x72\x67\xce\xe1\x61\x56\x5f\x96\x68\xe6\xe1\xdd\xf4\xbf\x1b\x80\xe0\x19\x1c\xf4\xc4\xd3\xdd\xd5\xd5\x57\x2d\x83\xc7\xa3\x37\x87\xf4\x4e\xe0\xf6\xd8\x6d\x65\xdc\xa0\x52\xa3\x13\xbe\x81\xfc\x30\xbe\x7d\x69\x58\x34\xb6\xdd\x41\xc6", 144) != 0)
+			throw TestFailed (SRC_POS);
+
+		if (pkcs5HmacBlake2s.DeriveKey (longKey.GetRange (0, 48), password, salt, 5) != 0)
+			throw TestFailed (SRC_POS);
+		if (memcmp (longKey.Ptr(), "\x8d\x51\xfa\x31\x46\x25\x37\x67\xa3\x29\x6b\x3c\x6b\xc1\x5d\xb2\xee\xe1\x6c\x28\x00\x26\xea\x08\x65\x9c\x12\xf1\x07\xde\x0d\xb9\x9b\x4f\x39\xfa\xc6\x80\x26\xb1\x8f\x8e\x48\x89\x85\x2d\x24\x2d", 48) != 0)
+			throw TestFailed (SRC_POS);
+
+		// Keys derived in parts, concurrently if the encryption thread pool is running, must match serial derivation
+		foreach (shared_ptr <Pkcs5Kdf> kdf, Pkcs5Kdf::GetAvailableAlgorithms())
+		{
+			size_t blockSize = kdf->GetDerivationBlockSize();
+			if (blockSize == 0)
+				continue;
+
+			size_t keySizes[] = { VolumeHeader::GetLargestSerializedKeySize(), 3 * blockSize - 5 };
+
+			for (size_t i = 0; i < array_capacity (keySizes); ++i)
+			{
+				size_t keySize = keySizes[i];
+				Buffer serialKey (keySize);
+				Buffer parallelKey (keySize);
+				Buffer keyPart (blockSize + 1);
+
+				if (kdf->DeriveKey (serialKey, password, salt, 5) != 0
+					|| EncryptionThreadPool::DeriveKeyInParts (*kdf, parallelKey, password, salt, 5, nullptr) != 0
+					|| memcmp (serialKey.Ptr(), parallelKey.Ptr(), keySize) != 0)
+				{
+					throw TestFailed (SRC_POS);
+				}
+
+				if (kdf->DeriveKeyPart (keyPart, password, salt, 5, 1, nullptr) != 0
+					|| memcmp (serialKey.Ptr() + blockSize, keyPart.Ptr(), keyPart.Size()) != 0)
+				{
+					throw TestFailed (SRC_POS);
+				}
+			}
+		}
+
 	#ifndef VC_DCS_DISABLE_ARGON2
 		Pkcs5Argon2 pkcs5Argon2;
 		static const uint8 argon2SaltData[] = { 's', 'o', 'm', 'e', 's', 'a', 'l', 't' };
@@ -1231,6 +1608,21 @@ namespace VeraCrypt
 		if (memcmp (argon2HeaderKey.Ptr(), argon2Pim1HeaderKeyPrefix, sizeof (argon2Pim1HeaderKeyPrefix)) != 0)
 			throw TestFailed (SRC_POS);
 
+		// PIM 1 maps to Argon2id t=3, m=64 MiB, p=4; the lanes are filled on the workers if the thread pool is running.
+		Pkcs5Argon2P4 pkcs5Argon2P4;
+		static const uint8 argon2P4Pim1DerivedKey[] =
+		{
+			0x66, 0x1f, 0xef, 0xbd, 0x6f, 0x29, 0xbc, 0xbc,
+			0x8f, 0x46, 0x46, 0xab, 0xc3, 0x2a, 0x9d, 0x7a,
+			0x46, 0x45, 0xbb, 0x5c, 0x05, 0x95, 0x37, 0xf8,
+			0xa5, 0x58, 0x7f, 0x31, 0xad, 0xbe, 0xcc, 0xcd
+		};
+
+		if (pkcs5Argon2P4.DeriveKey (argon2DerivedKey, password, 1, argon2Salt) != 0)
+			throw TestFailed (SRC_POS);
+		if (memcmp (argon2DerivedKey.Ptr(), argon2P4Pim1DerivedKey, sizeof (argon2P4Pim1DerivedKey)) != 0)
+			throw TestFailed (SRC_POS);
+
 		try
 		{
 			if (pkcs5Argon2.DeriveKey (derivedKey, password, salt, 5) != 0)
@@ -1297,6 +1689,53 @@ namespace VeraCrypt
 		catch (ExternalException&)
 		{
 		}
+
+		// The first decryptable candidate in list order is reported, whichever key derivation completes first
+		SecureBuffer corruptedHeaderBuffer (TC_VOLUME_HEADER_SIZE);
+		corruptedHeaderBuffer.CopyFrom (headerBuffer);
+		corruptedHeaderBuffer.Ptr()[VolumeHeader::GetSaltSize() + 16] ^= 1;
+
+		VolumeHeaderCandidateList candidates;
+		for (int i = 0; i < 3; ++i)
+		{
+			VolumeHeaderCandidate candidate;
+			candidate.Header.reset (new VolumeHeader (TC_VOLUME_HEADER_SIZE));
+			candidate.EncryptedData = (i == 0 ? corruptedHeaderBuffer : headerBuffer);
+			candidate.KeyDerivationFunctions = kdfs;
+			candidate.EncryptionAlgorithms.push_back (shared_ptr <EncryptionAlgorithm> (new AES));
+			candidate.EncryptionModes.push_back (shared_ptr <EncryptionMode> (new EncryptionModeXTS));
+			candidates.push_back (candidate);
+		}
+
+		if (VolumeHeader::DecryptFirst (candidates, password, 1, shared_ptr <Pkcs5Kdf> ()) != 1
+			|| candidates[1].Header->GetPkcs5Kdf()->GetName() != sha512Kdf->GetName())
+		{
+			throw TestFailed (SRC_POS);
+		}
+
+		// A hinted header that fails to decrypt falls back to the remaining derivations, as does a stale hint
+		VolumeHeaderHint hint;
+		hint.Pkcs5PrfName = sha512Kdf->GetName();
+		hint.EncryptionAlgorithmName = L"AES";
+
+		if (VolumeHeader::DecryptFirst (candidates, password, 1, shared_ptr <Pkcs5Kdf> (), hint) != 1)
+			throw TestFailed (SRC_POS);
+
+		candidates[0].HintApplicable = true;
+		if (VolumeHeader::DecryptFirst (candidates, password, 1, shared_ptr <Pkcs5Kdf> (), hint) != 1)
+			throw TestFailed (SRC_POS);
+
+		hint.Pkcs5PrfName = failingArgon2Kdf->GetName();
+		if (VolumeHeader::DecryptFirst (candidates, password, 1, shared_ptr <Pkcs5Kdf> (), hint) != 1
+			|| candidates[1].Header->GetPkcs5Kdf()->GetName() != sha512Kdf->GetName())
+		{
+			throw TestFailed (SRC_POS);
+		}
+
+		candidates.pop_back();
+		candidates.pop_back();
+		if (VolumeHeader::DecryptFirst (candidates, password, 1, sha512Kdf) != -1)
+			throw TestFailed (SRC_POS);
 	#endif
          #else
                Pkcs5HmacSha256 pkcs5HmacSha256;
@@ -26,10 +26,13 @@ namespace VeraCrypt
 
 	protected:
 		static void TestCiphers ();
+		static void TestEncryptionThreadPool ();
 		static void TestLegacyModes ();
 		static void TestPkcs5 ();
 		static void TestXts ();
 		static void TestXtsAES ();
+		static void TestXtsKernels ();
+		static void TestXtsPartialDataUnits ();
 
 	struct XtsTestVector
 	{
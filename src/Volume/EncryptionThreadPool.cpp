@@ -10,6 +10,8 @@
  code distribution packages.
 */
 
+#include <algorithm>
+
 #ifdef TC_UNIX
 #	include <unistd.h>
 #endif
@@ -19,6 +21,7 @@
 #	include <sys/sysctl.h>
 #endif
 
+#include "Platform/CpuTopology.h"
 #include "Platform/SyncEvent.h"
 #include "Platform/SystemLog.h"
 #include "Common/Crypto.h"
@@ -36,28 +39,106 @@ namespace VeraCrypt
 	{
 	}
 
-	void EncryptionThreadPool::BeginKeyDerivation (KeyDerivationWorkItem &keyDerivationWorkItem, const VolumePassword &password, int pim, const ConstBufferPtr &salt, SyncEvent &completionEvent, SyncEvent &noOutstandingWorkItemEvent, SharedVal <size_t> &outstandingWorkItemCount, long volatile *abortFlag)
+	EncryptionThreadPool::AsyncWork::~AsyncWork ()
 	{
-		if (!ThreadPoolRunning)
-			throw NotInitialized (SRC_POS);
+		// Workers may still reference the fragments of a pending request
+		while (!IsCompleted())
+			Completion.ItemCompletedEvent.Wait();
+
+		ScopeLock completionLock (Completion.CompletionMutex);
+	}
 
-		ScopeLock lock (EnqueueMutex);
+	void EncryptionThreadPool::AsyncWork::Wait ()
+	{
+		while (!IsCompleted())
+			Completion.ItemCompletedEvent.Wait();
 
-		WorkItem *workItem = &WorkItemQueue[EnqueuePosition++];
+		if (Completion.ItemException.get())
+			Completion.ItemException->Throw();
+	}
 
-		if (EnqueuePosition >= QueueSize)
-			EnqueuePosition = 0;
+	EncryptionThreadPool::WorkQueue::WorkQueue () : WorkerSleeping (false)
+	{
+		Clear();
+	}
 
-		while (workItem->State != WorkItem::State::Free)
+	void EncryptionThreadPool::WorkQueue::Clear ()
+	{
+		for (size_t i = 0; i < QueueSize; ++i)
 		{
-			WorkItemCompletedEvent.Wait();
+			Cells[i].Sequence.store (i, memory_order_relaxed);
+			Cells[i].Item = nullptr;
+		}
+
+		EnqueuePosition.store (0, memory_order_relaxed);
+		DequeuePosition.store (0, memory_order_relaxed);
+		WorkerSleeping.store (false, memory_order_relaxed);
+		WorkItemReadyEvent.Reset();
+	}
+
+	EncryptionThreadPool::WorkItem *EncryptionThreadPool::WorkQueue::Pop ()
+	{
+		size_t position = DequeuePosition.load (memory_order_relaxed);
+		Cell *cell;
+
+		while (true)
+		{
+			cell = &Cells[position % QueueSize];
+			ptrdiff_t diff = (ptrdiff_t) cell->Sequence.load (memory_order_acquire) - (ptrdiff_t) (position + 1);
+
+			if (diff == 0)
+			{
+				if (DequeuePosition.compare_exchange_weak (position, position + 1, memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return nullptr;
+			else
+				position = DequeuePosition.load (memory_order_relaxed);
 		}
 
+		WorkItem *workItem = cell->Item;
+		cell->Sequence.store (position + QueueSize, memory_order_release);
+		return workItem;
+	}
+
+	bool EncryptionThreadPool::WorkQueue::Push (WorkItem *workItem)
+	{
+		size_t position = EnqueuePosition.load (memory_order_relaxed);
+		Cell *cell;
+
+		while (true)
+		{
+			cell = &Cells[position % QueueSize];
+			ptrdiff_t diff = (ptrdiff_t) cell->Sequence.load (memory_order_acquire) - (ptrdiff_t) position;
+
+			if (diff == 0)
+			{
+				if (EnqueuePosition.compare_exchange_weak (position, position + 1, memory_order_relaxed))
+					break;
+			}
+			else if (diff < 0)
+				return false;
+			else
+				position = EnqueuePosition.load (memory_order_relaxed);
+		}
+
+		cell->Item = workItem;
+		cell->Sequence.store (position + 1, memory_order_release);
+		return true;
+	}
+
+	void EncryptionThreadPool::BeginKeyDerivation (KeyDerivationWorkItem &keyDerivationWorkItem, const VolumePassword &password, int pim, const ConstBufferPtr &salt, SyncEvent &completionEvent, SyncEvent &noOutstandingWorkItemEvent, SharedVal <size_t> &outstandingWorkItemCount, long volatile *abortFlag)
+	{
+		if (!ThreadPoolRunning)
+			throw NotInitialized (SRC_POS);
+
 		keyDerivationWorkItem.Completed.Set (false);
 		keyDerivationWorkItem.ItemException.reset();
 		keyDerivationWorkItem.Processed = false;
 		keyDerivationWorkItem.Result = 0;
 
+		WorkItem *workItem = &keyDerivationWorkItem.QueuedItem;
 		workItem->Type = WorkType::DeriveKey;
 		workItem->KeyDerivation.AbortFlag = abortFlag;
 		workItem->KeyDerivation.CompletionEvent = &completionEvent;
@@ -75,118 +156,711 @@ namespace VeraCrypt
 				noOutstandingWorkItemEvent.Reset();
 		}
 
-		workItem->State.Set (WorkItem::State::Ready);
-		WorkItemReadyEvent.Signal();
+		size_t queueIndex = NextQueueIndex.fetch_add (1, memory_order_relaxed);
+		EnqueueWorkItem (workItem, queueIndex % WorkerGroups.size(), queueIndex / WorkerGroups.size());
 	}
 
-	void EncryptionThreadPool::DoWork (WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	void EncryptionThreadPool::BeginWork (AsyncWork &work, WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
+		WorkRequest request;
+		request.Work = &work;
+		request.Type = type;
+		request.Mode = encryptionMode;
+		request.Data = data;
+		request.StartUnitNo = startUnitNo;
+		request.UnitCount = unitCount;
+		request.SectorSize = sectorSize;
+
+		SubmitWork (request, false, nullptr);
+	}
+
+	void EncryptionThreadPool::BeginWork (const vector <WorkRequest> &requests)
+	{
+		foreach (const WorkRequest &request, requests)
+		{
+			if (!request.Work || (request.Type != WorkType::EncryptDataUnits && request.Type != WorkType::DecryptDataUnits))
+				throw ParameterIncorrect (SRC_POS);
+		}
+
+		size_t pendingWakeups[MaxThreadCount] = { 0 };
+
+		foreach (const WorkRequest &request, requests)
+		{
+			SubmitWork (request, false, pendingWakeups);
+		}
+
+		for (size_t i = 0; i < WorkerGroups.size() && ThreadPoolRunning; ++i)
+		{
+			if (pendingWakeups[i] > 0)
+				WakeWorkers (i, 0, pendingWakeups[i]);
+		}
+	}
+
+	void EncryptionThreadPool::CompleteWorkItem (WorkItem *workItem)
+	{
+		if (workItem->Type == WorkType::DeriveKey)
+		{
+			workItem->KeyDerivation.WorkItem->Completed.Set (true);
+			workItem->KeyDerivation.CompletionEvent->Signal();
+			{
+				ScopeLock outstandingWorkItemLock (KeyDerivationCompletionMutex);
+				if (workItem->KeyDerivation.OutstandingWorkItemCount->Decrement() == 0)
+					workItem->KeyDerivation.NoOutstandingWorkItemEvent->Signal();
+			}
+		}
+		else if (workItem->Type == WorkType::DeriveKeyPart)
+		{
+			ReleaseKeyDerivationParts (workItem->KeyDerivationPart.Parts);
+		}
+		else if (workItem->Type == WorkType::DeriveKeyLane)
+		{
+			ReleaseKeyDerivationLanes (workItem->KeyDerivationLane.Lanes);
+		}
+		else
+		{
+			WorkCompletion *completion = workItem->Encryption.Completion;
+			if (completion->OutstandingFragmentCount.fetch_sub (1, memory_order_acq_rel) == 1)
+			{
+				// The owner may release the request as soon as it observes completion, so the
+				// completion is reported under a lock its destructor and resubmission acquire.
+				ScopeLock completionLock (completion->CompletionMutex);
+
+				if (completion->CompletionCallback)
+				{
+					try
+					{
+						(*completion->CompletionCallback)();
+					}
+					catch (exception &e)
+					{
+						SystemLog::WriteException (e);
+					}
+					catch (...)
+					{
+						SystemLog::WriteException (UnknownException (SRC_POS));
+					}
+				}
+#ifdef TC_UNIX
+				if (completion->CompletionEventFd != -1)
+				{
+					uint64 eventCount = 1;
+					if (write (completion->CompletionEventFd, &eventCount, sizeof (eventCount)) != sizeof (eventCount))
+						SystemLog::WriteException (SystemException (SRC_POS));
+				}
+#endif
+				completion->Completed.store (true, memory_order_release);
+				completion->ItemCompletedEvent.Signal();
+			}
+		}
+
+		if (EnqueueWaiterCount.load (memory_order_seq_cst) > 0)
+			WorkItemCompletedEvent.Signal();
+	}
+
+	int EncryptionThreadPool::DeriveKeyInParts (const Pkcs5Kdf &kdf, const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *abortFlag)
+	{
+		size_t blockSize = kdf.GetDerivationBlockSize();
+
+		if (!ThreadPoolRunning || blockSize == 0 || key.Size() <= blockSize)
+			return kdf.DeriveKey (key, password, salt, iterationCount, abortFlag);
+
+		size_t group = GetWorkerGroup (key.Get());
+
+		KeyDerivationParts *parts = new KeyDerivationParts;
+		finally_do_arg (KeyDerivationParts *, parts, { ReleaseKeyDerivationParts (finally_arg); });
+
+		parts->Kdf = &kdf;
+		parts->Key = key.Get();
+		parts->KeySize = key.Size();
+		parts->Password = &password;
+		parts->Salt = salt.Get();
+		parts->SaltSize = salt.Size();
+		parts->IterationCount = iterationCount;
+		parts->AbortFlag = abortFlag;
+		parts->BlockSize = blockSize;
+		parts->BlockCount = (key.Size() + blockSize - 1) / blockSize;
+		parts->PartCount = min (parts->BlockCount, WorkerGroups[group].Workers.size());
+		parts->OutstandingPartCount.store (parts->PartCount, memory_order_relaxed);
+
+		for (size_t i = 0; i < parts->PartCount; ++i)
+		{
+			parts->PartClaimed[i].store (false, memory_order_relaxed);
+
+			WorkItem *workItem = &parts->QueuedItems[i];
+			workItem->Type = WorkType::DeriveKeyPart;
+			workItem->KeyDerivationPart.Parts = parts;
+			workItem->KeyDerivationPart.PartIndex = i;
+		}
+
+		// The first part is derived by the calling thread. Queueing must not block, as the
+		// caller may itself be a worker; parts not queued are derived by the caller as well.
+		size_t firstQueue = NextQueueIndex.fetch_add (parts->PartCount, memory_order_relaxed);
+		size_t queuedCount = 0;
+
+		for (size_t i = 1; i < parts->PartCount; ++i)
+		{
+			parts->ReferenceCount.fetch_add (1, memory_order_relaxed);
+
+			if (!TryEnqueueWorkItem (&parts->QueuedItems[i], group, firstQueue + i, false))
+			{
+				parts->ReferenceCount.fetch_sub (1, memory_order_relaxed);
+				break;
+			}
+
+			++queuedCount;
+		}
+
+		WakeWorkers (group, firstQueue + 1, queuedCount);
+
+		parts->PartClaimed[0].store (true, memory_order_relaxed);
+		DeriveKeyParts (parts, 0, 1);
+
+		// Runs of parts not claimed by workers are derived in a single call, which allows
+		// the KDF to process their blocks together (e.g. in the lanes of a multi-buffer core)
+		for (size_t i = 1; i < parts->PartCount; ++i)
+		{
+			size_t endPart = i;
+			while (endPart < parts->PartCount && !parts->PartClaimed[endPart].exchange (true, memory_order_acq_rel))
+				++endPart;
+
+			if (endPart > i)
+			{
+				DeriveKeyParts (parts, i, endPart);
+				i = endPart - 1;
+			}
+		}
+
+		// Only parts already being derived by workers remain
+		while (parts->OutstandingPartCount.load (memory_order_acquire) != 0)
+			parts->PartsCompletedEvent.Wait();
+
+		if (parts->ItemException.get())
+			parts->ItemException->Throw();
+
+		return parts->Result.load (memory_order_relaxed);
+	}
+
+	void EncryptionThreadPool::DeriveKeyParts (KeyDerivationParts *parts, size_t firstPart, size_t endPart)
 	{
-		size_t fragmentCount;
-		size_t unitsPerFragment;
-		size_t remainder;
+		size_t firstBlock = firstPart * parts->BlockCount / parts->PartCount;
+		size_t endBlock = endPart * parts->BlockCount / parts->PartCount;
+		size_t offset = firstBlock * parts->BlockSize;
+		size_t size = min (endBlock * parts->BlockSize, parts->KeySize) - offset;
+
+		Exception *partException = nullptr;
+
+		try
+		{
+			int result = parts->Kdf->DeriveKeyPart (BufferPtr (parts->Key + offset, size), *parts->Password, ConstBufferPtr (parts->Salt, parts->SaltSize), parts->IterationCount, firstBlock, parts->AbortFlag);
+
+			if (result != 0)
+			{
+				int expected = 0;
+				parts->Result.compare_exchange_strong (expected, result, memory_order_relaxed);
+			}
+		}
+		catch (Exception &e)
+		{
+			partException = e.CloneNew();
+		}
+		catch (exception &e)
+		{
+			partException = new ExternalException (SRC_POS, StringConverter::ToExceptionString (e));
+		}
+		catch (...)
+		{
+			partException = new UnknownException (SRC_POS);
+		}
 
-		uint8 *fragmentData;
-		uint64 fragmentStartUnitNo;
+		// Only the first failing part reports its exception
+		if (partException)
+		{
+			if (!parts->ExceptionRecorded.exchange (true, memory_order_acq_rel))
+				parts->ItemException.reset (partException);
+			else
+				delete partException;
+		}
 
-		WorkItem *workItem;
-		WorkItem *firstFragmentWorkItem;
+		size_t partCount = endPart - firstPart;
+		if (parts->OutstandingPartCount.fetch_sub (partCount, memory_order_acq_rel) == partCount)
+			parts->PartsCompletedEvent.Signal();
+	}
 
+	void EncryptionThreadPool::FillKeyDerivationLanes (FillLaneFunction fillLane, void *laneData, size_t laneCount)
+	{
+		if (!ThreadPoolRunning || laneCount < 2 || laneCount > MaxThreadCount)
+		{
+			for (size_t i = 0; i < laneCount; ++i)
+				fillLane (laneData, (uint32) i);
+			return;
+		}
+
+		size_t group = GetWorkerGroup (laneData);
+
+		KeyDerivationLanes *lanes = new KeyDerivationLanes;
+		finally_do_arg (KeyDerivationLanes *, lanes, { ReleaseKeyDerivationLanes (finally_arg); });
+
+		lanes->FillLane = fillLane;
+		lanes->LaneData = laneData;
+		lanes->LaneCount = laneCount;
+		lanes->OutstandingLaneCount.store (laneCount, memory_order_relaxed);
+
+		for (size_t i = 0; i < laneCount; ++i)
+		{
+			lanes->LaneClaimed[i].store (false, memory_order_relaxed);
+
+			WorkItem *workItem = &lanes->QueuedItems[i];
+			workItem->Type = WorkType::DeriveKeyLane;
+			workItem->KeyDerivationLane.Lanes = lanes;
+			workItem->KeyDerivationLane.LaneIndex = i;
+		}
+
+		// Lanes are queued without blocking, like key derivation parts
+		size_t firstQueue = NextQueueIndex.fetch_add (laneCount, memory_order_relaxed);
+		size_t queuedCount = 0;
+
+		for (size_t i = 1; i < laneCount; ++i)
+		{
+			lanes->ReferenceCount.fetch_add (1, memory_order_relaxed);
+
+			if (!TryEnqueueWorkItem (&lanes->QueuedItems[i], group, firstQueue + i, false))
+			{
+				lanes->ReferenceCount.fetch_sub (1, memory_order_relaxed);
+				break;
+			}
+
+			++queuedCount;
+		}
+
+		WakeWorkers (group, firstQueue + 1, queuedCount);
+
+		for (size_t i = 0; i < laneCount; ++i)
+		{
+			if (!lanes->LaneClaimed[i].exchange (true, memory_order_acq_rel))
+				FillKeyDerivationLane (lanes, i);
+		}
+
+		// Only lanes already being filled by workers remain
+		while (lanes->OutstandingLaneCount.load (memory_order_acquire) != 0)
+			lanes->LanesCompletedEvent.Wait();
+	}
+
+	void EncryptionThreadPool::FillKeyDerivationLane (KeyDerivationLanes *lanes, size_t lane)
+	{
+		lanes->FillLane (lanes->LaneData, (uint32) lane);
+
+		if (lanes->OutstandingLaneCount.fetch_sub (1, memory_order_acq_rel) == 1)
+			lanes->LanesCompletedEvent.Signal();
+	}
+
+	void EncryptionThreadPool::DoWork (WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
 		if (unitCount == 0)
 			return;
 
-		if (!ThreadPoolRunning || unitCount == 1)
+		AsyncWork work;
+
+		WorkRequest request;
+		request.Work = &work;
+		request.Type = type;
+		request.Mode = encryptionMode;
+		request.Data = data;
+		request.StartUnitNo = startUnitNo;
+		request.UnitCount = unitCount;
+		request.SectorSize = sectorSize;
+
+		// The submitting thread processes the first fragment itself
+		SubmitWork (request, true, nullptr);
+		work.Wait();
+	}
+
+	void EncryptionThreadPool::EnqueueWorkItem (WorkItem *workItem, size_t group, size_t preferredQueue)
+	{
+		if (TryEnqueueWorkItem (workItem, group, preferredQueue, true))
+			return;
+
+		EnqueueWaiterCount.fetch_add (1, memory_order_seq_cst);
+		finally_do ({ EnqueueWaiterCount.fetch_sub (1, memory_order_seq_cst); });
+
+		while (!TryEnqueueWorkItem (workItem, group, preferredQueue, true))
 		{
-			switch (type)
+			WorkItemCompletedEvent.Wait();
+		}
+	}
+
+	void EncryptionThreadPool::ExecuteWorkItem (WorkItem *workItem)
+	{
+		try
+		{
+			switch (workItem->Type)
 			{
 			case WorkType::DecryptDataUnits:
-				encryptionMode->DecryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
+				workItem->Encryption.Mode->DecryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
 				break;
 
 			case WorkType::EncryptDataUnits:
-				encryptionMode->EncryptSectorsCurrentThread (data, startUnitNo, unitCount, sectorSize);
+				workItem->Encryption.Mode->EncryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
+				break;
+
+			case WorkType::DeriveKey:
+				{
+					KeyDerivationWorkItem *keyDerivationWorkItem = workItem->KeyDerivation.WorkItem;
+					if (workItem->KeyDerivation.AbortFlag && *workItem->KeyDerivation.AbortFlag)
+						keyDerivationWorkItem->Result = ERR_USER_ABORT;
+					else
+						keyDerivationWorkItem->Result = keyDerivationWorkItem->Kdf->DeriveKey (keyDerivationWorkItem->DerivedKey, *workItem->KeyDerivation.Password, workItem->KeyDerivation.Pim, ConstBufferPtr (workItem->KeyDerivation.Salt, workItem->KeyDerivation.SaltSize), workItem->KeyDerivation.AbortFlag);
+				}
+				break;
+
+			case WorkType::DeriveKeyPart:
+				{
+					KeyDerivationParts *parts = workItem->KeyDerivationPart.Parts;
+					size_t partIndex = workItem->KeyDerivationPart.PartIndex;
+
+					if (!parts->PartClaimed[partIndex].exchange (true, memory_order_acq_rel))
+						DeriveKeyParts (parts, partIndex, partIndex + 1);
+				}
+				break;
+
+			case WorkType::DeriveKeyLane:
+				{
+					KeyDerivationLanes *lanes = workItem->KeyDerivationLane.Lanes;
+					size_t lane = workItem->KeyDerivationLane.LaneIndex;
+
+					if (!lanes->LaneClaimed[lane].exchange (true, memory_order_acq_rel))
+						FillKeyDerivationLane (lanes, lane);
+				}
 				break;
 
 			default:
 				throw ParameterIncorrect (SRC_POS);
 			}
+		}
+		catch (Exception &e)
+		{
+			SetItemException (workItem, e.CloneNew());
+		}
+		catch (exception &e)
+		{
+			SetItemException (workItem, new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
+		}
+		catch (...)
+		{
+			SetItemException (workItem, new UnknownException (SRC_POS));
+		}
+	}
 
-			return;
+	EncryptionThreadPool::WorkItem *EncryptionThreadPool::FindWorkItem (size_t workerIndex)
+	{
+		WorkItem *workItem = WorkQueues[workerIndex].Pop();
+
+		// Steal from queues of other workers in the same group
+		const vector <size_t> &workers = WorkerGroups[WorkerGroupIndex[workerIndex]].Workers;
+		for (size_t i = 0; !workItem && i < workers.size(); ++i)
+		{
+			if (workers[i] != workerIndex)
+				workItem = WorkQueues[workers[i]].Pop();
+		}
+
+		return workItem;
+	}
+
+	vector <EncryptionThreadPool::NodeStatistics> EncryptionThreadPool::GetNodeStatistics ()
+	{
+		vector <NodeStatistics> statistics;
+
+		for (size_t i = 0; i < WorkerGroups.size(); ++i)
+		{
+			NodeStatistics nodeStatistics;
+			nodeStatistics.NodeId = WorkerGroups[i].NodeId;
+			nodeStatistics.DecryptedByteCount = DecryptedByteCount[i].load (memory_order_relaxed);
+			nodeStatistics.EncryptedByteCount = EncryptedByteCount[i].load (memory_order_relaxed);
+			nodeStatistics.WorkerCount = WorkerGroups[i].Workers.size();
+
+			statistics.push_back (nodeStatistics);
 		}
 
-		if (unitCount <= ThreadCount)
+		return statistics;
+	}
+
+	size_t EncryptionThreadPool::GetWorkerGroup (const void *data)
+	{
+		if (WorkerGroups.size() < 2)
+			return 0;
+
+		// Route the buffer to workers on the node holding its memory
+		int node = CpuTopology::GetMemoryNode (data);
+
+		for (size_t i = 0; i < WorkerGroups.size(); ++i)
 		{
-			fragmentCount = (size_t) unitCount;
-			unitsPerFragment = 1;
-			remainder = 0;
+			if (node >= 0 && WorkerGroups[i].NodeId == (uint32) node)
+				return i;
 		}
+
+		return NextQueueIndex.fetch_add (1, memory_order_relaxed) % WorkerGroups.size();
+	}
+
+	bool EncryptionThreadPool::IsWorkQueued (size_t group)
+	{
+		foreach (size_t worker, WorkerGroups[group].Workers)
+		{
+			const WorkQueue &queue = WorkQueues[worker];
+			if (queue.DequeuePosition.load (memory_order_relaxed) != queue.EnqueuePosition.load (memory_order_relaxed))
+				return true;
+		}
+
+		return false;
+	}
+
+	void EncryptionThreadPool::ReleaseKeyDerivationLanes (KeyDerivationLanes *lanes)
+	{
+		if (lanes->ReferenceCount.fetch_sub (1, memory_order_acq_rel) == 1)
+			delete lanes;
+	}
+
+	void EncryptionThreadPool::ReleaseKeyDerivationParts (KeyDerivationParts *parts)
+	{
+		if (parts->ReferenceCount.fetch_sub (1, memory_order_acq_rel) == 1)
+			delete parts;
+	}
+
+	void EncryptionThreadPool::SetItemException (WorkItem *workItem, Exception *exception)
+	{
+		if (workItem->Type == WorkType::DeriveKey)
+		{
+			workItem->KeyDerivation.WorkItem->ItemException.reset (exception);
+			return;
+		}
+
+		// Only the first failing fragment reports its exception
+		WorkCompletion *completion = workItem->Encryption.Completion;
+		if (!completion->ExceptionRecorded.exchange (true, memory_order_acq_rel))
+			completion->ItemException.reset (exception);
 		else
+			delete exception;
+	}
+
+	void EncryptionThreadPool::SetupWorkerGroups (size_t threadCount)
+	{
+		WorkerGroups.clear();
+
+		CpuTopologyNodeList nodes;
+		if (Placement == PlacementPolicy::NumaLocal)
+			nodes = CpuTopology::GetNodes();
+
+		if (nodes.size() < 2 || nodes.size() > threadCount)
 		{
-			fragmentCount = ThreadCount;
-			unitsPerFragment = (size_t) unitCount / ThreadCount;
-			remainder = (size_t) unitCount % ThreadCount;
+			WorkerGroup group;
+			group.NodeId = 0;
+
+			for (size_t i = 0; i < threadCount; ++i)
+			{
+				group.Workers.push_back (i);
+				WorkerGroupIndex[i] = 0;
+			}
 
-			if (remainder > 0)
-				++unitsPerFragment;
+			WorkerGroups.push_back (group);
+			return;
 		}
 
-		fragmentData = data;
-		fragmentStartUnitNo = startUnitNo;
+		// Every node gets one worker; the rest are distributed in proportion to the nodes' CPU counts
+		vector <size_t> workerCounts (nodes.size(), 1);
+
+		for (size_t assigned = nodes.size(); assigned < threadCount; ++assigned)
+		{
+			size_t best = 0;
+			for (size_t n = 1; n < nodes.size(); ++n)
+			{
+				if (nodes[n].Cpus.size() * (workerCounts[best] + 1) > nodes[best].Cpus.size() * (workerCounts[n] + 1))
+					best = n;
+			}
+
+			++workerCounts[best];
+		}
 
+		size_t workerIndex = 0;
+		for (size_t n = 0; n < nodes.size(); ++n)
 		{
-			ScopeLock lock (EnqueueMutex);
-			firstFragmentWorkItem = &WorkItemQueue[EnqueuePosition];
+			WorkerGroup group;
+			group.Cpus = nodes[n].Cpus;
+			group.NodeId = nodes[n].Id;
 
-			while (firstFragmentWorkItem->State != WorkItem::State::Free)
+			for (size_t i = 0; i < workerCounts[n]; ++i, ++workerIndex)
 			{
-				WorkItemCompletedEvent.Wait();
+				group.Workers.push_back (workerIndex);
+				WorkerGroupIndex[workerIndex] = n;
 			}
 
-			firstFragmentWorkItem->OutstandingFragmentCount.Set (fragmentCount);
-			firstFragmentWorkItem->ItemException.reset();
+			WorkerGroups.push_back (group);
+		}
+	}
+
+	void EncryptionThreadPool::SubmitWork (const WorkRequest &request, bool processFirstFragment, size_t *pendingWakeups)
+	{
+		if (request.Type != WorkType::EncryptDataUnits && request.Type != WorkType::DecryptDataUnits)
+			throw ParameterIncorrect (SRC_POS);
+
+		WorkCompletion &completion = request.Work->Completion;
+		WorkItem *fragments = request.Work->Fragments;
+
+		{
+			// Completion of the previous request must have been fully reported before the token is reused
+			ScopeLock completionLock (completion.CompletionMutex);
+			if (!completion.Completed.load (memory_order_acquire))
+				throw ParameterIncorrect (SRC_POS);
+		}
 
-			while (fragmentCount-- > 0)
+		bool runInline = !ThreadPoolRunning || request.UnitCount < 2;
+		size_t group = 0;
+		size_t fragmentCount = 1;
+		uint64 unitsPerFragment = request.UnitCount;
+		size_t remainder = 0;
+
+		if (!runInline)
+		{
+			group = GetWorkerGroup (request.Data);
+			size_t groupThreadCount = WorkerGroups[group].Workers.size();
+
+			if (request.UnitCount <= groupThreadCount)
 			{
-				workItem = &WorkItemQueue[EnqueuePosition++];
+				fragmentCount = (size_t) request.UnitCount;
+				unitsPerFragment = 1;
+			}
+			else
+			{
+				fragmentCount = groupThreadCount;
+				unitsPerFragment = request.UnitCount / groupThreadCount;
+				remainder = (size_t) (request.UnitCount % groupThreadCount);
 
-				if (EnqueuePosition >= QueueSize)
-					EnqueuePosition = 0;
+				if (remainder > 0)
+					++unitsPerFragment;
+			}
+		}
 
-				while (workItem->State != WorkItem::State::Free)
-				{
-					WorkItemCompletedEvent.Wait();
-				}
+		completion.ExceptionRecorded.store (false, memory_order_relaxed);
+		completion.ItemException.reset();
+		completion.ItemCompletedEvent.Reset();
+		completion.OutstandingFragmentCount.store (fragmentCount, memory_order_relaxed);
+		completion.Completed.store (false, memory_order_relaxed);
+
+		uint8 *fragmentData = request.Data;
+		uint64 fragmentStartUnitNo = request.StartUnitNo;
+
+		for (size_t i = 0; i < fragmentCount; ++i)
+		{
+			WorkItem *workItem = &fragments[i];
+
+			workItem->Type = request.Type;
+			workItem->Encryption.Completion = &completion;
+			workItem->Encryption.Mode = request.Mode;
+			workItem->Encryption.Data = fragmentData;
+			workItem->Encryption.UnitCount = unitsPerFragment;
+			workItem->Encryption.StartUnitNo = fragmentStartUnitNo;
+			workItem->Encryption.SectorSize = request.SectorSize;
+
+			fragmentData += unitsPerFragment * request.SectorSize;
+			fragmentStartUnitNo += unitsPerFragment;
+
+			if (remainder > 0 && --remainder == 0)
+				--unitsPerFragment;
+		}
+
+		if (runInline)
+		{
+			if (request.UnitCount > 0)
+				ExecuteWorkItem (&fragments[0]);
+
+			CompleteWorkItem (&fragments[0]);
+			return;
+		}
+
+		if (request.Type == WorkType::EncryptDataUnits)
+			EncryptedByteCount[group].fetch_add (request.UnitCount * request.SectorSize, memory_order_relaxed);
+		else
+			DecryptedByteCount[group].fetch_add (request.UnitCount * request.SectorSize, memory_order_relaxed);
+
+		size_t firstQueue = NextQueueIndex.fetch_add (fragmentCount, memory_order_relaxed);
+		size_t firstQueuedFragment = processFirstFragment ? 1 : 0;
+		size_t queuedCount = 0;
+
+		for (size_t i = firstQueuedFragment; i < fragmentCount; ++i)
+		{
+			if (TryEnqueueWorkItem (&fragments[i], group, firstQueue + i, false))
+			{
+				++queuedCount;
+				continue;
+			}
+
+			// All queues are full: wake workers for the queued items and process the fragment in the submitting thread
+			if (pendingWakeups)
+			{
+				queuedCount += pendingWakeups[group];
+				pendingWakeups[group] = 0;
+			}
+
+			WakeWorkers (group, firstQueue, queuedCount);
+			queuedCount = 0;
+
+			ExecuteWorkItem (&fragments[i]);
+			CompleteWorkItem (&fragments[i]);
+		}
 
-				workItem->Type = type;
-				workItem->FirstFragment = firstFragmentWorkItem;
+		// A single request wakes only the owner of its first queued fragment. Each worker taking an item
+		// wakes another one while items remain queued (see WorkThreadProc()), so small requests are not
+		// spread over more workers than can start on them before the queued fragments are processed.
+		if (pendingWakeups)
+			pendingWakeups[group] += queuedCount;
+		else
+			WakeWorkers (group, firstQueue + firstQueuedFragment, min (queuedCount, (size_t) 1));
 
-				workItem->Encryption.Mode = encryptionMode;
-				workItem->Encryption.Data = fragmentData;
-				workItem->Encryption.UnitCount = unitsPerFragment;
-				workItem->Encryption.StartUnitNo = fragmentStartUnitNo;
-				workItem->Encryption.SectorSize = sectorSize;
+		if (processFirstFragment)
+		{
+			ExecuteWorkItem (&fragments[0]);
+			CompleteWorkItem (&fragments[0]);
+		}
+	}
 
-				fragmentData += unitsPerFragment * sectorSize;
-				fragmentStartUnitNo += unitsPerFragment;
+	bool EncryptionThreadPool::TryEnqueueWorkItem (WorkItem *workItem, size_t group, size_t preferredQueue, bool wakeWorker)
+	{
+		const vector <size_t> &workers = WorkerGroups[group].Workers;
 
-				if (remainder > 0 && --remainder == 0)
-					--unitsPerFragment;
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			size_t position = (preferredQueue + i) % workers.size();
+			if (WorkQueues[workers[position]].Push (workItem))
+			{
+				if (wakeWorker)
+					WakeWorkers (group, position, 1);
 
-				workItem->State.Set (WorkItem::State::Ready);
-				WorkItemReadyEvent.Signal();
+				return true;
 			}
 		}
 
-		firstFragmentWorkItem->ItemCompletedEvent.Wait();
+		return false;
+	}
+
+	void EncryptionThreadPool::WakeWorkers (size_t group, size_t preferredQueue, size_t count)
+	{
+		if (count == 0)
+			return;
+
+		// Pairs with the fence in WorkThreadProc(): either the worker observes the new items
+		// before going to sleep, or we observe its sleeping flag here.
+		atomic_thread_fence (memory_order_seq_cst);
 
-		unique_ptr <Exception> itemException;
-		if (firstFragmentWorkItem->ItemException.get())
-			itemException = move_ptr(firstFragmentWorkItem->ItemException);
+		// If the owner of the preferred queue is busy, wake other idle workers of the group to steal the items
+		const vector <size_t> &workers = WorkerGroups[group].Workers;
 
-		firstFragmentWorkItem->State.Set (WorkItem::State::Free);
-		WorkItemCompletedEvent.Signal();
+		for (size_t i = 0; count > 0 && i < workers.size(); ++i)
+		{
+			WorkQueue &queue = WorkQueues[workers[(preferredQueue + i) % workers.size()]];
 
-		if (itemException.get())
-			itemException->Throw();
+			if (queue.WorkerSleeping.load (memory_order_relaxed) && queue.WorkerSleeping.exchange (false, memory_order_acq_rel))
+			{
+				queue.WorkItemReadyEvent.Signal();
+				--count;
+			}
+		}
 	}
 
 	void EncryptionThreadPool::Start ()
@@ -230,28 +904,37 @@ namespace VeraCrypt
 			cpuCount = MaxThreadCount;
 
 		StopPending = false;
-		DequeuePosition = 0;
-		EnqueuePosition = 0;
+		NextQueueIndex = 0;
 
-		for (size_t i = 0; i < sizeof (WorkItemQueue) / sizeof (WorkItemQueue[0]); ++i)
+		for (size_t i = 0; i < array_capacity (WorkQueues); ++i)
 		{
-			WorkItemQueue[i].State.Set (WorkItem::State::Free);
+			WorkQueues[i].Clear();
+			DecryptedByteCount[i] = 0;
+			EncryptedByteCount[i] = 0;
 		}
 
+		SetupWorkerGroups (cpuCount);
+
+		// Workers may steal from any queue below ThreadCount, so all queues must exist before the first thread starts
+		ThreadCount = cpuCount;
+
 		try
 		{
-			for (ThreadCount = 0; ThreadCount < cpuCount; ++ThreadCount)
+			for (size_t i = 0; i < cpuCount; ++i)
 			{
 				struct ThreadFunctor : public Functor
 				{
+					ThreadFunctor (size_t workerIndex) : WorkerIndex (workerIndex) { }
 					virtual void operator() ()
 					{
-						WorkThreadProc();
+						WorkThreadProc (WorkerIndex);
 					}
+
+					size_t WorkerIndex;
 				};
 
 				make_shared_auto (Thread, thread);
-				thread->Start (new ThreadFunctor ());
+				thread->Start (new ThreadFunctor (i));
 				RunningThreads.push_back (thread);
 			}
 		}
@@ -275,114 +958,79 @@ namespace VeraCrypt
 			return;
 
 		StopPending = true;
-		WorkItemReadyEvent.Signal();
+
+		for (size_t i = 0; i < ThreadCount; ++i)
+		{
+			WorkQueues[i].WorkItemReadyEvent.Signal();
+		}
 
 		foreach_ref (const Thread &thread, RunningThreads)
 		{
 			thread.Join();
 		}
 
+		// Key derivation parts and lanes left in the queues hold a reference to their state
+		for (size_t i = 0; i < ThreadCount; ++i)
+		{
+			while (WorkItem *workItem = WorkQueues[i].Pop())
+			{
+				if (workItem->Type == WorkType::DeriveKeyPart)
+					ReleaseKeyDerivationParts (workItem->KeyDerivationPart.Parts);
+				else if (workItem->Type == WorkType::DeriveKeyLane)
+					ReleaseKeyDerivationLanes (workItem->KeyDerivationLane.Lanes);
+			}
+		}
+
+		RunningThreads.clear();
 		ThreadCount = 0;
 		ThreadPoolRunning = false;
 	}
 
-	void EncryptionThreadPool::WorkThreadProc ()
+	void EncryptionThreadPool::WorkThreadProc (size_t workerIndex)
 	{
 		try
 		{
-			WorkItem *workItem;
+			WorkQueue &ownQueue = WorkQueues[workerIndex];
+			size_t group = WorkerGroupIndex[workerIndex];
+			const vector <size_t> &workers = WorkerGroups[group].Workers;
+			size_t position = find (workers.begin(), workers.end(), workerIndex) - workers.begin();
+
+			// Placement is best effort; an unpinned worker still processes its group's items
+			const vector <uint32> &cpus = WorkerGroups[group].Cpus;
+			if (!cpus.empty())
+				CpuTopology::SetCurrentThreadAffinity (cpus);
 
 			while (!StopPending)
 			{
-				{
-					ScopeLock lock (DequeueMutex);
-
-					workItem = &WorkItemQueue[DequeuePosition++];
-
-					if (DequeuePosition >= QueueSize)
-						DequeuePosition = 0;
-
-					while (!StopPending && workItem->State != WorkItem::State::Ready)
-					{
-						WorkItemReadyEvent.Wait();
-					}
-
-					workItem->State.Set (WorkItem::State::Busy);
-				}
-
-				if (StopPending)
-					break;
+				WorkItem *workItem = FindWorkItem (workerIndex);
 
-				try
+				if (!workItem)
 				{
-					switch (workItem->Type)
+					ownQueue.WorkerSleeping.store (true, memory_order_relaxed);
+					atomic_thread_fence (memory_order_seq_cst);
+
+					workItem = FindWorkItem (workerIndex);
+					if (workItem)
 					{
-					case WorkType::DecryptDataUnits:
-						workItem->Encryption.Mode->DecryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
-						break;
-
-					case WorkType::EncryptDataUnits:
-						workItem->Encryption.Mode->EncryptSectorsCurrentThread (workItem->Encryption.Data, workItem->Encryption.StartUnitNo, workItem->Encryption.UnitCount, workItem->Encryption.SectorSize);
-						break;
-
-					case WorkType::DeriveKey:
-						{
-							KeyDerivationWorkItem *keyDerivationWorkItem = workItem->KeyDerivation.WorkItem;
-							if (workItem->KeyDerivation.AbortFlag && *workItem->KeyDerivation.AbortFlag)
-								keyDerivationWorkItem->Result = ERR_USER_ABORT;
-							else
-								keyDerivationWorkItem->Result = keyDerivationWorkItem->Kdf->DeriveKey (keyDerivationWorkItem->DerivedKey, *workItem->KeyDerivation.Password, workItem->KeyDerivation.Pim, ConstBufferPtr (workItem->KeyDerivation.Salt, workItem->KeyDerivation.SaltSize), workItem->KeyDerivation.AbortFlag);
-						}
-						break;
-
-					default:
-						throw ParameterIncorrect (SRC_POS);
+						// An item arrived after all; if a submitter already cleared the flag, consume its signal
+						if (!ownQueue.WorkerSleeping.exchange (false, memory_order_acq_rel))
+							ownQueue.WorkItemReadyEvent.Wait();
 					}
-				}
-				catch (Exception &e)
-				{
-					if (workItem->Type == WorkType::DeriveKey)
-						workItem->KeyDerivation.WorkItem->ItemException.reset (e.CloneNew());
-					else
-						workItem->FirstFragment->ItemException.reset (e.CloneNew());
-				}
-				catch (exception &e)
-				{
-					if (workItem->Type == WorkType::DeriveKey)
-						workItem->KeyDerivation.WorkItem->ItemException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
-					else
-						workItem->FirstFragment->ItemException.reset (new ExternalException (SRC_POS, StringConverter::ToExceptionString (e)));
-				}
-				catch (...)
-				{
-					if (workItem->Type == WorkType::DeriveKey)
-						workItem->KeyDerivation.WorkItem->ItemException.reset (new UnknownException (SRC_POS));
 					else
-						workItem->FirstFragment->ItemException.reset (new UnknownException (SRC_POS));
-				}
-
-				if (workItem->Type == WorkType::DeriveKey)
-				{
-					workItem->KeyDerivation.WorkItem->Completed.Set (true);
-					workItem->KeyDerivation.CompletionEvent->Signal();
 					{
-						ScopeLock outstandingWorkItemLock (KeyDerivationCompletionMutex);
-						if (workItem->KeyDerivation.OutstandingWorkItemCount->Decrement() == 0)
-							workItem->KeyDerivation.NoOutstandingWorkItemEvent->Signal();
+						if (!StopPending)
+							ownQueue.WorkItemReadyEvent.Wait();
+
+						ownQueue.WorkerSleeping.store (false, memory_order_relaxed);
+						continue;
 					}
-					workItem->State.Set (WorkItem::State::Free);
-					WorkItemCompletedEvent.Signal();
-					continue;
 				}
 
-				if (workItem != workItem->FirstFragment)
-				{
-					workItem->State.Set (WorkItem::State::Free);
-					WorkItemCompletedEvent.Signal();
-				}
+				if (IsWorkQueued (group))
+					WakeWorkers (group, position + 1, 1);
 
-				if (workItem->FirstFragment->OutstandingFragmentCount.Decrement() == 0)
-					workItem->FirstFragment->ItemCompletedEvent.Signal();
+				ExecuteWorkItem (workItem);
+				CompleteWorkItem (workItem);
 			}
 		}
 		catch (exception &e)
@@ -396,21 +1044,22 @@ namespace VeraCrypt
 	}
 
 	volatile bool EncryptionThreadPool::ThreadPoolRunning = false;
-	volatile bool EncryptionThreadPool::StopPending = false;
 
 	size_t EncryptionThreadPool::ThreadCount;
 
-	EncryptionThreadPool::WorkItem EncryptionThreadPool::WorkItemQueue[QueueSize];
-
-	volatile size_t EncryptionThreadPool::EnqueuePosition;
-	volatile size_t EncryptionThreadPool::DequeuePosition;
+	atomic <uint64> EncryptionThreadPool::DecryptedByteCount[MaxThreadCount];
+	atomic <uint64> EncryptionThreadPool::EncryptedByteCount[MaxThreadCount];
+	atomic <size_t> EncryptionThreadPool::EnqueueWaiterCount (0);
+	atomic <size_t> EncryptionThreadPool::NextQueueIndex (0);
+	atomic <bool> EncryptionThreadPool::StopPending (false);
 
-	Mutex EncryptionThreadPool::EnqueueMutex;
-	Mutex EncryptionThreadPool::DequeueMutex;
 	Mutex EncryptionThreadPool::KeyDerivationCompletionMutex;
+	EncryptionThreadPool::PlacementPolicy::Enum EncryptionThreadPool::Placement = EncryptionThreadPool::PlacementPolicy::Default;
 
-	SyncEvent EncryptionThreadPool::WorkItemReadyEvent;
 	SyncEvent EncryptionThreadPool::WorkItemCompletedEvent;
+	size_t EncryptionThreadPool::WorkerGroupIndex[MaxThreadCount];
+	vector <EncryptionThreadPool::WorkerGroup> EncryptionThreadPool::WorkerGroups;
+	EncryptionThreadPool::WorkQueue EncryptionThreadPool::WorkQueues[MaxThreadCount];
 
 	list < shared_ptr <Thread> > EncryptionThreadPool::RunningThreads;
 }
@@ -13,6 +13,7 @@
 #ifndef TC_HEADER_Volume_EncryptionThreadPool
 #define TC_HEADER_Volume_EncryptionThreadPool
 
+#include <atomic>
 #include "Platform/Platform.h"
 #include "EncryptionMode.h"
 
@@ -24,41 +25,53 @@ namespace VeraCrypt
 	class EncryptionThreadPool
 	{
 	public:
+		static const size_t CacheLineSize = 64;
+		static const size_t MaxThreadCount = 32;
+		static const size_t QueueSize = 64;
+
 		struct WorkType
 		{
 			enum Enum
 			{
 				EncryptDataUnits,
 				DecryptDataUnits,
-				DeriveKey
+				DeriveKey,
+				DeriveKeyPart,
+				DeriveKeyLane
 			};
 		};
 
-		struct KeyDerivationWorkItem;
-
-		struct WorkItem
+		struct PlacementPolicy
 		{
-			struct State
+			enum Enum
 			{
-				enum Enum
-				{
-					Free,
-					Ready,
-					Busy
-				};
+				Default,	// Workers float across all CPUs
+				NumaLocal	// Workers are pinned to NUMA nodes and process buffers residing on their node
 			};
+		};
 
-			struct WorkItem *FirstFragment;
-			unique_ptr <Exception> ItemException;
-			SyncEvent ItemCompletedEvent;
-			SharedVal <size_t> OutstandingFragmentCount;
-			SharedVal <State::Enum> State;
+		struct NodeStatistics
+		{
+			uint32 NodeId;
+			uint64 DecryptedByteCount;
+			uint64 EncryptedByteCount;
+			size_t WorkerCount;
+		};
+
+		struct KeyDerivationLanes;
+		struct KeyDerivationParts;
+		struct KeyDerivationWorkItem;
+		struct WorkCompletion;
+
+		struct WorkItem
+		{
 			WorkType::Enum Type;
 
 			union
 			{
 				struct
 				{
+					WorkCompletion *Completion;
 					const EncryptionMode *Mode;
 					uint8 *Data;
 					uint64 StartUnitNo;
@@ -78,9 +91,77 @@ namespace VeraCrypt
 					size_t SaltSize;
 					KeyDerivationWorkItem *WorkItem;
 				} KeyDerivation;
+
+				struct
+				{
+					KeyDerivationParts *Parts;
+					size_t PartIndex;
+				} KeyDerivationPart;
+
+				struct
+				{
+					KeyDerivationLanes *Lanes;
+					size_t LaneIndex;
+				} KeyDerivationLane;
 			};
 		};
 
+		// Shared by all fragments of one encryption or decryption request
+		struct WorkCompletion
+		{
+			WorkCompletion () : CompletionEventFd (-1), Completed (true), ExceptionRecorded (false), OutstandingFragmentCount (0) { }
+
+			shared_ptr <Functor> CompletionCallback;
+			int CompletionEventFd;
+			atomic <bool> Completed;
+			Mutex CompletionMutex;	// Held while completion is reported; acquired before the request is released or reused
+			atomic <bool> ExceptionRecorded;
+			unique_ptr <Exception> ItemException;
+			SyncEvent ItemCompletedEvent;
+			atomic <size_t> OutstandingFragmentCount;
+
+		private:
+			WorkCompletion (const WorkCompletion &);
+			WorkCompletion &operator= (const WorkCompletion &);
+		};
+
+		// Completion token of an asynchronous request. The token and the data buffer of the request are
+		// owned by the caller; the destructor waits for a pending request to complete.
+		class AsyncWork
+		{
+		public:
+			AsyncWork () { }
+			~AsyncWork ();
+
+			bool IsCompleted () const { return Completion.Completed.load (memory_order_acquire); }
+			// The callback is invoked by the thread completing the request and must not submit work or wait for this token
+			void SetCompletionCallback (shared_ptr <Functor> callback) { Completion.CompletionCallback = callback; }
+			// An 8-byte counter increment compatible with eventfd(2) is written to the descriptor on completion
+			void SetCompletionEventFd (int fd) { Completion.CompletionEventFd = fd; }
+			void Wait ();
+
+		protected:
+			friend class EncryptionThreadPool;
+
+			WorkCompletion Completion;
+			WorkItem Fragments[MaxThreadCount];
+
+		private:
+			AsyncWork (const AsyncWork &);
+			AsyncWork &operator= (const AsyncWork &);
+		};
+
+		struct WorkRequest
+		{
+			AsyncWork *Work;
+			WorkType::Enum Type;
+			const EncryptionMode *Mode;
+			uint8 *Data;
+			uint64 StartUnitNo;
+			uint64 UnitCount;
+			size_t SectorSize;
+		};
+
 		struct KeyDerivationWorkItem
 		{
 			KeyDerivationWorkItem (shared_ptr <Pkcs5Kdf> kdf, size_t derivedKeySize);
@@ -92,34 +173,153 @@ namespace VeraCrypt
 			shared_ptr <Pkcs5Kdf> Kdf;
 			bool Processed;
 			int Result;
+			WorkItem QueuedItem;
+		};
+
+		// Key derived in parts by the submitter and the workers. Each part is derived by the first thread claiming it,
+		// so the submitter only waits for parts being derived; queued items keep the state alive until they are dequeued.
+		struct KeyDerivationParts
+		{
+			KeyDerivationParts () : ExceptionRecorded (false), OutstandingPartCount (0), ReferenceCount (1), Result (0) { }
+
+			const Pkcs5Kdf *Kdf;
+			uint8 *Key;
+			size_t KeySize;
+			const VolumePassword *Password;
+			const uint8 *Salt;
+			size_t SaltSize;
+			int IterationCount;
+			long volatile *AbortFlag;
+			size_t BlockCount;
+			size_t BlockSize;
+			size_t PartCount;
+
+			atomic <bool> ExceptionRecorded;
+			unique_ptr <Exception> ItemException;
+			atomic <size_t> OutstandingPartCount;
+			atomic <bool> PartClaimed[MaxThreadCount];
+			SyncEvent PartsCompletedEvent;
+			WorkItem QueuedItems[MaxThreadCount];
+			atomic <size_t> ReferenceCount;
+			atomic <int> Result;
+
+		private:
+			KeyDerivationParts (const KeyDerivationParts &);
+			KeyDerivationParts &operator= (const KeyDerivationParts &);
+		};
+
+		typedef void (*FillLaneFunction) (void *laneData, uint32 lane);
+
+		// Lanes of a memory-hard key derivation (e.g. Argon2 lanes of one slice) filled concurrently by the submitter
+		// and the workers. As with key derivation parts, each lane is filled by the first thread claiming it.
+		struct KeyDerivationLanes
+		{
+			KeyDerivationLanes () : OutstandingLaneCount (0), ReferenceCount (1) { }
+
+			FillLaneFunction FillLane;
+			void *LaneData;
+			size_t LaneCount;
+
+			atomic <size_t> OutstandingLaneCount;
+			atomic <bool> LaneClaimed[MaxThreadCount];
+			SyncEvent LanesCompletedEvent;
+			WorkItem QueuedItems[MaxThreadCount];
+			atomic <size_t> ReferenceCount;
+
+		private:
+			KeyDerivationLanes (const KeyDerivationLanes &);
+			KeyDerivationLanes &operator= (const KeyDerivationLanes &);
 		};
 
 		// Caller-owned references and pointers must remain valid until noOutstandingWorkItemEvent is signaled.
 		static void BeginKeyDerivation (KeyDerivationWorkItem &keyDerivationWorkItem, const VolumePassword &password, int pim, const ConstBufferPtr &salt, SyncEvent &completionEvent, SyncEvent &noOutstandingWorkItemEvent, SharedVal <size_t> &outstandingWorkItemCount, long volatile *abortFlag);
+		// Queues a request without waiting for it; a token can be reused once its previous request has completed
+		static void BeginWork (AsyncWork &work, WorkType::Enum type, const EncryptionMode *mode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+		// Queues independent requests, waking workers once for the whole batch
+		static void BeginWork (const vector <WorkRequest> &requests);
+		// Derives the key with its output blocks spread across the workers; the calling thread derives the parts no worker has started
+		static int DeriveKeyInParts (const Pkcs5Kdf &kdf, const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *abortFlag);
+		// Calls fillLane for each lane in [0, laneCount) and returns when all lanes are filled; fillLane must not throw.
+		// The calling thread fills the lanes no worker has started, so it may itself be a worker.
+		static void FillKeyDerivationLanes (FillLaneFunction fillLane, void *laneData, size_t laneCount);
 		static void DoWork (WorkType::Enum type, const EncryptionMode *mode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+		static vector <NodeStatistics> GetNodeStatistics ();
+		static PlacementPolicy::Enum GetPlacementPolicy () { return Placement; }
+		static size_t GetThreadCount () { return ThreadCount; }
 		static bool IsRunning () { return ThreadPoolRunning; }
+		static void SetPlacementPolicy (PlacementPolicy::Enum policy) { Placement = policy; }	// Applied by the next Start(); a running pool is not affected
 		static void Start ();
 		static void Stop ();
 
 	protected:
-		static void WorkThreadProc ();
+		// Bounded lock-free multi-producer/multi-consumer queue owned by one worker thread.
+		// Submitters push to any worker's queue; the owner and idle workers (stealing) pop from it.
+		struct WorkQueue
+		{
+			WorkQueue ();
 
-		static const size_t MaxThreadCount = 32;
-		static const size_t QueueSize = MaxThreadCount * 2;
+			void Clear ();
+			WorkItem *Pop ();
+			bool Push (WorkItem *workItem);
+
+			struct Cell
+			{
+				atomic <size_t> Sequence;
+				WorkItem *Item;
+			};
+
+			Cell Cells[QueueSize];
+			alignas (CacheLineSize) atomic <size_t> EnqueuePosition;
+			alignas (CacheLineSize) atomic <size_t> DequeuePosition;
+			alignas (CacheLineSize) atomic <bool> WorkerSleeping;
+			SyncEvent WorkItemReadyEvent;
+
+		private:
+			WorkQueue (const WorkQueue &);
+			WorkQueue &operator= (const WorkQueue &);
+		};
+
+		// Workers sharing a NUMA node; without node-local placement, a single group holds all workers.
+		// Work items submitted to a group are processed and stolen only by its members.
+		struct WorkerGroup
+		{
+			vector <uint32> Cpus;	// Worker affinity; empty if workers are not pinned
+			uint32 NodeId;
+			vector <size_t> Workers;
+		};
+
+		static void CompleteWorkItem (WorkItem *workItem);
+		static void DeriveKeyParts (KeyDerivationParts *parts, size_t firstPart, size_t endPart);
+		static void EnqueueWorkItem (WorkItem *workItem, size_t group, size_t preferredQueue);
+		static void FillKeyDerivationLane (KeyDerivationLanes *lanes, size_t lane);
+		static void ExecuteWorkItem (WorkItem *workItem);
+		static WorkItem *FindWorkItem (size_t workerIndex);
+		static size_t GetWorkerGroup (const void *data);
+		static bool IsWorkQueued (size_t group);	// Hint only; items may be taken or added concurrently
+		static void ReleaseKeyDerivationLanes (KeyDerivationLanes *lanes);
+		static void ReleaseKeyDerivationParts (KeyDerivationParts *parts);
+		static void SetItemException (WorkItem *workItem, Exception *exception);
+		static void SetupWorkerGroups (size_t threadCount);
+		static void SubmitWork (const WorkRequest &request, bool processFirstFragment, size_t *pendingWakeups);
+		static bool TryEnqueueWorkItem (WorkItem *workItem, size_t group, size_t preferredQueue, bool wakeWorker);
+		static void WakeWorkers (size_t group, size_t preferredQueue, size_t count);
+		static void WorkThreadProc (size_t workerIndex);
 
-		static Mutex DequeueMutex;
-		static volatile size_t DequeuePosition;
-		static volatile size_t EnqueuePosition;
-		static Mutex EnqueueMutex;
+		static atomic <uint64> DecryptedByteCount[MaxThreadCount];
+		static atomic <uint64> EncryptedByteCount[MaxThreadCount];
+		static atomic <size_t> EnqueueWaiterCount;
 		// Orders KDF outstanding-count transitions against no-outstanding event updates.
 		static Mutex KeyDerivationCompletionMutex;
+		static atomic <size_t> NextQueueIndex;
+		static PlacementPolicy::Enum Placement;
 		static list < shared_ptr <Thread> > RunningThreads;
-		static volatile bool StopPending;
+		static atomic <bool> StopPending;
 		static size_t ThreadCount;
 		static volatile bool ThreadPoolRunning;
 		static SyncEvent WorkItemCompletedEvent;
-		static WorkItem WorkItemQueue[QueueSize];
-		static SyncEvent WorkItemReadyEvent;
+		static size_t WorkerGroupIndex[MaxThreadCount];
+		static vector <WorkerGroup> WorkerGroups;
+		static WorkQueue WorkQueues[MaxThreadCount];
 	};
 }
 
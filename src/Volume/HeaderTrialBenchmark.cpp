@@ -0,0 +1,67 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include "Platform/Time.h"
+#include "HeaderTrialBenchmark.h"
+#include "VolumeHeader.h"
+#ifndef WOLFCRYPT_BACKEND
+#include "EncryptionModeXTS.h"
+#endif
+
+namespace VeraCrypt
+{
+	HeaderTrialBenchmark HeaderTrialBenchmark::Run ()
+	{
+#ifdef WOLFCRYPT_BACKEND
+		throw NotApplicable (SRC_POS);
+#else
+		EncryptionAlgorithmList algorithms = EncryptionAlgorithm::GetAvailableAlgorithms();
+		EncryptionModeList modes;
+		modes.push_back (shared_ptr <EncryptionMode> (new EncryptionModeXTS));
+
+		// No algorithm accepts the key, so every trial runs through the whole candidate list as a wrong password does
+		SecureBuffer encryptedData (TC_VOLUME_HEADER_EFFECTIVE_SIZE);
+		for (size_t i = 0; i < encryptedData.Size(); ++i)
+			encryptedData[i] = (uint8) (i * 151 + 3);
+
+		SecureBuffer headerKey (VolumeHeader::GetLargestSerializedKeySize());
+		for (size_t i = 0; i < headerKey.Size(); ++i)
+			headerKey[i] = (uint8) (i * 29 + 7);
+
+		VolumeHeader header (encryptedData.Size());
+		shared_ptr <Pkcs5Kdf> kdf = Pkcs5Kdf::GetAlgorithm (L"HMAC-SHA-512");
+
+		HeaderTrialBenchmark result;
+		result.AlgorithmCount = algorithms.size();
+
+		for (int round = 0; round < RoundCount; ++round)
+		{
+			for (int earlyReject = 0; earlyReject <= 1; ++earlyReject)
+			{
+				uint64 startTime = Time::GetCurrent();
+
+				for (int trial = 0; trial < TrialCount; ++trial)
+				{
+					if (header.DecryptWithHeaderKey (encryptedData, kdf, headerKey, algorithms, modes, earlyReject != 0))
+						throw TestFailed (SRC_POS);
+				}
+
+				// Time is measured in hundreds of nanoseconds
+				uint64 trialTime = (Time::GetCurrent() - startTime) * 100 / TrialCount;
+				uint64 &bestTime = earlyReject ? result.EarlyRejectTime : result.FullDecryptionTime;
+
+				if (bestTime == 0 || trialTime < bestTime)
+					bestTime = trialTime;
+			}
+		}
+
+		return result;
+#endif
+	}
+}
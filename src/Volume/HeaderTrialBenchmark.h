@@ -0,0 +1,34 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Volume_HeaderTrialBenchmark
+#define TC_HEADER_Volume_HeaderTrialBenchmark
+
+#include "Platform/Platform.h"
+
+namespace VeraCrypt
+{
+	// Cost of trying a wrong header key with all available encryption algorithms in XTS mode when each
+	// candidate decrypts the whole header and when candidates are rejected by the first cipher block
+	struct HeaderTrialBenchmark
+	{
+		HeaderTrialBenchmark () : AlgorithmCount (0), EarlyRejectTime (0), FullDecryptionTime (0) { }
+
+		static HeaderTrialBenchmark Run ();
+
+		static const int RoundCount = 5;
+		static const int TrialCount = 200;
+
+		size_t AlgorithmCount;
+		uint64 EarlyRejectTime;		// Nanoseconds per header key
+		uint64 FullDecryptionTime;
+	};
+}
+
+#endif // TC_HEADER_Volume_HeaderTrialBenchmark
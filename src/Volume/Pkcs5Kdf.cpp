@@ -12,6 +12,7 @@
 
 #include "Common/Pkcs5.h"
 #include "Platform/StringConverter.h"
+#include "EncryptionThreadPool.h"
 #include "Pkcs5Kdf.h"
 #include "VolumePassword.h"
 #if !defined (WOLFCRYPT_BACKEND) && !defined (VC_DCS_DISABLE_ARGON2)
@@ -20,6 +21,8 @@
 
 namespace VeraCrypt
 {
+	bool Pkcs5Kdf::ParallelDerivationEnabled = true;
+
 	Pkcs5Kdf::Pkcs5Kdf ()
 	{
 	}
@@ -35,7 +38,16 @@ namespace VeraCrypt
 
 	int Pkcs5Kdf::DeriveKey (const BufferPtr &key, const VolumePassword &password, int pim, const ConstBufferPtr &salt, long volatile *pAbortKeyDerivation) const
 	{
-		return DeriveKey (key, password, salt, GetIterationCount(pim), pAbortKeyDerivation);
+		int iterationCount = GetIterationCount (pim);
+
+		// Output blocks of PBKDF2 are independent of each other and can be derived concurrently
+		if (ParallelDerivationEnabled && GetDerivationBlockSize() > 0 && EncryptionThreadPool::IsRunning())
+		{
+			ValidateParameters (key, password, salt, iterationCount);
+			return EncryptionThreadPool::DeriveKeyInParts (*this, key, password, salt, iterationCount, pAbortKeyDerivation);
+		}
+
+		return DeriveKey (key, password, salt, iterationCount, pAbortKeyDerivation);
 	}
 
 	int Pkcs5Kdf::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const
@@ -44,6 +56,17 @@ namespace VeraCrypt
 		return DeriveKey (key, password, salt, iterationCount);
 	}
 
+	int Pkcs5Kdf::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		(void) key;
+		(void) password;
+		(void) salt;
+		(void) iterationCount;
+		(void) firstBlock;
+		(void) pAbortKeyDerivation;
+		throw NotApplicable (SRC_POS);
+	}
+
 	wstring Pkcs5Kdf::GetDerivationFailureMessage (int result) const
 	{
 		(void) result;
@@ -86,6 +109,7 @@ namespace VeraCrypt
 		l.push_back (shared_ptr <Pkcs5Kdf> (new Pkcs5HmacStreebog ()));
         #ifndef VC_DCS_DISABLE_ARGON2
 		l.push_back (shared_ptr <Pkcs5Kdf> (new Pkcs5Argon2 ()));
+		l.push_back (shared_ptr <Pkcs5Kdf> (new Pkcs5Argon2P4 ()));
         #endif
         #endif
 		return l;
@@ -110,6 +134,13 @@ namespace VeraCrypt
 		return 0;
 	}
 
+	int Pkcs5HmacBlake2s_Boot::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_blake2s_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
+
 	int Pkcs5HmacBlake2s::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
 	{
 		return DeriveKey (key, password, salt, iterationCount, nullptr);
@@ -121,6 +152,13 @@ namespace VeraCrypt
 		derive_key_blake2s (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, key.Get(), (int) key.Size(), pAbortKeyDerivation);
 		return 0;
 	}
+
+	int Pkcs5HmacBlake2s::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_blake2s_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
     #endif
 
 	int Pkcs5HmacSha256_Boot::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
@@ -135,6 +173,15 @@ namespace VeraCrypt
 		return 0;
 	}
 
+#ifndef WOLFCRYPT_BACKEND
+	int Pkcs5HmacSha256_Boot::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_sha256_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
+#endif
+
 	int Pkcs5HmacSha256::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
 	{
 		return DeriveKey (key, password, salt, iterationCount, nullptr);
@@ -147,6 +194,15 @@ namespace VeraCrypt
 		return 0;
 	}
 
+#ifndef WOLFCRYPT_BACKEND
+	int Pkcs5HmacSha256::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_sha256_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
+#endif
+
 	int Pkcs5HmacSha512::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
 	{
 		return DeriveKey (key, password, salt, iterationCount, nullptr);
@@ -159,6 +215,15 @@ namespace VeraCrypt
 		return 0;
 	}
 
+#ifndef WOLFCRYPT_BACKEND
+	int Pkcs5HmacSha512::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_sha512_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
+#endif
+
     #ifndef WOLFCRYPT_BACKEND
 	int Pkcs5HmacWhirlpool::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
 	{
@@ -171,6 +236,13 @@ namespace VeraCrypt
 		derive_key_whirlpool (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, key.Get(), (int) key.Size(), pAbortKeyDerivation);
 		return 0;
 	}
+
+	int Pkcs5HmacWhirlpool::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_whirlpool_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
 	
 	int Pkcs5HmacStreebog::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
 	{
@@ -184,6 +256,13 @@ namespace VeraCrypt
 		return 0;
 	}
 
+	int Pkcs5HmacStreebog::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_streebog_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
+
 	#ifndef VC_DCS_DISABLE_ARGON2
 	int Pkcs5Argon2::DeriveKey (const BufferPtr &key, const VolumePassword &password, int pim, const ConstBufferPtr &salt) const
 	{
@@ -227,6 +306,49 @@ namespace VeraCrypt
 		get_argon2_params (pim, &iterationCount, &memoryCost);
 		return iterationCount;
 	}
+
+	uint64 Pkcs5Argon2::GetMemoryCost (int pim) const
+	{
+		int iterationCount;
+		int memoryCost;
+		get_argon2_params (pim, &iterationCount, &memoryCost);
+		return (uint64) memoryCost * 1024;
+	}
+
+	static void FillArgon2Lanes (fill_lane_fptr fillLane, void *laneData, uint32_t lanes, void *runLanesData)
+	{
+		(void) runLanesData;
+		EncryptionThreadPool::FillKeyDerivationLanes (fillLane, laneData, lanes);
+	}
+
+	int Pkcs5Argon2P4::DeriveKey (const BufferPtr &key, const VolumePassword &password, int pim, const ConstBufferPtr &salt, long volatile *pAbortKeyDerivation) const
+	{
+		int iterationCount;
+		int memoryCost;
+		get_argon2_p4_params (pim, &iterationCount, &memoryCost);
+
+		ValidateParameters (key, password, salt, iterationCount);
+
+		// The lanes of each slice are independent and are filled on the workers; the key does not depend on it
+		run_lanes_fptr runLanes = (ParallelDerivationEnabled && EncryptionThreadPool::IsRunning()) ? FillArgon2Lanes : nullptr;
+		return derive_key_argon2_lanes (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, memoryCost, ARGON2_P4_LANES, key.Get(), (int) key.Size(), pAbortKeyDerivation, runLanes, nullptr);
+	}
+
+	int Pkcs5Argon2P4::GetIterationCount (int pim) const
+	{
+		int iterationCount;
+		int memoryCost;
+		get_argon2_p4_params (pim, &iterationCount, &memoryCost);
+		return iterationCount;
+	}
+
+	uint64 Pkcs5Argon2P4::GetMemoryCost (int pim) const
+	{
+		int iterationCount;
+		int memoryCost;
+		get_argon2_p4_params (pim, &iterationCount, &memoryCost);
+		return (uint64) memoryCost * 1024;
+	}
 	#endif
 	
 	int Pkcs5HmacStreebog_Boot::DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const
@@ -240,5 +362,12 @@ namespace VeraCrypt
 		derive_key_streebog (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, key.Get(), (int) key.Size(), pAbortKeyDerivation);
 		return 0;
 	}
+
+	int Pkcs5HmacStreebog_Boot::DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const
+	{
+		ValidateParameters (key, password, salt, iterationCount);
+		derive_key_streebog_part (password.DataPtr(), (int) password.Size(), salt.Get(), (int) salt.Size(), iterationCount, (int) firstBlock, key.Get(), (int) key.Size(), pAbortKeyDerivation);
+		return 0;
+	}
     #endif
 }
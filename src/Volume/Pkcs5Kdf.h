@@ -14,6 +14,7 @@
 #define TC_HEADER_Encryption_Pkcs5
 
 #include "Platform/Platform.h"
+#include "Common/Crypto.h"
 #include "Hash.h"
 #include "VolumePassword.h"
 
@@ -31,27 +32,37 @@ namespace VeraCrypt
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, int pim, const ConstBufferPtr &salt, long volatile *pAbortKeyDerivation) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const = 0;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const = 0;
+		// Derives key.Size() bytes of the key starting at the given zero-based output block (see GetDerivationBlockSize())
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
+		// If enabled, output blocks of keys derived from a PIM are spread across the encryption thread pool
+		static void EnableParallelDerivation (bool enable) { ParallelDerivationEnabled = enable; }
 		static shared_ptr <Pkcs5Kdf> GetAlgorithm (const wstring &name);
 		static shared_ptr <Pkcs5Kdf> GetAlgorithm (const Hash &hash);
 		static Pkcs5KdfList GetAvailableAlgorithms ();
 		virtual shared_ptr <Hash> GetHash () const = 0;
 		virtual wstring GetDerivationFailureMessage (int result) const;
 		virtual int GetDefaultPim () const { return 485; }
+		// Size of the independently derivable output blocks of the key; zero if the key cannot be derived in parts
+		virtual size_t GetDerivationBlockSize () const { return 0; }
 		virtual const char *GetPimHelpMessageId () const { return "PIM_HELP"; }
 		virtual const char *GetPimLargeWarningMessageId () const { return "PIM_LARGE_WARNING"; }
 		virtual const char *GetPimSmallWarningMessageId () const { return "PIM_SMALL_WARNING"; }
 		virtual const char *GetPimRequireLongPasswordMessageId () const { return "PIM_REQUIRE_LONG_PASSWORD"; }
 		virtual int GetIterationCount (int pim) const = 0;
+		virtual uint64 GetMemoryCost (int pim) const { (void) pim; return 0; }	// Bytes of memory used by a key derivation
 		virtual wstring GetName () const = 0;
 		virtual Pkcs5Kdf* Clone () const = 0;
 		virtual bool IsArgon2 () const { return false; }
 		virtual bool IsDeprecated () const { return GetHash()->IsDeprecated(); }
+		static bool IsParallelDerivationEnabled () { return ParallelDerivationEnabled; }
 
 	protected:
 		Pkcs5Kdf ();
 
 		void ValidateParameters (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 
+		static bool ParallelDerivationEnabled;
+
 	private:
 		Pkcs5Kdf (const Pkcs5Kdf &);
 		Pkcs5Kdf &operator= (const Pkcs5Kdf &);
@@ -66,7 +77,9 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Blake2s); }
+		virtual size_t GetDerivationBlockSize () const { return BLAKE2S_DIGESTSIZE; }
 		virtual int GetDefaultPim () const { return 98; }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 200000 : (pim * 2048); }
 		virtual wstring GetName () const { return L"HMAC-BLAKE2s-256"; }
@@ -85,7 +98,9 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Blake2s); }
+		virtual size_t GetDerivationBlockSize () const { return BLAKE2S_DIGESTSIZE; }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 500000 : (15000 + (pim * 1000)); }
 		virtual wstring GetName () const { return L"HMAC-BLAKE2s-256"; }
 		virtual Pkcs5Kdf* Clone () const { return new Pkcs5HmacBlake2s(); }
@@ -104,6 +119,10 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+#ifndef WOLFCRYPT_BACKEND
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
+		virtual size_t GetDerivationBlockSize () const { return SHA256_DIGESTSIZE; }
+#endif
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Sha256); }
 		virtual int GetDefaultPim () const { return 98; }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 200000 : (pim * 2048); }
@@ -123,6 +142,10 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+#ifndef WOLFCRYPT_BACKEND
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
+		virtual size_t GetDerivationBlockSize () const { return SHA256_DIGESTSIZE; }
+#endif
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Sha256); }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 500000 : (15000 + (pim * 1000)); }
 		virtual wstring GetName () const { return L"HMAC-SHA-256"; }
@@ -141,6 +164,10 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+#ifndef WOLFCRYPT_BACKEND
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
+		virtual size_t GetDerivationBlockSize () const { return SHA512_DIGESTSIZE; }
+#endif
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Sha512); }
 		virtual int GetIterationCount (int pim) const { return (pim <= 0 ? 500000 : (15000 + (pim * 1000))); }
 		virtual wstring GetName () const { return L"HMAC-SHA-512"; }
@@ -159,7 +186,9 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Whirlpool); }
+		virtual size_t GetDerivationBlockSize () const { return WHIRLPOOL_DIGESTSIZE; }
 		virtual int GetIterationCount (int pim) const { return (pim <= 0 ? 500000 : (15000 + (pim * 1000))); }
 		virtual wstring GetName () const { return L"HMAC-Whirlpool"; }
 		virtual Pkcs5Kdf* Clone () const { return new Pkcs5HmacWhirlpool(); }
@@ -177,7 +206,9 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Streebog); }
+		virtual size_t GetDerivationBlockSize () const { return STREEBOG_DIGESTSIZE; }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 500000 : (15000 + (pim * 1000)); }
 		virtual wstring GetName () const { return L"HMAC-Streebog"; }
 		virtual Pkcs5Kdf* Clone () const { return new Pkcs5HmacStreebog(); }
@@ -206,6 +237,7 @@ namespace VeraCrypt
 		virtual const char *GetPimSmallWarningMessageId () const { return "PIM_ARGON2_SMALL_WARNING"; }
 		virtual const char *GetPimRequireLongPasswordMessageId () const { return "PIM_ARGON2_REQUIRE_LONG_PASSWORD"; }
 		virtual int GetIterationCount (int pim) const;
+		virtual uint64 GetMemoryCost (int pim) const;
 		virtual wstring GetName () const { return L"Argon2"; }
 		virtual Pkcs5Kdf* Clone () const { return new Pkcs5Argon2(); }
 		virtual bool IsArgon2 () const { return true; }
@@ -214,6 +246,25 @@ namespace VeraCrypt
 		Pkcs5Argon2 (const Pkcs5Argon2 &);
 		Pkcs5Argon2 &operator= (const Pkcs5Argon2 &);
 	};
+
+	// Argon2id with ARGON2_P4_LANES lanes, filled concurrently on the encryption thread pool
+	class Pkcs5Argon2P4 : public Pkcs5Argon2
+	{
+	public:
+		Pkcs5Argon2P4 () : Pkcs5Argon2() { }
+		virtual ~Pkcs5Argon2P4 () { }
+
+		using Pkcs5Argon2::DeriveKey;
+		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, int pim, const ConstBufferPtr &salt, long volatile *pAbortKeyDerivation) const;
+		virtual int GetIterationCount (int pim) const;
+		virtual uint64 GetMemoryCost (int pim) const;
+		virtual wstring GetName () const { return L"Argon2-P4"; }
+		virtual Pkcs5Kdf* Clone () const { return new Pkcs5Argon2P4(); }
+
+	private:
+		Pkcs5Argon2P4 (const Pkcs5Argon2P4 &);
+		Pkcs5Argon2P4 &operator= (const Pkcs5Argon2P4 &);
+	};
 	#endif
 	
 	class Pkcs5HmacStreebog_Boot : public Pkcs5Kdf
@@ -224,7 +275,9 @@ namespace VeraCrypt
 
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount) const;
 		virtual int DeriveKey (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, long volatile *pAbortKeyDerivation) const;
+		virtual int DeriveKeyPart (const BufferPtr &key, const VolumePassword &password, const ConstBufferPtr &salt, int iterationCount, size_t firstBlock, long volatile *pAbortKeyDerivation) const;
 		virtual shared_ptr <Hash> GetHash () const { return shared_ptr <Hash> (new Streebog); }
+		virtual size_t GetDerivationBlockSize () const { return STREEBOG_DIGESTSIZE; }
 		virtual int GetDefaultPim () const { return 98; }
 		virtual int GetIterationCount (int pim) const { return pim <= 0 ? 200000 : pim * 2048; }
 		virtual wstring GetName () const { return L"HMAC-Streebog"; }
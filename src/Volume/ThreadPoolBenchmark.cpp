@@ -0,0 +1,381 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#include "Platform/SharedVal.h"
+#include "Platform/SyncEvent.h"
+#include "Platform/Time.h"
+#include "EncryptionAlgorithm.h"
+#include "EncryptionThreadPool.h"
+#include "ThreadPoolBenchmark.h"
+#ifndef WOLFCRYPT_BACKEND
+#include "EncryptionModeXTS.h"
+#endif
+
+namespace VeraCrypt
+{
+	// The former scheduler of EncryptionThreadPool, reduced to the processing of data units: producers and workers
+	// are serialized by an enqueue and a dequeue mutex and producers wait for free entries of a fixed ring
+	class RingThreadPool
+	{
+	public:
+		RingThreadPool (size_t threadCount);
+		~RingThreadPool ();
+
+		void DoWork (EncryptionThreadPool::WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize);
+
+	protected:
+		struct WorkItem
+		{
+			struct State
+			{
+				enum Enum
+				{
+					Free,
+					Ready,
+					Busy
+				};
+			};
+
+			WorkItem *FirstFragment;
+			unique_ptr <Exception> ItemException;
+			SyncEvent ItemCompletedEvent;
+			SharedVal <size_t> OutstandingFragmentCount;
+			SharedVal <State::Enum> State;
+			EncryptionThreadPool::WorkType::Enum Type;
+
+			const EncryptionMode *Mode;
+			uint8 *Data;
+			uint64 StartUnitNo;
+			uint64 UnitCount;
+			size_t SectorSize;
+		};
+
+		void Stop ();
+		void WorkThreadProc ();
+
+		static const size_t QueueSize = EncryptionThreadPool::MaxThreadCount * 2;
+
+		Mutex DequeueMutex;
+		volatile size_t DequeuePosition;
+		volatile size_t EnqueuePosition;
+		Mutex EnqueueMutex;
+		list < shared_ptr <Thread> > RunningThreads;
+		volatile bool StopPending;
+		size_t ThreadCount;
+		SyncEvent WorkItemCompletedEvent;
+		WorkItem WorkItemQueue[QueueSize];
+		SyncEvent WorkItemReadyEvent;
+
+	private:
+		RingThreadPool (const RingThreadPool &);
+		RingThreadPool &operator= (const RingThreadPool &);
+	};
+
+	RingThreadPool::RingThreadPool (size_t threadCount)
+		: DequeuePosition (0), EnqueuePosition (0), StopPending (false), ThreadCount (0)
+	{
+		for (size_t i = 0; i < QueueSize; ++i)
+			WorkItemQueue[i].State.Set (WorkItem::State::Free);
+
+		try
+		{
+			for (ThreadCount = 0; ThreadCount < threadCount; ++ThreadCount)
+			{
+				struct ThreadFunctor : public Functor
+				{
+					ThreadFunctor (RingThreadPool &pool) : Pool (pool) { }
+					virtual void operator() ()
+					{
+						Pool.WorkThreadProc();
+					}
+
+					RingThreadPool &Pool;
+				};
+
+				make_shared_auto (Thread, thread);
+				thread->Start (new ThreadFunctor (*this));
+				RunningThreads.push_back (thread);
+			}
+		}
+		catch (...)
+		{
+			Stop();
+			throw;
+		}
+	}
+
+	RingThreadPool::~RingThreadPool ()
+	{
+		Stop();
+	}
+
+	void RingThreadPool::DoWork (EncryptionThreadPool::WorkType::Enum type, const EncryptionMode *encryptionMode, uint8 *data, uint64 startUnitNo, uint64 unitCount, size_t sectorSize)
+	{
+		size_t fragmentCount;
+		size_t unitsPerFragment;
+		size_t remainder;
+
+		if (unitCount <= ThreadCount)
+		{
+			fragmentCount = (size_t) unitCount;
+			unitsPerFragment = 1;
+			remainder = 0;
+		}
+		else
+		{
+			fragmentCount = ThreadCount;
+			unitsPerFragment = (size_t) unitCount / ThreadCount;
+			remainder = (size_t) unitCount % ThreadCount;
+
+			if (remainder > 0)
+				++unitsPerFragment;
+		}
+
+		uint8 *fragmentData = data;
+		uint64 fragmentStartUnitNo = startUnitNo;
+		WorkItem *firstFragmentWorkItem;
+
+		{
+			ScopeLock lock (EnqueueMutex);
+			firstFragmentWorkItem = &WorkItemQueue[EnqueuePosition];
+
+			while (firstFragmentWorkItem->State != WorkItem::State::Free)
+			{
+				WorkItemCompletedEvent.Wait();
+			}
+
+			firstFragmentWorkItem->OutstandingFragmentCount.Set (fragmentCount);
+			firstFragmentWorkItem->ItemException.reset();
+
+			while (fragmentCount-- > 0)
+			{
+				WorkItem *workItem = &WorkItemQueue[EnqueuePosition++];
+
+				if (EnqueuePosition >= QueueSize)
+					EnqueuePosition = 0;
+
+				while (workItem->State != WorkItem::State::Free)
+				{
+					WorkItemCompletedEvent.Wait();
+				}
+
+				workItem->Type = type;
+				workItem->FirstFragment = firstFragmentWorkItem;
+
+				workItem->Mode = encryptionMode;
+				workItem->Data = fragmentData;
+				workItem->UnitCount = unitsPerFragment;
+				workItem->StartUnitNo = fragmentStartUnitNo;
+				workItem->SectorSize = sectorSize;
+
+				fragmentData += unitsPerFragment * sectorSize;
+				fragmentStartUnitNo += unitsPerFragment;
+
+				if (remainder > 0 && --remainder == 0)
+					--unitsPerFragment;
+
+				workItem->State.Set (WorkItem::State::Ready);
+				WorkItemReadyEvent.Signal();
+			}
+		}
+
+		firstFragmentWorkItem->ItemCompletedEvent.Wait();
+
+		unique_ptr <Exception> itemException;
+		if (firstFragmentWorkItem->ItemException.get())
+			itemException = move_ptr (firstFragmentWorkItem->ItemException);
+
+		firstFragmentWorkItem->State.Set (WorkItem::State::Free);
+		WorkItemCompletedEvent.Signal();
+
+		if (itemException.get())
+			itemException->Throw();
+	}
+
+	void RingThreadPool::Stop ()
+	{
+		StopPending = true;
+		WorkItemReadyEvent.Signal();
+
+		foreach_ref (const Thread &thread, RunningThreads)
+		{
+			thread.Join();
+		}
+
+		RunningThreads.clear();
+	}
+
+	void RingThreadPool::WorkThreadProc ()
+	{
+		while (!StopPending)
+		{
+			WorkItem *workItem;
+
+			{
+				ScopeLock lock (DequeueMutex);
+
+				workItem = &WorkItemQueue[DequeuePosition++];
+
+				if (DequeuePosition >= QueueSize)
+					DequeuePosition = 0;
+
+				while (!StopPending && workItem->State != WorkItem::State::Ready)
+				{
+					WorkItemReadyEvent.Wait();
+				}
+
+				workItem->State.Set (WorkItem::State::Busy);
+			}
+
+			if (StopPending)
+				break;
+
+			try
+			{
+				if (workItem->Type == EncryptionThreadPool::WorkType::DecryptDataUnits)
+					workItem->Mode->DecryptSectorsCurrentThread (workItem->Data, workItem->StartUnitNo, workItem->UnitCount, workItem->SectorSize);
+				else
+					workItem->Mode->EncryptSectorsCurrentThread (workItem->Data, workItem->StartUnitNo, workItem->UnitCount, workItem->SectorSize);
+			}
+			catch (Exception &e)
+			{
+				workItem->FirstFragment->ItemException.reset (e.CloneNew());
+			}
+			catch (...)
+			{
+				workItem->FirstFragment->ItemException.reset (new UnknownException (SRC_POS));
+			}
+
+			if (workItem != workItem->FirstFragment)
+			{
+				workItem->State.Set (WorkItem::State::Free);
+				WorkItemCompletedEvent.Signal();
+			}
+
+			if (workItem->FirstFragment->OutstandingFragmentCount.Decrement() == 0)
+				workItem->FirstFragment->ItemCompletedEvent.Signal();
+		}
+	}
+
+	ThreadPoolBenchmark ThreadPoolBenchmark::Run (size_t submitterCount, size_t requestSize)
+	{
+#ifdef WOLFCRYPT_BACKEND
+		throw NotApplicable (SRC_POS);
+#else
+		if (!EncryptionThreadPool::IsRunning())
+			throw NotApplicable (SRC_POS);
+
+		requestSize -= requestSize % ENCRYPTION_DATA_UNIT_SIZE;
+		if (submitterCount < 1 || requestSize == 0)
+			throw ParameterIncorrect (SRC_POS);
+
+		// AES is the fastest cipher, which makes the cost of scheduling most visible
+		shared_ptr <EncryptionAlgorithm> ea (new AES);
+		shared_ptr <EncryptionModeXTS> xts (new EncryptionModeXTS);
+
+		SecureBuffer key (ea->GetKeySize());
+		for (size_t i = 0; i < key.Size(); ++i)
+			key[i] = (uint8) (i * 29 + 7);
+
+		ea->SetKey (key);
+		xts->SetKey (key);
+		ea->SetMode (xts);
+
+		struct SubmitterFunctor : public Functor
+		{
+			SubmitterFunctor (RingThreadPool *ring, const EncryptionMode &mode, size_t requestSize, uint64 requestCount, SharedVal <size_t> &failureCount)
+				: FailureCount (failureCount), Mode (mode), RequestCount (requestCount), RequestSize (requestSize), Ring (ring) { }
+
+			virtual void operator() ()
+			{
+				try
+				{
+					Buffer buffer (RequestSize);
+					buffer.Zero();
+
+					uint64 unitCount = RequestSize / ENCRYPTION_DATA_UNIT_SIZE;
+
+					// Requests alternate between encryption and decryption of the same data units
+					for (uint64 request = 0; request < RequestCount; ++request)
+					{
+						EncryptionThreadPool::WorkType::Enum type = (request % 2 == 0) ? EncryptionThreadPool::WorkType::EncryptDataUnits : EncryptionThreadPool::WorkType::DecryptDataUnits;
+						uint64 startUnitNo = (request / 2) * unitCount;
+
+						if (Ring)
+							Ring->DoWork (type, &Mode, buffer, startUnitNo, unitCount, ENCRYPTION_DATA_UNIT_SIZE);
+						else
+							EncryptionThreadPool::DoWork (type, &Mode, buffer, startUnitNo, unitCount, ENCRYPTION_DATA_UNIT_SIZE);
+					}
+				}
+				catch (...)
+				{
+					FailureCount.Increment();
+				}
+			}
+
+			SharedVal <size_t> &FailureCount;
+			const EncryptionMode &Mode;
+			uint64 RequestCount;
+			size_t RequestSize;
+			RingThreadPool *Ring;
+		};
+
+		ThreadPoolBenchmark result;
+		result.RequestSize = requestSize;
+		result.SubmitterCount = submitterCount;
+		result.ThreadCount = EncryptionThreadPool::GetThreadCount();
+
+		uint64 requestCount = RoundDataSize / requestSize / submitterCount;
+		if (requestCount < 2)
+			requestCount = 2;
+
+		RingThreadPool ring (result.ThreadCount);
+
+		// Both schedulers alternate so that changes in CPU frequency affect both; the best round is reported
+		for (int round = 0; round < RoundCount; ++round)
+		{
+			for (int workStealing = 0; workStealing <= 1; ++workStealing)
+			{
+				SharedVal <size_t> failureCount (0);
+				list < shared_ptr <Thread> > submitters;
+
+				uint64 startTime = Time::GetCurrent();
+
+				for (size_t i = 0; i < submitterCount; ++i)
+				{
+					make_shared_auto (Thread, thread);
+					thread->Start (new SubmitterFunctor (workStealing ? nullptr : &ring, *xts, requestSize, requestCount, failureCount));
+					submitters.push_back (thread);
+				}
+
+				foreach_ref (const Thread &thread, submitters)
+				{
+					thread.Join();
+				}
+
+				uint64 elapsedTime = Time::GetCurrent() - startTime;
+				if (elapsedTime == 0)
+					elapsedTime = 1;
+
+				if (failureCount.Get() != 0)
+					throw TestFailed (SRC_POS);
+
+				// Time is measured in hundreds of nanoseconds
+				uint64 speed = (uint64) ((double) requestCount * submitterCount * requestSize * 10 * 1000 * 1000 / elapsedTime);
+				uint64 &bestSpeed = workStealing ? result.WorkStealingSpeed : result.RingSpeed;
+
+				if (speed > bestSpeed)
+					bestSpeed = speed;
+			}
+		}
+
+		return result;
+#endif
+	}
+}
@@ -0,0 +1,37 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ This file is part of VeraCrypt and is governed by the Apache License 2.0
+ the full text of which is contained in the file License.txt included in
+ VeraCrypt binary and source code distribution packages.
+*/
+
+#ifndef TC_HEADER_Volume_ThreadPoolBenchmark
+#define TC_HEADER_Volume_ThreadPoolBenchmark
+
+#include "Platform/Platform.h"
+
+namespace VeraCrypt
+{
+	// XTS throughput of concurrent requests processed by the work-stealing queues of the encryption thread pool
+	// and by the scheduler they replaced, a single ring of work items guarded by an enqueue and a dequeue mutex
+	struct ThreadPoolBenchmark
+	{
+		ThreadPoolBenchmark () : RequestSize (0), RingSpeed (0), SubmitterCount (0), ThreadCount (0), WorkStealingSpeed (0) { }
+
+		static ThreadPoolBenchmark Run (size_t submitterCount, size_t requestSize = DefaultRequestSize);
+
+		static const size_t DefaultRequestSize = 64 * 1024;
+		static const int RoundCount = 5;
+		static const uint64 RoundDataSize = 64 * 1024 * 1024;
+
+		size_t RequestSize;
+		uint64 RingSpeed;	// Bytes per second (encryption and decryption)
+		size_t SubmitterCount;
+		size_t ThreadCount;
+		uint64 WorkStealingSpeed;
+	};
+}
+
+#endif // TC_HEADER_Volume_ThreadPoolBenchmark
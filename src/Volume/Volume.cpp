@@ -14,15 +14,18 @@
 #include <errno.h>
 #endif
 #include "EncryptionModeXTS.h"
+#include "EncryptionThreadPool.h"
 #include "Volume.h"
 #include "VolumeHeader.h"
 #include "VolumeLayout.h"
 #include "Common/Crypto.h"
+#include "Platform/FileIoBatch.h"
 
 namespace VeraCrypt
 {
 	Volume::Volume ()
 		: HiddenVolumeProtectionTriggered (false),
+		ReadChunkSize (DefaultReadChunkSize),
 		SystemEncryption (false),
 		VolumeDataOffset (0),
 		VolumeDataSize (0),
@@ -58,6 +61,32 @@ namespace VeraCrypt
 		VolumeFile.reset();
 	}
 
+	uint64 Volume::GetEncryptedRange (const ConstBufferPtr &data, uint64 hostOffset, size_t &encryptedOffset) const
+	{
+		uint64 length = data.Size();
+		encryptedOffset = 0;
+
+		// first sector can be unencrypted in some cases (e.g. windows repair)
+		// detect this case by looking for NTFS header
+		if (SystemEncryption && (hostOffset == 0) && length >= SectorSize && ((BE64 (*(uint64 *) data.Get ())) == 0xEB52904E54465320ULL))
+		{
+			encryptedOffset = SectorSize;
+			hostOffset += SectorSize;
+			length -= SectorSize;
+		}
+
+		if (EncryptionNotCompleted)
+		{
+			// if encryption is not complete, we decrypt only the encrypted sectors
+			if (hostOffset >= EncryptedDataSize)
+				return 0;
+
+			length = VC_MIN (length, (EncryptedDataSize - hostOffset));
+		}
+
+		return length;
+	}
+
 	shared_ptr <EncryptionAlgorithm> Volume::GetEncryptionAlgorithm () const
 	{
 		if_debug (ValidateState ());
@@ -70,7 +99,7 @@ namespace VeraCrypt
 		return EA->GetMode();
 	}
 
-	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope)
+	void Volume::Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf, shared_ptr <KeyfileList> protectionKeyfiles, bool sharedAccessAllowed, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeHeaderHint &headerHint)
 	{
 		make_shared_auto (File, file);
 
@@ -101,10 +130,10 @@ namespace VeraCrypt
 				throw;
 		}
 
-		return Open (file, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf,protectionKeyfiles, volumeType, useBackupHeaders, partitionInSystemEncryptionScope);
+		return Open (file, password, pim, kdf, keyfiles, emvSupportEnabled, protection, protectionPassword, protectionPim, protectionKdf,protectionKeyfiles, volumeType, useBackupHeaders, partitionInSystemEncryptionScope, headerHint);
 	}
 
-	void Volume::Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf,shared_ptr <KeyfileList> protectionKeyfiles, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope)
+	void Volume::Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection, shared_ptr <VolumePassword> protectionPassword, int protectionPim, shared_ptr <Pkcs5Kdf> protectionKdf,shared_ptr <KeyfileList> protectionKeyfiles, VolumeType::Enum volumeType, bool useBackupHeaders, bool partitionInSystemEncryptionScope, const VolumeHeaderHint &headerHint)
 	{
 		if (!volumeFile)
 			throw ParameterIncorrect (SRC_POS);
@@ -119,8 +148,11 @@ namespace VeraCrypt
 			shared_ptr <VolumePassword> passwordKey = Keyfile::ApplyListToPassword (keyfiles, password, emvSupportEnabled);
 
 			bool skipLayoutV1Normal = false;
+			VolumeLayoutList candidateLayouts;
+			list < shared_ptr <SecureBuffer> > headerBuffers;
+			VolumeHeaderCandidateList candidates;
 
-			// Test volume layouts
+			// Read the headers of all volume layouts
 			foreach (shared_ptr <VolumeLayout> layout, VolumeLayout::GetAvailableLayouts (volumeType))
 			{
 				if (skipLayoutV1Normal && typeid (*layout) == typeid (VolumeLayoutV1Normal))
@@ -132,7 +164,7 @@ namespace VeraCrypt
 				if (useBackupHeaders && !layout->HasBackupHeader())
 					continue;
 
-				SecureBuffer headerBuffer (layout->GetHeaderSize());
+				shared_ptr <SecureBuffer> headerBuffer (new SecureBuffer (layout->GetHeaderSize()));
 
 				if (layout->HasDriveHeader())
 				{
@@ -152,7 +184,7 @@ namespace VeraCrypt
 					else
 						driveDevice.SeekEnd (headerOffset);
 
-					if (driveDevice.Read (headerBuffer) != layout->GetHeaderSize())
+					if (driveDevice.Read (*headerBuffer) != layout->GetHeaderSize())
 						continue;
 				}
 				else
@@ -167,7 +199,7 @@ namespace VeraCrypt
 					else
 						VolumeFile->SeekEnd (headerOffset);
 
-					if (VolumeFile->Read (headerBuffer) != layout->GetHeaderSize())
+					if (VolumeFile->Read (*headerBuffer) != layout->GetHeaderSize())
 						continue;
 				}
 
@@ -183,88 +215,108 @@ namespace VeraCrypt
 					layoutEncryptionModes = EncryptionMode::GetAvailableModes();
 				}
 
-				shared_ptr <VolumeHeader> header = layout->GetHeader();
+				VolumeHeaderCandidate candidate;
+				candidate.Header = layout->GetHeader();
+				candidate.EncryptedData = *headerBuffer;
+				candidate.HintApplicable = layout->GetType() == VolumeType::Normal && !layout->HasDriveHeader()
+					&& !useBackupHeaders && protection == VolumeProtection::None;
+				candidate.KeyDerivationFunctions = layout->GetSupportedKeyDerivationFunctions();
+				candidate.EncryptionAlgorithms = layoutEncryptionAlgorithms;
+				candidate.EncryptionModes = layoutEncryptionModes;
+
+				headerBuffers.push_back (headerBuffer);
+				candidateLayouts.push_back (layout);
+				candidates.push_back (candidate);
+			}
+
+			// Test volume layouts concurrently; the first layout in the list order whose header is decrypted wins
+			int decryptedCandidate = VolumeHeader::DecryptFirst (candidates, *passwordKey, pim, kdf, headerHint);
 
-				if (header->Decrypt (headerBuffer, *passwordKey, pim, kdf, layout->GetSupportedKeyDerivationFunctions(), layoutEncryptionAlgorithms, layoutEncryptionModes))
+			if (decryptedCandidate >= 0)
+			{
+				// Header decrypted
+				VolumeLayoutList::iterator layoutIterator = candidateLayouts.begin();
+				advance (layoutIterator, decryptedCandidate);
+
+				shared_ptr <VolumeLayout> layout = *layoutIterator;
+				shared_ptr <VolumeHeader> header = candidates[decryptedCandidate].Header;
+
+
+				if (typeid (*layout) == typeid (VolumeLayoutV2Normal) && header->GetRequiredMinProgramVersion() < 0x10b)
 				{
-					// Header decrypted
+					// VolumeLayoutV1Normal has been opened as VolumeLayoutV2Normal
+					layout.reset (new VolumeLayoutV1Normal);
+					header->SetSize (layout->GetHeaderSize());
+					layout->SetHeader (header);
+				}
+
+				Pim = pim;
+				Type = layout->GetType();
+				SectorSize = header->GetSectorSize();
+
+				VolumeDataOffset = layout->GetDataOffset (VolumeHostSize);
+				VolumeDataSize = layout->GetDataSize (VolumeHostSize);
+				EncryptedDataSize = header->GetEncryptedAreaLength();
+
+				Header = header;
+				Layout = layout;
+				EA = header->GetEncryptionAlgorithm();
+				EncryptionMode &mode = *EA->GetMode();
 
-					if (typeid (*layout) == typeid (VolumeLayoutV2Normal) && header->GetRequiredMinProgramVersion() < 0x10b)
+				if (layout->HasDriveHeader())
+				{
+					if (header->GetEncryptedAreaLength() != header->GetVolumeDataSize())
 					{
-						// VolumeLayoutV1Normal has been opened as VolumeLayoutV2Normal
-						layout.reset (new VolumeLayoutV1Normal);
-						header->SetSize (layout->GetHeaderSize());
-						layout->SetHeader (header);
+						EncryptionNotCompleted = true;
+						// we avoid writing data to the partition since it is only partially encrypted
+						Protection = VolumeProtection::ReadOnly;
 					}
 
-					Pim = pim;
-					Type = layout->GetType();
-					SectorSize = header->GetSectorSize();
+					uint64 partitionStartOffset = VolumeFile->GetPartitionDeviceStartOffset();
 
-					VolumeDataOffset = layout->GetDataOffset (VolumeHostSize);
-					VolumeDataSize = layout->GetDataSize (VolumeHostSize);
-					EncryptedDataSize = header->GetEncryptedAreaLength();
+					if (partitionStartOffset < header->GetEncryptedAreaStart()
+						|| partitionStartOffset >= header->GetEncryptedAreaStart() + header->GetEncryptedAreaLength())
+						throw PasswordIncorrect (SRC_POS);
 
-					Header = header;
-					Layout = layout;
-					EA = header->GetEncryptionAlgorithm();
-					EncryptionMode &mode = *EA->GetMode();
+					EncryptedDataSize -= partitionStartOffset - header->GetEncryptedAreaStart();
+
+					mode.SetSectorOffset (partitionStartOffset / ENCRYPTION_DATA_UNIT_SIZE);
+				}
 
-					if (layout->HasDriveHeader())
+				// Volume protection
+				if (Protection == VolumeProtection::HiddenVolumeReadOnly)
+				{
+					if (Type == VolumeType::Hidden)
+						throw PasswordIncorrect (SRC_POS);
+					else
 					{
-						if (header->GetEncryptedAreaLength() != header->GetVolumeDataSize())
+						try
 						{
-							EncryptionNotCompleted = true;
-							// we avoid writing data to the partition since it is only partially encrypted
-							Protection = VolumeProtection::ReadOnly;
-						}
-
-						uint64 partitionStartOffset = VolumeFile->GetPartitionDeviceStartOffset();
+							Volume protectedVolume;
 
-						if (partitionStartOffset < header->GetEncryptedAreaStart()
-							|| partitionStartOffset >= header->GetEncryptedAreaStart() + header->GetEncryptedAreaLength())
-							throw PasswordIncorrect (SRC_POS);
+							protectedVolume.Open (VolumeFile,
+								protectionPassword, protectionPim, protectionKdf, protectionKeyfiles,
+								emvSupportEnabled,
+								VolumeProtection::ReadOnly,
+								shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> (),
+								VolumeType::Hidden,
+								useBackupHeaders);
 
-						EncryptedDataSize -= partitionStartOffset - header->GetEncryptedAreaStart();
+							if (protectedVolume.GetType() != VolumeType::Hidden)
+								ParameterIncorrect (SRC_POS);
 
-						mode.SetSectorOffset (partitionStartOffset / ENCRYPTION_DATA_UNIT_SIZE);
-					}
-
-					// Volume protection
-					if (Protection == VolumeProtection::HiddenVolumeReadOnly)
-					{
-						if (Type == VolumeType::Hidden)
-							throw PasswordIncorrect (SRC_POS);
-						else
+							ProtectedRangeStart = protectedVolume.VolumeDataOffset;
+							ProtectedRangeEnd = protectedVolume.VolumeDataOffset + protectedVolume.VolumeDataSize;
+						}
+						catch (PasswordException&)
 						{
-							try
-							{
-								Volume protectedVolume;
-
-								protectedVolume.Open (VolumeFile,
-									protectionPassword, protectionPim, protectionKdf, protectionKeyfiles,
-									emvSupportEnabled,
-									VolumeProtection::ReadOnly,
-									shared_ptr <VolumePassword> (), 0, shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> (),
-									VolumeType::Hidden,
-									useBackupHeaders);
-
-								if (protectedVolume.GetType() != VolumeType::Hidden)
-									ParameterIncorrect (SRC_POS);
-
-								ProtectedRangeStart = protectedVolume.VolumeDataOffset;
-								ProtectedRangeEnd = protectedVolume.VolumeDataOffset + protectedVolume.VolumeDataSize;
-							}
-							catch (PasswordException&)
-							{
-								if (protectionKeyfiles && !protectionKeyfiles->empty())
-									throw ProtectionPasswordKeyfilesIncorrect (SRC_POS);
-								throw ProtectionPasswordIncorrect (SRC_POS);
-							}
+							if (protectionKeyfiles && !protectionKeyfiles->empty())
+								throw ProtectionPasswordKeyfilesIncorrect (SRC_POS);
+							throw ProtectionPasswordIncorrect (SRC_POS);
 						}
 					}
-					return;
 				}
+				return;
 			}
 
 			if (partitionInSystemEncryptionScope)
@@ -311,40 +363,65 @@ namespace VeraCrypt
 
 		uint64 length = buffer.Size();
 		uint64 hostOffset = VolumeDataOffset + byteOffset;
-		size_t bufferOffset = 0;
+		size_t encryptedOffset;
 
 		if (length % SectorSize != 0 || byteOffset % SectorSize != 0)
 			throw ParameterIncorrect (SRC_POS);
 
-		if (VolumeFile->ReadAt (buffer, hostOffset) != length)
-			throw MissingVolumeData (SRC_POS);
+		size_t chunkSize = ReadChunkSize - ReadChunkSize % SectorSize;
 
-		// first sector can be unencrypted in some cases (e.g. windows repair)
-		// detect this case by looking for NTFS header
-		if (SystemEncryption && (hostOffset == 0) && ((BE64 (*(uint64 *) buffer.Get ())) == 0xEB52904E54465320ULL))
+		if (chunkSize == 0 || length <= chunkSize || !EncryptionThreadPool::IsRunning())
 		{
-			bufferOffset = (size_t) SectorSize;
-			hostOffset += SectorSize;
-			length -= SectorSize;
+			if (VolumeFile->ReadAt (buffer, hostOffset) != length)
+				throw MissingVolumeData (SRC_POS);
+
+			uint64 encryptedLength = GetEncryptedRange (buffer, hostOffset, encryptedOffset);
+			if (encryptedLength)
+				EA->DecryptSectors (buffer.GetRange (encryptedOffset, encryptedLength), (hostOffset + encryptedOffset) / SectorSize, encryptedLength / SectorSize, SectorSize);
+
+			TotalDataRead += length - encryptedOffset;
+			return;
 		}
 
-		if (length)
+		// Pipelined read: each chunk is decrypted by the thread pool while the next one is being read.
+		// All chunks are submitted at once to I/O engines able to perform them concurrently.
+		// Pending work is waited for by the token and batch destructors if reading fails.
+		const EncryptionMode *mode = EA->GetMode().get();
+		EncryptionThreadPool::AsyncWork works[2];
+		size_t skippedLength = 0;
+
+		FileIoBatch readBatch (*VolumeFile);
+		for (uint64 chunkOffset = 0; chunkOffset < length; chunkOffset += chunkSize)
+			readBatch.AddRead (buffer.GetRange ((size_t) chunkOffset, (size_t) VC_MIN ((uint64) chunkSize, length - chunkOffset)), hostOffset + chunkOffset);
+
+		readBatch.Submit();
+
+		for (uint64 chunkOffset = 0, chunkIndex = 0; chunkOffset < length; chunkOffset += chunkSize, ++chunkIndex)
 		{
-			if (EncryptionNotCompleted)
+			BufferPtr chunk = buffer.GetRange ((size_t) chunkOffset, (size_t) VC_MIN ((uint64) chunkSize, length - chunkOffset));
+			uint64 chunkHostOffset = hostOffset + chunkOffset;
+
+			if (readBatch.Wait ((size_t) chunkIndex) != chunk.Size())
+				throw MissingVolumeData (SRC_POS);
+
+			uint64 encryptedLength = GetEncryptedRange (chunk, chunkHostOffset, encryptedOffset);
+			if (chunkOffset == 0)
+				skippedLength = encryptedOffset;
+
+			if (encryptedLength)
 			{
-				// if encryption is not complete, we decrypt only the encrypted sectors
-				if (hostOffset < EncryptedDataSize)
-				{
-					uint64 encryptedLength = VC_MIN (length, (EncryptedDataSize - hostOffset));
+				EncryptionThreadPool::AsyncWork &work = works[chunkIndex % array_capacity (works)];
+				work.Wait();
 
-					EA->DecryptSectors (buffer.GetRange (bufferOffset, encryptedLength), hostOffset / SectorSize, encryptedLength / SectorSize, SectorSize);			
-				}
+				EncryptionThreadPool::BeginWork (work, EncryptionThreadPool::WorkType::DecryptDataUnits, mode,
+					chunk.Get() + encryptedOffset, (chunkHostOffset + encryptedOffset) / SectorSize, encryptedLength / SectorSize, SectorSize);
 			}
-			else
-				EA->DecryptSectors (buffer.GetRange (bufferOffset, length), hostOffset / SectorSize, length / SectorSize, SectorSize);
 		}
 
-		TotalDataRead += length;
+		for (size_t i = 0; i < array_capacity (works); ++i)
+			works[i].Wait();
+
+		TotalDataRead += length - skippedLength;
 	}
 
 	void Volume::ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf)
@@ -395,16 +472,39 @@ namespace VeraCrypt
 		if (Protection == VolumeProtection::HiddenVolumeReadOnly)
 			CheckProtectedRange (hostOffset, length);
 
-		SecureBuffer encBuf (buffer.Size());
+		PooledSecureBuffer encBuf (ScratchBufferPool, buffer.Size());
 		encBuf.CopyFrom (buffer);
 
-		EA->EncryptSectors (encBuf, hostOffset / SectorSize, length / SectorSize, SectorSize);
-		VolumeFile->WriteAt (encBuf, hostOffset);
+		FileIoBatch writeBatch (*VolumeFile);
+
+		if (writeBatch.GetEngine() == FileIoEngine::Blocking || length <= WriteChunkSize)
+		{
+			EA->EncryptSectors (encBuf, hostOffset / SectorSize, length / SectorSize, SectorSize);
+			VolumeFile->WriteAt (encBuf, hostOffset);
+		}
+		else
+		{
+			// Each chunk is written while the next one is being encrypted
+			for (uint64 chunkOffset = 0; chunkOffset < length; chunkOffset += WriteChunkSize)
+			{
+				uint64 chunkLength = VC_MIN ((uint64) WriteChunkSize, length - chunkOffset);
+				BufferPtr chunk = encBuf.GetRange ((size_t) chunkOffset, (size_t) chunkLength);
+
+				EA->EncryptSectors (chunk, (hostOffset + chunkOffset) / SectorSize, chunkLength / SectorSize, SectorSize);
+
+				writeBatch.AddWrite (chunk, hostOffset + chunkOffset);
+				writeBatch.Submit();
+			}
+
+			writeBatch.WaitAll();
+		}
 
 		TotalDataWritten += length;
 
 		uint64 writeEndOffset = byteOffset + buffer.Size();
-		if (writeEndOffset > TopWriteOffset)
-			TopWriteOffset = writeEndOffset;
+		uint64 topWriteOffset = TopWriteOffset;
+
+		while (writeEndOffset > topWriteOffset && !TopWriteOffset.compare_exchange_weak (topWriteOffset, writeEndOffset))
+			;
 	}
 }
@@ -13,7 +13,9 @@
 #ifndef TC_HEADER_Volume_Volume
 #define TC_HEADER_Volume_Volume
 
+#include <atomic>
 #include "Platform/Platform.h"
+#include "Platform/SecureBufferPool.h"
 #include "Platform/StringConverter.h"
 #include "EncryptionAlgorithm.h"
 #include "EncryptionMode.h"
@@ -79,9 +81,14 @@ namespace VeraCrypt
 		};
 	};
 
+	// Sector I/O (ReadSectors and WriteSectors) may be performed by several threads concurrently,
+	// e.g. by the multithreaded FUSE service; opening, closing and header updates may not.
 	class Volume
 	{
 	public:
+		static const size_t DefaultReadChunkSize = 0;	// Pipelined reads are enabled per mount (see SetReadChunkSize())
+		static const size_t WriteChunkSize = 256 * 1024;	// Used if the I/O engine can write a chunk while the next one is encrypted
+
 		Volume ();
 		virtual ~Volume ();
 
@@ -92,7 +99,9 @@ namespace VeraCrypt
 		shared_ptr <VolumeHeader> GetHeader () const { return Header; }
 		uint64 GetHeaderCreationTime () const { return Header->GetHeaderCreationTime(); }
 		uint64 GetHostSize () const { return VolumeHostSize; }
+		size_t GetReadChunkSize () const { return ReadChunkSize; }
 		shared_ptr <VolumeLayout> GetLayout () const { return Layout; }
+		SecureBufferPool &GetScratchBufferPool () { return ScratchBufferPool; }
 		VolumePath GetPath () const { return VolumeFile->GetPath(); }
 		VolumeProtection::Enum GetProtectionType () const { return Protection; }
 		shared_ptr <Pkcs5Kdf> GetPkcs5Kdf () const { return Header->GetPkcs5Kdf(); }
@@ -108,25 +117,29 @@ namespace VeraCrypt
 		uint64 GetVolumeCreationTime () const { return Header->GetVolumeCreationTime(); }
 		bool IsHiddenVolumeProtectionTriggered () const { return HiddenVolumeProtectionTriggered; }
 		bool IsInSystemEncryptionScope () const { return SystemEncryption; }
-		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
-		void Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false);
+		void Open (const VolumePath &volumePath, bool preserveTimestamps, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (),shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), bool sharedAccessAllowed = false, VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false, const VolumeHeaderHint &headerHint = VolumeHeaderHint());
+		void Open (shared_ptr <File> volumeFile, shared_ptr <VolumePassword> password, int pim, shared_ptr <Pkcs5Kdf> kdf, shared_ptr <KeyfileList> keyfiles, bool emvSupportEnabled, VolumeProtection::Enum protection = VolumeProtection::None, shared_ptr <VolumePassword> protectionPassword = shared_ptr <VolumePassword> (), int protectionPim = 0, shared_ptr <Pkcs5Kdf> protectionKdf = shared_ptr <Pkcs5Kdf> (), shared_ptr <KeyfileList> protectionKeyfiles = shared_ptr <KeyfileList> (), VolumeType::Enum volumeType = VolumeType::Unknown, bool useBackupHeaders = false, bool partitionInSystemEncryptionScope = false, const VolumeHeaderHint &headerHint = VolumeHeaderHint());
 		void ReadSectors (const BufferPtr &buffer, uint64 byteOffset);
 		void ReEncryptHeader (bool backupHeader, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf);
+		void SetReadChunkSize (size_t chunkSize) { ReadChunkSize = chunkSize; }	// Zero disables pipelined reads
 		void WriteSectors (const ConstBufferPtr &buffer, uint64 byteOffset);
 		bool IsEncryptionNotCompleted () const { return EncryptionNotCompleted; }
 		bool IsMasterKeyVulnerable() const { return Header && Header->IsMasterKeyVulnerable(); }
 
 	protected:
 		void CheckProtectedRange (uint64 writeHostOffset, uint64 writeLength);
+		uint64 GetEncryptedRange (const ConstBufferPtr &data, uint64 hostOffset, size_t &encryptedOffset) const;
 		void ValidateState () const;
 
 		shared_ptr <EncryptionAlgorithm> EA;
 		shared_ptr <VolumeHeader> Header;
-		bool HiddenVolumeProtectionTriggered;
+		atomic <bool> HiddenVolumeProtectionTriggered;
 		shared_ptr <VolumeLayout> Layout;
 		uint64 ProtectedRangeStart;
 		uint64 ProtectedRangeEnd;
 		VolumeProtection::Enum Protection;
+		size_t ReadChunkSize;
+		SecureBufferPool ScratchBufferPool;
 		size_t SectorSize;
 		bool SystemEncryption;
 		VolumeType::Enum Type;
@@ -135,9 +148,9 @@ namespace VeraCrypt
 		uint64 VolumeDataOffset;
 		uint64 VolumeDataSize;
 		uint64 EncryptedDataSize;
-		uint64 TopWriteOffset;
-		uint64 TotalDataRead;
-		uint64 TotalDataWritten;
+		atomic <uint64> TopWriteOffset;
+		atomic <uint64> TotalDataRead;
+		atomic <uint64> TotalDataWritten;
 		int Pim;
 		bool EncryptionNotCompleted;
 
@@ -145,6 +158,8 @@ namespace VeraCrypt
 		Volume (const Volume &);
 		Volume &operator= (const Volume &);
 	};
+
+	typedef list < shared_ptr <Volume> > VolumeList;
 }
 
 #endif // TC_HEADER_Volume_Volume
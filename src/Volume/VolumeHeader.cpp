@@ -201,8 +201,205 @@ namespace VeraCrypt
 		return false;
 	}
 
-	bool VolumeHeader::DecryptWithHeaderKey (const ConstBufferPtr &encryptedData, shared_ptr <Pkcs5Kdf> pkcs5, const ConstBufferPtr &headerKey, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes)
+	int VolumeHeader::DecryptFirst (const VolumeHeaderCandidateList &candidates, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const VolumeHeaderHint &hint)
 	{
+		if (password.Size() < 1)
+			throw PasswordEmpty (SRC_POS);
+
+		if (!hint.IsEmpty())
+		{
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				const VolumeHeaderCandidate &candidate = candidates[i];
+				if (!candidate.HintApplicable)
+					continue;
+
+				shared_ptr <Pkcs5Kdf> hintedKdf;
+				Pkcs5KdfList otherKeyDerivationFunctions;
+
+				foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidate.KeyDerivationFunctions)
+				{
+					if (!hintedKdf && pkcs5->GetName() == hint.Pkcs5PrfName && (!kdf || kdf->GetName() == pkcs5->GetName()))
+						hintedKdf = pkcs5;
+					else
+						otherKeyDerivationFunctions.push_back (pkcs5);
+				}
+
+				if (!hintedKdf)
+					break;
+
+				EncryptionAlgorithmList encryptionAlgorithms;
+				foreach (shared_ptr <EncryptionAlgorithm> ea, candidate.EncryptionAlgorithms)
+				{
+					if (ea->GetName() == hint.EncryptionAlgorithmName)
+						encryptionAlgorithms.push_front (ea);
+					else
+						encryptionAlgorithms.push_back (ea);
+				}
+
+				// The normal volume header precedes the other candidates, so a match is accepted without trying them
+				SecureBuffer headerKey (GetHeaderKeyDerivationSize (hintedKdf));
+				int derivationResult = hintedKdf->DeriveKey (headerKey, password, pim, candidate.EncryptedData.GetRange (SaltOffset, SaltSize));
+				if (derivationResult != 0 && kdf)
+					throw ExternalException (SRC_POS, hintedKdf->GetDerivationFailureMessage (derivationResult));
+
+				if (derivationResult == 0 && candidate.Header->DecryptWithHeaderKey (candidate.EncryptedData, hintedKdf, headerKey, encryptionAlgorithms, candidate.EncryptionModes))
+					return (int) i;
+
+				VolumeHeaderCandidateList remainingCandidates (candidates);
+				remainingCandidates[i].KeyDerivationFunctions = otherKeyDerivationFunctions;
+
+				return DecryptFirst (remainingCandidates, password, pim, kdf);
+			}
+		}
+
+		size_t derivationCount = 0;
+		for (size_t i = 0; i < candidates.size(); ++i)
+		{
+			foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidates[i].KeyDerivationFunctions)
+			{
+				if (!kdf || kdf->GetName() == pkcs5->GetName())
+					++derivationCount;
+			}
+		}
+
+		if (!EncryptionThreadPool::IsRunning() || candidates.size() < 2 || derivationCount < 2)
+		{
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				const VolumeHeaderCandidate &candidate = candidates[i];
+				if (candidate.Header->Decrypt (candidate.EncryptedData, password, pim, kdf, candidate.KeyDerivationFunctions, candidate.EncryptionAlgorithms, candidate.EncryptionModes))
+					return (int) i;
+			}
+			return -1;
+		}
+
+		// Keys of all candidates are derived at the same time. A decrypted header aborts derivations of the candidates
+		// following it, but is only reported once all candidates preceding it have been rejected.
+		typedef EncryptionThreadPool::KeyDerivationWorkItem KeyDerivationWorkItem;
+
+		struct CandidateKeyDerivation
+		{
+			size_t Candidate;
+			shared_ptr <KeyDerivationWorkItem> WorkItem;
+		};
+
+		vector <CandidateKeyDerivation> keyDerivations;
+		unique_ptr <long volatile[]> abortKeyDerivation (new long volatile[candidates.size()]);
+		vector <size_t> pendingDerivationCount (candidates.size(), 0);
+		SharedVal <size_t> outstandingWorkItemCount (0);
+		SyncEvent keyDerivationCompletedEvent;
+		SyncEvent noOutstandingWorkItemEvent;
+		size_t enqueuedWorkItemCount = 0;
+		size_t processedWorkItemCount = 0;
+		bool workItemsDrained = false;
+		int decryptedCandidate = -1;
+
+		for (size_t i = 0; i < candidates.size(); ++i)
+			abortKeyDerivation[i] = 0;
+
+		try
+		{
+			for (size_t i = 0; i < candidates.size(); ++i)
+			{
+				const VolumeHeaderCandidate &candidate = candidates[i];
+				ConstBufferPtr salt (candidate.EncryptedData.GetRange (SaltOffset, SaltSize));
+
+				foreach (shared_ptr <Pkcs5Kdf> pkcs5, candidate.KeyDerivationFunctions)
+				{
+					if (kdf && kdf->GetName() != pkcs5->GetName())
+						continue;
+
+					CandidateKeyDerivation keyDerivation;
+					keyDerivation.Candidate = i;
+					keyDerivation.WorkItem.reset (new KeyDerivationWorkItem (pkcs5, GetHeaderKeyDerivationSize (pkcs5)));
+					keyDerivations.push_back (keyDerivation);
+
+					EncryptionThreadPool::BeginKeyDerivation (*keyDerivation.WorkItem, password, pim, salt, keyDerivationCompletedEvent, noOutstandingWorkItemEvent, outstandingWorkItemCount, &abortKeyDerivation[i]);
+					++enqueuedWorkItemCount;
+					++pendingDerivationCount[i];
+				}
+			}
+
+			while (processedWorkItemCount < keyDerivations.size())
+			{
+				if (decryptedCandidate >= 0)
+				{
+					size_t precedingPendingCount = 0;
+					for (int i = 0; i < decryptedCandidate; ++i)
+						precedingPendingCount += pendingDerivationCount[i];
+
+					if (precedingPendingCount == 0)
+						break;
+				}
+
+				bool processed = false;
+
+				for (size_t derivation = 0; derivation < keyDerivations.size(); ++derivation)
+				{
+					const CandidateKeyDerivation &keyDerivation = keyDerivations[derivation];
+					KeyDerivationWorkItem &workItem = *keyDerivation.WorkItem;
+
+					if (workItem.Processed || !workItem.Completed.Get())
+						continue;
+
+					workItem.Processed = true;
+					++processedWorkItemCount;
+					--pendingDerivationCount[keyDerivation.Candidate];
+					processed = true;
+
+					if (workItem.ItemException.get())
+						workItem.ItemException->Throw();
+
+					if (decryptedCandidate >= 0 && keyDerivation.Candidate >= (size_t) decryptedCandidate)
+						continue;
+
+					if (workItem.Result != 0)
+					{
+						if (!kdf)
+							continue;
+
+						throw ExternalException (SRC_POS, workItem.Kdf->GetDerivationFailureMessage (workItem.Result));
+					}
+
+					const VolumeHeaderCandidate &candidate = candidates[keyDerivation.Candidate];
+					if (candidate.Header->DecryptWithHeaderKey (candidate.EncryptedData, workItem.Kdf, workItem.DerivedKey, candidate.EncryptionAlgorithms, candidate.EncryptionModes))
+					{
+						decryptedCandidate = (int) keyDerivation.Candidate;
+
+						for (size_t i = keyDerivation.Candidate; i < candidates.size(); ++i)
+							abortKeyDerivation[i] = 1;
+					}
+				}
+
+				if (processedWorkItemCount < keyDerivations.size() && !processed)
+					keyDerivationCompletedEvent.Wait();
+			}
+		}
+		catch (...)
+		{
+			for (size_t i = 0; i < candidates.size(); ++i)
+				abortKeyDerivation[i] = 1;
+
+			DrainKeyDerivationWorkItems (noOutstandingWorkItemEvent, enqueuedWorkItemCount, workItemsDrained);
+			throw;
+		}
+
+		for (size_t i = 0; i < candidates.size(); ++i)
+			abortKeyDerivation[i] = 1;
+
+		DrainKeyDerivationWorkItems (noOutstandingWorkItemEvent, enqueuedWorkItemCount, workItemsDrained);
+		return decryptedCandidate;
+	}
+
+	bool VolumeHeader::DecryptWithHeaderKey (const ConstBufferPtr &encryptedData, shared_ptr <Pkcs5Kdf> pkcs5, const ConstBufferPtr &headerKey, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, bool earlyReject)
+	{
+		struct KeyedAlgorithm
+		{
+			shared_ptr <EncryptionAlgorithm> EA;
+			shared_ptr <EncryptionMode> Mode;
+		};
+
 		SecureBuffer header (EncryptedHeaderDataSize);
 
 		foreach (shared_ptr <EncryptionMode> mode, encryptionModes)
@@ -220,6 +417,8 @@ namespace VeraCrypt
 				mode->SetKey (headerKey.GetRange (0, mode->GetKeySize()));
 			}
 
+			vector <KeyedAlgorithm> keyedAlgorithms;
+
 			foreach (shared_ptr <EncryptionAlgorithm> ea, encryptionAlgorithms)
 			{
 				if (!ea->IsModeSupported (mode))
@@ -246,12 +445,45 @@ namespace VeraCrypt
 
 				ea->SetMode (mode);
 
+				KeyedAlgorithm keyedAlgorithm;
+				keyedAlgorithm.EA = ea;
+				keyedAlgorithm.Mode = mode;
+				keyedAlgorithms.push_back (keyedAlgorithm);
+			}
+
+		#ifndef WOLFCRYPT_BACKEND
+			if (xtsMode && earlyReject && !keyedAlgorithms.empty())
+			{
+				// The magic is held by the first cipher block of the header, which is decrypted for all algorithms
+				// before any header is decrypted in full
+				SecureBuffer firstBlocks (keyedAlgorithms.size() * BYTES_PER_XTS_BLOCK);
+				size_t acceptedCount = 0;
+
+				for (size_t i = 0; i < keyedAlgorithms.size(); ++i)
+				{
+					uint8 *firstBlock = firstBlocks.Ptr() + i * BYTES_PER_XTS_BLOCK;
+					memcpy (firstBlock, encryptedData.Get() + EncryptedHeaderDataOffset, BYTES_PER_XTS_BLOCK);
+
+					static_cast <const EncryptionModeXTS &> (*keyedAlgorithms[i].Mode).DecryptPartialDataUnit (firstBlock, 0, 0, 1);
+
+					if (memcmp (firstBlock, "VERA", 4) == 0)
+						keyedAlgorithms[acceptedCount++] = keyedAlgorithms[i];
+				}
+
+				keyedAlgorithms.resize (acceptedCount);
+			}
+		#endif
+
+			for (size_t i = 0; i < keyedAlgorithms.size(); ++i)
+			{
+				KeyedAlgorithm &keyedAlgorithm = keyedAlgorithms[i];
+
 				header.CopyFrom (encryptedData.GetRange (EncryptedHeaderDataOffset, EncryptedHeaderDataSize));
-				ea->Decrypt (header);
+				keyedAlgorithm.EA->Decrypt (header);
 
-				if (Deserialize (header, ea, mode))
+				if (Deserialize (header, keyedAlgorithm.EA, keyedAlgorithm.Mode))
 				{
-					EA = ea;
+					EA = keyedAlgorithm.EA;
 					Pkcs5 = pkcs5;
 					return true;
 				}
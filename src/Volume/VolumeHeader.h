@@ -53,6 +53,34 @@ namespace VeraCrypt
 		VolumeType::Enum Type;
 	};
 
+	class VolumeHeader;
+
+	// Non-secret record of the parameters with which the normal volume header at a path was last decrypted.
+	// Hints never refer to hidden volume or backup headers, so that they do not reveal a hidden volume.
+	struct VolumeHeaderHint
+	{
+		bool IsEmpty () const { return Pkcs5PrfName.empty(); }
+
+		wstring Pkcs5PrfName;
+		wstring EncryptionAlgorithmName;
+	};
+
+	// Encrypted header of a volume layout tried by VolumeHeader::DecryptFirst (). Candidates must not share
+	// header, encryption algorithm or encryption mode objects.
+	struct VolumeHeaderCandidate
+	{
+		VolumeHeaderCandidate () : HintApplicable (false) { }
+
+		shared_ptr <VolumeHeader> Header;
+		ConstBufferPtr EncryptedData;
+		bool HintApplicable;	// Primary header of a normal volume, to which a VolumeHeaderHint may refer
+		Pkcs5KdfList KeyDerivationFunctions;
+		EncryptionAlgorithmList EncryptionAlgorithms;
+		EncryptionModeList EncryptionModes;
+	};
+
+	typedef vector <VolumeHeaderCandidate> VolumeHeaderCandidateList;
+
 	class VolumeHeader
 	{
 	public:
@@ -61,6 +89,11 @@ namespace VeraCrypt
 
 		void Create (const BufferPtr &headerBuffer, VolumeHeaderCreationOptions &options);
 		bool Decrypt (const ConstBufferPtr &encryptedData, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const Pkcs5KdfList &keyDerivationFunctions, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes);
+		// Decrypts the header of each candidate (keys of all candidates are derived concurrently if possible) and returns
+		// the index of the first candidate in list order whose header was decrypted, or -1. If a hint is given, the hinted KDF
+		// and encryption algorithm are tried alone first on the first candidate to which hints apply, and all other
+		// derivations are started only if they fail.
+		static int DecryptFirst (const VolumeHeaderCandidateList &candidates, const VolumePassword &password, int pim, shared_ptr <Pkcs5Kdf> kdf, const VolumeHeaderHint &hint = VolumeHeaderHint());
 		void EncryptNew (const BufferPtr &newHeaderBuffer, const ConstBufferPtr &newSalt, const ConstBufferPtr &newHeaderKey, shared_ptr <Pkcs5Kdf> newPkcs5Kdf);
 		uint64 GetEncryptedAreaStart () const { return EncryptedAreaStart; }
 		uint64 GetEncryptedAreaLength () const { return EncryptedAreaLength; }
@@ -80,7 +113,7 @@ namespace VeraCrypt
 		bool IsMasterKeyVulnerable () const { return XtsKeyVulnerable; }
 
 	protected:
-		bool DecryptWithHeaderKey (const ConstBufferPtr &encryptedData, shared_ptr <Pkcs5Kdf> pkcs5, const ConstBufferPtr &headerKey, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes);
+		bool DecryptWithHeaderKey (const ConstBufferPtr &encryptedData, shared_ptr <Pkcs5Kdf> pkcs5, const ConstBufferPtr &headerKey, const EncryptionAlgorithmList &encryptionAlgorithms, const EncryptionModeList &encryptionModes, bool earlyReject = true);
 		bool Deserialize (const ConstBufferPtr &header, shared_ptr <EncryptionAlgorithm> &ea, shared_ptr <EncryptionMode> &mode);
 		template <typename T> T DeserializeEntry (const ConstBufferPtr &header, size_t &offset) const;
 		template <typename T> T DeserializeEntryAt (const ConstBufferPtr &header, const size_t &offset) const;
@@ -125,6 +158,8 @@ namespace VeraCrypt
 		SecureBuffer DataAreaKey;
 		bool XtsKeyVulnerable;
 
+		friend struct HeaderTrialBenchmark;
+
 	private:
 		VolumeHeader (const VolumeHeader &);
 		VolumeHeader &operator= (const VolumeHeader &);
@@ -0,0 +1,101 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#include "VolumeHeaderHintStore.h"
+
+namespace VeraCrypt
+{
+	void VolumeHeaderHintStore::Clear ()
+	{
+		ScopeLock lock (HintsMutex);
+		Hints.clear();
+		MountStatistics = Statistics();
+	}
+
+	VolumeHeaderHint VolumeHeaderHintStore::Find (const VolumePath &volumePath)
+	{
+		ScopeLock lock (HintsMutex);
+
+		VolumeHeaderHintMap::const_iterator hint = Hints.find (wstring (volumePath));
+		if (hint == Hints.end())
+			return VolumeHeaderHint();
+
+		return hint->second;
+	}
+
+	VolumeHeaderHintMap VolumeHeaderHintStore::GetHints ()
+	{
+		ScopeLock lock (HintsMutex);
+		return Hints;
+	}
+
+	VolumeHeaderHintStore::Statistics VolumeHeaderHintStore::GetStatistics ()
+	{
+		ScopeLock lock (HintsMutex);
+		return MountStatistics;
+	}
+
+	void VolumeHeaderHintStore::RecordMount (const VolumeHeaderHint &usedHint, const VolumeInfo &mountedVolume, uint64 mountTime)
+	{
+		// Neither a hint nor a statistic may depend on the header of a hidden volume
+		if (mountedVolume.Type != VolumeType::Normal)
+			return;
+
+		{
+			ScopeLock lock (HintsMutex);
+
+			if (usedHint.IsEmpty())
+			{
+				++MountStatistics.UnhintedMounts;
+				MountStatistics.UnhintedMountTime += mountTime;
+			}
+			else
+			{
+				++MountStatistics.HintedMounts;
+				MountStatistics.HintedMountTime += mountTime;
+
+				if (usedHint.Pkcs5PrfName != mountedVolume.Pkcs5PrfName
+					|| usedHint.EncryptionAlgorithmName != mountedVolume.EncryptionAlgorithmName)
+				{
+					++MountStatistics.HintMisses;
+				}
+			}
+		}
+
+		UpdateHint (mountedVolume);
+	}
+
+	void VolumeHeaderHintStore::SetHints (const VolumeHeaderHintMap &hints, const Statistics &statistics)
+	{
+		ScopeLock lock (HintsMutex);
+		Hints = hints;
+		MountStatistics = statistics;
+	}
+
+	void VolumeHeaderHintStore::UpdateHint (const VolumeInfo &mountedVolume)
+	{
+		if (mountedVolume.Type != VolumeType::Normal || mountedVolume.Pkcs5PrfName.empty())
+			return;
+
+		ScopeLock lock (HintsMutex);
+
+		wstring path = wstring (mountedVolume.Path);
+		if (Hints.size() >= Capacity && Hints.find (path) == Hints.end())
+			return;
+
+		VolumeHeaderHint &hint = Hints[path];
+		hint.Pkcs5PrfName = mountedVolume.Pkcs5PrfName;
+		hint.EncryptionAlgorithmName = mountedVolume.EncryptionAlgorithmName;
+	}
+
+	bool VolumeHeaderHintStore::Enabled = false;
+	VolumeHeaderHintMap VolumeHeaderHintStore::Hints;
+	Mutex VolumeHeaderHintStore::HintsMutex;
+	VolumeHeaderHintStore::Statistics VolumeHeaderHintStore::MountStatistics;
+}
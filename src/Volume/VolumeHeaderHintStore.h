@@ -0,0 +1,60 @@
+/*
+ VeraCrypt source code
+ Copyright (c) 2026 AM Crypto
+
+ Governed by the Apache License 2.0 the full text of which is contained in
+ the file License.txt included in VeraCrypt binary and source code
+ distribution packages.
+*/
+
+#ifndef TC_HEADER_Volume_VolumeHeaderHintStore
+#define TC_HEADER_Volume_VolumeHeaderHintStore
+
+#include "Platform/Platform.h"
+#include "VolumeHeader.h"
+#include "VolumeInfo.h"
+
+namespace VeraCrypt
+{
+	typedef map <wstring, VolumeHeaderHint> VolumeHeaderHintMap;
+
+	// Records the KDF and encryption algorithm that last opened the normal volume header at each path so that the next
+	// mount can try them first. Mounts of hidden volumes are not recorded. Hints do not contain secrets but reveal which
+	// files and devices hold volumes; the store is therefore opt-in.
+	class VolumeHeaderHintStore
+	{
+	public:
+		struct Statistics
+		{
+			Statistics () : HintedMounts (0), HintMisses (0), UnhintedMounts (0), HintedMountTime (0), UnhintedMountTime (0) { }
+
+			uint64 HintedMounts;		// Mounts for which a hint was available
+			uint64 HintMisses;			// Hinted mounts opened with a different KDF or encryption algorithm
+			uint64 UnhintedMounts;
+			uint64 HintedMountTime;		// Milliseconds spent in hinted mounts
+			uint64 UnhintedMountTime;	// Milliseconds spent in unhinted mounts
+		};
+
+		static void Clear ();
+		static void Enable (bool enable) { Enabled = enable; }
+		static VolumeHeaderHint Find (const VolumePath &volumePath);
+		static VolumeHeaderHintMap GetHints ();
+		static Statistics GetStatistics ();
+		static bool IsEnabled () { return Enabled; }
+		static void RecordMount (const VolumeHeaderHint &usedHint, const VolumeInfo &mountedVolume, uint64 mountTime);
+		static void SetHints (const VolumeHeaderHintMap &hints, const Statistics &statistics);
+		static void UpdateHint (const VolumeInfo &mountedVolume);	// Updates the hint without recording statistics
+		static const size_t Capacity = 1024;
+
+	protected:
+		static bool Enabled;
+		static VolumeHeaderHintMap Hints;
+		static Mutex HintsMutex;
+		static Statistics MountStatistics;
+
+	private:
+		VolumeHeaderHintStore ();
+	};
+}
+
+#endif // TC_HEADER_Volume_VolumeHeaderHintStore